@@ -97,7 +97,6 @@ namespace {
 // =============================================================================
 // EXTERNAL FUNCTION DECLARATIONS
 // =============================================================================
-void send_gmcp_event(DESCRIPTOR_DATA* desc, const char* event, const char* json);
 extern int top_help;
 extern int top_area;
 
@@ -1160,22 +1159,6 @@ CMDF do_look(CHAR_DATA* ch, const char* argument)
                 show_list_to_char(ch->in_room->first_content, ch, FALSE,
                                   FALSE);
                 show_char_to_char(ch->in_room->first_person, ch);
-                if (ch->desc)
-                {
-                        /* Send detailed Room.Info for web navigation */
-                        char room_buf[1024];
-                        char desc_buf[512];
-                        mudstrlcpy(desc_buf, ch->in_room->description, sizeof(desc_buf));
-                        char *clean_desc = smash_color(desc_buf);
-                        snprintf(room_buf, sizeof(room_buf),
-                                 "{\"num\":%d,\"name\":\"%s\",\"desc\":\"%s\"}",
-                                 ch->in_room->vnum, ch->in_room->name, clean_desc);
-                        send_gmcp_event(ch->desc, "Core.Room.Info", room_buf);
-
-                        /* Send Area.Weather GMCP/GCMP event */
-                        /* If area weather support is added, send Area.Weather GMCP/GCMP event here. */
-                        /* Currently, area_data has no weather member, so this block is disabled. */
-                }
 
                 if (str_cmp(arg1, "auto"))
                         if ((ship =
@@ -3312,8 +3295,7 @@ CMDF do_who(CHAR_DATA* ch, [[maybe_unused]] const char* argument)
                          IS_SET(wch->pcdata->flags, PCFLAG_WORKING) ? "&Y [&RWORKING&Y]&W" : "&W",
                          IS_SET(wch->act, PLR_SILENCE) ? "&Y [&BS&zilenced&Y]&W" : "&W",
                          wch->desc->connected == CON_EDITING ? "&Y [&cWRITING&Y]" : 
-                         (wch->desc->connected == CON_IAFORKED || 
-                          wch->desc->connected == CON_FORKED) ? "&Y [&cCOMPILING&Y]" : "");
+                         shell_running(wch) ? "&Y [&cCOMPILING&Y]" : "");
                 
                 /* Copy the safely built string to the main buffer */
                 snprintf(buf, MSL, "%s", safe_buf);
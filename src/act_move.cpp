@@ -532,12 +532,30 @@ EXIT_DATA *get_exit(ROOM_INDEX_DATA * room, sh_int dir)
                 return NULL;
         }
 
+        if (dir >= 0 && dir <= DIR_SOMEWHERE)
+                return room->exit_dir[dir];
         for (xit = room->first_exit; xit; xit = xit->next)
                 if (xit->vdir == dir)
                         return xit;
         return NULL;
 }
 
+/*
+ * Rebuild a room's direction index from its exit list.  Whatever adds,
+ * removes, reorders or redirects exits calls this afterwards; the list
+ * stays the ordered record used for display and saving.
+ */
+void index_exits(ROOM_INDEX_DATA * room)
+{
+        EXIT_DATA *xit;
+
+        memset(room->exit_dir, 0, sizeof(room->exit_dir));
+        for (xit = room->first_exit; xit; xit = xit->next)
+                if (xit->vdir >= 0 && xit->vdir <= DIR_SOMEWHERE
+                    && !room->exit_dir[xit->vdir])
+                        room->exit_dir[xit->vdir] = xit;
+}
+
 /*
  * Function to get an exit, leading the the specified room
  */
@@ -551,7 +569,9 @@ EXIT_DATA *get_exit_to(ROOM_INDEX_DATA * room, sh_int dir, int vnum)
                 return NULL;
         }
 
-        for (xit = room->first_exit; xit; xit = xit->next)
+        xit = (dir >= 0 && dir <= DIR_SOMEWHERE) ? room->exit_dir[dir]
+                : room->first_exit;
+        for (; xit; xit = xit->next)
                 if (xit->vdir == dir && xit->vnum == vnum)
                         return xit;
         return NULL;
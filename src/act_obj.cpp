@@ -3106,6 +3106,9 @@ void free_object(OBJ_DATA * obj)
         }
         obj->first_extradesc = obj->last_extradesc = NULL;
         UNLINK(obj, first_object, last_object, next, prev);
+        UNLINK(obj, obj->pIndexData->first_instance,
+               obj->pIndexData->last_instance, next_instance, prev_instance);
+        obj_disown(obj);
 
         STRFREE(obj->name);
         STRFREE(obj->description);
@@ -64,9 +64,11 @@
 #include "mud.hpp"
 #include "changes.hpp"
 #include "boards.hpp"
+#include "bootload.hpp"
 #include "bounty.hpp"
 #include "account.hpp"
 #include "channels.hpp"
+#include "logging.hpp"
 #include "body.hpp"
 #include "cpp_compat.hpp"
 #include "races.hpp"
@@ -74,6 +76,7 @@
 #include "olc_bounty.hpp"
 #include "space2.hpp"
 #include "installations.hpp"
+#include "search.hpp"
 
 // ============================================================================
 // Constants and Configuration
@@ -2277,80 +2280,46 @@ CMDF do_mstat(CHAR_DATA * ch, char *argument)
 
 
 
+/*
+ * mfind and ofind answer from the name index in search.cpp, so results
+ * come back in vnum order and can be narrowed by vnum and level, and
+ * objects by type.
+ */
 CMDF do_mfind(CHAR_DATA * ch, char *argument)
 {
-/*  extern int top_mob_index; */
-        char      arg[MAX_INPUT_LENGTH];
-        MOB_INDEX_DATA *pMobIndex;
+        SEARCH_QUERY query;
+        std::vector < MOB_INDEX_DATA * >found;
+        size_t    first, last, i;
 
-/*  int vnum; */
-        int       hash;
-        int       nMatch;
-        bool      fAll;
-
-        one_argument(argument, arg);
-        if (arg[0] == '\0')
+        if (argument[0] == '\0')
         {
                 send_to_char("Mfind whom?\n\r", ch);
+                send_to_char
+                        ("Syntax: mfind <name|all> [vnum <lo-hi>] [level <lo-hi>] [page <n>]\n\r",
+                         ch);
                 return;
         }
+        if (!search_parse(ch, argument, &query, FALSE))
+                return;
 
-        fAll = !str_cmp(arg, "all");
-        nMatch = 0;
         set_pager_color(AT_PLAIN, ch);
-
-        /*
-         * Yeah, so iterating over all vnum's takes 10,000 loops.
-         * Get_mob_index is fast, and I don't feel like threading another link.
-         * Do you?
-         * -- Furey
-         */
-/*  for ( vnum = 0; nMatch < top_mob_index; vnum++ )
-    {
-	if ( ( pMobIndex = get_mob_index( vnum ) ) != NULL )
-	{
-	    if ( fAll || is_name( arg, pMobIndex->player_name ) )
-	    {
-		nMatch++;
-		snprintf( buf, MSL, "[%5d] %s\n\r",
-		    pMobIndex->vnum, capitalize( pMobIndex->short_descr ) );
-		send_to_char( buf, ch );
-	    }
-	}
-    }
-     */
-
-        /*
-         * This goes through all the hash entry points (1024), and is therefore
-         * much faster, though you won't get your vnums in order... oh well. :)
-         *
-         * Tests show that Furey's method will usually loop 32,000 times, calling
-         * get_mob_index()... which loops itself, an average of 1-2 times...
-         * So theoretically, the above routine may loop well over 40,000 times,
-         * and my routine bellow will loop for as many index_mobiles are on
-         * your mud... likely under 3000 times.
-         * -Thoric
-         */
-        for (hash = 0; hash < MAX_KEY_HASH; hash++)
-                for (pMobIndex = mob_index_hash[hash];
-                     pMobIndex; pMobIndex = pMobIndex->next)
-                        if (fAll
-                            || nifty_is_name(arg, pMobIndex->player_name))
-                        {
-                                nMatch++;
-                                pager_printf(ch, "[%5d] %s\n\r",
-                                             pMobIndex->vnum,
-                                             capitalize(pMobIndex->
-                                                        short_descr));
-                        }
-
-        if (nMatch)
-                pager_printf(ch, "Number of matches: %d\n", nMatch);
-        else
+        search_mobs(&query, found);
+        if (found.empty())
+        {
                 send_to_char
                         ("Nothing like that in hell, earth, or heaven.\n\r",
                          ch);
+                return;
+        }
+        if (!search_page(ch, &query, found.size(),
+                         &first, &last))
+                return;
 
+        for (i = first; i < last; i++)
+                pager_printf(ch, "[%5d] %s\n\r", found[i]->vnum,
+                             capitalize(found[i]->short_descr));
+        pager_printf(ch, "Number of matches: %d\n",
+                     static_cast < int >(found.size()));
         return;
 }
 
@@ -2358,116 +2327,87 @@ CMDF do_mfind(CHAR_DATA * ch, char *argument)
 
 CMDF do_ofind(CHAR_DATA * ch, char *argument)
 {
-/*  extern int top_obj_index; */
-        char      arg[MAX_INPUT_LENGTH];
-        OBJ_INDEX_DATA *pObjIndex;
-
-/*  int vnum; */
-        int       hash;
-        int       nMatch;
-        bool      fAll;
+        SEARCH_QUERY query;
+        std::vector < OBJ_INDEX_DATA * >found;
+        size_t    first, last, i;
 
-        one_argument(argument, arg);
-        if (arg[0] == '\0')
+        if (argument[0] == '\0')
         {
                 send_to_char("Ofind what?\n\r", ch);
+                send_to_char
+                        ("Syntax: ofind <name|all> [vnum <lo-hi>] [level <lo-hi>] [type <type>] [page <n>]\n\r",
+                         ch);
                 return;
         }
+        if (!search_parse(ch, argument, &query, TRUE))
+                return;
 
         set_pager_color(AT_PLAIN, ch);
-        fAll = !str_cmp(arg, "all");
-        nMatch = 0;
-/*  nLoop	= 0; */
-
-        /*
-         * Yeah, so iterating over all vnum's takes 10,000 loops.
-         * Get_obj_index is fast, and I don't feel like threading another link.
-         * Do you?
-         * -- Furey
-         for ( vnum = 0; nMatch < top_obj_index; vnum++ )
-         {
-         nLoop++;
-         if ( ( pObjIndex = get_obj_index( vnum ) ) != NULL )
-         {
-         if ( fAll || nifty_is_name( arg, pObjIndex->name ) )
-         {
-         nMatch++;
-         snprintf( buf, MSL, "[%5d] %s\n\r",
-         pObjIndex->vnum, capitalize( pObjIndex->short_descr ) );
-         send_to_char( buf, ch );
-         }
-         }
-         }
-         */
-
-        /*
-         * This goes through all the hash entry points (1024), and is therefore
-         * much faster, though you won't get your vnums in order... oh well. :)
-         *
-         * Tests show that Furey's method will usually loop 32,000 times, calling
-         * get_obj_index()... which loops itself, an average of 2-3 times...
-         * So theoretically, the above routine may loop well over 50,000 times,
-         * and my routine bellow will loop for as many index_objects are on
-         * your mud... likely under 3000 times.
-         * -Thoric
-         */
-        for (hash = 0; hash < MAX_KEY_HASH; hash++)
-                for (pObjIndex = obj_index_hash[hash];
-                     pObjIndex; pObjIndex = pObjIndex->next)
-                        if (fAll || nifty_is_name(arg, pObjIndex->name))
-                        {
-                                nMatch++;
-                                pager_printf(ch, "[%5d] %s\n\r",
-                                             pObjIndex->vnum,
-                                             capitalize(pObjIndex->
-                                                        short_descr));
-                        }
-
-        if (nMatch)
-                pager_printf(ch, "Number of matches: %d\n", nMatch);
-        else
+        search_objs(&query, found);
+        if (found.empty())
+        {
                 send_to_char
                         ("Nothing like that in hell, earth, or heaven.\n\r",
                          ch);
+                return;
+        }
+        if (!search_page(ch, &query, found.size(),
+                         &first, &last))
+                return;
 
+        for (i = first; i < last; i++)
+                pager_printf(ch, "[%5d] %s\n\r", found[i]->vnum,
+                             capitalize(found[i]->short_descr));
+        pager_printf(ch, "Number of matches: %d\n",
+                     static_cast < int >(found.size()));
         return;
 }
 
 
 
+/*
+ * A bare vnum finds every copy of that prototype.
+ */
 CMDF do_mwhere(CHAR_DATA * ch, char *argument)
 {
-        char      arg[MAX_INPUT_LENGTH];
+        SEARCH_QUERY query;
+        std::vector < CHAR_DATA * >found;
         CHAR_DATA *victim;
-        bool      found;
+        size_t    first, last, i;
 
-        one_argument(argument, arg);
-        if (arg[0] == '\0')
+        if (argument[0] == '\0')
         {
                 send_to_char("Mwhere whom?\n\r", ch);
                 return;
         }
+        if (!search_parse(ch, argument, &query, FALSE))
+                return;
+        if (is_number(query.words))
+        {
+                query.vnum_lo = query.vnum_hi = atoi(query.words);
+                query.all = TRUE;
+        }
 
         set_pager_color(AT_PLAIN, ch);
-        found = FALSE;
-        for (victim = first_char; victim; victim = victim->next)
+        search_mob_instances(&query, found);
+        if (found.empty())
         {
-                if (IS_NPC(victim)
-                    && victim->in_room && nifty_is_name(arg, victim->name))
-                {
-                        found = TRUE;
-                        pager_printf(ch, "[%5d] %-28s [%5d] %s\n\r",
-                                     victim->pIndexData->vnum,
-                                     victim->short_descr,
-                                     victim->in_room->vnum,
-                                     victim->in_room->name);
-                }
+                act(AT_PLAIN, "You didn't find any $T.", ch, NULL,
+                    query.words, TO_CHAR);
+                return;
         }
+        if (!search_page(ch, &query, found.size(),
+                         &first, &last))
+                return;
 
-        if (!found)
-                act(AT_PLAIN, "You didn't find any $T.", ch, NULL, arg,
-                    TO_CHAR);
-
+        for (i = first; i < last; i++)
+        {
+                victim = found[i];
+                pager_printf(ch, "[%5d] %-28s [%5d] %s\n\r",
+                             victim->pIndexData->vnum,
+                             victim->short_descr,
+                             victim->in_room->vnum, victim->in_room->name);
+        }
         return;
 }
 
@@ -2477,7 +2417,7 @@ CMDF do_bodybag(CHAR_DATA * ch, char *argument)
         char      buf2[MAX_STRING_LENGTH];
         char      buf3[MAX_STRING_LENGTH];
         char      arg[MAX_INPUT_LENGTH];
-        OBJ_DATA *obj;
+        OBJ_DATA *obj, *obj_next;
         bool      found;
 
         one_argument(argument, arg);
@@ -2496,11 +2436,10 @@ CMDF do_bodybag(CHAR_DATA * ch, char *argument)
          */
         snprintf(buf2, MSL, "the corpse of %s", arg);
         found = FALSE;
-        for (obj = first_object; obj; obj = obj->next)
+        for (obj = first_owned(OWNER_CORPSE, arg); obj; obj = obj_next)
         {
-                if (obj->in_room
-                    && !str_cmp(buf2, obj->short_descr)
-                    && (obj->pIndexData->vnum == 11))
+                obj_next = obj->next_owned;
+                if (obj->in_room && !str_cmp(buf2, obj->short_descr))
                 {
                         found = TRUE;
                         ch_printf(ch,
@@ -2526,17 +2465,19 @@ CMDF do_owhere(CHAR_DATA * ch, char *argument)
         char      buf[MAX_STRING_LENGTH];
         char      arg[MAX_INPUT_LENGTH];
         char      arg1[MAX_INPUT_LENGTH];
+        SEARCH_QUERY query;
+        std::vector < OBJ_DATA * >matches;
         OBJ_DATA *obj;
         bool      found;
         int       icnt = 0;
+        size_t    first, last, i;
 
-        argument = one_argument(argument, arg);
+        one_argument(one_argument(argument, arg), arg1);
         if (arg[0] == '\0')
         {
                 send_to_char("Owhere what?\n\r", ch);
                 return;
         }
-        argument = one_argument(argument, arg1);
 
         set_pager_color(AT_PLAIN, ch);
         if (arg1[0] != '\0' && !str_prefix(arg1, "nesthunt"))
@@ -2583,10 +2524,21 @@ CMDF do_owhere(CHAR_DATA * ch, char *argument)
         }
 
         found = FALSE;
-        for (obj = first_object; obj; obj = obj->next)
+        if (!search_parse(ch, argument, &query, TRUE))
+                return;
+        if (is_number(query.words))
         {
-                if (!nifty_is_name(arg, obj->name))
-                        continue;
+                query.vnum_lo = query.vnum_hi = atoi(query.words);
+                query.all = TRUE;
+        }
+        search_obj_instances(&query, matches);
+        if (!search_page(ch, &query, matches.size(),
+                         &first, &last))
+                return;
+        icnt = static_cast < int >(first);
+        for (i = first; i < last; i++)
+        {
+                obj = matches[i];
                 found = TRUE;
 
                 snprintf(buf, MSL, "(%3d) [%5d] %-28s in ", ++icnt,
@@ -2615,10 +2567,11 @@ CMDF do_owhere(CHAR_DATA * ch, char *argument)
         }
 
         if (!found)
-                act(AT_PLAIN, "You didn't find any $T.", ch, NULL, arg,
-                    TO_CHAR);
+                act(AT_PLAIN, "You didn't find any $T.", ch, NULL,
+                    query.words, TO_CHAR);
         else
-                pager_printf(ch, "%d matches.\n\r", icnt);
+                pager_printf(ch, "%d matches.\n\r",
+                             static_cast < int >(matches.size()));
 
         return;
 }
@@ -2861,6 +2814,7 @@ CMDF do_switch(CHAR_DATA * ch, char *argument)
         victim->desc = ch->desc;
         ch->desc = NULL;
         ch->switched = victim;
+        channel_listeners_changed();
         send_to_char("Ok.\n\r", victim);
         return;
 }
@@ -5549,17 +5503,19 @@ void close_area(AREA_DATA * pArea)
                 if (ech->in_room && ech->in_room->area == pArea)
                         do_recall(ech, "");
         }
-        for (eobj = first_object; eobj; eobj = eobj_next)
-        {
-                eobj_next = eobj->next;
-                /*
-                 * if obj is in area, or part of area. 
-                 */
-                if (URANGE(pArea->low_o_vnum, eobj->pIndexData->vnum,
-                           pArea->hi_o_vnum) == eobj->pIndexData->vnum ||
-                    (eobj->in_room && eobj->in_room->area == pArea))
+        /*
+         * if obj is in area, or part of area. 
+         */
+        for (oid = obj_index_table.next(pArea->low_o_vnum - 1);
+             oid && oid->vnum <= pArea->hi_o_vnum;
+             oid = obj_index_table.next(oid->vnum))
+                while ((eobj = oid->first_instance) != NULL)
                         extract_obj(eobj);
-        }
+        for (icnt = pArea->low_r_vnum; icnt <= pArea->hi_r_vnum; icnt++)
+                if ((rid = get_room_index(icnt)) != NULL
+                    && rid->area == pArea)
+                        while ((eobj = rid->first_content) != NULL)
+                                extract_obj(eobj);
         for (icnt = 0; icnt < MAX_KEY_HASH; icnt++)
         {
                 for (rid = room_index_hash[icnt]; rid; rid = rid_next)
@@ -5580,6 +5536,7 @@ void close_area(AREA_DATA * pArea)
                                         DISPOSE(pexit);
                                 }
                         }
+                        index_exits(rid);
                         if (rid->area != pArea)
                                 continue;
                         STRFREE(rid->name);
@@ -5646,6 +5603,7 @@ void close_area(AREA_DATA * pArea)
                                 else
                                         trid->next = rid->next;
                         }
+                        room_index_table.remove(rid->vnum, rid);
                         DISPOSE(rid);
                 }
 
@@ -5695,6 +5653,8 @@ void close_area(AREA_DATA * pArea)
                                 else
                                         tmid->next = mid->next;
                         }
+                        mob_index_table.remove(mid->vnum, mid);
+                        search_invalidate();
                         DISPOSE(mid);
                 }
 
@@ -5745,6 +5705,8 @@ void close_area(AREA_DATA * pArea)
                                 else
                                         toid->next = oid->next;
                         }
+                        obj_index_table.remove(oid->vnum, oid);
+                        search_invalidate();
                         DISPOSE(oid);
                 }
         }
@@ -5766,6 +5728,9 @@ void close_area(AREA_DATA * pArea)
             UNLINK( pArea, first_area, last_area, next, prev );
             UNLINK( pArea, first_asort, last_asort, next_sort, prev_sort );
         }
+        cancel_area_reset(pArea);
+        free_reset_prog(pArea);
+        invalidate_reset_progs();
         DISPOSE(pArea);
 }
 
@@ -6249,6 +6214,10 @@ CMDF do_cset(CHAR_DATA * ch, char *argument)
                           true_false[sysdata.DEBUG]);
                 ch_printf(ch, "  Greet System: &w%s&z.\n\r",
                           true_false[sysdata.GREET]);
+                ch_printf(ch, "  Boot threads: &w%d&z (0 = auto, 1 = serial).\n\r",
+                          sysdata.boot_threads);
+                ch_printf(ch, "  Reset budget: &w%d&z msec per pulse.\n\r",
+                          sysdata.reset_budget);
                 ch_printf(ch, "  Save flags: &w%s&z\n\r\n\r&W",
                           flag_string(sysdata.save_flags, const_cast<char* const*>(save_flag)));
                 return;
@@ -6369,6 +6338,32 @@ CMDF do_cset(CHAR_DATA * ch, char *argument)
                 return;
         }
 
+        else if (!str_cmp(arg, "bootthreads"))
+        {
+                if (level < 0 || level > BOOT_THREADS_MAX)
+                {
+                        ch_printf(ch, "Boot threads must be 0 to %d.\n\r",
+                                  BOOT_THREADS_MAX);
+                        return;
+                }
+                sysdata.boot_threads = level;
+                send_to_char("Ok.  Takes effect on the next boot.\n\r", ch);
+                return;
+        }
+
+        else if (!str_cmp(arg, "resetbudget"))
+        {
+                if (level < 1 || level > 1000 / PULSE_PER_SECOND)
+                {
+                        ch_printf(ch, "Reset budget must be 1 to %d msec.\n\r",
+                                  1000 / PULSE_PER_SECOND);
+                        return;
+                }
+                sysdata.reset_budget = level;
+                send_to_char("Ok.\n\r", ch);
+                return;
+        }
+
         else if (!str_cmp(arg, "newbie_purge"))
         {
                 if (level < 1)
@@ -6555,65 +6550,13 @@ CMDF do_cset(CHAR_DATA * ch, char *argument)
         }
         else if (!str_cmp(arg, "channellog"))
         {
-                sh_int    oldsize;
                 CHANNEL_DATA *channel;
 
+                sysdata.channellog = static_cast<sh_int>(level);
                 for (channel = first_channel; channel;
                      channel = channel->next)
-                {
-                        oldsize = sysdata.channellog;
-                        sysdata.channellog = level;
-
-                        /*
-                         * If we are not setting it to the same size 
-                         */
-                        if (channel->log != NULL && level != oldsize)
-                        {
-                                LOG_DATA *new_log;
-                                sh_int    i;
-
-                                CREATE(new_log, LOG_DATA, static_cast<size_t>(level));
-                                /*
-                                 * if the old one was smaller, its ok to start at 0 and copy 
-                                 */
-                                if (oldsize < level)
-                                {
-                                        for (i = 0; i < oldsize; i++)
-                                        {
-                                                if (!channel->log[i].name
-                                                    || !channel->log[i].
-                                                    message)
-                                                        continue;
-                                                new_log[i] = channel->log[i];
-                                        }
-                                }
-                                /*
-                                 * if the new one is smaller, we need to just copy the last X messages in 
-                                 */
-                                else
-                                {
-                                        for (i = level; i >= 0; i--)
-                                                new_log[i] =
-                                                        channel->log[oldsize -
-                                                                     (level -
-                                                                      i)];
-
-                                        for (i = 0; i < level; i++)
-                                        {
-                                                if (!channel->log[i].name
-                                                    || !channel->log[i].
-                                                    message)
-                                                        continue;
-                                                DISPOSE(channel->log[i].name);
-                                                DISPOSE(channel->log[i].
-                                                        message);
-                                        }
-                                }
-                                DISPOSE(channel->log);
-                                channel->log = new_log;
-                                channel->logpos = level;
-                        }
-                }
+                        if (channel->log)
+                                resize_channel_log(channel, level);
                 send_to_char("Ok.\n\r", ch);
                 return;
         }
@@ -6653,8 +6596,8 @@ CMDF do_cset(CHAR_DATA * ch, char *argument)
                         ("dam_pvm, dam_pvp, get_notake, stun_pvp, stun, regular_purge\n\r",
                          ch);
                 send_to_char
-                        ("newbie_purge, log_size, savefrequency,\n\r", ch);
-                send_to_char("saveflag, save, pfiles, channellog\n\r", ch);
+                        ("newbie_purge, log_size, savefrequency, bootthreads,\n\r", ch);
+                send_to_char("saveflag, save, pfiles, channellog, resetbudget\n\r", ch);
                 return;
         }
 }
@@ -6822,6 +6765,7 @@ CMDF do_vsearch(CHAR_DATA * ch, char *argument)
 {
         char      arg[MAX_INPUT_LENGTH];
         bool      found = FALSE;
+        OBJ_INDEX_DATA *pObjIndex;
         OBJ_DATA *obj;
         OBJ_DATA *in_obj;
         int       obj_counter = 1;
@@ -6837,14 +6781,19 @@ CMDF do_vsearch(CHAR_DATA * ch, char *argument)
 
         set_pager_color(AT_PLAIN, ch);
         argi = atoi(arg);
-        if (argi < 0 && argi > MAX_VNUMS)
+        if (argi < 0 || argi > MAX_VNUMS)
         {
                 send_to_char("Vnum out of range.\n\r", ch);
                 return;
         }
-        for (obj = first_object; obj != NULL; obj = obj->next)
+        if ((pObjIndex = get_obj_index(argi)) == NULL)
+        {
+                send_to_char("No object has that vnum.\n\r", ch);
+                return;
+        }
+        for (obj = pObjIndex->first_instance; obj; obj = obj->next_instance)
         {
-                if (!can_see_obj(ch, obj) || !(argi == obj->pIndexData->vnum))
+                if (!can_see_obj(ch, obj))
                         continue;
 
                 found = TRUE;
@@ -8509,6 +8458,7 @@ CMDF do_pcrename(CHAR_DATA * ch, char *argument)
 
         STRFREE(victim->name);
         victim->name = STRALLOC_CAPITALIZE(arg2);
+        name_index_update(victim);
         STRFREE(victim->pcdata->full_name);
         victim->pcdata->full_name = STRALLOC_CAPITALIZE(arg2);
         remove(backname);
@@ -9106,6 +9056,7 @@ CMDF do_watch(CHAR_DATA * ch, char *argument)
                 char      fname[MAX_INPUT_LENGTH];
 
                 sprintf(fname, "%s%s", WATCH_DIR, strlower(ch->name));
+                log_release(fname);
                 if (0 == remove(fname))
                 {
                         send_to_pager
@@ -9128,6 +9079,7 @@ CMDF do_watch(CHAR_DATA * ch, char *argument)
                 int       rec_count = 0;
 
                 sprintf(fname, "%s%s", WATCH_DIR, strlower(ch->name));
+                log_flush();
 
                 if (!(fp = fopen(fname, "r")))
                 {
@@ -9172,6 +9124,7 @@ CMDF do_watch(CHAR_DATA * ch, char *argument)
                 limit = UMIN(limit, MAX_DISPLAY_LINES);
 
                 sprintf(fname, "%s%s", WATCH_DIR, strlower(ch->name));
+                log_flush();
                 if (!(fp = fopen(fname, "r")))
                         return;
                 fgets(s, MAX_STRING_LENGTH, fp);
@@ -43,8 +43,16 @@
 
 #include <string.h>
 #include <limits.h>
+#include <dirent.h>
+#include <unistd.h>
 #include <cmath>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "mud.hpp"
+#include "persist.hpp"
 
 // ============================================================================
 // Security and Configuration Constants
@@ -74,6 +82,7 @@ bool     account_add args((BANK_ACCOUNT * account, long amount));
 bool     account_sub args((BANK_ACCOUNT * account, long amount));
 bool     account_has_funds args((BANK_ACCOUNT * account, long amount));
 int      baccounts args((CHAR_DATA * ch));
+BANK_ACCOUNT *account_by_code args((const char *code));
 
 // ============================================================================
 // Global Variables
@@ -81,6 +90,344 @@ int      baccounts args((CHAR_DATA * ch));
 BANK_ACCOUNT *first_baccount = nullptr;
 BANK_ACCOUNT *last_baccount = nullptr;
 
+// ============================================================================
+// Ledger Indexes and Journal
+// ============================================================================
+
+/*
+ * Accounts are found by code through bank_codes, and by the name of their
+ * owner or any trustee through bank_holders, so lookups never walk
+ * first_baccount.
+ *
+ * Balance changes are not written to the account files as they happen.
+ * Each deposit, withdrawal, transfer or interest payment appends one line
+ * to the current journal segment, BANK_DIR "journal.<n>", holding the
+ * balances it left behind; a transfer carries both accounts on the same
+ * line, so it is replayed whole or not at all.  After BANK_JOURNAL_MAX
+ * records, the accounts the segment touched are saved (the snapshot), and
+ * the segment is deleted behind those saves.  At boot any segments still
+ * on disk are replayed in order over the loaded accounts and snapshotted,
+ * so a crash loses at most a torn last line.
+ */
+typedef std::vector < BANK_ACCOUNT * >BANK_LIST;
+
+static std::unordered_map < std::string, BANK_ACCOUNT * >bank_codes;
+static std::unordered_map < std::string, BANK_LIST > bank_holders;
+static std::unordered_set < std::string > bank_journaled;
+static FILE *bank_journal_fp;
+static long bank_journal_seq = 1;
+static int bank_journal_records;
+
+static void bank_holder_add(const char *name, BANK_ACCOUNT * account)
+{
+        BANK_LIST & list = bank_holders[lower_key(name)];
+
+        if (std::find(list.begin(), list.end(), account) == list.end())
+                list.push_back(account);
+}
+
+static void bank_holder_remove(const char *name, BANK_ACCOUNT * account)
+{
+        auto      it = bank_holders.find(lower_key(name));
+
+        if (it == bank_holders.end())
+                return;
+        it->second.erase(std::remove(it->second.begin(), it->second.end(),
+                                     account), it->second.end());
+        if (it->second.empty())
+                bank_holders.erase(it);
+}
+
+/*
+ * File or unfile an account under its owner and each word of its
+ * trustees, split the way nifty_is_name splits them.
+ */
+static void bank_index_holders(BANK_ACCOUNT * account, bool fAdd)
+{
+        char      name[MAX_INPUT_LENGTH];
+        char     *trustees = account->trustees;
+
+        if (account->owner && account->owner[0] != '\0')
+        {
+                if (fAdd)
+                        bank_holder_add(account->owner, account);
+                else
+                        bank_holder_remove(account->owner, account);
+        }
+        if (!trustees)
+                return;
+
+        for (trustees = one_argument2(trustees, name); name[0] != '\0';
+             trustees = one_argument2(trustees, name))
+        {
+                if (fAdd)
+                        bank_holder_add(name, account);
+                else
+                        bank_holder_remove(name, account);
+        }
+}
+
+static void bank_index_add(BANK_ACCOUNT * account)
+{
+        if (!bank_codes.emplace(account->code, account).second)
+                bug("bank_index_add: duplicate account code %s",
+                    account->code);
+        bank_index_holders(account, TRUE);
+}
+
+static void bank_index_remove(BANK_ACCOUNT * account)
+{
+        auto      it = bank_codes.find(account->code ? account->code : "");
+
+        if (it != bank_codes.end() && it->second == account)
+                bank_codes.erase(it);
+        bank_index_holders(account, FALSE);
+}
+
+/*
+ * Accounts that name is the owner or a trustee of.  Callers still check
+ * which, since the index ignores case.
+ */
+static const BANK_LIST &bank_accounts_of(const char *name)
+{
+        static const BANK_LIST none;
+        auto      it = bank_holders.find(lower_key(name));
+
+        return it == bank_holders.end()? none : it->second;
+}
+
+static void bank_journal_path(char *buf, size_t len, long seq)
+{
+        snprintf(buf, len, "%s%s.%ld", BANK_DIR, BANK_JOURNAL, seq);
+}
+
+/*
+ * Save every account the current segment touched and drop the segment
+ * once those saves are on disk.
+ */
+void bank_snapshot(void)
+{
+        BANK_ACCOUNT *account;
+        char      filename[256];
+
+        for (const std::string & code:bank_journaled)
+                if ((account = account_by_code(code.c_str())) != NULL)
+                        save_baccount(account);
+        bank_journaled.clear();
+
+        if (bank_journal_fp)
+        {
+                FCLOSE(bank_journal_fp);
+        }
+        if (bank_journal_records > 0)
+        {
+                bank_journal_path(filename, sizeof(filename),
+                                  bank_journal_seq++);
+                persist_remove(filename);
+        }
+        bank_journal_records = 0;
+}
+
+/*
+ * Push journaled records to the disk.  Interest runs call this once at
+ * the end instead of per record.
+ */
+static void bank_journal_sync(void)
+{
+        if (bank_journal_fp)
+                fdatasync(fileno(bank_journal_fp));
+}
+
+/*
+ * Record a balance change made by actor.  destin is the other side of a
+ * transfer.  Without a journal, fall back to saving the accounts.
+ */
+static void bank_journal(char kind, const char *actor, long amount,
+                         BANK_ACCOUNT * account, BANK_ACCOUNT * destin,
+                         bool fSync)
+{
+        char      filename[256];
+
+        if (!bank_journal_fp)
+        {
+                bank_journal_path(filename, sizeof(filename),
+                                  bank_journal_seq);
+                if ((bank_journal_fp = fopen(filename, "ae")) == NULL)
+                {
+                        perror(filename);
+                        bug("bank_journal: can't open %s", filename);
+                        save_baccount(account);
+                        if (destin)
+                                save_baccount(destin);
+                        return;
+                }
+        }
+
+        fprintf(bank_journal_fp, "%c %ld %ld %s %s %ld %ld", kind,
+                static_cast < long >(current_time), amount, actor, account->code,
+                account->amounthi, account->amountlo);
+        if (destin)
+                fprintf(bank_journal_fp, " %s %ld %ld", destin->code,
+                        destin->amounthi, destin->amountlo);
+        fprintf(bank_journal_fp, " $\n");
+        fflush(bank_journal_fp);
+        if (fSync)
+                bank_journal_sync();
+
+        bank_journaled.insert(account->code);
+        if (destin)
+                bank_journaled.insert(destin->code);
+        if (++bank_journal_records >= BANK_JOURNAL_MAX)
+                bank_snapshot();
+}
+
+static void bank_replay_balance(const char *code, long hi, long lo)
+{
+        BANK_ACCOUNT *account;
+
+        if ((account = account_by_code(code)) == NULL)
+        {
+                bug("bank_replay: journal names unknown account %s", code);
+                return;
+        }
+        account->amounthi = hi;
+        account->amountlo = lo;
+        bank_journaled.insert(account->code);
+}
+
+/*
+ * Replay one segment.  A line without its closing $ was cut short by a
+ * crash and is skipped.
+ */
+static int bank_replay_segment(const char *filename)
+{
+        char      line[MAX_INPUT_LENGTH];
+        char      actor[MAX_INPUT_LENGTH], code[MAX_INPUT_LENGTH];
+        char      destin[MAX_INPUT_LENGTH], end[MAX_INPUT_LENGTH];
+        long      when, amount, hi, lo, dhi, dlo;
+        char      kind;
+        int       count = 0, n;
+        FILE     *fp;
+
+        if ((fp = fopen(filename, "r")) == NULL)
+        {
+                perror(filename);
+                return 0;
+        }
+
+        while (fgets(line, sizeof(line), fp))
+        {
+                n = sscanf(line, "%c %ld %ld %s %s %ld %ld %s %ld %ld %s",
+                           &kind, &when, &amount, actor, code, &hi, &lo,
+                           destin, &dhi, &dlo, end);
+                if (kind == 'T' ? (n != 11 || strcmp(end, "$"))
+                    : (n != 8 || strcmp(destin, "$")))
+                {
+                        bug("bank_replay: skipping bad record in %s",
+                            filename);
+                        continue;
+                }
+                bank_replay_balance(code, hi, lo);
+                if (kind == 'T')
+                        bank_replay_balance(destin, dhi, dlo);
+                count++;
+        }
+        fclose(fp);
+        return count;
+}
+
+/*
+ * Called once the accounts are loaded.
+ */
+static void bank_replay(void)
+{
+        std::vector < long >segments;
+        struct dirent *de;
+        size_t    len = strlen(BANK_JOURNAL);
+        char      filename[256];
+        char      buf[MAX_STRING_LENGTH];
+        int       count = 0;
+        DIR      *dp;
+
+        if ((dp = opendir(BANK_DIR)) == NULL)
+                return;
+        while ((de = readdir(dp)) != NULL)
+                if (!strncmp(de->d_name, BANK_JOURNAL, len)
+                    && de->d_name[len] == '.'
+                    && de->d_name[len + 1] != '\0'
+                    && is_number(de->d_name + len + 1))
+                        segments.push_back(atol(de->d_name + len + 1));
+        closedir(dp);
+
+        if (segments.empty())
+                return;
+        std::sort(segments.begin(), segments.end());
+
+        for (long seq:segments)
+        {
+                bank_journal_path(filename, sizeof(filename), seq);
+                count += bank_replay_segment(filename);
+        }
+
+        for (const std::string & code:bank_journaled)
+        {
+                BANK_ACCOUNT *account = account_by_code(code.c_str());
+
+                if (account)
+                        save_baccount(account);
+        }
+        bank_journaled.clear();
+        for (long seq:segments)
+        {
+                bank_journal_path(filename, sizeof(filename), seq);
+                persist_remove(filename);
+        }
+        bank_journal_seq = segments.back() + 1;
+
+        snprintf(buf, sizeof(buf),
+                 "Replayed %d bank journal records from %d segments",
+                 count, static_cast < int >(segments.size()));
+        log_string(buf);
+}
+
+static void bank_tell(const char *who, const char *name, const char *msg,
+                      std::vector < CHAR_DATA * >&told)
+{
+        CHAR_DATA *holder;
+
+        if ((holder = get_player_world(who)) == NULL
+            || !strcmp(holder->name, name)
+            || std::find(told.begin(), told.end(), holder) != told.end())
+                return;
+        send_to_char(msg, holder);
+        told.push_back(holder);
+}
+
+/*
+ * Tell the online owners and trustees of account, and of destin if
+ * given, except name.  Each hears it once.
+ */
+static void bank_notify(BANK_ACCOUNT * account, BANK_ACCOUNT * destin,
+                        const char *name, const char *msg)
+{
+        std::vector < CHAR_DATA * >told;
+        BANK_ACCOUNT *accounts[2] = { account, destin };
+        char      who[MAX_INPUT_LENGTH];
+        char     *trustees;
+
+        for (BANK_ACCOUNT * acct:accounts)
+        {
+                if (!acct)
+                        continue;
+                bank_tell(acct->owner, name, msg, told);
+                if (!acct->trustees)
+                        continue;
+                for (trustees = one_argument2(acct->trustees, who);
+                     who[0] != '\0'; trustees = one_argument2(trustees, who))
+                        bank_tell(who, name, msg, told);
+        }
+}
+
 // ============================================================================
 // Account Management Functions
 // ============================================================================
@@ -102,7 +449,7 @@ void save_baccount(BANK_ACCOUNT * account)
         // Use secure path construction
         snprintf(filename, sizeof(filename), "%s%s.acct", BACCOUNT_DIR, account->code);
         
-        if ((fp = fopen(filename, "w")) == nullptr) {
+        if ((fp = persist_open(filename)) == nullptr) {
                 bug("save_baccount: unable to open %s.acct for writing!", account->code);
                 perror(filename);
                 return;
@@ -119,11 +466,7 @@ void save_baccount(BANK_ACCOUNT * account)
         fprintf(fp, "Amounthi    %ld\n", account->amounthi);
         fprintf(fp, "Amountlo    %ld\n", account->amountlo);
         fprintf(fp, "End\n");
-        
-        if (fclose(fp) != 0) {
-                bug("save_baccount: Error closing file %s", filename);
-                perror(filename);
-        }
+        persist_close(fp);
 
         return;
 }
@@ -180,6 +523,7 @@ void load_baccount_list()
         FCLOSE(fpList);
         log_string("Done loading accounts");
         fpReserve = fopen(NULL_FILE, "r");
+        bank_replay();
         return;
 }
 
@@ -245,6 +589,7 @@ void load_baccount(char *name)
                                         account->owner = STRALLOC(const_cast<char*>("NOOWNER"));
                                 if (account->trustees == NULL)
                                         account->trustees = STRALLOC(const_cast<char*>(""));
+                                bank_index_add(account);
                                 FCLOSE(fp);
                                 return;
                         }
@@ -283,7 +628,7 @@ BANK_ACCOUNT *create_baccount(CHAR_DATA * ch)
         
         // Check if player already has too many accounts (security measure)
         int player_account_count = 0;
-        for (BANK_ACCOUNT* existing = first_baccount; existing; existing = existing->next) {
+        for (BANK_ACCOUNT* existing : bank_accounts_of(ch->name)) {
                 if (existing->owner && !str_cmp(existing->owner, ch->name)) {
                         player_account_count++;
                 }
@@ -307,6 +652,7 @@ BANK_ACCOUNT *create_baccount(CHAR_DATA * ch)
         account->interest = static_cast<float>(BankSecurity::DEFAULT_INTEREST_RATE);
         account->amounthi = 0;
         account->amountlo = 0;
+        bank_index_add(account);
 
         save_baccount(account);
         write_baccount_list();
@@ -331,8 +677,10 @@ void delete_account(BANK_ACCOUNT * account)
         
         char filename[256];
         
-        // Remove from linked list first
+        // Remove from linked list and indexes first
         UNLINK(account, first_baccount, last_baccount, next, prev);
+        bank_index_remove(account);
+        bank_journaled.erase(account->code);
         
         // Construct filename for deletion
         snprintf(filename, sizeof(filename), "%s%s.acct", BACCOUNT_DIR, account->code);
@@ -344,11 +692,8 @@ void delete_account(BANK_ACCOUNT * account)
         STRFREE(account->trustees);
         DISPOSE(account);
 
-        // Remove the file and check for errors
-        if (remove(filename) != 0) {
-                bug("delete_account: Failed to remove file %s", filename);
-                perror(filename);
-        }
+        // Remove the file behind any queued save of it
+        persist_remove(filename);
         
         write_baccount_list();
         return;
@@ -359,6 +704,7 @@ void free_baccount(BANK_ACCOUNT * account)
         if (!account || account == NULL)
                 return;
         UNLINK(account, first_baccount, last_baccount, next, prev);
+        bank_index_remove(account);
         STRFREE(account->code);
         STRFREE(account->creator);
         STRFREE(account->owner);
@@ -368,14 +714,11 @@ void free_baccount(BANK_ACCOUNT * account)
 
 char     *generate_code()
 {
-        BANK_ACCOUNT *account;
         static char buf1[MAX_STRING_LENGTH];
         int       count = 0;
-        bool      match;
 
         do
         {
-                match = FALSE;
                 for (count = 0; count < 20; count++)
                 {
                         if (number_range(1, 100) <= 50)
@@ -385,16 +728,8 @@ char     *generate_code()
                 }
 
                 buf1[20] = '\0';
-
-                for (account = first_baccount; account;
-                     account = account->next)
-                {
-                        if (account->code && !strcmp(account->code, buf1))
-                                match = TRUE;
-                        break;
-                }
         }
-        while (match);
+        while (account_by_code(buf1) != NULL);
 
         return buf1;
 }
@@ -545,69 +880,48 @@ char* account_sum(BANK_ACCOUNT* account)
 
 int baccounts(CHAR_DATA * ch)
 {
-        BANK_ACCOUNT *account;
         int       count = 0;
 
         if (!ch || ch == NULL)
-        {
-                for (account = first_baccount; account;
-                     account = account->next)
+                return static_cast<int>(bank_codes.size());
+
+        for (BANK_ACCOUNT * account:bank_accounts_of(ch->name))
+                if (!strcmp(account->owner, ch->name))
                         count++;
-                return count;
-        }
-        else
-        {
-                for (account = first_baccount; account;
-                     account = account->next)
-                        if (!strcmp(account->owner, ch->name))
-                                count++;
-                return count;
-        }
-        return 0;
+        return count;
 }
 
-BANK_ACCOUNT *account_by_code(char *code)
+BANK_ACCOUNT *account_by_code(const char *code)
 {
-        BANK_ACCOUNT *account;
-
         if (!code || code == NULL || code[0] == '\0')
                 return NULL;
 
-        for (account = first_baccount; account; account = account->next)
-                if (!strcmp(account->code, code))
-                        return account;
-        return NULL;
+        auto      it = bank_codes.find(code);
+
+        return it == bank_codes.end()? NULL : it->second;
 }
 
 void notify_trustees_dep(BANK_ACCOUNT * account, char *name, long amount,
                          bool anon)
 {
-        CHAR_DATA *trustee;
-
-        for (trustee = first_char; trustee; trustee = trustee->next)
-                if ((!strcmp(trustee->name, account->owner) ||
-                     nifty_is_name(trustee->name, account->trustees)) &&
-                    strcmp(trustee->name, name))
-                        ch_printf(trustee,
-                                  "%s has deposited %ld credits in account %s.\n\r",
-                                  anon ? "Someone" : name, amount,
-                                  account->code);
+        char      buf[MAX_STRING_LENGTH];
+
+        snprintf(buf, sizeof(buf),
+                 "%s has deposited %ld credits in account %s.\n\r",
+                 anon ? "Someone" : name, amount, account->code);
+        bank_notify(account, NULL, name, buf);
         return;
 }
 
 void notify_trustees_wit(BANK_ACCOUNT * account, char *name, long amount,
                          bool anon)
 {
-        CHAR_DATA *trustee;
-
-        for (trustee = first_char; trustee; trustee = trustee->next)
-                if ((!strcmp(trustee->name, account->owner) ||
-                     nifty_is_name(trustee->name, account->trustees)) &&
-                    strcmp(trustee->name, name))
-                        ch_printf(trustee,
-                                  "%s has withdrawn %ld credits from account %s.\n\r",
-                                  anon ? "Someone" : name, amount,
-                                  account->code);
+        char      buf[MAX_STRING_LENGTH];
+
+        snprintf(buf, sizeof(buf),
+                 "%s has withdrawn %ld credits from account %s.\n\r",
+                 anon ? "Someone" : name, amount, account->code);
+        bank_notify(account, NULL, name, buf);
         return;
 }
 
@@ -615,11 +929,11 @@ void notify_trustees_wit(BANK_ACCOUNT * account, char *name, long amount,
  * Enhanced interest application with secure mathematical operations
  * SECURITY: Prevents floating-point precision exploits and overflow attacks
  */
-void apply_interest(BANK_ACCOUNT* account)
+long apply_interest(BANK_ACCOUNT* account)
 {
     if (!account) {
         bug("apply_interest: null account pointer");
-        return;
+        return 0;
     }
 
     // Validate interest rate to prevent exploits
@@ -628,7 +942,7 @@ void apply_interest(BANK_ACCOUNT* account)
         bug("apply_interest: Invalid interest rate %f for account %s", 
             account->interest, account->code ? account->code : "UNKNOWN");
         account->interest = static_cast<float>(BANK_INTEREST); // Reset to default safe value
-        return;
+        return 0;
     }
 
     // Calculate interest safely using integer arithmetic to avoid precision issues
@@ -637,7 +951,7 @@ void apply_interest(BANK_ACCOUNT* account)
     
     // Skip interest on empty accounts
     if (original_hi == 0 && original_lo == 0) {
-        return;
+        return 0;
     }
 
     // Calculate interest on low amount using safe integer operations
@@ -654,7 +968,7 @@ void apply_interest(BANK_ACCOUNT* account)
         if (hi_interest > static_cast<double>(BankSecurity::SAFE_ADDITION_LIMIT)) {
             bug("apply_interest: Interest calculation overflow for account %s", 
                 account->code ? account->code : "UNKNOWN");
-            return;
+            return 0;
         }
         
         interest_hi = static_cast<long>(hi_interest);
@@ -667,7 +981,7 @@ void apply_interest(BANK_ACCOUNT* account)
     if (total_interest < 0 || total_interest > BankSecurity::MAX_TRANSACTION_AMOUNT) {
         bug("apply_interest: Calculated interest %ld is out of bounds for account %s", 
             total_interest, account->code ? account->code : "UNKNOWN");
-        return;
+        return 0;
     }
 
     // Apply interest using our secure addition function
@@ -675,53 +989,41 @@ void apply_interest(BANK_ACCOUNT* account)
         if (!account_add(account, total_interest)) {
             bug("apply_interest: Failed to add interest %ld to account %s", 
                 total_interest, account->code ? account->code : "UNKNOWN");
-            return;
+            return 0;
         }
 
         // Notify owner of interest gained
-        for (CHAR_DATA* owner = first_char; owner; owner = owner->next) {
-            if (!strcmp(owner->name, account->owner) && total_interest > 0) {
-                ch_printf(owner, "&R[&BInterest&R] &wAccount %s has gained %ld credits.\n\r",
-                         account->code, total_interest);
-            }
+        CHAR_DATA* owner = get_player_world(account->owner);
+        if (owner) {
+            ch_printf(owner, "&R[&BInterest&R] &wAccount %s has gained %ld credits.\n\r",
+                     account->code, total_interest);
         }
     }
+    return total_interest > 0 ? total_interest : 0;
 }
 
 void update_baccounts()
 {
         BANK_ACCOUNT *account;
+        long      interest;
 
         for (account = first_baccount; account; account = account->next)
-        {
-                apply_interest(account);
-                save_baccount(account);
-        }
+                if ((interest = apply_interest(account)) > 0)
+                        bank_journal('I', "-", interest, account, NULL,
+                                     FALSE);
+        bank_journal_sync();
         return;
 }
 
 void notify_trustees_tra(BANK_ACCOUNT * source, BANK_ACCOUNT * destin,
                          char *name, long amount, bool anon)
 {
-        CHAR_DATA *trustee;
+        char      buf[MAX_STRING_LENGTH];
 
-        for (trustee = first_char; trustee; trustee = trustee->next)
-        {
-                if ((!strcmp(trustee->name, source->owner) ||
-                     nifty_is_name(trustee->name, source->trustees)) &&
-                    strcmp(trustee->name, name))
-                        ch_printf(trustee,
-                                  "%s has transfered %ld credits from account %s to account %s.\n\r",
-                                  anon ? "Someone" : name, amount,
-                                  source->code, destin->code);
-                if ((!strcmp(trustee->name, destin->owner)
-                     || nifty_is_name(trustee->name, destin->trustees))
-                    && strcmp(trustee->name, name))
-                        ch_printf(trustee,
-                                  "%s has transfered %ld credits from account %s to account %s.\n\r",
-                                  anon ? "Someone" : name, amount,
-                                  source->code, destin->code);
-        }
+        snprintf(buf, sizeof(buf),
+                 "%s has transfered %ld credits from account %s to account %s.\n\r",
+                 anon ? "Someone" : name, amount, source->code, destin->code);
+        bank_notify(source, destin, name, buf);
         return;
 }
 
@@ -849,14 +1151,12 @@ CMDF do_bank_new(CHAR_DATA * ch, char *argument)
         }
         else if (!strcmp(arg1, "list"))
         {
-                BANK_ACCOUNT *account;
                 int       count = 0;
                 // char      buf[MAX_STRING_LENGTH]; // Unused variable removed
 
                 ch_printf(ch,
                           "&wAccount Number            Your Status           Balance\n\r");
-                for (account = first_baccount; account;
-                     account = account->next)
+                for (BANK_ACCOUNT * account:bank_accounts_of(ch->name))
                 {
                         // What a bitch it is to get these aligned the way I want them.
                         if (!strcmp(account->owner, ch->name))
@@ -866,7 +1166,7 @@ CMDF do_bank_new(CHAR_DATA * ch, char *argument)
                                           account->code, "Owner",
                                           account_sum(account));
                         }
-                        else if (nifty_is_name(account->trustees, ch->name))
+                        else if (nifty_is_name(ch->name, account->trustees))
                         {
                                 count++;
                                 ch_printf(ch, "&C%-25s %-21s %s\n\r",
@@ -943,7 +1243,7 @@ CMDF do_bank_new(CHAR_DATA * ch, char *argument)
 
                 ch->gold -= num;
                 do_save(ch, "-silentsave");
-                save_baccount(account);
+                bank_journal('D', ch->name, num, account, NULL, TRUE);
                 ch_printf(ch, "You deposit %ld credits in account %s.\n\r",
                           num, account->code);
                 notify_trustees_dep(account, ch->name, num, anon);
@@ -1014,7 +1314,7 @@ CMDF do_bank_new(CHAR_DATA * ch, char *argument)
 
                 ch->gold += num;
                 do_save(ch, "-silentsave");
-                save_baccount(account);
+                bank_journal('W', ch->name, num, account, NULL, TRUE);
                 ch_printf(ch, "You withdraw %ld credits from account %s.\n\r",
                           num, account->code);
                 // No anonymity on withdrawls.
@@ -1103,8 +1403,7 @@ CMDF do_bank_new(CHAR_DATA * ch, char *argument)
                         return;
                 }
 
-                save_baccount(source);
-                save_baccount(destin);
+                bank_journal('T', ch->name, num, source, destin, TRUE);
                 ch_printf(ch, "You transfer %ld credits from account %s to account %s.\n\r",
                           num, source->code, destin->code);
                 notify_trustees_tra(source, destin, ch->name, num, FALSE);
@@ -1179,13 +1478,12 @@ CMDF do_entrust(CHAR_DATA * ch, char *argument)
                 int       count = 0;
 
                 ch_printf(ch, "Account Number            Trustees\n\r");
-                for (account = first_baccount; account;
-                     account = account->next)
-                        if (!strcmp(ch->name, account->owner))
+                for (BANK_ACCOUNT * held:bank_accounts_of(ch->name))
+                        if (!strcmp(ch->name, held->owner))
                         {
                                 count++;
-                                ch_printf(ch, "&B%-24s %s\n\r", account->code,
-                                          account->trustees);
+                                ch_printf(ch, "&B%-24s %s\n\r", held->code,
+                                          held->trustees);
                         }
                 if (count == 0)
                         ch_printf(ch, "&RYou don't own any accounts.&w\n\r");
@@ -1208,9 +1506,11 @@ CMDF do_entrust(CHAR_DATA * ch, char *argument)
                         return;
                 }
 
+                bank_index_holders(account, FALSE);
                 if (account->trustees != NULL)
                         STRFREE(account->trustees);
                 account->trustees = STRALLOC(const_cast<char*>(""));
+                bank_index_holders(account, TRUE);
                 save_baccount(account);
                 ch_printf(ch,
                           "Okay, account %s no longer has any trustees.\n\r",
@@ -1265,9 +1565,11 @@ CMDF do_entrust(CHAR_DATA * ch, char *argument)
         }
 
         sprintf(buf, "%s %s", account->trustees, vict->name);
+        bank_index_holders(account, FALSE);
         if (account->trustees != NULL)
                 STRFREE(account->trustees);
         account->trustees = STRALLOC(buf);
+        bank_index_holders(account, TRUE);
         save_baccount(account);
         ch_printf(ch, "Okay, %s has been entrusted with account %s.\n\r",
                   vict->name, account->code);
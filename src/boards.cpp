@@ -44,10 +44,16 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "mud.hpp"
 #ifdef MXP
 #include "mxp.hpp"
+#include "persist.hpp"
 #endif
 #include "editor.hpp"
 #include "boards.hpp"
@@ -60,6 +66,14 @@ char     *const vote_types[VOTE_MAX] = { const_cast<char*>("None"), const_cast<c
 BOARD_DATA *first_board;
 BOARD_DATA *last_board;
 
+/*
+ * Notes on each board by recipient, keyed on the lowercased words of
+ * their to_list ("all", "immortal", player names), so mail_count() only
+ * looks at notes that can be addressed to the player.
+ */
+typedef std::unordered_map<std::string, std::vector<NOTE_DATA *>> NOTE_INDEX;
+static std::unordered_map<BOARD_DATA *, NOTE_INDEX> note_index;
+
 int get_boardtypes(char *flag)
 {
         unsigned int x;
@@ -254,38 +268,209 @@ void note_attach(CHAR_DATA * ch)
         return;
 }
 
+static void index_note(BOARD_DATA * board, NOTE_DATA * pnote)
+{
+        NOTE_INDEX &index = note_index[board];
+        char     *list = pnote->to_list;
+        char      name[MAX_INPUT_LENGTH];
+
+        for (;;)
+        {
+                list = one_argument(list, name);
+                if (name[0] == '\0')
+                        break;
+                index[name].push_back(pnote);
+        }
+}
+
+static void unindex_note(BOARD_DATA * board, NOTE_DATA * pnote)
+{
+        NOTE_INDEX &index = note_index[board];
+        char     *list = pnote->to_list;
+        char      name[MAX_INPUT_LENGTH];
+        NOTE_INDEX::iterator it;
+
+        for (;;)
+        {
+                list = one_argument(list, name);
+                if (name[0] == '\0')
+                        break;
+                if ((it = index.find(name)) == index.end())
+                        continue;
+                std::erase(it->second, pnote);
+                if (it->second.empty())
+                        index.erase(it);
+        }
+}
+
+static void index_board(BOARD_DATA * board)
+{
+        NOTE_DATA *pnote;
+
+        note_index[board].clear();
+        for (pnote = board->first_note; pnote; pnote = pnote->next)
+                index_note(board, pnote);
+}
+
+static void fwrite_note(FILE * fp, NOTE_DATA * pnote)
+{
+        fprintf(fp,
+                "Sender  %s~\nDate    %s~\nTo      %s~\nSubject %s~\nVoting %d\nYesvotes %s~\nNovotes %s~\nAbstentions %s~\nText\n%s~\n\n",
+                pnote->sender, pnote->date, pnote->to_list,
+                pnote->subject, pnote->voting,
+                pnote->yesvotes, pnote->novotes,
+                pnote->abstentions, pnote->text);
+}
+
+static int note_number(BOARD_DATA * board, NOTE_DATA * pnote)
+{
+        NOTE_DATA *tnote;
+        int       vnum = 1;
+
+        for (tnote = board->first_note; tnote && tnote != pnote;
+             tnote = tnote->next)
+                vnum++;
+        return vnum;
+}
+
+/*
+ * Read the "Generation" line a note file or journal starts with.  Files
+ * written before there was one count as generation 0.
+ */
+static int fread_board_gen(FILE * fp)
+{
+        long      start = ftell(fp);
+        int       gen;
+
+        if (fscanf(fp, " Generation %d", &gen) == 1)
+                return gen;
+        fseek(fp, start, SEEK_SET);
+        return 0;
+}
+
+/*
+ * Rewrite a board's note file in full, which also empties its journal.
+ * Callers that edit notes in place (pfile renames) rely on this to
+ * refresh the recipient index too.
+ *
+ * The file goes through persist_open(), so a crash leaves the old one
+ * whole.  It carries the next generation, which retires the journal
+ * even if a crash keeps us from removing it.  The journal is only
+ * removed once the new file is known to be on disk.
+ */
 void write_board(BOARD_DATA * board)
 {
         FILE     *fp;
         char      filename[256];
+        char      jnlname[256];
         NOTE_DATA *pnote;
 
-        /*
-         * Rewrite entire list. 
-         */
-        FCLOSE(fpReserve);
         snprintf(filename, MSL, "%s%s", BOARD_DIR, board->note_file);
-        if ((fp = fopen(filename, "w")) == NULL)
+        if ((fp = persist_open(filename)) == NULL)
         {
                 perror(filename);
+                index_board(board);
+                return;
         }
-        else
+        board->journal_gen++;
+        fprintf(fp, "Generation %d\n\n", board->journal_gen);
+        for (pnote = board->first_note; pnote; pnote = pnote->next)
+                fwrite_note(fp, pnote);
+        persist_close(fp);
+        persist_flush();
+        board->journal_ops = 0;
+
+        /*
+         * If the write failed the old file is still there, and the
+         * journal still belongs to it. 
+         */
+        FCLOSE(fpReserve);
+        if ((fp = fopen(filename, "r")) != NULL)
         {
-                for (pnote = board->first_note; pnote; pnote = pnote->next)
+                if (fread_board_gen(fp) == board->journal_gen)
                 {
-                        fprintf(fp,
-                                "Sender  %s~\nDate    %s~\nTo      %s~\nSubject %s~\nVoting %d\nYesvotes %s~\nNovotes %s~\nAbstentions %s~\nText\n%s~\n\n",
-                                pnote->sender, pnote->date, pnote->to_list,
-                                pnote->subject, pnote->voting,
-                                pnote->yesvotes, pnote->novotes,
-                                pnote->abstentions, pnote->text);
+                        snprintf(jnlname, MSL, "%s%s.jnl", BOARD_DIR,
+                                 board->note_file);
+                        remove(jnlname);
                 }
                 FCLOSE(fp);
         }
         fpReserve = fopen(NULL_FILE, "r");
+        index_board(board);
         return;
 }
 
+/*
+ * Append one record to a board's journal, after the change is made in
+ * memory.  A full rewrite stands in when the journal is due for
+ * compaction or the record will not fit.  Each record is framed as
+ * "Record <length>" so a write cut off by a crash can be found and
+ * dropped at boot.
+ */
+static void journal_board(BOARD_DATA * board, const char *fmt, ...)
+{
+        FILE     *fp;
+        char      filename[256];
+        char      buf[MAX_STRING_LENGTH * 2];
+        va_list   args;
+        int       len;
+
+        if (board->journal_ops >= BOARD_JOURNAL_MAX)
+        {
+                write_board(board);
+                return;
+        }
+
+        va_start(args, fmt);
+        len = vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        if (len < 0 || static_cast<size_t>(len) >= sizeof(buf))
+        {
+                write_board(board);
+                return;
+        }
+
+        FCLOSE(fpReserve);
+        snprintf(filename, MSL, "%s%s.jnl", BOARD_DIR, board->note_file);
+        if ((fp = fopen(filename, "a")) == NULL)
+        {
+                perror(filename);
+                fpReserve = fopen(NULL_FILE, "r");
+                write_board(board);
+                return;
+        }
+        fseek(fp, 0, SEEK_END);
+        if (ftell(fp) == 0)
+                fprintf(fp, "Generation %d\n", board->journal_gen);
+        fprintf(fp, "Record %d\n%s", len, buf);
+        FCLOSE(fp);
+        fpReserve = fopen(NULL_FILE, "r");
+        board->journal_ops++;
+}
+
+static void journal_votes(BOARD_DATA * board, NOTE_DATA * pnote)
+{
+        journal_board(board,
+                      "Vote %d %d\nYesvotes %s~\nNovotes %s~\nAbstentions %s~\n",
+                      note_number(board, pnote), pnote->voting,
+                      pnote->yesvotes, pnote->novotes, pnote->abstentions);
+}
+
+/*
+ * Add a finished note to a board.
+ */
+void post_note(BOARD_DATA * board, NOTE_DATA * pnote)
+{
+        LINK(pnote, board->first_note, board->last_note, next, prev);
+        board->num_posts++;
+        index_note(board, pnote);
+        journal_board(board,
+                      "Post\nSender  %s~\nDate    %s~\nTo      %s~\nSubject %s~\nVoting %d\nYesvotes %s~\nNovotes %s~\nAbstentions %s~\nText\n%s~\n\n",
+                      pnote->sender, pnote->date, pnote->to_list,
+                      pnote->subject, pnote->voting, pnote->yesvotes,
+                      pnote->novotes, pnote->abstentions, pnote->text);
+}
+
 
 void free_note(NOTE_DATA * pnote)
 {
@@ -310,6 +495,8 @@ void free_note(NOTE_DATA * pnote)
 
 void note_remove(CHAR_DATA * ch, BOARD_DATA * board, NOTE_DATA * pnote)
 {
+        int       vnum;
+
         (void)ch; // Mark as intentionally unused for now
         if (!board)
         {
@@ -326,11 +513,13 @@ void note_remove(CHAR_DATA * ch, BOARD_DATA * board, NOTE_DATA * pnote)
         /*
          * Remove note from linked list.
          */
+        vnum = note_number(board, pnote);
+        unindex_note(board, pnote);
         UNLINK(pnote, board->first_note, board->last_note, next, prev);
 
         --board->num_posts;
         free_note(pnote);
-        write_board(board);
+        journal_board(board, "Remove %d\n", vnum);
 }
 
 
@@ -762,7 +951,7 @@ void note(CHAR_DATA * ch, char *arg_passed, BOARD_DATA * board)
                                 act(AT_ACTION, "$n opens voting on a note.",
                                     ch, NULL, NULL, TO_ROOM);
                         send_to_char("Voting opened.\n\r", ch);
-                        write_board(board);
+                        journal_votes(board, pnote);
                         return;
                 }
                 if (!str_cmp(arg_passed, "close"))
@@ -779,7 +968,7 @@ void note(CHAR_DATA * ch, char *arg_passed, BOARD_DATA * board)
                                 act(AT_ACTION, "$n closes voting on a note.",
                                     ch, NULL, NULL, TO_ROOM);
                         send_to_char("Voting closed.\n\r", ch);
-                        write_board(board);
+                        journal_votes(board, pnote);
                         return;
                 }
 
@@ -837,7 +1026,7 @@ void note(CHAR_DATA * ch, char *arg_passed, BOARD_DATA * board)
                         act(AT_ACTION, "$n votes on a note.", ch, NULL, NULL,
                             TO_ROOM);
                 send_to_char("Ok.\n\r", ch);
-                write_board(board);
+                journal_votes(board, pnote);
                 return;
         }
         else if (!str_cmp(arg, "write"))
@@ -1142,9 +1331,7 @@ void note(CHAR_DATA * ch, char *arg_passed, BOARD_DATA * board)
                 if (board->type == BOARD_IDEA)
                         pnote->voting = VOTE_OPEN;
 
-                LINK(pnote, board->first_note, board->last_note, next, prev);
-                board->num_posts++;
-                write_board(board);
+                post_note(board, pnote);
                 send_to_char("You upload your message to the terminal.\n\r",
                              ch);
                 extract_obj(paper);
@@ -1520,6 +1707,200 @@ NOTE_DATA *read_note(char * /* notefile */, FILE * fp)
         exit(1);
 }
 
+static NOTE_DATA *get_note_number(BOARD_DATA * board, int vnum)
+{
+        NOTE_DATA *pnote;
+
+        for (pnote = board->first_note; pnote && vnum > 1;
+             pnote = pnote->next)
+                vnum--;
+        return vnum == 1 ? pnote : NULL;
+}
+
+/*
+ * Offset just past the journal's last whole record.  A record whose
+ * header or body runs past the end of the file was cut off mid-write.
+ * Journals written before records were framed are taken as they are.
+ */
+static long board_journal_end(FILE * fp)
+{
+        long      size, pos, len, start, first;
+
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        rewind(fp);
+        fread_board_gen(fp);
+        pos = first = ftell(fp);
+        for (;;)
+        {
+                fseek(fp, pos, SEEK_SET);
+                if (fscanf(fp, " Record %ld", &len) != 1 || len < 0
+                    || getc(fp) != '\n')
+                        break;
+                start = ftell(fp);
+                if (start + len > size)
+                        break;
+                pos = start + len;
+        }
+        if (pos == first)
+        {
+                char      word[8] = "";
+
+                fseek(fp, first, SEEK_SET);
+                if (fscanf(fp, " %6s", word) == 1 && str_cmp(word, "Record"))
+                        pos = size;
+        }
+        for (; pos < size; pos++)
+        {
+                int       c;
+
+                fseek(fp, pos, SEEK_SET);
+                if ((c = getc(fp)) == EOF || !isspace(c))
+                        break;
+        }
+        rewind(fp);
+        return pos;
+}
+
+/*
+ * Replay a board's journal on top of its note file.  Returns the number
+ * of records applied.
+ */
+static int read_board_journal(BOARD_DATA * board)
+{
+        FILE     *fp;
+        NOTE_DATA *pnote;
+        char      filename[256];
+        const char *word;
+        char      letter;
+        int       count = 0;
+        int       gen;
+        long      size, end;
+
+        snprintf(filename, MSL, "%s%s.jnl", BOARD_DIR, board->note_file);
+        if ((fp = fopen(filename, "r")) == NULL)
+                return 0;
+
+        /*
+         * Drop a record cut off by a crash, or read_note() would run
+         * into the end of the file and exit. 
+         */
+        end = board_journal_end(fp);
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        rewind(fp);
+        if (end < size)
+        {
+                bug("read_board_journal: %s: dropping %ld bytes of a cut off record",
+                    filename, size - end);
+                FCLOSE(fp);
+                if (truncate(filename, end) != 0
+                    || (fp = fopen(filename, "r")) == NULL)
+                {
+                        perror(filename);
+                        return 0;
+                }
+        }
+
+        /*
+         * A journal from before the note file's last rewrite is already
+         * in it; replaying it would post notes twice and remove or vote
+         * on the wrong ones. 
+         */
+        if ((gen = fread_board_gen(fp)) != board->journal_gen)
+        {
+                bug("read_board_journal: %s: generation %d, note file has %d; discarding",
+                    filename, gen, board->journal_gen);
+                FCLOSE(fp);
+                remove(filename);
+                return 0;
+        }
+
+        for (;;)
+        {
+                do
+                {
+                        letter = static_cast<char>(getc(fp));
+                        if (feof(fp))
+                        {
+                                FCLOSE(fp);
+                                return count;
+                        }
+                }
+                while (isspace(letter));
+                ungetc(letter, fp);
+
+                word = fread_word(fp);
+                if (!str_cmp(word, "Record"))
+                {
+                        fread_number(fp);
+                        continue;
+                }
+                if (!str_cmp(word, "Post"))
+                {
+                        /*
+                         * read_note closes fp itself at the end of the file 
+                         */
+                        if ((pnote = read_note(filename, fp)) == NULL)
+                                return count;
+                        LINK(pnote, board->first_note, board->last_note,
+                             next, prev);
+                        board->num_posts++;
+                }
+                else if (!str_cmp(word, "Remove"))
+                {
+                        if ((pnote =
+                             get_note_number(board, fread_number(fp))) == NULL)
+                        {
+                                bug("read_board_journal: %s: bad note to remove",
+                                    filename);
+                                continue;
+                        }
+                        UNLINK(pnote, board->first_note, board->last_note,
+                               next, prev);
+                        board->num_posts--;
+                        free_note(pnote);
+                }
+                else if (!str_cmp(word, "Vote"))
+                {
+                        int       vnum = fread_number(fp);
+                        int       voting = fread_number(fp);
+                        char     *yes, *no, *abstain;
+
+                        fread_word(fp);
+                        yes = fread_string_nohash(fp);
+                        fread_word(fp);
+                        no = fread_string_nohash(fp);
+                        fread_word(fp);
+                        abstain = fread_string_nohash(fp);
+                        if ((pnote = get_note_number(board, vnum)) == NULL)
+                        {
+                                bug("read_board_journal: %s: bad note to vote on", filename);
+                                DISPOSE(yes);
+                                DISPOSE(no);
+                                DISPOSE(abstain);
+                                continue;
+                        }
+                        pnote->voting = voting;
+                        DISPOSE(pnote->yesvotes);
+                        DISPOSE(pnote->novotes);
+                        DISPOSE(pnote->abstentions);
+                        pnote->yesvotes = yes;
+                        pnote->novotes = no;
+                        pnote->abstentions = abstain;
+                }
+                else
+                {
+                        bug("read_board_journal: %s: bad record %s",
+                            filename, word);
+                        break;
+                }
+                count++;
+        }
+        FCLOSE(fp);
+        return count;
+}
+
 /*
  * Load boards file.
  */
@@ -1546,6 +1927,7 @@ void load_boards(void)
                 boot_log(notefile);
                 if ((note_fp = fopen(notefile, "r")) != NULL)
                 {
+                        board->journal_gen = fread_board_gen(note_fp);
                         while ((pnote = read_note(notefile, note_fp)) != NULL)
                         {
                                 LINK(pnote, board->first_note,
@@ -1553,6 +1935,10 @@ void load_boards(void)
                                 board->num_posts++;
                         }
                 }
+                if (read_board_journal(board) > 0)
+                        write_board(board);
+                else
+                        index_board(board);
         }
         return;
 }
@@ -1715,8 +2101,13 @@ CMDF do_bset(CHAR_DATA * ch, char *argument)
                         send_to_char("No filename specified.\n\r", ch);
                         return;
                 }
+                /*
+                 * Fold the journal in under the old name first 
+                 */
+                write_board(board);
                 DISPOSE(board->note_file);
                 board->note_file = str_dup(argument);
+                write_board(board);
         }
         else if (!str_cmp(arg2, "name"))
         {
@@ -1856,15 +2247,34 @@ CMDF do_boards(CHAR_DATA * ch, char * /* argument */)
 void mail_count(CHAR_DATA * ch)
 {
         BOARD_DATA *board;
-        NOTE_DATA *note;
+        std::vector<NOTE_DATA *> notes;
+        NOTE_INDEX::iterator it;
         int       cnt = 0;
 
         for (board = first_board; board; board = board->next)
-                if (board->type == BOARD_MAIL && can_read(ch, board))
-                        for (note = board->first_note; note;
-                             note = note->next)
-                                if (is_note_to_def(ch, note))
-                                        ++cnt;
+        {
+                if (board->type != BOARD_MAIL || !can_read(ch, board))
+                        continue;
+
+                NOTE_INDEX &index = note_index[board];
+
+                /*
+                 * Same matches as is_note_to_def(), counting each note once 
+                 */
+                notes.clear();
+                if ((it = index.find(strlower(ch->name))) != index.end())
+                        notes.insert(notes.end(), it->second.begin(),
+                                     it->second.end());
+                if ((it = index.find("all")) != index.end())
+                        notes.insert(notes.end(), it->second.begin(),
+                                     it->second.end());
+                if (IS_HERO(ch) && (it = index.find("immortal")) != index.end())
+                        notes.insert(notes.end(), it->second.begin(),
+                                     it->second.end());
+                std::sort(notes.begin(), notes.end());
+                cnt += static_cast<int>(std::unique(notes.begin(), notes.end())
+                                        - notes.begin());
+        }
         if (cnt)
                 ch_printf(ch, "You have %d mail messages waiting.\n\r", cnt);
         return;
@@ -1944,6 +2354,7 @@ void free_board(BOARD_DATA * board)
         NOTE_DATA *pnote, *note_next;
 
         UNLINK(board, first_board, last_board, next, prev);
+        note_index.erase(board);
         DISPOSE(board->note_file);
         DISPOSE(board->board_name);
         DISPOSE(board->read_group);
@@ -95,8 +95,18 @@ struct board_data
         sh_int    min_remove_level; /* Minimum level to remove a note  */
         sh_int    max_posts;    /* Maximum amount of notes allowed */
         int       type; /* Normal board or mail board? */
+        sh_int    journal_ops;  /* Journal records since last rewrite */
+        int       journal_gen;  /* Rewrites of the note file so far */
 };
 
+/*
+ * Posts, removals and votes are appended to <note_file>.jnl and folded
+ * into the note file once this many have built up, or at boot.  Both
+ * files start with the same "Generation" line; a journal left over from
+ * before the last rewrite carries an older one and is not replayed.
+ */
+#define BOARD_JOURNAL_MAX 50
+
 bool is_note_to args((CHAR_DATA * ch, NOTE_DATA * pnote));
 bool is_note_to_def args((CHAR_DATA * ch, NOTE_DATA * pnote));
 void note_attach args((CHAR_DATA * ch));
@@ -104,6 +114,7 @@ void      note_remove
 args((CHAR_DATA * ch, BOARD_DATA * board, NOTE_DATA * pnote));
 void note args((CHAR_DATA * ch, char *arg_passed, BOARD_DATA * board));
 void write_board args((BOARD_DATA * board));
+void post_note args((BOARD_DATA * board, NOTE_DATA * pnote));
 
 /* boards.c */
 void load_boards args((void));
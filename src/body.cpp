@@ -156,6 +156,8 @@ CMDF do_testbody(CHAR_DATA * ch, char *argument)
 
 BODY_DATA::BODY_DATA() : _filename{}, _gravity{0}, _name{}, _type{0}, 
                          _xpos{0}, _ypos{0}, _zpos{0}, _orbitcount{0},
+                         _orbittime{0}, _postime{0},
+                         _carryx{0}, _carryy{0}, _carryz{0},
                          _xmove{0}, _ymove{0}, _zmove{0},
                          _centerx{0}, _centery{0}, _centerz{0},
                          _planet{nullptr}, _starsystem{nullptr}
@@ -246,6 +248,128 @@ int BODY_DATA::hyperdistance(SHIP_DATA * ship)
 }
 
 
+/*
+ * Where this body's orbit puts it at a given game time.  The path keeps
+ * the shape of the old eight-phase stepping table: it starts at
+ * (centerx, centery, centerz - 1800 * zmove), sweeps ORBIT_REACH * move
+ * either side in x, out to twice that in y, and bobs twice per turn in z.
+ */
+void BODY_DATA::position_at(time_t when, int &x, int &y, int &z)
+{
+        double    steps, theta;
+
+        steps = this->_orbitcount
+                + static_cast<double>(when - this->_orbittime) / ORBIT_STEP_SECONDS;
+        steps = fmod(steps, ORBIT_STEPS);
+        if (steps < 0)
+                steps += ORBIT_STEPS;
+        theta = 2 * M_PI * steps / ORBIT_STEPS;
+
+        x = this->_centerx
+                + static_cast<int>(lround(ORBIT_REACH * this->_xmove * sin(theta)));
+        y = this->_centery
+                + static_cast<int>(lround(ORBIT_REACH * this->_ymove * (1 - cos(theta))));
+        z = this->_centerz - this->_zmove * 1800
+                + static_cast<int>(lround(ORBIT_REACH * 2 / 3 * this->_zmove
+                                          * (1 - cos(2 * theta))));
+}
+
+void BODY_DATA::update_position(void)
+{
+        if (this->orbiting())
+                this->position_at(current_time, this->_xpos, this->_ypos,
+                                  this->_zpos);
+        this->_postime = current_time;
+}
+
+/*
+ * The current orbit step, for display.
+ */
+int BODY_DATA::orbitcount()
+{
+        double    steps;
+
+        if (!this->orbiting())
+                return this->_orbitcount;
+        steps = this->_orbitcount
+                + static_cast<double>(current_time - this->_orbittime) / ORBIT_STEP_SECONDS;
+        steps = fmod(steps, ORBIT_STEPS);
+        return static_cast<int>(steps < 0 ? steps + ORBIT_STEPS : steps);
+}
+
+/*
+ * Put the body at step a of its orbit as of now.
+ */
+void BODY_DATA::orbitcount(int a)
+{
+        this->_orbitcount = a;
+        this->_orbittime = current_time;
+        this->_postime = 0;
+        this->carry_reset();
+}
+
+/*
+ * Back to the start of the orbit (placebody, resetbody).
+ */
+void BODY_DATA::reset_orbit(void)
+{
+        if (!this->orbiting())
+        {
+                this->_xpos = this->_centerx;
+                this->_ypos = this->_centery;
+                this->_zpos = this->_centerz - this->_zmove * 1800;
+        }
+        this->orbitcount(0);
+}
+
+/*
+ * Ships inside a planet's or moon's gravity well ride along with it.
+ * Called every space pulse, so the nudge is small and continuous.
+ */
+void BODY_DATA::carry_ships(void)
+{
+        SHIP_DATA *ship;
+        int       dx, dy, dz;
+        double    gx, gy, gz;
+
+        dx = this->xpos() - this->_carryx;
+        dy = this->ypos() - this->_carryy;
+        dz = this->zpos() - this->_carryz;
+        gx = this->_carryx;
+        gy = this->_carryy;
+        gz = this->_carryz;
+        this->_carryx = this->_xpos;
+        this->_carryy = this->_ypos;
+        this->_carryz = this->_zpos;
+
+        if ((dx == 0 && dy == 0 && dz == 0) || !this->orbiting()
+            || (this->_type != PLANET_BODY && this->_type != MOON_BODY))
+                return;
+
+        for (ship = this->_starsystem->first_ship; ship;
+             ship = ship->next_in_starsystem)
+        {
+                if ((ship->vx - gx) * (ship->vx - gx)
+                    + (ship->vy - gy) * (ship->vy - gy)
+                    + (ship->vz - gz) * (ship->vz - gz)
+                    >= static_cast<double>(this->_gravity) * this->_gravity)
+                        continue;
+                ship->vx += static_cast<float>(dx);
+                ship->vy += static_cast<float>(dy);
+                ship->vz += static_cast<float>(dz);
+        }
+}
+
+/*
+ * Carry ships from wherever the body is now.
+ */
+void BODY_DATA::carry_reset(void)
+{
+        this->_carryx = this->xpos();
+        this->_carryy = this->ypos();
+        this->_carryz = this->zpos();
+}
+
 void BODY_DATA::remove_area(AREA_DATA * area)
 {
         this->_areas.
@@ -290,6 +414,8 @@ void BODY_DATA::starsystem(SPACE_DATA * starsystem)
                 starsystem->bodies.push_back(this);
                 this->_starsystem = starsystem;
         }
+        this->_postime = 0;
+        this->carry_reset();
 }
 
 BODY_DATA *BODY_DATA::load(FILE * fp)
@@ -349,6 +475,14 @@ BODY_DATA *BODY_DATA::load(FILE * fp)
                                 while (this->_zmove > -10
                                        && this->_zmove < 10)
                                         this->_zmove = number_range(-50, 50);
+                                /*
+                                 * Files from before orbits were analytic
+                                 * carry only the step; take it as of now. 
+                                 */
+                                if (this->_orbittime == 0)
+                                        this->_orbittime = current_time;
+                                this->_postime = 0;
+                                this->carry_reset();
                                 return this;
                         }
                         break;
@@ -378,6 +512,8 @@ BODY_DATA *BODY_DATA::load(FILE * fp)
                 case 'O':
                         KEY("Orbitcount", this->_orbitcount,
                             fread_number(fp));
+                        KEY("Orbittime", this->_orbittime,
+                            fread_number(fp));
                         break;
 
                 case 'P':
@@ -534,9 +670,9 @@ void BODY_DATA::save()
                 fprintf(fp, "Name         %s~\n", this->_name.c_str());
                 fprintf(fp, "Filename     %s~\n", this->_filename.c_str());
                 fprintf(fp, "Type         %d\n", this->_type);
-                fprintf(fp, "Xpos         %d\n", this->_xpos);
-                fprintf(fp, "Ypos         %d\n", this->_ypos);
-                fprintf(fp, "Zpos         %d\n", this->_zpos);
+                fprintf(fp, "Xpos         %d\n", this->xpos());
+                fprintf(fp, "Ypos         %d\n", this->ypos());
+                fprintf(fp, "Zpos         %d\n", this->zpos());
                 fprintf(fp, "Xmove        %d\n", this->_xmove);
                 fprintf(fp, "Ymove        %d\n", this->_ymove);
                 fprintf(fp, "Zmove        %d\n", this->_zmove);
@@ -545,6 +681,8 @@ void BODY_DATA::save()
                 fprintf(fp, "Centerz      %d\n", this->_centerz);
                 fprintf(fp, "Gravity      %d\n", this->_gravity);
                 fprintf(fp, "Orbitcount   %d\n", this->_orbitcount);
+                fprintf(fp, "Orbittime    %ld\n",
+                        static_cast<long>(this->_orbittime));
                 if (this->_starsystem && this->_starsystem->name)
                         fprintf(fp, "Starsystem   %s~\n",
                                 this->_starsystem->name);
@@ -618,6 +756,7 @@ void load_bodies()
         fpReserve = fopen(NULL_FILE, "r");
         for (planet = first_planet; planet; planet = planet->next)
                 planet->body = get_body(planet->bodyname);
+        check_orbits();
         return;
 }
 
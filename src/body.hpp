@@ -56,6 +56,16 @@ namespace BodyConstants {
 // Legacy macros for compatibility
 #define BODY_DIR       "../body/"
 #define FILE_BODY_LIST	"body.lst"
+
+/*
+ * Orbits are evaluated from the body's orbital parameters and the game
+ * clock rather than stepped.  One revolution is ORBIT_STEPS steps of
+ * ORBIT_STEP_SECONDS each (the old hourly update), and ORBIT_REACH scales
+ * the move values into the orbit's extent.
+ */
+#define ORBIT_STEPS		360
+#define ORBIT_STEP_SECONDS	(PULSE_TAXES / PULSE_PER_SECOND)
+#define ORBIT_REACH		1350
 typedef std::list < DOCK_DATA * >DOCK_LIST;
 extern DOCK_DATA *first_dock;
 extern DOCK_DATA *last_dock;
@@ -114,7 +124,12 @@ class BODY_DATA
         int _xpos;
         int _ypos;
         int _zpos;
-        int _orbitcount;
+        int _orbitcount;     /* Orbit step at _orbittime */
+        time_t _orbittime;
+        time_t _postime;     /* Game time _xpos.._zpos were evaluated for */
+        int _carryx;         /* Position when ships were last carried along */
+        int _carryy;
+        int _carryz;
         int _xmove;
         int _ymove;
         int _zmove;
@@ -202,83 +217,133 @@ class BODY_DATA
         inline void type(int a)
         {
                 this->_type = a;
-        } inline int xpos()
+        }
+        /*
+         * A body in a starsystem is always on its orbit, so its position
+         * is worked out (once per second of game time) when asked for.
+         * Setting a position moves the orbit's center instead.  Any
+         * change by hand also restarts carry_ships() from where the body
+         * now is, so ships are not dragged along by the jump.
+         */
+        inline bool orbiting() const
         {
+                return this->_starsystem != NULL;
+        }
+        inline int xpos()
+        {
+                if (this->_postime != current_time)
+                        this->update_position();
                 return this->_xpos;
         }
         inline void xpos(int a)
         {
+                if (this->orbiting())
+                        this->_centerx += a - this->xpos();
                 this->_xpos = a;
-        } inline int ypos()
+                this->_postime = 0;
+                this->carry_reset();
+        }
+        inline int ypos()
         {
+                if (this->_postime != current_time)
+                        this->update_position();
                 return this->_ypos;
         }
         inline void ypos(int a)
         {
+                if (this->orbiting())
+                        this->_centery += a - this->ypos();
                 this->_ypos = a;
-        } inline int zpos()
+                this->_postime = 0;
+                this->carry_reset();
+        }
+        inline int zpos()
         {
+                if (this->_postime != current_time)
+                        this->update_position();
                 return this->_zpos;
         }
         inline void zpos(int a)
         {
+                if (this->orbiting())
+                        this->_centerz += a - this->zpos();
                 this->_zpos = a;
-        } inline int xmove()
+                this->_postime = 0;
+                this->carry_reset();
+        }
+        inline int xmove()
         {
                 return this->_xmove;
         }
         inline void xmove(int a)
         {
                 this->_xmove = a;
-        } inline int ymove()
+                this->_postime = 0;
+                this->carry_reset();
+        }
+        inline int ymove()
         {
                 return this->_ymove;
         }
         inline void ymove(int a)
         {
                 this->_ymove = a;
-        } inline int zmove()
+                this->_postime = 0;
+                this->carry_reset();
+        }
+        inline int zmove()
         {
                 return this->_zmove;
         }
         inline void zmove(int a)
         {
                 this->_zmove = a;
-        } inline int centerx()
+                this->_postime = 0;
+                this->carry_reset();
+        }
+        inline int centerx()
         {
                 return this->_centerx;
         }
         inline void centerx(int a)
         {
                 this->_centerx = a;
-        } inline int centery()
+                this->_postime = 0;
+                this->carry_reset();
+        }
+        inline int centery()
         {
                 return this->_centery;
         }
         inline void centery(int a)
         {
                 this->_centery = a;
-        } inline int centerz()
+                this->_postime = 0;
+                this->carry_reset();
+        }
+        inline int centerz()
         {
                 return this->_centerz;
         }
         inline void centerz(int a)
         {
                 this->_centerz = a;
-        } inline int orbitcount()
-        {
-                return this->_orbitcount;
-        }
-        inline void orbitcount(int a)
-        {
-                this->_orbitcount = a;
+                this->_postime = 0;
+                this->carry_reset();
         }
+        int orbitcount();
+        void orbitcount(int a);
         /*
          * Other Functions 
          */
       public:void save();
 
         BODY_DATA *load(FILE *);
+        void update_position(void);
+        void position_at(time_t when, int &x, int &y, int &z);
+        void reset_orbit(void);
+        void carry_ships(void);
+        void carry_reset(void);
         void remove_area(AREA_DATA * pArea);
         void add_area(AREA_DATA * pArea);
         void add_dock(DOCK_DATA *);
@@ -296,6 +361,7 @@ BODY_DATA *get_body(char *name);
 DOCK_DATA *get_dock(char *name);
 DOCK_DATA *get_dock_isname(SHIP_DATA *ship, char *name);
 void load_bodies();
+void check_orbits(void);
 
 // Legacy macro-style declarations for compatibility
 BODY_DATA *get_body args((char *name));
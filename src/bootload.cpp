@@ -0,0 +1,235 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                              SWTFE Parallel Boot Module                               *
+ ****************************************************************************************/
+#include <string.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mud.hpp"
+#include "bootload.hpp"
+
+thread_local BOOT_STAGE *boot_stage = NULL;
+
+/*
+ * The stage table is built before any worker starts and never resized
+ * while they run.  next_stage hands out files in list order; done is only
+ * read or written under boot_mutex.
+ */
+static std::vector < BOOT_STAGE > boot_stages;
+static std::vector < std::thread > boot_workers;
+static size_t boot_next_stage;
+static std::mutex boot_mutex;
+static std::condition_variable boot_ready;
+
+/*
+ * Claim the next unparsed file, or return FALSE once all are claimed.
+ */
+static bool boot_claim(size_t * i)
+{
+        std::lock_guard < std::mutex > lock(boot_mutex);
+
+        if (boot_next_stage >= boot_stages.size())
+                return FALSE;
+        *i = boot_next_stage++;
+        return TRUE;
+}
+
+static void boot_parse_stage(size_t i)
+{
+        boot_parse_area(&boot_stages[i]);
+        {
+                std::lock_guard < std::mutex > lock(boot_mutex);
+
+                boot_stages[i].done = TRUE;
+        }
+        boot_ready.notify_all();
+}
+
+static void boot_worker(void)
+{
+        size_t    i;
+
+        while (boot_claim(&i))
+                boot_parse_stage(i);
+}
+
+/*
+ * Wait for a file to be parsed, parsing others in the meantime rather
+ * than sitting idle.
+ */
+static void boot_wait_stage(size_t i)
+{
+        size_t    j;
+
+        for (;;)
+        {
+                {
+                        std::unique_lock < std::mutex > lock(boot_mutex);
+
+                        if (boot_stages[i].done)
+                                return;
+                        if (boot_next_stage >= boot_stages.size())
+                        {
+                                boot_ready.wait(lock,[i] {
+                                                return boot_stages[i].done;}
+                                );
+                                return;
+                        }
+                }
+                if (boot_claim(&j))
+                        boot_parse_stage(j);
+        }
+}
+
+static void boot_start(size_t next, int threads)
+{
+        int       i;
+
+        boot_next_stage = next;
+        for (i = 1; i < threads; i++)
+                boot_workers.emplace_back(boot_worker);
+}
+
+/*
+ * Stop handing out files and wait for the workers.  Returns the first
+ * file nobody claimed, for boot_start() to carry on from.
+ */
+static size_t boot_join(void)
+{
+        size_t    next;
+
+        {
+                std::lock_guard < std::mutex > lock(boot_mutex);
+
+                next = boot_next_stage;
+                boot_next_stage = boot_stages.size();
+        }
+        for (std::thread & worker:boot_workers)
+                if (worker.joinable()
+                    && worker.get_id() != std::this_thread::get_id())
+                        worker.join();
+        boot_workers.clear();
+        return next;
+}
+
+/*
+ * A loader that hits a bad file exit()s mid-boot, and destroying a
+ * joinable std::thread would terminate instead.  That exit() may come
+ * from a worker, which must not try to join itself.
+ */
+static void boot_join_at_exit(void)
+{
+        boot_join();
+}
+
+static int boot_thread_count(void)
+{
+        int       threads = sysdata.boot_threads;
+
+        if (threads == BOOT_THREADS_AUTO)
+                threads = static_cast < int >(std::thread::hardware_concurrency());
+        return URANGE(1, threads, BOOT_THREADS_MAX);
+}
+
+/*
+ * Load the area files named in area.lst.  With more than one boot thread
+ * they are parsed in parallel and linked here in list order; the game
+ * thread counts as one of the threads and parses too while it waits.
+ */
+void boot_load_areas(std::vector < std::string > &files)
+{
+        extern thread_local char strArea[MAX_INPUT_LENGTH];
+        static bool registered = FALSE;
+        int       threads = boot_thread_count();
+        size_t    i;
+
+        if (threads <= 1 || files.size() < 2)
+        {
+                for (std::string & file:files)
+                {
+                        mudstrlcpy(strArea, file.c_str(), MIL);
+                        load_area_file(last_area, strArea);
+                }
+                return;
+        }
+
+        if (!registered)
+        {
+                atexit(boot_join_at_exit);
+                registered = TRUE;
+        }
+        boot_stages.clear();
+        boot_stages.resize(files.size());
+        for (i = 0; i < files.size(); i++)
+                boot_stages[i].filename = files[i];
+        boot_next_stage = 0;
+        threads = UMIN(threads, static_cast < int >(files.size()));
+        boot_log("Parallel boot: parsing %d area files on %d threads.",
+                 static_cast < int >(files.size()), threads);
+
+        str_hash_threads(TRUE);
+        boot_start(0, threads);
+
+        for (i = 0; i < boot_stages.size(); i++)
+        {
+                boot_wait_stage(i);
+                /*
+                 * Loading a file serially toggles fBootDb, which the
+                 * workers read, so they sit that one out. 
+                 */
+                if (boot_stages[i].serial)
+                {
+                        size_t    next = boot_join();
+
+                        boot_link_area(&boot_stages[i]);
+                        boot_start(next, threads);
+                }
+                else
+                        boot_link_area(&boot_stages[i]);
+                boot_stages[i].sections.clear();
+                boot_stages[i].sections.shrink_to_fit();
+        }
+
+        boot_join();
+        str_hash_threads(FALSE);
+        boot_stages.clear();
+        boot_stages.shrink_to_fit();
+}
@@ -0,0 +1,115 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                              SWTFE Parallel Boot Module                               *
+ ****************************************************************************************/
+#ifndef _BOOTLOAD_H_
+#define _BOOTLOAD_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/*
+ * Parallel boot support.
+ *
+ * Area files are parsed on a pool of worker threads into staging records,
+ * one per file.  The game thread then links the records into the world in
+ * area.lst order, one section at a time, so hashes, vnum tables and lists
+ * come out exactly as a serial boot leaves them.
+ *
+ * Workers run the ordinary section loaders with boot_stage pointing at
+ * their file's record.  Mobiles, objects, rooms and helps are built in
+ * full and queued on the record instead of being linked; counters the
+ * loaders bump go through BOOT_TALLY.  Sections that look things up in
+ * the world (resets, shops, repairs, specials, program sections) are
+ * skipped and re-read by their loader on the game thread when the file is
+ * linked.  A file that does not start with #AREA is loaded serially.
+ *
+ * fpArea, strArea and the fread_* buffers are per thread, and the shared
+ * string hash takes striped locks while workers run.  "cset bootthreads 1"
+ * turns the pool off, 0 picks a thread count from the hardware.
+ */
+#define BOOT_THREADS_AUTO	0
+#define BOOT_THREADS_MAX	16
+
+typedef enum
+{
+        BOOT_SECTION_AREA,      /* Link the area itself */
+        BOOT_SECTION_HELPS, BOOT_SECTION_MOBILES, BOOT_SECTION_OBJECTS,
+        BOOT_SECTION_ROOMS,
+        BOOT_SECTION_DEFERRED   /* Re-read by its loader when linked */
+} boot_section_types;
+
+typedef void BOOT_LOADER(AREA_DATA * tarea, FILE * fp);
+
+struct boot_section
+{
+        int       type;
+        AREA_DATA *area;
+        BOOT_LOADER *loader;    /* Deferred sections only */
+        long      offset;       /* Deferred sections only */
+        std::vector < HELP_DATA * >helps;
+        std::vector < MOB_INDEX_DATA * >mobs;
+        std::vector < OBJ_INDEX_DATA * >objs;
+        std::vector < ROOM_INDEX_DATA * >rooms;
+};
+
+struct BOOT_STAGE
+{
+        std::string filename;
+        std::vector < boot_section > sections;
+        AREA_DATA *area;        /* Area the file's sections ended on */
+        bool      serial;       /* Load on the game thread instead */
+        bool      done;
+        int       top_affect;
+        int       top_ed;
+        int       top_exit;
+};
+
+/* The record the calling thread is parsing into, if any */
+extern thread_local BOOT_STAGE *boot_stage;
+
+#define BOOT_TALLY(counter)	(boot_stage ? boot_stage->counter++ : counter++)
+
+void      boot_load_areas(std::vector < std::string > &files);
+
+/* db.c */
+void      boot_parse_area(BOOT_STAGE * stage);
+void      boot_link_area(BOOT_STAGE * stage);
+
+#endif
@@ -57,6 +57,8 @@
 #include "installations.hpp"
 #include "space2.hpp"
 #include "password.hpp"
+#include "search.hpp"
+#include "channels.hpp"
 
 // Shared mutable empty string buffer to avoid repeated string literal casting
 static char empty_string[] = ""; // use with STRALLOC(empty_string)
@@ -1934,11 +1936,13 @@ CMDF do_mset(CHAR_DATA * ch, char *argument)
 
                 STRFREE(victim->name);
                 victim->name = STRALLOC(arg3);
+                name_index_update(victim);
                 if (IS_NPC(victim) && IS_SET(victim->act, ACT_PROTOTYPE))
                 {
                         STRFREE(victim->pIndexData->player_name);
                         victim->pIndexData->player_name =
                                 QUICKLINK(victim->name);
+                        search_invalidate();
                 }
                 return;
         }
@@ -2010,6 +2014,7 @@ CMDF do_mset(CHAR_DATA * ch, char *argument)
                                                    roster, victim->name);
 
                         victim->pcdata->clan = NULL;
+                        channel_listeners_changed();
                         send_to_char
                                 ("Removed from clan.\n\rPlease make sure you adjust that clan's members accordingly.\n\rAlso be sure to remove any bestowments they have been given.\n\r",
                                  ch);
@@ -2022,6 +2027,7 @@ CMDF do_mset(CHAR_DATA * ch, char *argument)
                         return;
                 }
                 victim->pcdata->clan = clan;
+                channel_listeners_changed();
                 if (clan->roster)
                 {
                         if (!hasname(clan->roster, victim->name))
@@ -3612,6 +3618,7 @@ CMDF do_oset(CHAR_DATA * ch, char *argument)
                 {
                         STRFREE(obj->pIndexData->name);
                         obj->pIndexData->name = QUICKLINK(obj->name);
+                        search_invalidate();
                 }
                 return;
         }
@@ -3620,6 +3627,7 @@ CMDF do_oset(CHAR_DATA * ch, char *argument)
         {
                 STRFREE(obj->short_descr);
                 obj->short_descr = STRALLOC(arg3);
+                obj_reown(obj);
                 if (IS_OBJ_STAT(obj, ITEM_PROTOTYPE))
                 {
                         STRFREE(obj->pIndexData->short_descr);
@@ -5371,6 +5379,7 @@ CMDF do_mcreate(CHAR_DATA * ch, char *argument)
 
 void free_reset(AREA_DATA * are, RESET_DATA * res)
 {
+        invalidate_reset_progs();
         UNLINK(res, are->first_reset, are->last_reset, next, prev);
         DISPOSE(res);
 }
@@ -46,6 +46,11 @@
 #include <cstring>
 #include <cctype>
 #include <ctime>
+#include <cstdint>
+#include <sys/stat.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "mud.hpp"
 #include "channels.hpp"
 #include "color.hpp"
@@ -67,16 +72,163 @@ DECLARE_DO_FUN(do_history);
 extern bool is_ignoring(CHAR_DATA * ch, CHAR_DATA * victim);
 extern char *const valid_color[];
 char     *scramble args((const char *argument, LANGUAGE_DATA * language));
+static void close_channel_logfile(CHANNEL_DATA * channel);
 
 CHANNEL_DATA *first_channel = NULL;
 CHANNEL_DATA *last_channel = NULL;
 
 CHANNEL_DATA *get_channel(char *name) { return get_channel(static_cast<const char*>(name)); }
 
+/*
+ * Channel lookup runs for every word interpret() doesn't recognise, so the
+ * names are kept in two hashes: one for exact names and one holding every
+ * prefix of every keyword, each pointing at the first channel in list order
+ * that nifty_is_name_prefix would have picked.  Both are rebuilt lazily
+ * whenever the channel list or a channel name changes.
+ */
+static std::unordered_map<std::string, CHANNEL_DATA *> channel_exact;
+static std::unordered_map<std::string, CHANNEL_DATA *> channel_prefix;
+static bool channel_index_stale = true;
+
+/*
+ * Who is listening to what, in descriptor list order.  The character is
+ * kept alongside so a descriptor that has since switched bodies or logged
+ * in as someone else is noticed at delivery.
+ */
+struct channel_listener
+{
+        DESCRIPTOR_DATA *d;
+        CHAR_DATA *och;
+};
+
+/*
+ * Everyone listening to one channel, plus the same people filed by clan and
+ * by descriptor so clan and planet range don't have to look at all of them.
+ * Anyone switched into a mob is kept apart too: the area player lists that
+ * planet range walks only carry players' own bodies.
+ */
+struct channel_audience
+{
+        std::vector<channel_listener> all;
+        std::vector<channel_listener> switched;
+        std::unordered_map<DESCRIPTOR_DATA *, CHAR_DATA *> by_desc;
+        std::unordered_map<CLAN_DATA *, std::vector<channel_listener>> by_clan;
+};
+static std::unordered_map<CHANNEL_DATA *, channel_audience> channel_listeners;
+static bool channel_listeners_stale = true;
+static unsigned int channel_listeners_epoch = 0;
+
+/*
+ * Only plain single keywords can be answered from the hash; anything that
+ * one_argument2 would split or unquote goes through the old scan.
+ */
+static bool channel_simple_key(const char *name)
+{
+        if (name[0] == '\0')
+                return FALSE;
+        for (; *name; name++)
+                if (isspace(*name) || *name == '-' || *name == '\'' || *name == '"')
+                        return FALSE;
+        return TRUE;
+}
+
+static void build_channel_index(void)
+{
+        char      names[MAX_INPUT_LENGTH];
+        char      word[MAX_INPUT_LENGTH];
+
+        channel_exact.clear();
+        channel_prefix.clear();
+        for (CHANNEL_DATA *channel = first_channel; channel; channel = channel->next)
+        {
+                char     *p;
+
+                if (!channel->name)
+                        continue;
+                channel_exact.emplace(lower_key(channel->name), channel);
+                mudstrlcpy(names, channel->name, MAX_INPUT_LENGTH);
+                for (p = one_argument2(names, word); word[0] != '\0'; p = one_argument2(p, word))
+                {
+                        std::string key = lower_key(word);
+
+                        while (!key.empty())
+                        {
+                                channel_prefix.emplace(key, channel);
+                                key.pop_back();
+                        }
+                }
+        }
+        channel_index_stale = false;
+}
+
+/*
+ * The channel list or a name changed; lookups and listener sets both
+ * depend on it.
+ */
+static void channel_table_changed(void)
+{
+        channel_index_stale = true;
+        channel_listeners_changed();
+}
+
+void channel_listeners_changed(void)
+{
+        channel_listeners_stale = true;
+        channel_listeners_epoch++;
+}
+
+static void build_channel_listeners(void)
+{
+        channel_listeners.clear();
+        for (CHANNEL_DATA *channel = first_channel; channel; channel = channel->next)
+        {
+                channel_audience &audience = channel_listeners[channel];
+
+                if (!channel->name)
+                        continue;
+                for (DESCRIPTOR_DATA *d = first_descriptor; d; d = d->next)
+                {
+                        CHAR_DATA *och = d->original ? d->original : d->character;
+
+                        if (!och || !och->pcdata
+                            || !hasname(och->pcdata->listening, channel->name))
+                                continue;
+                        audience.all.push_back({ d, och });
+                        audience.by_desc.emplace(d, och);
+                        if (d->original)
+                                audience.switched.push_back({ d, och });
+                        if (och->pcdata->clan)
+                                audience.by_clan[och->pcdata->clan].push_back({ d, och });
+                }
+        }
+        channel_listeners_stale = false;
+}
+
+static bool descriptor_linked(DESCRIPTOR_DATA * d)
+{
+        for (DESCRIPTOR_DATA *dl = first_descriptor; dl; dl = dl->next)
+                if (dl == d)
+                        return TRUE;
+        return FALSE;
+}
+
 CHANNEL_DATA *get_channel(const char *name)
 {
         if (!name)
                 return nullptr;
+        if (channel_simple_key(name))
+        {
+                std::string key = lower_key(name);
+
+                if (channel_index_stale)
+                        build_channel_index();
+                auto it = channel_exact.find(key);
+
+                if (it != channel_exact.end())
+                        return it->second;
+                it = channel_prefix.find(key);
+                return it != channel_prefix.end() ? it->second : nullptr;
+        }
         for (CHANNEL_DATA *channel = first_channel; channel; channel = channel->next)
         {
                 if (!str_cmp(name, channel->name))
@@ -100,20 +252,10 @@ void free_channel(CHANNEL_DATA * channel)
                 DISPOSE(channel->emotemessage);
         if (channel->socialmessage)
                 DISPOSE(channel->socialmessage);
-        if (channel->log)
-        {
-                int       x;
-
-                for (x = 0; x <= channel->logpos; x++)
-                {
-                        if (channel->log[x].name)
-                                STRFREE(channel->log[x].name);
-                        if (channel->log[x].message)
-                                DISPOSE(channel->log[x].message);
-                }
-                DISPOSE(channel->log);
-        }
+        resize_channel_log(channel, 0);
+        close_channel_logfile(channel);
         UNLINK(channel, first_channel, last_channel, next, prev);
+        channel_table_changed();
         DISPOSE(channel);
         return;
 }
@@ -134,6 +276,128 @@ bool player_is_listening(CHAR_DATA * ch, CHANNEL_DATA * channel)
 	return true;
 }
 
+/*
+ * act() says nothing at all for a secretive speaker in character.
+ */
+static bool channel_secretive(CHAR_DATA * ch, bool OOC)
+{
+        if (OOC)
+                return FALSE;
+        if (IS_NPC(ch))
+                return IS_SET(ch->act, ACT_SECRETIVE);
+        return IS_SET(ch->act, PLR_SECRETIVE) || IS_AFFECTED(ch, AFF_SECRETIVE);
+}
+
+/*
+ * A message using nothing but $n and $t reads the same for every listener
+ * who sees the speaker under the same name, so it only needs formatting once
+ * per name.
+ */
+static bool channel_format_once(const char *format)
+{
+        for (; *format; format++)
+        {
+                if (*format != '$')
+                        continue;
+                ++format;
+                if (*format != 'n' && *format != 't')
+                        return FALSE;
+        }
+        return TRUE;
+}
+
+/*
+ * Cockpit vnum to ship, resolving clashes the way ship_from_cockpit does
+ * (first ship in the list wins), so system range costs one pass over the
+ * ships per message instead of one per listener.
+ */
+static void build_cockpit_index(std::unordered_map<int, SHIP_DATA *> &cockpits)
+{
+        for (SHIP_DATA *ship = first_ship; ship; ship = ship->next)
+        {
+                cockpits.emplace(ship->cockpit, ship);
+                cockpits.emplace(ship->turret1, ship);
+                cockpits.emplace(ship->turret2, ship);
+                cockpits.emplace(ship->pilotseat, ship);
+                cockpits.emplace(ship->coseat, ship);
+                cockpits.emplace(ship->navseat, ship);
+                cockpits.emplace(ship->gunseat, ship);
+                cockpits.emplace(ship->engineroom, ship);
+        }
+}
+
+/*
+ * Listeners in the clan or any of its subclans.
+ */
+static void channel_clan_audience(channel_audience & audience, CLAN_DATA * clan,
+                                  std::vector<channel_listener> &listeners)
+{
+        for (CLAN_DATA *sub = first_clan; sub; sub = sub->next)
+        {
+                if (sub != clan && sub->mainclan != clan)
+                        continue;
+                auto it = audience.by_clan.find(sub);
+
+                if (it != audience.by_clan.end())
+                        listeners.insert(listeners.end(), it->second.begin(),
+                                         it->second.end());
+        }
+}
+
+/*
+ * Listeners standing somewhere on the planet, found through the player
+ * lists of its areas, plus the switched ones for the caller to check.
+ */
+static void channel_planet_audience(channel_audience & audience,
+                                    PLANET_DATA * planet,
+                                    std::vector<channel_listener> &listeners)
+{
+        for (AREA_DATA *area = planet->first_area; area; area = area->next_on_planet)
+                for (CHAR_DATA *pc = area->first_person; pc; pc = pc->next_in_area)
+                {
+                        if (!pc->desc || pc->desc->character != pc)
+                                continue;
+                        auto it = audience.by_desc.find(pc->desc);
+
+                        if (it != audience.by_desc.end() && it->second == pc)
+                                listeners.push_back({ pc->desc, pc });
+                }
+        for (const channel_listener &l : audience.switched)
+                if (l.d->original)
+                        listeners.push_back(l);
+}
+
+/*
+ * The TO_VICT half of act() for text that has already been formatted,
+ * act triggers included.
+ */
+static void channel_send(CHANNEL_DATA * channel, const char *format,
+                         CHAR_DATA * ch, CHAR_DATA * vch, const char *txt,
+                         void *arg1, bool OOC)
+{
+        if (!vch->in_room)
+        {
+                bug("Act: vch in NULL room!");
+                bug("%s -> %s (%s)", ch->name, vch->name, format);
+                return;
+        }
+        if ((!vch->desc && IS_NPC(vch)
+             && !IS_SET(vch->pIndexData->progtypes, ACT_PROG))
+            || (!OOC && !IS_AWAKE(vch)))
+                return;
+        if (is_ignoring(ch, vch))
+                return;
+        if (vch->desc && !is_ignoring(vch, ch))
+        {
+                set_char_color(static_cast<sh_int>(channel->color), vch);
+                send_to_char(txt, vch);
+        }
+        if (MOBtrigger && !OOC)
+                mprog_act_trigger(const_cast<char *>(txt), vch, ch,
+                                  static_cast<OBJ_DATA *>(arg1), vch);
+        MOBtrigger = TRUE;
+}
+
 bool check_channel(CHAR_DATA * ch, char *command, char *argument)
 {
         CHANNEL_DATA *channel;
@@ -384,27 +648,58 @@ bool check_channel(CHAR_DATA * ch, char *command, char *argument)
         else
                 act(static_cast<sh_int>(channel->color), messagetype, ch, buf, NULL, TO_CHAR_OOC);
 
-        for (d = first_descriptor; d; d = d->next)
+        if (channel_listeners_stale)
+                build_channel_listeners();
+
+        /*
+         * Copy the set: a send that overflows an output buffer closes that
+         * socket and invalidates the shared one under us.
+         */
+        channel_audience &audience = channel_listeners[channel];
+        std::vector<channel_listener> listeners;
+
+        if (channel->range == CHANNEL_CLAN && clan)
+                channel_clan_audience(audience, clan, listeners);
+        else if (channel->range == CHANNEL_PLANET && planet)
+                channel_planet_audience(audience, planet, listeners);
+        else
+                listeners = audience.all;
+        unsigned int epoch = channel_listeners_epoch;
+        bool      OOC = OOC_CHANNEL(channel);
+        bool      once = !social && !channel_secretive(ch, OOC)
+                && channel_format_once(messagetype);
+        bool      named = strstr(messagetype, "$n") != NULL;
+        std::unordered_map<int, SHIP_DATA *> cockpits;
+        std::unordered_map<std::string, std::string> rendered[2];
+        std::string scrambled;
+        bool      have_scrambled = FALSE;
+
+        if (channel->range == CHANNEL_SYSTEM && ship)
+                build_cockpit_index(cockpits);
+
+        for (const channel_listener &l : listeners)
         {
                 CHAR_DATA *och;
                 CHAR_DATA *vch;
 
+                d = l.d;
+                if (epoch != channel_listeners_epoch && !descriptor_linked(d))
+                        continue;
+
                 och = d->original ? d->original : d->character;
                 vch = d->character;
 
-                if (IS_PLAYING(d) && vch != ch
-                    && hasname(och->pcdata->listening, channel->name))
+                if (IS_PLAYING(d) && vch != ch && och == l.och)
                 {
                         /*
                          * Ignoring Publicly 
                          */
                         char     *sbuf = argument;
+                        bool      garbled = FALSE;
 
                         if (channel->type == CHANNEL_IC_COM
                             && !has_comlink(och))
                                 continue;
-                        if (channel->level > ch->top_level)
-                                continue;
                         if (channel->type != CHANNEL_OOC
                             && xIS_SET(vch->in_room->room_flags,
                                        ROOM_SILENCE))
@@ -425,32 +720,27 @@ bool check_channel(CHAR_DATA * ch, char *command, char *argument)
                         }
                         if (channel->range == CHANNEL_CLAN)
                         {
-                                if (!vch->pcdata->clan)
+                                if (!och->pcdata->clan)
                                         continue;
-                                if (vch->pcdata->clan != clan
-                                    && vch->pcdata->clan->mainclan != clan)
+                                if (och->pcdata->clan != clan
+                                    && och->pcdata->clan->mainclan != clan)
                                         continue;
                         }
                         if (channel->range == CHANNEL_SYSTEM)
                         {
-                                SHIP_DATA *target;
-
                                 if (!ship)
                                         continue;
 
                                 if (!vch->in_room)
                                         continue;
 
-                                target = ship_from_cockpit(vch->in_room->
-                                                           vnum);
+                                auto target = cockpits.find(vch->in_room->vnum);
 
-                                if (!target)
+                                if (target == cockpits.end())
                                         continue;
 
-                                if (target->starsystem != ship->starsystem)
+                                if (target->second->starsystem != ship->starsystem)
                                         continue;
-                                snprintf(buf, MSL, "%s %s&D: $t",
-                                         channel->name, ship->name);
                         }
 
                         MOBtrigger = FALSE;
@@ -506,11 +796,36 @@ bool check_channel(CHAR_DATA * ch, char *command, char *argument)
                                      || channel->type == CHANNEL_IC_COM)
                                     && !knows_language(vch, ch->speaking, vch)
                                     && (!IS_NPC(ch) || ch->speaking != 0))
-                                        sbuf = scramble(argument,
-                                                        ch->speaking);
+                                {
+                                        /*
+                                         * One garbling per message; everyone
+                                         * who doesn't speak it hears the same.
+                                         */
+                                        if (!have_scrambled)
+                                        {
+                                                scrambled = scramble(argument,
+                                                                     ch->speaking);
+                                                have_scrambled = TRUE;
+                                        }
+                                        sbuf = const_cast<char *>(scrambled.c_str());
+                                        garbled = TRUE;
+                                }
                         }
 
-                        if (IC_CHANNEL(channel))
+                        if (once)
+                        {
+                                std::string name = named ? act_name(ch, vch, OOC) : "";
+                                auto     &cache = rendered[garbled ? 1 : 0];
+                                auto      it = cache.find(name);
+
+                                if (it == cache.end())
+                                        it = cache.emplace(name,
+                                                           act_string(messagetype, vch, ch,
+                                                                      sbuf, vch, OOC)).first;
+                                channel_send(channel, messagetype, ch, vch,
+                                             it->second.c_str(), sbuf, OOC);
+                        }
+                        else if (IC_CHANNEL(channel))
                                 act(static_cast<sh_int>(channel->color), messagetype, ch, sbuf,
                                     vch, TO_VICT);
                         else
@@ -581,6 +896,11 @@ CHANNEL_DATA *create_channel(void)
         channel->level = 0;
         channel->history = FALSE;
         channel->logpos = 0;
+        channel->logcount = 0;
+        channel->logsize = 0;
+        channel->logfp = NULL;
+        channel->idxfp = NULL;
+        channel->logbucket = 0;
         channel->cost = 0;
         channel->enabled = TRUE;
         return channel;
@@ -714,6 +1034,7 @@ void load_channels(void)
                                 channel = fread_channel(fp);
                                 LINK(channel, first_channel, last_channel,
                                      next, prev);
+                                channel_table_changed();
                                 continue;
                         }
                         else if (!str_cmp(word, "END"))
@@ -793,6 +1114,7 @@ CMDF do_makechannel(CHAR_DATA * ch, char *argument)
         strdup_printf(&channel->emotemessage, fmt_emote, channel->name);
         strdup_printf(&channel->socialmessage, fmt_social, channel->name);
         LINK(channel, first_channel, last_channel, next, prev);
+        channel_table_changed();
         save_channels();
         send_to_char("Done.\n\r", ch);
 }
@@ -862,6 +1184,8 @@ CMDF do_setchannel(CHAR_DATA * ch, char *argument)
                 if (channel->name)
                         STRFREE(channel->name);
                 channel->name = STRALLOC(argument);
+                close_channel_logfile(channel);
+                channel_table_changed();
                 send_to_char("Done.\n\r", ch);
         }
 
@@ -1022,6 +1346,7 @@ void addname(char **list, const char *name)
 
         STRFREE(*list);
         *list = STRALLOC(buf);
+        channel_listeners_changed();
 }
 
 /* Remove a name from a list */
@@ -1046,6 +1371,7 @@ void removename(char **list, const char *name)
 
         STRFREE(*list);
         *list = STRALLOC(buf);
+        channel_listeners_changed();
 }
 
 CMDF do_listen(CHAR_DATA * ch, char *argument)
@@ -1240,117 +1566,426 @@ CMDF do_channels(CHAR_DATA * ch, char *argument)
         return;
 }
 
-void add_channel_log(CHAR_DATA * from, char *message, CHANNEL_DATA * channel)
+/*
+ * The in-memory history is a ring of sysdata.channellog entries: logpos is
+ * the next slot to fill and logcount how many are in use, so adding a line
+ * only ever touches the slot it replaces.
+ */
+LOG_DATA *channel_log_entry(CHANNEL_DATA * channel, int n)
+{
+        if (!channel->log || n < 0 || n >= channel->logcount)
+                return NULL;
+        return &channel->log[(channel->logpos - channel->logcount + n +
+                              channel->logsize) % channel->logsize];
+}
+
+static void clear_log_entry(LOG_DATA * entry)
 {
-        int       i;
+        if (entry->name)
+                STRFREE(entry->name);
+        if (entry->message)
+                DISPOSE(entry->message);
+        entry->time = 0;
+        entry->language = NULL;
+}
 
-        if (!channel->history)
+/*
+ * Regrow or shrink the ring, keeping the newest entries.  A size of zero
+ * frees it.
+ */
+void resize_channel_log(CHANNEL_DATA * channel, int size)
+{
+        LOG_DATA *new_log = NULL;
+        int       keep, drop, i;
+
+        if (size < 0)
+                size = 0;
+        if (size == channel->logsize && channel->log)
                 return;
 
-        if (channel->log == NULL)
+        keep = UMIN(channel->logcount, size);
+        drop = channel->logcount - keep;
+        if (size > 0)
+                CREATE(new_log, LOG_DATA, static_cast<size_t>(size));
+        for (i = 0; i < channel->logcount; i++)
         {
-                CREATE(channel->log, LOG_DATA, static_cast<size_t>(sysdata.channellog));
-                channel->logpos = -1;
+                LOG_DATA *entry = channel_log_entry(channel, i);
+
+                if (i < drop)
+                        clear_log_entry(entry);
+                else
+                        new_log[i - drop] = *entry;
         }
+        if (channel->log)
+                DISPOSE(channel->log);
+        channel->log = new_log;
+        channel->logsize = size;
+        channel->logcount = keep;
+        channel->logpos = size > 0 ? keep % size : 0;
+}
 
-        smash_tilde(message);
-        if (++channel->logpos == sysdata.channellog)
-        {
-                if (channel->log[0].name)
-                        STRFREE(channel->log[0].name);
-                if (channel->log[0].message)
-                        DISPOSE(channel->log[0].message);
-                channel->log[0].time = 0;
-                channel->log[0].language = NULL;
-                for (i = 0; i < (sysdata.channellog - 1); i++)
+/*
+ * Store an entry in the ring.  The ring takes ownership of name (a shared
+ * string) and message (str_dup'd).
+ */
+void push_channel_log(CHANNEL_DATA * channel, char *name, char *message,
+                      time_t time, LANGUAGE_DATA * language)
+{
+        LOG_DATA *entry;
+
+        if (sysdata.channellog <= 0)
+        {
+                STRFREE(name);
+                DISPOSE(message);
+                return;
+        }
+        if (channel->logsize != sysdata.channellog || !channel->log)
+                resize_channel_log(channel, sysdata.channellog);
+
+        entry = &channel->log[channel->logpos];
+        clear_log_entry(entry);
+        entry->name = name;
+        entry->message = message;
+        entry->time = time;
+        entry->language = language;
+        channel->logpos = (channel->logpos + 1) % channel->logsize;
+        if (channel->logcount < channel->logsize)
+                channel->logcount++;
+}
+
+/*
+ * History files.  Each channel with history on appends one line per message
+ * to CHANNEL_LOG_DIR<name>.log:
+ *
+ *      <time>\t<speaker>\t<language>\t<message>
+ *
+ * and, whenever a message opens a new CHANNEL_LOG_BUCKET, a record to
+ * <name>.idx giving the bucket start and the byte offset of that line.
+ * Reading a day back is a binary search over the index and one seek.
+ */
+struct channel_log_index
+{
+        int64_t   time;
+        int64_t   offset;
+};
+
+static time_t logfile_failed = 0;
+
+static void channel_log_path(CHANNEL_DATA * channel, const char *ext,
+                             char *buf, size_t len)
+{
+        char      name[MAX_INPUT_LENGTH];
+        size_t    i;
+
+        for (i = 0; channel->name[i] != '\0' && i < sizeof(name) - 1; i++)
+                name[i] = isalnum(static_cast<unsigned char>(channel->name[i]))
+                        ? static_cast<char>(LOWER(channel->name[i])) : '_';
+        name[i] = '\0';
+        snprintf(buf, len, "%s%s.%s", CHANNEL_LOG_DIR, name, ext);
+}
+
+static void close_channel_logfile(CHANNEL_DATA * channel)
+{
+        if (channel->logfp)
+        {
+                FCLOSE(channel->logfp);
+        }
+        if (channel->idxfp)
+        {
+                FCLOSE(channel->idxfp);
+        }
+        channel->logbucket = 0;
+}
+
+static bool open_channel_logfile(CHANNEL_DATA * channel)
+{
+        char      path[MSL];
+        channel_log_index last;
+
+        if (channel->logfp && channel->idxfp)
+                return TRUE;
+        /*
+         * Don't retry (and bug) on every message while the directory is
+         * unwritable.
+         */
+        if (logfile_failed && current_time - logfile_failed < 60)
+                return FALSE;
+        close_channel_logfile(channel);
+
+        channel_log_path(channel, "log", path, sizeof(path));
+        if ((channel->logfp = fopen(path, "ae")) == NULL)
+        {
+                mkdir(CHANNEL_LOG_DIR, 0755);
+                if ((channel->logfp = fopen(path, "ae")) == NULL)
                 {
-                        if (channel->log[i].name)
-                                STRFREE(channel->log[i].name);
-                        channel->log[i].name =
-                                STRALLOC(channel->log[i + 1].name);
-                        if (channel->log[i].message)
-                                DISPOSE(channel->log[i].message);
-                        channel->log[i].message =
-                                str_dup(channel->log[i + 1].message);
-                        channel->log[i].time = channel->log[i + 1].time;
-                        channel->log[i].language =
-                                channel->log[i + 1].language;
+                        bug("%s: can't open %s", __func__, path);
+                        logfile_failed = current_time;
+                        return FALSE;
                 }
-                --channel->logpos;
-        }
-        if (channel->log[channel->logpos].name)
-                STRFREE(channel->log[channel->logpos].name);
-        channel->log[channel->logpos].name =
-                STRALLOC(IS_SET(from->act, PLR_WIZINVIS) ? immortal_visible_name : from->name);
-        if (channel->log[channel->logpos].message)
-                DISPOSE(channel->log[channel->logpos].message);
-        channel->log[channel->logpos].message = str_dup(message);
-        channel->log[channel->logpos].time = current_time;
-        channel->log[channel->logpos].language = from->speaking;
+        }
+        channel_log_path(channel, "idx", path, sizeof(path));
+        if ((channel->idxfp = fopen(path, "a+be")) == NULL)
+        {
+                bug("%s: can't open %s", __func__, path);
+                FCLOSE(channel->logfp);
+                logfile_failed = current_time;
+                return FALSE;
+        }
+        fseek(channel->logfp, 0, SEEK_END);
+
+        /*
+         * Pick up where the index left off so a reboot inside a bucket
+         * doesn't index it twice.
+         */
+        if (fseek(channel->idxfp, -static_cast<long>(sizeof(last)), SEEK_END) == 0
+            && fread(&last, sizeof(last), 1, channel->idxfp) == 1)
+                channel->logbucket = static_cast<time_t>(last.time);
+        return TRUE;
 }
 
-CMDF do_history(CHAR_DATA * ch, const char *argument)
+static void append_channel_logfile(CHANNEL_DATA * channel, LOG_DATA * entry)
+{
+        time_t    bucket;
+
+        if (!open_channel_logfile(channel))
+                return;
+
+        bucket = entry->time - entry->time % CHANNEL_LOG_BUCKET;
+        if (bucket != channel->logbucket)
+        {
+                channel_log_index rec;
+
+                rec.time = static_cast<int64_t>(bucket);
+                rec.offset = static_cast<int64_t>(ftell(channel->logfp));
+                fwrite(&rec, sizeof(rec), 1, channel->idxfp);
+                fflush(channel->idxfp);
+                channel->logbucket = bucket;
+        }
+        fprintf(channel->logfp, "%ld\t%s\t%s\t%s\n",
+                static_cast<long>(entry->time), entry->name,
+                entry->language ? entry->language->name : "", entry->message);
+        fflush(channel->logfp);
+}
+
+/*
+ * Offset in the history file of the bucket holding "from", found by binary
+ * search over the fixed-size index records.
+ */
+static long find_channel_logfile_offset(FILE * idx, time_t from)
+{
+        channel_log_index rec;
+        long      lo = 0, hi, found = 0;
+
+        if (fseek(idx, 0, SEEK_END) != 0)
+                return 0;
+        hi = ftell(idx) / static_cast<long>(sizeof(rec)) - 1;
+        while (lo <= hi)
+        {
+                long      mid = lo + (hi - lo) / 2;
+
+                if (fseek(idx, mid * static_cast<long>(sizeof(rec)), SEEK_SET) != 0
+                    || fread(&rec, sizeof(rec), 1, idx) != 1)
+                        break;
+                if (static_cast<time_t>(rec.time) <= from)
+                {
+                        found = static_cast<long>(rec.offset);
+                        lo = mid + 1;
+                }
+                else
+                        hi = mid - 1;
+        }
+        return found;
+}
+
+/*
+ * Read up to max lines logged at or after "from", skipping the first skip
+ * of them.  Returns the number of lines read.
+ */
+int read_channel_logfile(CHANNEL_DATA * channel, time_t from, int skip,
+                         int max, std::vector<channel_log_line> &lines)
+{
+        char      path[MSL];
+        char      line[MSL * 2];
+        FILE     *fp;
+        long      offset = 0;
+
+        lines.clear();
+        channel_log_path(channel, "idx", path, sizeof(path));
+        if ((fp = fopen(path, "rb")) != NULL)
+        {
+                offset = find_channel_logfile_offset(fp, from);
+                FCLOSE(fp);
+        }
+
+        channel_log_path(channel, "log", path, sizeof(path));
+        if ((fp = fopen(path, "r")) == NULL)
+                return 0;
+        fseek(fp, offset, SEEK_SET);
+        while (static_cast<int>(lines.size()) < max && fgets(line, sizeof(line), fp))
+        {
+                channel_log_line entry;
+                char     *name, *lang, *message, *p;
+                long      when = strtol(line, &p, 10);
+
+                if (*p != '\t')
+                        continue;
+                name = p + 1;
+                if ((lang = strchr(name, '\t')) == NULL)
+                        continue;
+                *lang++ = '\0';
+                if ((message = strchr(lang, '\t')) == NULL)
+                        continue;
+                *message++ = '\0';
+                if (static_cast<time_t>(when) < from || skip-- > 0)
+                        continue;
+                message[strcspn(message, "\r\n")] = '\0';
+
+                entry.time = static_cast<time_t>(when);
+                entry.name = name;
+                entry.language = lang;
+                entry.message = message;
+                lines.push_back(entry);
+        }
+        FCLOSE(fp);
+        return static_cast<int>(lines.size());
+}
+
+void add_channel_log(CHAR_DATA * from, char *message, CHANNEL_DATA * channel)
+{
+        LOG_DATA *entry;
+
+        if (!channel->history)
+                return;
+
+        smash_tilde(message);
+        push_channel_log(channel,
+                         STRALLOC(IS_SET(from->act, PLR_WIZINVIS) ? immortal_visible_name : from->name),
+                         str_dup(message), current_time, from->speaking);
+        if ((entry = channel_log_entry(channel, channel->logcount - 1)) != NULL)
+                append_channel_logfile(channel, entry);
+}
+
+static void show_history_line(CHAR_DATA * ch, CHANNEL_DATA * channel,
+                              int count, time_t when, const char *name,
+                              LANGUAGE_DATA * language, char *message)
 {
-        int       count = 0;
-        int       pos = 0;
-        CHANNEL_DATA *channel;
         char      buf[MSL];
         char      chan[100];
 
+        buf[0] = '\0';
+        chan[0] = '\0';
+        if (channel->type != CHANNEL_OOC && language
+            && !knows_language(ch, language, ch))
+        {
+                snprintf(buf, MSL, "%s", scramble(message, language));
+        }
+        else
+        {
+                snprintf(buf, MSL, "%s", message);
+                if (channel->type != CHANNEL_OOC && language)
+                        snprintf(chan, 100, "(%s) ", language->name);
+        }
+
+        set_char_color(static_cast<sh_int>(channel->color), ch);
+        ch_printf(ch,
+                  "&B[&W%2d&B][&W%.24s&B]&D %s %s&W: &Y%s&W%s&w\n\r",
+                  count, ctime(&when), channel->name, name, chan, buf);
+}
+
+/*
+ * history <channel>                  - the recent lines kept in memory
+ * history <channel> <days> [page]    - read back from the history file,
+ *                                      starting <days> days ago
+ */
+CMDF do_history(CHAR_DATA * ch, const char *argument)
+{
+        CHANNEL_DATA *channel;
+        char      buf[MIL];
+        char      arg[MIL];
+        char      arg2[MIL];
+        char     *rest;
+        int       count;
+
         if (!argument || argument[0] == '\0')
         {
-                send_to_char("Syntanx: history <channel>", ch);
+                send_to_char("Syntanx: history <channel> [<days ago> [page]]", ch);
                 return;
         }
 
-        if ((channel = get_channel(argument)) == NULL)
+        mudstrlcpy(buf, argument, MIL);
+        rest = one_argument(buf, arg);
+        rest = one_argument(rest, arg2);
+        if (arg2[0] == '\0' || !is_number(arg2))
+                mudstrlcpy(arg, argument, MIL);
+
+        if ((channel = get_channel(arg)) == NULL)
         {
                 send_to_char("That is not a valid channel", ch);
                 return;
         }
 
-        if (channel->history == FALSE || !channel->log
-            || ch->top_level < channel->level)
+        if (channel->history == FALSE || ch->top_level < channel->level)
         {
                 send_to_char("That channel does not have a log.", ch);
                 return;
         }
 
-        ch_printf(ch, "&B%c&z%s History\n\r", channel->name[0],
-                  channel->name + 1);
-        send_to_char("&B-----------\n\r", ch);
-
-        while (1)
+        if (arg2[0] != '\0' && is_number(arg2))
         {
-                if (count++ >= sysdata.channellog)
-                        break;
-                if (pos > channel->logpos)
-                        break;
-                buf[0] = '\0';
-                chan[0] = '\0';
-
-                if (channel->type != CHANNEL_OOC &&
-                    !knows_language(ch, channel->log[pos].language, ch))
+                std::vector<channel_log_line> lines;
+                int       days = URANGE(0, atoi(arg2), 3650);
+                int       page = UMAX(1, atoi(rest));
+                int       per_page = sysdata.channellog > 0 ? sysdata.channellog : 20;
+                time_t    from = current_time - current_time % 86400 -
+                        static_cast<time_t>(days) * 86400;
+
+                read_channel_logfile(channel, from, (page - 1) * per_page,
+                                     per_page, lines);
+                ch_printf(ch, "&B%c&z%s History from %.10s, page %d\n\r",
+                          channel->name[0], channel->name + 1, ctime(&from),
+                          page);
+                send_to_char("&B-----------\n\r", ch);
+                if (lines.empty())
                 {
-                        snprintf(buf, MSL, "%s",
-                                 scramble(channel->log[pos].message,
-                                          channel->log[pos].language));
+                        send_to_char("Nothing logged there.\n\r", ch);
+                        return;
                 }
-                else
+                count = (page - 1) * per_page;
+                for (channel_log_line &line : lines)
                 {
-                        snprintf(buf, MSL, "%s", channel->log[pos].message);
-                        if (channel->type != CHANNEL_OOC)
-                                snprintf(chan, 100, "(%s) ",
-                                         channel->log[pos].language->name);
+                        char      message[MSL];
+                        LANGUAGE_DATA *language = NULL;
+
+                        mudstrlcpy(message, line.message.c_str(), MSL);
+                        if (!line.language.empty())
+                        {
+                                char      lang[MIL];
+
+                                mudstrlcpy(lang, line.language.c_str(), MIL);
+                                language = get_language(lang);
+                        }
+                        show_history_line(ch, channel, ++count, line.time,
+                                          line.name.c_str(), language, message);
                 }
+                return;
+        }
 
-                set_char_color(static_cast<sh_int>(channel->color), ch);
-                ch_printf(ch,
-                          "&B[&W%2d&B][&W%.24s&B]&D %s %s&W: &Y%s&W%s&w\n\r",
-                          count,
-                          ctime(&channel->log[pos].time),
-                          channel->name, channel->log[pos].name, chan, buf);
-                pos++;
+        if (!channel->log)
+        {
+                send_to_char("That channel does not have a log.", ch);
+                return;
+        }
+
+        ch_printf(ch, "&B%c&z%s History\n\r", channel->name[0],
+                  channel->name + 1);
+        send_to_char("&B-----------\n\r", ch);
+
+        for (count = 0; count < channel->logcount; count++)
+        {
+                LOG_DATA *entry = channel_log_entry(channel, count);
+
+                show_history_line(ch, channel, count + 1, entry->time,
+                                  entry->name, entry->language, entry->message);
         }
 }
 
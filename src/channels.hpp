@@ -40,6 +40,9 @@
  *                                SWR OLC Channel module                                 *
  ****************************************************************************************/
 
+#include <string>
+#include <vector>
+
 // Forward declaration
 struct channel_data;
 using CHANNEL_DATA = channel_data;
@@ -47,6 +50,8 @@ extern CHANNEL_DATA *first_channel;
 extern CHANNEL_DATA *last_channel;
 
 #define CHANNEL_FILE SYSTEM_DIR "channel.dat"
+#define CHANNEL_LOG_DIR LOG_DIR "channels/"  /* Append-only history, one file per channel */
+#define CHANNEL_LOG_BUCKET 3600               /* Seconds covered by one time index entry */
 struct channel_data
 {
         CHANNEL_DATA *next;
@@ -61,7 +66,12 @@ struct channel_data
         int       color;     /* Color of TEXT to send, best to reset title at the end with &D */
         int       range;     /* Room/Area/Planet/System/Global/Clan */
         int       level;     /* Minimum level to see this channel */
-        int       logpos;    /* Current position in the log (runtime only) */
+        int       logpos;    /* Next slot to write in the log ring (runtime only) */
+        int       logcount;  /* Entries held in the log ring */
+        int       logsize;   /* Slots allocated for the log ring */
+        FILE     *logfp;     /* Open history file, or NULL */
+        FILE     *idxfp;     /* Its time index */
+        time_t    logbucket; /* Start of the last indexed bucket */
         int       cost;      /* Does it cost to use this channel? */
         bool      history;  /* Whether or not we are saving a log on thig channel */
         bool      enabled;  /* Whether we want people to use this channel at the moment */
@@ -81,7 +91,23 @@ typedef enum
 CHANNEL_DATA *get_channel(char *name);              // legacy mutable interface
 CHANNEL_DATA *get_channel(const char *name);        // const-safe overload
 bool check_channel(CHAR_DATA * ch, char *command, char *argument);
+void channel_listeners_changed(void);
 void add_channel_log(CHAR_DATA * from, char *message, CHANNEL_DATA * channel);
+void push_channel_log(CHANNEL_DATA * channel, char *name, char *message,
+                      time_t time, LANGUAGE_DATA * language);
+LOG_DATA *channel_log_entry(CHANNEL_DATA * channel, int n);
+void resize_channel_log(CHANNEL_DATA * channel, int size);
+
+/* One line read back from a channel's history file */
+struct channel_log_line
+{
+        time_t    time;
+        std::string name;
+        std::string language;
+        std::string message;
+};
+int read_channel_logfile(CHANNEL_DATA * channel, time_t from, int skip,
+                         int max, std::vector<channel_log_line> &lines);
 int hasname(const char *list, const char *name);
 void addname(char **list, const char *name);
 void removename(char **list, const char *name);
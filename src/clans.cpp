@@ -72,6 +72,9 @@
 #include "space2.hpp"
 #include "installations.hpp"
 #include "hotboot.hpp"
+#include "persist.hpp"
+#include "economy.hpp"
+#include "channels.hpp"
 
 #define MAX_NEST	100
 static OBJ_DATA *rgObjNest[MAX_NEST];
@@ -180,7 +183,7 @@ void save_clan(CLAN_DATA * clan)
         snprintf(filename, MSL, "%s%s", CLAN_DIR, clan->filename);
 
         FCLOSE(fpReserve);
-        if ((fp = fopen(filename, "w")) == NULL)
+        if ((fp = persist_open(filename)) == NULL)
         {
                 bug("save_clan: fopen", 0);
                 perror(filename);
@@ -228,7 +231,7 @@ void save_clan(CLAN_DATA * clan)
                 fprintf(fp, "Roster     %s~\n", clan->roster);
                 fprintf(fp, "End\n\n");
                 fprintf(fp, "#END\n");
-                FCLOSE(fp);
+                persist_close(fp);
         }
         fpReserve = fopen(NULL_FILE, "r");
         return;
@@ -262,7 +265,7 @@ void save_planet(PLANET_DATA * planet, bool copyover)
         snprintf(filename, MSL, "%s%s", PLANET_DIR, planet->filename);
 
         FCLOSE(fpReserve);
-        if ((fp = fopen(filename, "w")) == NULL)
+        if ((fp = persist_open(filename)) == NULL)
         {
                 bug("save_planet: fopen", 0);
                 perror(filename);
@@ -321,7 +324,7 @@ void save_planet(PLANET_DATA * planet, bool copyover)
                 fprintf(fp, "End\n\n");
                 fprintf(fp, "#END\n");
         }
-        FCLOSE(fp);
+        persist_close(fp);
         fpReserve = fopen(NULL_FILE, "r");
         return;
 }
@@ -1146,6 +1149,7 @@ CMDF do_induct(CHAR_DATA * ch, char *argument)
         clan->members++;
 
         victim->pcdata->clan = clan;
+        channel_listeners_changed();
         if (clan->roster)
         {
                 if (!hasname(clan->roster, victim->name))
@@ -1235,6 +1239,7 @@ CMDF do_outcast(CHAR_DATA * ch, char *argument)
                         removename(&ch->pcdata->clan->roster, ch->name);
 
         victim->pcdata->clan = NULL;
+        channel_listeners_changed();
         act(AT_MAGIC, "You outcast $N from $t", ch, clan->name, victim,
             TO_CHAR);
         act(AT_MAGIC, "$n outcasts $N from $t", ch, clan->name, victim,
@@ -1953,6 +1958,7 @@ CMDF do_setplanet(CHAR_DATA * ch, char *argument)
         }
         else if (!strcmp(arg2, "delete"))
         {
+                economy_forget(planet);
                 UNLINK(planet, first_planet, last_planet, next, prev);
                 free_planet(planet);
                 write_planet_list();
@@ -2695,6 +2701,7 @@ CMDF do_enlist(CHAR_DATA * ch, char *argument)
                                 {
                                         ++clan->members;
                                         ch->pcdata->clan = clan;
+                                        channel_listeners_changed();
    									    ch->pcdata->clanrank = 0;
                                         if (clan->roster)
                                         {
@@ -2728,6 +2735,7 @@ CMDF do_enlist(CHAR_DATA * ch, char *argument)
                                 {
                                         ++clan->members;
                                         ch->pcdata->clan = installation->clan;
+                                        channel_listeners_changed();
                                         ch_printf(ch, "Welcome to %s.\n\r",
                                                   clan->name);
                                         save_clan(clan);
@@ -2796,6 +2804,7 @@ CMDF do_resign(CHAR_DATA * ch, char *argument)
                 if (hasname(ch->pcdata->clan->roster, ch->name))
                         removename(&ch->pcdata->clan->roster, ch->name);
         ch->pcdata->clan = NULL;
+        channel_listeners_changed();
         act(AT_MAGIC, "You resign your position in $t", ch, clan->name, NULL,
             TO_CHAR);
         snprintf(buf, MSL, "%s has quit %s!", ch->name, clan->name);
@@ -4203,6 +4212,7 @@ void free_clan(CLAN_DATA * clan)
                         STRFREE(ch->mob_clan);
                 }
         }
+        channel_listeners_changed();
 
         for (bounty = first_disintigration; bounty; bounty = next_bounty)
         {
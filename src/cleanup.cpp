@@ -138,6 +138,10 @@ void free_characters(void)
         {
                 char_from_room(supermob);
                 UNLINK(supermob, first_char, last_char, next, prev);
+                name_index_remove(supermob);
+                UNLINK(supermob, supermob->pIndexData->first_instance,
+                       supermob->pIndexData->last_instance, next_instance,
+                       prev_instance);
                 free_char(supermob);
         }
 
@@ -98,6 +98,11 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <sys/time.h>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "mud.hpp"
 #include "mxp.hpp"
 #include "cpp_compat.hpp"
@@ -906,241 +911,492 @@ const char *color_str(sh_int AType, CHAR_DATA * ch)
         }
 }
 
+/*
+ * Table driven color and MXP rendering.
+ *
+ * Every byte of outgoing text is classified through render_action[], one
+ * 256 entry table per client profile (ANSI on/off, MXP on/off).  Runs of
+ * plain bytes are found with a SIMD scan where available and copied as a
+ * block; color codes come from color_table[] and MXP markup is converted
+ * in the same pass.  The result is collected in a small buffer and handed
+ * to the descriptor in a few large appends instead of one per fragment.
+ */
+#ifdef OVERLANDCODE
+#define BACK_LEAD	'{'
+#define BACK_LEAD_STR	"{"
+#else
+#define BACK_LEAD	'^'
+#define BACK_LEAD_STR	"^"
+#endif
+
+#define RENDER_ANSI	BV00
+#define RENDER_MXP	BV01
+#define RENDER_PROFILES	4
+
+#define RENDER_CHUNK	4096
+
+enum
+{
+        RA_COPY, RA_COLOR, RA_MXP_BEG, RA_MXP_END, RA_MXP_AMP, RA_ESCAPE
+};
+
+enum
+{
+        LEAD_FORE, LEAD_BLINK, LEAD_BACK, MAX_LEAD
+};
+
+static unsigned char render_action[RENDER_PROFILES][256];
+static const char *color_table[MAX_LEAD][256];
+static const char *mxp_escape[256];
+static bool render_ready = FALSE;
+
+/* Marks &D, which depends on the current pager color */
+static const char color_page_default[] = "";
+
+static void init_render_tables(void)
+{
+        static const struct
+        {
+                char      code;
+                const char *fore;
+                const char *blink;
+                const char *back;
+        } colors[] =
+        {
+                {'x', ANSI_BLACK, BLINK_BLACK, BACK_BLACK},
+                {'r', ANSI_DRED, BLINK_DRED, BACK_DRED},
+                {'g', ANSI_DGREEN, BLINK_DGREEN, BACK_DGREEN},
+                {'O', ANSI_ORANGE, BLINK_ORANGE, BACK_ORANGE},
+                {'b', ANSI_DBLUE, BLINK_DBLUE, BACK_DBLUE},
+                {'p', ANSI_PURPLE, BLINK_PURPLE, BACK_PURPLE},
+                {'c', ANSI_CYAN, BLINK_CYAN, BACK_CYAN},
+                {'w', ANSI_GREY, BLINK_GREY, BACK_GREY},
+                {'z', ANSI_DGREY, BLINK_DGREY, NULL},
+                {'R', ANSI_RED, BLINK_RED, NULL},
+                {'G', ANSI_GREEN, BLINK_GREEN, NULL},
+                {'Y', ANSI_YELLOW, BLINK_YELLOW, NULL},
+                {'B', ANSI_BLUE, BLINK_BLUE, NULL},
+                {'P', ANSI_PINK, BLINK_PINK, NULL},
+                {'C', ANSI_LBLUE, BLINK_LBLUE, NULL},
+                {'W', ANSI_WHITE, BLINK_WHITE, NULL}
+        };
+        size_t    i;
+        int       profile;
+
+        for (i = 0; i < sizeof(colors) / sizeof(colors[0]); i++)
+        {
+                unsigned char c = static_cast<unsigned char>(colors[i].code);
+
+                color_table[LEAD_FORE][c] = colors[i].fore;
+                color_table[LEAD_BLINK][c] = colors[i].blink;
+                color_table[LEAD_BACK][c] = colors[i].back;
+        }
+        color_table[LEAD_FORE][static_cast<unsigned char>('i')] = ANSI_ITALIC;
+        color_table[LEAD_FORE][static_cast<unsigned char>('I')] = ANSI_ITALIC;
+        color_table[LEAD_FORE][static_cast<unsigned char>('v')] = ANSI_REVERSE;
+        color_table[LEAD_FORE][static_cast<unsigned char>('V')] = ANSI_REVERSE;
+        color_table[LEAD_FORE][static_cast<unsigned char>('u')] = ANSI_UNDERLINE;
+        color_table[LEAD_FORE][static_cast<unsigned char>('U')] = ANSI_UNDERLINE;
+        color_table[LEAD_FORE][static_cast<unsigned char>('s')] = ANSI_STRIKEOUT;
+        color_table[LEAD_FORE][static_cast<unsigned char>('S')] = ANSI_STRIKEOUT;
+        color_table[LEAD_FORE][static_cast<unsigned char>('d')] = ANSI_RESET;
+        color_table[LEAD_FORE][static_cast<unsigned char>('D')] =
+                color_page_default;
+
+        mxp_escape[static_cast<unsigned char>('<')] = "&lt;";
+        mxp_escape[static_cast<unsigned char>('>')] = "&gt;";
+        mxp_escape[static_cast<unsigned char>('&')] = "&amp;";
+        mxp_escape[static_cast<unsigned char>('"')] = "&quot;";
+
+        for (profile = 0; profile < RENDER_PROFILES; profile++)
+        {
+                unsigned char *act = render_action[profile];
+
+                if (IS_SET(profile, RENDER_MXP))
+                {
+                        act[static_cast<unsigned char>('<')] = RA_ESCAPE;
+                        act[static_cast<unsigned char>('>')] = RA_ESCAPE;
+                        act[static_cast<unsigned char>('"')] = RA_ESCAPE;
+                }
+                act[static_cast<unsigned char>(MXP_BEGc)] = RA_MXP_BEG;
+                act[static_cast<unsigned char>(MXP_ENDc)] = RA_MXP_END;
+                act[static_cast<unsigned char>(MXP_AMPc)] = RA_MXP_AMP;
+                act[static_cast<unsigned char>('&')] = RA_COLOR;
+                act[static_cast<unsigned char>('}')] = RA_COLOR;
+                act[static_cast<unsigned char>(BACK_LEAD)] = RA_COLOR;
+        }
+        render_ready = TRUE;
+}
+
+static inline int color_lead(char c)
+{
+        return c == '&' ? LEAD_FORE : c == '}' ? LEAD_BLINK : LEAD_BACK;
+}
+
+/*
+ * Whether color codes turn into ANSI for this character.  A character
+ * with no gold (or none at all) gets ANSI, as it always has.
+ */
+static bool render_ansi(CHAR_DATA * ch)
+{
+        if (!ch || ch->gold == 0)
+                return TRUE;
+        return (!IS_NPC(ch) && IS_SET(ch->act, PLR_ANSI));
+}
+
 int colorcode(const char *col, char *code, CHAR_DATA * ch)
 {
         const char *ctype = col;
+        const char *ansi_code;
         int       ln;
-        bool      ansi;
-
 
-        if (!ch || ch->gold == 0)
-                ansi = TRUE;
-        else
-                ansi = (!IS_NPC(ch) && IS_SET(ch->act, PLR_ANSI));
+        if (!render_ready)
+                init_render_tables();
 
         col++;
 
         if (!*col)
                 ln = -1;
-#ifdef OVERLANDCODE
-        else if (*ctype != '&' && *ctype != '{' && *ctype != '}')
-        {
-                bug("colorcode: command '%c' not '&', '{' or '}'", *ctype);
-                ln = -1;
-        }
-#else
-        else if (*ctype != '&' && *ctype != '^' && *ctype != '}')
+        else if (*ctype != '&' && *ctype != BACK_LEAD && *ctype != '}')
         {
-                bug("colorcode: command '%c' not '&', '^' or '}'", *ctype);
+                bug("colorcode: command '%c' not '&', '%c' or '}'", *ctype,
+                    BACK_LEAD);
                 ln = -1;
         }
-#endif
         else if (*col == *ctype)
         {
                 code[0] = *col;
                 code[1] = '\0';
                 ln = 1;
         }
-        else if (!ansi)
+        else if (!render_ansi(ch))
                 ln = 0;
+        else if (!(ansi_code =
+                   color_table[color_lead(*ctype)][static_cast<unsigned char>(*col)]))
+        {
+                code[0] = *ctype;
+                code[1] = *col;
+                code[2] = '\0';
+                return 2;
+        }
         else
         {
-                /*
-                 * Foreground text - non-blinking 
-                 */
-                if (*ctype == '&')
+                if (ansi_code == color_page_default)
                 {
-                        switch (*col)
-                        {
-                        default:
-                                code[0] = *ctype;
-                                code[1] = *col;
-                                code[2] = '\0';
-                                return 2;
-                        case 'i':  /* Italic text */
-                        case 'I':
-                                mudstrlcpy(code, ANSI_ITALIC, 20);
-                                break;
-                        case 'v':  /* Reverse colors */
-                        case 'V':
-                                mudstrlcpy(code, ANSI_REVERSE, 20);
-                                break;
-                        case 'u':  /* Underline */
-                        case 'U':
-                                mudstrlcpy(code, ANSI_UNDERLINE, 20);
-                                break;
-                        case 's':  /* Strikeover */
-                        case 'S':
-                                mudstrlcpy(code, ANSI_STRIKEOUT, 20);
-                                break;
-                        case 'd':  /* Player's client default color */
-                                mudstrlcpy(code, ANSI_RESET, 20);
-                                break;
-                        case 'D':  /* Reset to custom color for whatever is being displayed */
-                                mudstrlcpy(code, ANSI_RESET, 20);   /* Yes, this reset here is quite necessary to cancel out other things */
+                        /*
+                         * The reset cancels out other attributes first 
+                         */
+                        mudstrlcpy(code, ANSI_RESET, 20);
+                        if (ch && ch->desc)
                                 mudstrlcat(code,
                                            color_str(ch->desc->pagecolor, ch),
                                            20);
-                                break;
-                        case 'x':  /* Black */
-                                mudstrlcpy(code, ANSI_BLACK, 20);
-                                break;
-                        case 'O':  /* Orange/Brown */
-                                mudstrlcpy(code, ANSI_ORANGE, 20);
-                                break;
-                        case 'c':  /* Cyan */
-                                mudstrlcpy(code, ANSI_CYAN, 20);
-                                break;
-                        case 'z':  /* Dark Grey */
-                                mudstrlcpy(code, ANSI_DGREY, 20);
-                                break;
-                        case 'g':  /* Dark Green */
-                                mudstrlcpy(code, ANSI_DGREEN, 20);
-                                break;
-                        case 'G':  /* Light Green */
-                                mudstrlcpy(code, ANSI_GREEN, 20);
-                                break;
-                        case 'P':  /* Pink/Light Purple */
-                                mudstrlcpy(code, ANSI_PINK, 20);
-                                break;
-                        case 'r':  /* Dark Red */
-                                mudstrlcpy(code, ANSI_DRED, 20);
-                                break;
-                        case 'b':  /* Dark Blue */
-                                mudstrlcpy(code, ANSI_DBLUE, 20);
-                                break;
-                        case 'w':  /* Grey */
-                                mudstrlcpy(code, ANSI_GREY, 20);
-                                break;
-                        case 'Y':  /* Yellow */
-                                mudstrlcpy(code, ANSI_YELLOW, 20);
-                                break;
-                        case 'C':  /* Light Blue */
-                                mudstrlcpy(code, ANSI_LBLUE, 20);
-                                break;
-                        case 'p':  /* Purple */
-                                mudstrlcpy(code, ANSI_PURPLE, 20);
-                                break;
-                        case 'R':  /* Red */
-                                mudstrlcpy(code, ANSI_RED, 20);
-                                break;
-                        case 'B':  /* Blue */
-                                mudstrlcpy(code, ANSI_BLUE, 20);
-                                break;
-                        case 'W':  /* White */
-                                mudstrlcpy(code, ANSI_WHITE, 20);
-                                break;
-                        }
                 }
-                /*
-                 * Foreground text - blinking 
-                 */
-                if (*ctype == '}')
+                else
+                        mudstrlcpy(code, ansi_code, 20);
+                ln = static_cast<int>(strlen(code));
+        }
+        if (ln <= 0)
+                *code = '\0';
+        return ln;
+}
+
+/*
+ * Output collector for render_text().  Output goes to str if set, else to
+ * the descriptor.  With neither it is only counted, which is what
+ * colorbench uses.
+ */
+struct render_out
+{
+        DESCRIPTOR_DATA *d;
+        std::string *str;
+        bool      pager;
+        bool      failed;
+        int       len;
+        long      total;
+        char      buf[RENDER_CHUNK];
+};
+
+static void render_flush(render_out * out)
+{
+        if (out->len == 0 || out->failed)
+                return;
+        out->total += out->len;
+        if (out->str)
+                out->str->append(out->buf, static_cast<size_t>(out->len));
+        else if (out->d)
+        {
+                if (out->pager)
+                        out->failed = !write_to_pager_raw(out->d, out->buf,
+                                                          out->len);
+                else
+                        out->failed = !write_to_buffer_raw(out->d, out->buf,
+                                                           out->len);
+        }
+        out->len = 0;
+}
+
+static inline void render_emit(render_out * out, const char *txt, int len)
+{
+        while (len > 0 && !out->failed)
+        {
+                int       room = RENDER_CHUNK - out->len;
+                int       n = len < room ? len : room;
+
+                memcpy(out->buf + out->len, txt, static_cast<size_t>(n));
+                out->len += n;
+                txt += n;
+                len -= n;
+                if (out->len == RENDER_CHUNK)
+                        render_flush(out);
+        }
+}
+
+static inline void render_emit_char(render_out * out, char c)
+{
+        if (out->len == RENDER_CHUNK)
+                render_flush(out);
+        out->buf[out->len++] = c;
+}
+
+/*
+ * A character that came out of a color code as text, escaped for MXP.
+ */
+static inline void render_emit_literal(render_out * out, char c, bool escape)
+{
+        const char *entity = mxp_escape[static_cast<unsigned char>(c)];
+
+        if (escape && entity)
+                render_emit(out, entity, static_cast<int>(strlen(entity)));
+        else
+                render_emit_char(out, c);
+}
+
+/*
+ * Length of the leading run of txt that needs no translation.
+ */
+static inline int render_plain_run(const unsigned char *act,
+                                   const char *txt, int len, bool mxp)
+{
+        int       i = 0;
+
+#ifdef __SSE2__
+        const __m128i amp = _mm_set1_epi8('&');
+        const __m128i blink = _mm_set1_epi8('}');
+        const __m128i back = _mm_set1_epi8(BACK_LEAD);
+        const __m128i beg = _mm_set1_epi8(MXP_BEGc);
+        const __m128i end = _mm_set1_epi8(MXP_ENDc);
+        const __m128i ent = _mm_set1_epi8(MXP_AMPc);
+        const __m128i lt = _mm_set1_epi8('<');
+        const __m128i gt = _mm_set1_epi8('>');
+        const __m128i quot = _mm_set1_epi8('"');
+
+        for (; i + 16 <= len; i += 16)
+        {
+                __m128i   v =
+                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(txt + i));
+                __m128i   hit;
+                int       mask;
+
+                hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, amp),
+                                                _mm_cmpeq_epi8(v, blink)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(v, back),
+                                                _mm_cmpeq_epi8(v, beg)));
+                hit = _mm_or_si128(hit,
+                                   _mm_or_si128(_mm_cmpeq_epi8(v, end),
+                                                _mm_cmpeq_epi8(v, ent)));
+                if (mxp)
+                        hit = _mm_or_si128(hit,
+                                           _mm_or_si128(_mm_cmpeq_epi8(v, lt),
+                                                        _mm_or_si128(_mm_cmpeq_epi8(v, gt),
+                                                                     _mm_cmpeq_epi8(v, quot))));
+                mask = _mm_movemask_epi8(hit);
+                if (mask)
+                        return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+#else
+        (void) mxp;
+#endif
+        while (i < len && act[static_cast<unsigned char>(txt[i])] == RA_COPY)
+                i++;
+        return i;
+}
+
+/*
+ * Translate color codes and MXP markup in one pass.
+ */
+static void render_text(render_out * out, const char *txt, int len,
+                        int profile, CHAR_DATA * ch)
+{
+        const unsigned char *act;
+        bool      mxp = IS_SET(profile, RENDER_MXP);
+        bool      ansi = IS_SET(profile, RENDER_ANSI);
+        bool      in_tag = FALSE;
+        bool      in_entity = FALSE;
+        const char *code;
+        int       i = 0;
+
+        if (!render_ready)
+                init_render_tables();
+        act = render_action[profile];
+
+        while (i < len && !out->failed)
+        {
+                int       run;
+                char      c;
+
+                if (!in_tag && !in_entity)
                 {
-                        switch (*col)
+                        run = render_plain_run(act, txt + i, len - i, mxp);
+                        if (run > 0)
                         {
-                        default:
-                                code[0] = *ctype;
-                                code[1] = *col;
-                                code[2] = '\0';
-                                return 2;
-                        case 'x':  /* Black */
-                                mudstrlcpy(code, BLINK_BLACK, 20);
-                                break;
-                        case 'O':  /* Orange/Brown */
-                                mudstrlcpy(code, BLINK_ORANGE, 20);
-                                break;
-                        case 'c':  /* Cyan */
-                                mudstrlcpy(code, BLINK_CYAN, 20);
-                                break;
-                        case 'z':  /* Dark Grey */
-                                mudstrlcpy(code, BLINK_DGREY, 20);
-                                break;
-                        case 'g':  /* Dark Green */
-                                mudstrlcpy(code, BLINK_DGREEN, 20);
-                                break;
-                        case 'G':  /* Light Green */
-                                mudstrlcpy(code, BLINK_GREEN, 20);
-                                break;
-                        case 'P':  /* Pink/Light Purple */
-                                mudstrlcpy(code, BLINK_PINK, 20);
-                                break;
-                        case 'r':  /* Dark Red */
-                                mudstrlcpy(code, BLINK_DRED, 20);
-                                break;
-                        case 'b':  /* Dark Blue */
-                                mudstrlcpy(code, BLINK_DBLUE, 20);
-                                break;
-                        case 'w':  /* Grey */
-                                mudstrlcpy(code, BLINK_GREY, 20);
-                                break;
-                        case 'Y':  /* Yellow */
-                                mudstrlcpy(code, BLINK_YELLOW, 20);
-                                break;
-                        case 'C':  /* Light Blue */
-                                mudstrlcpy(code, BLINK_LBLUE, 20);
-                                break;
-                        case 'p':  /* Purple */
-                                mudstrlcpy(code, BLINK_PURPLE, 20);
-                                break;
-                        case 'R':  /* Red */
-                                mudstrlcpy(code, BLINK_RED, 20);
-                                break;
-                        case 'B':  /* Blue */
-                                mudstrlcpy(code, BLINK_BLUE, 20);
-                                break;
-                        case 'W':  /* White */
-                                mudstrlcpy(code, BLINK_WHITE, 20);
+                                render_emit(out, txt + i, run);
+                                i += run;
+                                if (i >= len)
+                                        break;
+                        }
+                }
+
+                c = txt[i];
+                if (act[static_cast<unsigned char>(c)] == RA_COLOR)
+                {
+                        char      next = i + 1 < len ? txt[i + 1] : '\0';
+
+                        /*
+                         * A lead at the very end is dropped along with the
+                         * rest of the string, as colorcode() always did. 
+                         */
+                        if (!next)
                                 break;
+                        i += 2;
+                        if (next == c)
+                        {
+                                render_emit_literal(out, c, mxp && !in_tag
+                                                    && !in_entity);
+                                continue;
+                        }
+                        if (!ansi)
+                                continue;
+                        code = color_table[color_lead(c)][static_cast<unsigned char>(next)];
+                        if (!code)
+                        {
+                                /*
+                                 * Unknown code, passed through as text 
+                                 */
+                                render_emit_literal(out, c, mxp && !in_tag
+                                                    && !in_entity);
+                                render_emit_literal(out, next, mxp && !in_tag
+                                                    && !in_entity);
+                                continue;
                         }
+                        if (code == color_page_default)
+                        {
+                                render_emit(out, ANSI_RESET,
+                                            static_cast<int>(sizeof(ANSI_RESET) - 1));
+                                if (ch && ch->desc)
+                                        code = color_str(ch->desc->pagecolor, ch);
+                                else
+                                        continue;
+                        }
+                        render_emit(out, code, static_cast<int>(strlen(code)));
+                        continue;
                 }
-                /*
-                 * Background color 
-                 */
-#ifdef OVERLANDCODE
-                if (*ctype == '{')
-#else
-                if (*ctype == '^')
-#endif
+
+                i++;
+                if (in_tag)
                 {
-                        switch (*col)
+                        if (c == MXP_ENDc)
                         {
-                        default:
-                                code[0] = *ctype;
-                                code[1] = *col;
-                                code[2] = '\0';
-                                return 2;
-                        case 'x':  /* Black */
-                                mudstrlcpy(code, BACK_BLACK, 20);
-                                break;
-                        case 'r':  /* Dark Red */
-                                mudstrlcpy(code, BACK_DRED, 20);
-                                break;
-                        case 'g':  /* Dark Green */
-                                mudstrlcpy(code, BACK_DGREEN, 20);
-                                break;
-                        case 'O':  /* Orange/Brown */
-                                mudstrlcpy(code, BACK_ORANGE, 20);
-                                break;
-                        case 'b':  /* Dark Blue */
-                                mudstrlcpy(code, BACK_DBLUE, 20);
-                                break;
-                        case 'p':  /* Purple */
-                                mudstrlcpy(code, BACK_PURPLE, 20);
-                                break;
-                        case 'c':  /* Cyan */
-                                mudstrlcpy(code, BACK_CYAN, 20);
-                                break;
-                        case 'w':  /* Grey */
-                                mudstrlcpy(code, BACK_GREY, 20);
-                                break;
+                                in_tag = FALSE;
+                                if (mxp)
+                                        render_emit_char(out, '>');
                         }
+                        else if (mxp)
+                                render_emit_char(out, c);
+                        continue;
+                }
+                if (in_entity)
+                {
+                        if (mxp)
+                                render_emit_char(out, c);
+                        if (c == ';')
+                                in_entity = FALSE;
+                        continue;
+                }
+                switch (act[static_cast<unsigned char>(c)])
+                {
+                case RA_MXP_BEG:
+                        in_tag = TRUE;
+                        if (mxp)
+                                render_emit_char(out, '<');
+                        break;
+                case RA_MXP_END:
+                        if (mxp)
+                                render_emit_char(out, '>');
+                        break;
+                case RA_MXP_AMP:
+                        in_entity = TRUE;
+                        if (mxp)
+                                render_emit_char(out, '&');
+                        break;
+                case RA_ESCAPE:
+                        code = mxp_escape[static_cast<unsigned char>(c)];
+                        render_emit(out, code, static_cast<int>(strlen(code)));
+                        break;
+                default:
+                        render_emit_char(out, c);
+                        break;
                 }
-                ln = static_cast<int>(strlen(code));
         }
-        if (ln <= 0)
-                *code = '\0';
-        return ln;
+        render_flush(out);
+}
+
+/*
+ * The profile text for d is rendered with.  Anything that caches rendered
+ * text, like compiled prompts, is only good for the profile it was made
+ * for.
+ */
+int render_profile(DESCRIPTOR_DATA * d, CHAR_DATA * ch)
+{
+        int       profile = 0;
+
+        if (render_ansi(ch))
+                SET_BIT(profile, RENDER_ANSI);
+        if (d && d->mxp_detected)
+                SET_BIT(profile, RENDER_MXP);
+        return profile;
+}
+
+static void render_to_desc(DESCRIPTOR_DATA * d, const char *txt,
+                           CHAR_DATA * ch, bool pager)
+{
+        render_out out;
+
+        out.d = d;
+        out.str = NULL;
+        out.pager = pager;
+        out.failed = FALSE;
+        out.len = 0;
+        out.total = 0;
+        render_text(&out, txt, static_cast<int>(strlen(txt)),
+                    render_profile(d, ch), ch);
+}
+
+/*
+ * Render txt for profile and append it to dst.
+ */
+void render_to_string(std::string & dst, const char *txt, int len,
+                      int profile, CHAR_DATA * ch)
+{
+        render_out out;
+
+        out.d = NULL;
+        out.str = &dst;
+        out.pager = FALSE;
+        out.failed = FALSE;
+        out.len = 0;
+        out.total = 0;
+        render_text(&out, txt, len, profile, ch);
 }
 
 /* Moved from comm.c */
@@ -1162,25 +1418,12 @@ void set_pager_color(sh_int AType, CHAR_DATA * ch)
         ch->desc->pagecolor = static_cast<char>(ch->colors[AType]);
 }
 
-void write_to_pager(DESCRIPTOR_DATA * d, const char *txt, int length)
+/*
+ * Make room for length more bytes in the pager buffer.
+ */
+static bool reserve_pagebuf(DESCRIPTOR_DATA * d, int length)
 {
         int       pageroffset;  /* Pager fix by thoric */
-        int       origlength = 0;
-
-        if (length <= 0)
-                length = static_cast<int>(strlen(txt));
-
-        /*
-         * Find length in case caller didn't. 
-         */
-        if (length == 0)
-                return;
-
-        origlength = length;
-        /*
-         * How much space do we need to expand stuff 
-         */
-        length += count_mxp_tags(d, txt, length);
 
         if (!d->pagebuf)
         {
@@ -1209,7 +1452,7 @@ void write_to_pager(DESCRIPTOR_DATA * d, const char *txt, int length)
                         d->pagepoint = NULL;
                         DISPOSE(d->pagebuf);
                         d->pagesize = MSL;
-                        return;
+                        return FALSE;
                 }
                 d->pagesize *= 2;
                 _Pragma("GCC diagnostic push")
@@ -1218,6 +1461,30 @@ void write_to_pager(DESCRIPTOR_DATA * d, const char *txt, int length)
                 _Pragma("GCC diagnostic pop")
         }
         d->pagepoint = d->pagebuf + pageroffset;    /* pager fix (goofup fixed 08/21/97) */
+        return TRUE;
+}
+
+void write_to_pager(DESCRIPTOR_DATA * d, const char *txt, int length)
+{
+        int       origlength = 0;
+
+        if (length <= 0)
+                length = static_cast<int>(strlen(txt));
+
+        /*
+         * Find length in case caller didn't. 
+         */
+        if (length == 0)
+                return;
+
+        origlength = length;
+        /*
+         * How much space do we need to expand stuff 
+         */
+        length += count_mxp_tags(d, txt, length);
+
+        if (!reserve_pagebuf(d, length))
+                return;
 /*   mudstrlcpy( d->pagebuf + d->pagetop, txt, length ); */
         convert_mxp_tags(d, d->pagebuf + d->pagetop, txt, origlength);
         d->pagetop += length;
@@ -1225,14 +1492,24 @@ void write_to_pager(DESCRIPTOR_DATA * d, const char *txt, int length)
         return;
 }
 
+/*
+ * Append text that is already rendered for this descriptor.
+ */
+bool write_to_pager_raw(DESCRIPTOR_DATA * d, const char *txt, int length)
+{
+        if (length <= 0)
+                return TRUE;
+        if (!reserve_pagebuf(d, length))
+                return FALSE;
+        memcpy(d->pagebuf + d->pagetop, txt, static_cast<size_t>(length));
+        d->pagetop += length;
+        d->pagebuf[d->pagetop] = '\0';
+        return TRUE;
+}
+
 /* Writes to a descriptor, usually best used when there's no character to send to ( like logins ) */
 void send_to_desc_color(const char *txt, DESCRIPTOR_DATA * d)
 {
-        char     *colstr;
-        const char *prevstr = txt;
-        char      colbuf[20];
-        int       ln;
-
         if (!d)
         {
                 bug("%s", "send_to_desc_color: NULL *d");
@@ -1242,25 +1519,7 @@ void send_to_desc_color(const char *txt, DESCRIPTOR_DATA * d)
         if (!txt || !d->descriptor)
                 return;
 
-        while ((colstr = strpbrk(STRING_LITERAL(prevstr), "&^}")) != NULL)
-        {
-                if (colstr > prevstr)
-                        write_to_buffer(d, prevstr, static_cast<int>(colstr - prevstr));
-
-                ln = colorcode(colstr, colbuf, d->character);
-                if (ln < 0)
-                {
-                        prevstr = colstr + 1;
-                        break;
-                }
-
-                else if (ln > 0)
-                        write_to_buffer(d, colbuf, ln);
-                prevstr = colstr + 2;
-        }
-        if (*prevstr)
-                write_to_buffer(d, prevstr, 0);
-
+        render_to_desc(d, txt, d->character, FALSE);
         return;
 }
 
@@ -1269,11 +1528,6 @@ void send_to_desc_color(const char *txt, DESCRIPTOR_DATA * d)
  */
 void send_to_char_color(const char *txt, CHAR_DATA * ch)
 {
-        char     *colstr;
-        const char *prevstr = txt;
-        char      colbuf[20];
-        int       ln;
-
         if (!ch)
         {
                 bug("%s", "send_to_char_color: NULL ch!");
@@ -1281,41 +1535,12 @@ void send_to_char_color(const char *txt, CHAR_DATA * ch)
         }
 
         if (txt && ch->desc)
-        {
-#ifdef OVERLANDCODE
-                while ((colstr = strpbrk(STRING_LITERAL(prevstr), "&{}")) != NULL)
-#else
-                while ((colstr = strpbrk(STRING_LITERAL(prevstr), "&^}")) != NULL)
-#endif
-                {
-                        if (colstr > prevstr)
-                                write_to_buffer(ch->desc, prevstr,
-                                                static_cast<int>(colstr - prevstr));
-                        if (!ch->desc)
-                                return;
-                        ln = colorcode(colstr, colbuf, ch);
-                        if (ln < 0)
-                        {
-                                prevstr = colstr + 1;
-                                break;
-                        }
-                        else if (ln > 0)
-                                write_to_buffer(ch->desc, colbuf, ln);
-                        prevstr = colstr + 2;
-                }
-                if (*prevstr)
-                        write_to_buffer(ch->desc, prevstr, 0);
-        }
+                render_to_desc(ch->desc, txt, ch, FALSE);
         return;
 }
 
 void send_to_pager_color(const char *txt, CHAR_DATA * ch)
 {
-        char     *colstr;
-        const char *prevstr = txt;
-        char      colbuf[20];
-        int       ln;
-
         if (IS_NPC(ch)) /* NPCs can't do pager */
                 send_to_char_color(txt, ch);
 
@@ -1335,27 +1560,7 @@ void send_to_pager_color(const char *txt, CHAR_DATA * ch)
                         send_to_char_color(txt, d->character);
                         return;
                 }
-#ifdef OVERLANDCODE
-                while ((colstr = strpbrk(STRING_LITERAL(prevstr), "&{}")) != NULL)
-#else
-                while ((colstr = strpbrk(STRING_LITERAL(prevstr), "&^}")) != NULL)
-#endif
-                {
-                        if (colstr > prevstr)
-                                write_to_pager(ch->desc, prevstr,
-                                               static_cast<int>(colstr - prevstr));
-                        ln = colorcode(colstr, colbuf, ch);
-                        if (ln < 0)
-                        {
-                                prevstr = colstr + 1;
-                                break;
-                        }
-                        else if (ln > 0)
-                                write_to_pager(ch->desc, colbuf, ln);
-                        prevstr = colstr + 2;
-                }
-                if (*prevstr)
-                        write_to_pager(ch->desc, prevstr, 0);
+                render_to_desc(d, txt, ch, TRUE);
         }
         return;
 }
@@ -1398,3 +1603,170 @@ void pager_printf(CHAR_DATA * ch, char *fmt, ...)
 
         send_to_pager_color(buf, ch);
 }
+
+/*
+ * The old fragment at a time path: strpbrk() for each code, then a
+ * count_mxp_tags()/convert_mxp_tags() pair per fragment, as each
+ * write_to_buffer() did.  Only kept so colorbench has a baseline.
+ */
+static long legacy_fragment(DESCRIPTOR_DATA * d, const char *txt, int length,
+                            std::vector<char> &scratch)
+{
+        int       total = length + count_mxp_tags(d, txt, length);
+
+        convert_mxp_tags(d, &scratch[0], txt, length);
+        return total;
+}
+
+static long legacy_render(DESCRIPTOR_DATA * d, const char *txt,
+                          std::vector<char> &scratch)
+{
+        const char *prevstr = txt;
+        const char *colstr;
+        char      colbuf[20];
+        long      total = 0;
+        int       ln;
+
+        while ((colstr = strpbrk(prevstr, "&}" BACK_LEAD_STR)) != NULL)
+        {
+                if (colstr > prevstr)
+                        total += legacy_fragment(d, prevstr,
+                                                 static_cast<int>(colstr - prevstr),
+                                                 scratch);
+                ln = colorcode(colstr, colbuf, NULL);
+                if (ln < 0)
+                {
+                        prevstr = colstr + 1;
+                        break;
+                }
+                else if (ln > 0)
+                        total += legacy_fragment(d, colbuf, ln, scratch);
+                prevstr = colstr + 2;
+        }
+        if (*prevstr)
+                total += legacy_fragment(d, prevstr,
+                                         static_cast<int>(strlen(prevstr)),
+                                         scratch);
+        return total;
+}
+
+static long bench_usec(struct timeval *start)
+{
+        struct timeval now;
+
+        gettimeofday(&now, NULL);
+        return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_usec -
+                                                         start->tv_usec);
+}
+
+/*
+ * Time the renderer against the old path over the help files and room
+ * descriptions actually loaded.
+ */
+CMDF do_colorbench(CHAR_DATA * ch, char *argument)
+{
+        std::vector<const char *> texts;
+        std::vector<char> scratch;
+        DESCRIPTOR_DATA *fake;
+        HELP_DATA *help;
+        ROOM_INDEX_DATA *room;
+        struct timeval start;
+        render_out *out;
+        long      bytes = 0;
+        int       plain = 0;
+        int       passes = 1;
+        static const int bench_profiles[2] =
+                { RENDER_ANSI, RENDER_ANSI | RENDER_MXP };
+        int       p, pass;
+        size_t    i, longest = 0;
+
+        if (argument[0] != '\0')
+        {
+                if (!is_number(argument) || (passes = atoi(argument)) < 1
+                    || passes > 100)
+                {
+                        send_to_char("Syntax: colorbench [passes 1-100]\n\r",
+                                     ch);
+                        return;
+                }
+        }
+
+        for (help = first_help; help; help = help->next)
+                if (help->text && help->text[0] != '\0')
+                        texts.push_back(help->text);
+        for (room = room_index_table.first(); room;
+             room = room_index_table.next(room->vnum))
+                if (room->description && room->description[0] != '\0')
+                        texts.push_back(room->description);
+        if (texts.empty())
+        {
+                send_to_char("Nothing to render.\n\r", ch);
+                return;
+        }
+
+        if (!render_ready)
+                init_render_tables();
+        for (i = 0; i < texts.size(); i++)
+        {
+                size_t    len = strlen(texts[i]);
+                const unsigned char *act = render_action[RENDER_MXP];
+
+                bytes += static_cast<long>(len);
+                longest = UMAX(longest, len);
+                if (render_plain_run(act, texts[i], static_cast<int>(len),
+                                     TRUE) == static_cast<int>(len))
+                        plain++;
+        }
+        scratch.resize(longest * 6 + 64);
+
+        CREATE(fake, DESCRIPTOR_DATA, 1);
+        out = new render_out;
+        out->d = NULL;
+        out->str = NULL;
+        out->pager = FALSE;
+
+        ch_printf(ch, "%d texts, %ld bytes, %d without markup, %d pass%s.\n\r",
+                  static_cast<int>(texts.size()), bytes, plain, passes,
+                  passes == 1 ? "" : "es");
+        ch_printf(ch, "%-10s %12s %12s %8s\n\r", "Profile", "Old usec",
+                  "New usec", "Speedup");
+        /*
+         * The old path can only turn ANSI off for a real player, so only
+         * the ANSI profiles are compared. 
+         */
+        for (p = 0; p < 2; p++)
+        {
+                int       profile = bench_profiles[p];
+                long      old_usec, new_usec, old_out = 0, new_out = 0;
+
+                fake->mxp_detected = IS_SET(profile, RENDER_MXP);
+
+                gettimeofday(&start, NULL);
+                for (pass = 0; pass < passes; pass++)
+                        for (i = 0; i < texts.size(); i++)
+                                old_out += legacy_render(fake, texts[i], scratch);
+                old_usec = bench_usec(&start);
+
+                gettimeofday(&start, NULL);
+                for (pass = 0; pass < passes; pass++)
+                        for (i = 0; i < texts.size(); i++)
+                        {
+                                out->failed = FALSE;
+                                out->len = 0;
+                                out->total = 0;
+                                render_text(out, texts[i],
+                                            static_cast<int>(strlen(texts[i])),
+                                            profile, NULL);
+                                new_out += out->total;
+                        }
+                new_usec = bench_usec(&start);
+
+                ch_printf(ch, "%-10s %12ld %12ld %7.2fx%s\n\r",
+                          IS_SET(profile, RENDER_MXP) ? "ansi+mxp" : "ansi",
+                          old_usec, new_usec,
+                          new_usec > 0 ? static_cast<double>(old_usec) / static_cast<double>(new_usec) : 0.0,
+                          old_out != new_out ? "  (output differs)" : "");
+        }
+        delete    out;
+        DISPOSE(fake);
+}
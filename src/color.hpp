@@ -78,6 +78,9 @@ void set_pager_color( sh_int AType, CHAR_DATA *ch );*/
 const char *color_str(sh_int AType, CHAR_DATA * ch);
 const char *const_color_align(const char *argument, int size, int align);
 void send_to_desc_color args((const char *txt, DESCRIPTOR_DATA * d));
+int       render_profile(DESCRIPTOR_DATA * d, CHAR_DATA * ch);
+void      render_to_string(std::string & dst, const char *txt, int len,
+                           int profile, CHAR_DATA * ch);
 
 
 /*
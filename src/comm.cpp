@@ -81,7 +81,6 @@
 #define TELCMDS
 
 // Communication constants
-#define GMCP_BUFFER_SIZE    1024
 #define HOSTNAME_SIZE       64
 #define SOCKET_LINGER_TIME  1000
 #define DEFAULT_PORT        4000
@@ -101,6 +100,11 @@
 #include "races.hpp"
 #include "greet.hpp"
 #include "password.hpp"
+#include "logging.hpp"
+#include "persist.hpp"
+#include "search.hpp"
+#include "prompt.hpp"
+#include "telemetry.hpp"
 
 // Forward declarations
 bool should_upgrade_hash(const char *hash);
@@ -117,27 +121,19 @@ const char* position_name(int position);
 // GMCP (Generic MUD Communication Protocol) Support
 // =============================================================================
 
-/* Helper to copy a C string into gmcp_buf while escaping IAC (0xFF) bytes.
- * gmcp_buf: destination buffer
- * len: pointer to current length (will be updated)
- * bufsize: size of destination buffer
- * p: source C string
+/* Helper to append a C string to a GMCP payload while escaping IAC (0xFF)
+ * bytes by doubling them.
  */
-static void copy_and_escape_to_buf(unsigned char *gmcp_buf, int *len, size_t bufsize, const char *p)
+static void gmcp_append_escaped(std::string &gmcp_buf, const char *p)
 {
     if (!p)
         return;
 
-    /* leave room for potential escapes and final IAC SE */
-    while (*p && *len < static_cast<int>(bufsize) - 4) {
-        unsigned char uc = static_cast<unsigned char>(*p++);
-        if (uc == IAC) {
-            /* Escape 0xFF by doubling */
-            if (*len < static_cast<int>(bufsize)) gmcp_buf[(*len)++] = IAC;
-            if (*len < static_cast<int>(bufsize)) gmcp_buf[(*len)++] = IAC;
-        } else {
-            gmcp_buf[(*len)++] = uc;
-        }
+    for (; *p; p++) {
+        unsigned char uc = static_cast<unsigned char>(*p);
+        if (uc == IAC)
+            gmcp_buf += static_cast<char>(IAC);
+        gmcp_buf += static_cast<char>(uc);
     }
 }
 
@@ -146,28 +142,33 @@ void send_gmcp_event(DESCRIPTOR_DATA *d, const char *event, const char *data) {
          * Build a GMCP subnegotiation payload according to the common GMCP
          * convention: "Event.Name <json>". We must frame with IAC SB TELOPT_GMCP
          * ... IAC SE and escape any embedded IAC bytes by doubling 0xFF.
+         * The payload is sized to fit, so long room descriptions and
+         * inventories are never cut off mid-JSON.
+         * Clients that have not answered DO GMCP get nothing.
          */
-        unsigned char gmcp_buf[GMCP_BUFFER_SIZE];
-        int len = 0;
+        std::string gmcp_buf;
+
+        if (!d || !d->gmcp_detected)
+                return;
         /* Start subnegotiation */
-        gmcp_buf[len++] = IAC;
-        gmcp_buf[len++] = SB;
-        gmcp_buf[len++] = TELOPT_GMCP;
+        gmcp_buf += static_cast<char>(IAC);
+        gmcp_buf += static_cast<char>(SB);
+        gmcp_buf += static_cast<char>(TELOPT_GMCP);
 
         /* Event name */
-        copy_and_escape_to_buf(gmcp_buf, &len, sizeof(gmcp_buf), event);
+        gmcp_append_escaped(gmcp_buf, event);
 
         /* If we have data, insert a single space separator then copy data */
         if (data && *data) {
-                if (len < static_cast<int>(sizeof(gmcp_buf)) - 4) gmcp_buf[len++] = ' ';
-                copy_and_escape_to_buf(gmcp_buf, &len, sizeof(gmcp_buf), data);
+                gmcp_buf += ' ';
+                gmcp_append_escaped(gmcp_buf, data);
         }
 
         /* End subnegotiation */
-        if (len < static_cast<int>(sizeof(gmcp_buf)) - 2) gmcp_buf[len++] = IAC;
-        if (len < static_cast<int>(sizeof(gmcp_buf)) - 1) gmcp_buf[len++] = SE;
+        gmcp_buf += static_cast<char>(IAC);
+        gmcp_buf += static_cast<char>(SE);
 
-        write_to_buffer(d, reinterpret_cast<const char *>(gmcp_buf), len);
+        write_to_buffer_oob(d, gmcp_buf.data(), static_cast<int>(gmcp_buf.size()));
 }
 
 // =============================================================================
@@ -199,6 +200,9 @@ const char go_ahead_str[]      = { static_cast<char>(IAC), static_cast<char>(GA)
 // GMCP (Generic Mud Communication Protocol)
 const unsigned char will_gmcp_str[]     = { IAC, WILL, TELOPT_GMCP, '\0' };
 
+// MSDP (Mud Server Data Protocol)
+const unsigned char will_msdp_str[]     = { IAC, WILL, TELOPT_MSDP, '\0' };
+
 #ifdef MCCP
 // MCCP (Mud Client Compression Protocol)
 const unsigned char will_compress_str[]  = { IAC, WILL, TELOPT_COMPRESS, '\0' };
@@ -222,7 +226,7 @@ const char *gotmail = "[MAIL]";
 
 // System functions
 void save_sysdata args((SYSTEM_DATA sys));
-void shutdown_mud args((char *reason));
+void shutdown_mud args((const char *reason));
 void memory_cleanup args((void));
 int main args((int argc, char **argv));
 
@@ -441,8 +445,10 @@ int main(int argc, char **argv)
          * Run the game.
          */
 
+        init_log();
         log_string("Booting Database");
         boot_db(fCopyOver);
+        init_persist();
         log_string("Initializing socket");
         if (!fCopyOver) /* We have already the port if copyover'ed */
                 control = init_socket(port);
@@ -486,6 +492,10 @@ int main(int argc, char **argv)
 #endif
         log_string("Normal termination of game.");
         log_string("Cleaning up Memory.");
+        shutdown_shell();
+        shutdown_search();
+        shutdown_persist();
+        shutdown_log();
         memory_cleanup();
         exit(0);
         return 0;
@@ -569,6 +579,7 @@ static void SegVio(int signum)
         char      buf[MSL];
 
         (void)signum;    /* Unused parameter */
+        log_crash();
         log_string("SEGMENTATION VIOLATION");
         log_string(lastplayercmd);
         mudstrlcpy(lastplayercmd, "", MIL * 2);
@@ -826,6 +837,7 @@ void accept_new(int ctrl)
                 if (d == last_descriptor)
                         break;
         }
+        shell_fdset(&in_set, &maxdesc);
         if (select(maxdesc + 1, &in_set, &out_set, &exc_set, &null_time) < 0)
         {
                 perror("accept_new: select: poll");
@@ -866,6 +878,7 @@ void game_loop()
         while (!mud_down)
         {
                 accept_new(control);
+                shell_update(&in_set);  /* Stream output of mudexec/compile */
 #ifdef WEB
                 if (sysdata.web)
                         handle_web();
@@ -883,12 +896,6 @@ void game_loop()
                         }
                         d_next = d->next;
 
-                        /*
-                         * Shell code - cheks for forked descriptors 
-                         */
-                        if (check_forks(d, cmdline))
-                                continue;
-
                         /*
                          * Check for aliases, and do its code 
                          */
@@ -997,6 +1004,11 @@ void game_loop()
                  */
                 update_handler();
 
+                /*
+                 * Out-of-band state, at most once a pulse, see telemetry.cpp 
+                 */
+                telemetry_update();
+
                 /*
                  * Output.
                  */
@@ -1122,6 +1134,8 @@ void init_descriptor(DESCRIPTOR_DATA * dnew, int desc)
         dnew->client = STRALLOC(const_cast<char *>("(unknown)"));
         dnew->mxp_detected = FALSE; /* turn off MXP initaly */
         dnew->msp_detected = FALSE; /* turn off MSP initaly */
+        dnew->gmcp_detected = FALSE;    /* until the client says DO */
+        dnew->msdp_detected = FALSE;
         /*
          * force ansi - Dude, as samson said, it is the 2003s - Gavin
          */
@@ -1261,20 +1275,18 @@ void new_descriptor(int new_desc)
          */
 
         write_to_buffer(dnew, reinterpret_cast<const char *>(will_mxp_str), 0);
-        send_gmcp_event(dnew, "Core.Client.MXP", "WILL");
 
         /*
          * Mud Sound Protocol 
          */
 
         write_to_buffer(dnew, reinterpret_cast<const char *>(will_msp_str), 0);
-        send_gmcp_event(dnew, "Core.Client.MSP", "WILL");
 
         /*
-         * GMCP (Generic MUD Communication Protocol)
+         * GMCP and MSDP, nothing goes out of band until the client agrees 
          */
         write_to_buffer(dnew, reinterpret_cast<const char *>(will_gmcp_str), 0);
-        send_gmcp_event(dnew, "Core.Client.GMCP", "{\"version\":\"1.0\"}");
+        write_to_buffer(dnew, reinterpret_cast<const char *>(will_msdp_str), 0);
 
         /*
          * Send the greeting.
@@ -1318,6 +1330,8 @@ void free_desc(DESCRIPTOR_DATA * d)
                 DISPOSE(d->pagebuf);
         if (d->client)
                 STRFREE(d->client);
+        free_prompt_cache(d);
+        free_telemetry(d);
 #ifdef MCCP
         compressEnd(d);
 #endif
@@ -1460,6 +1474,7 @@ void close_socket(DESCRIPTOR_DATA * dclose, bool force)
         }
 #endif
 
+        channel_listeners_changed();
 
         if (!DoNotUnlink)
         {
@@ -1718,6 +1733,32 @@ void read_from_buffer(DESCRIPTOR_DATA * d)
                                          static_cast<signed char>(DONT))
                                         d->msp_detected = FALSE;
                         }
+                        else if (d->inbuf[i] == static_cast<signed char>(TELOPT_GMCP))
+                        {
+                                if (d->inbuf[i - 1] == static_cast<signed char>(DO)
+                                    && !d->gmcp_detected)
+                                {
+                                        d->gmcp_detected = TRUE;
+                                        send_gmcp_event(d, "Core.Client.GMCP",
+                                                        "{\"version\":\"1.0\"}");
+                                        free_telemetry(d);  /* resend it all */
+                                }
+                                else if (d->inbuf[i - 1] ==
+                                         static_cast<signed char>(DONT))
+                                        d->gmcp_detected = FALSE;
+                        }
+                        else if (d->inbuf[i] == static_cast<signed char>(TELOPT_MSDP))
+                        {
+                                if (d->inbuf[i - 1] == static_cast<signed char>(DO)
+                                    && !d->msdp_detected)
+                                {
+                                        d->msdp_detected = TRUE;
+                                        free_telemetry(d);
+                                }
+                                else if (d->inbuf[i - 1] ==
+                                         static_cast<signed char>(DONT))
+                                        d->msdp_detected = FALSE;
+                        }
                 }
                 else if (d->inbuf[i] == '\b' && k > 0)
                         --k;
@@ -1796,6 +1837,39 @@ void read_from_buffer(DESCRIPTOR_DATA * d)
 
 
 
+/*
+ * Hand a snooper the chunk we are about to send.  It is already rendered
+ * for the victim's client, so it goes straight into the snooper's buffer
+ * without another pass through the MXP counting in write_to_buffer.
+ */
+static void snoop_output(DESCRIPTOR_DATA * d, const char *txt, size_t length)
+{
+        char      buf[MIL];
+        int       len;
+
+        if (!d->snoop_by || length == 0)
+                return;
+
+        /*
+         * without check, 'force mortal quit' while snooped caused crash, -h 
+         */
+        if (d->character && d->character->name)
+        {
+                /*
+                 * Show original snooped names. -- Altrag 
+                 */
+                if (d->original && d->original->name)
+                        len = snprintf(buf, MIL, "%s (%s)%% ",
+                                       d->character->name, d->original->name);
+                else
+                        len = snprintf(buf, MIL, "%s%% ", d->character->name);
+        }
+        else
+                len = snprintf(buf, MIL, "%% ");
+        write_to_buffer_raw(d->snoop_by, buf, UMIN(len, MIL - 1));
+        write_to_buffer_raw(d->snoop_by, txt, static_cast<int>(length));
+}
+
 /*
  * Low level output function.
  */
@@ -1803,9 +1877,10 @@ bool flush_buffer(DESCRIPTOR_DATA * d, bool fPrompt)
 {
         char      buf[MIL * 5];
         CHAR_DATA *ch;
+        bool      fOob = d->oobonly && !d->fcommand;
 
         ch = d->original ? d->original : d->character;
-        if (ch && ch->fighting && ch->fighting->who)
+        if (!fOob && ch && ch->fighting && ch->fighting->who)
                 show_condition(ch, ch->fighting->who);
 
         if (!d->speed || d->speed < 1 || d->speed > 5)
@@ -1820,25 +1895,7 @@ bool flush_buffer(DESCRIPTOR_DATA * d, bool fPrompt)
                 memmove(d->outbuf, d->outbuf + client_speed(d->speed),
                         static_cast<size_t>(d->outtop - client_speed(d->speed)));
                 d->outtop -= client_speed(d->speed);
-                if (d->snoop_by)
-                {
-                        char      snoopbuf[MIL * 5];
-
-                        buf[client_speed(d->speed)] = '\0';
-                        if (d->character && d->character->name)
-                        {
-                                if (d->original && d->original->name)
-                                        snprintf(snoopbuf, MIL * 5, "%s (%s)",
-                                                 d->character->name,
-                                                 d->original->name);
-                                else
-                                        snprintf(snoopbuf, MIL * 5, "%s",
-                                                 d->character->name);
-                                write_to_buffer(d->snoop_by, snoopbuf, 0);
-                        }
-                        write_to_buffer(d->snoop_by, "% ", 2);
-                        write_to_buffer(d->snoop_by, buf, 0);
-                }
+                snoop_output(d, buf, speed_bytes);
                 if (!write_to_descriptor
                     (d->descriptor, buf, client_speed(d->speed)))
                 {
@@ -1852,7 +1909,7 @@ bool flush_buffer(DESCRIPTOR_DATA * d, bool fPrompt)
         /*
          * Bust a prompt.
          */
-        if (fPrompt && !mud_down && d->connected == CON_PLAYING)
+        if (fPrompt && !fOob && !mud_down && d->connected == CON_PLAYING)
         {
                 ch = d->original ? d->original : d->character;
                 if (IS_SET(ch->act, PLR_BLANK))
@@ -1873,32 +1930,12 @@ bool flush_buffer(DESCRIPTOR_DATA * d, bool fPrompt)
         /*
          * Snoop-o-rama.
          */
-        if (d->snoop_by)
-        {
-                /*
-                 * without check, 'force mortal quit' while snooped caused crash, -h 
-                 */
-                if (d->character && d->character->name)
-                {
-                        /*
-                         * Show original snooped names. -- Altrag 
-                         */
-                        if (d->original && d->original->name)
-                                snprintf(buf, MIL * 5, "%s (%s)",
-                                         d->character->name,
-                                         d->original->name);
-                        else
-                                snprintf(buf, MIL * 5, "%s",
-                                         d->character->name);
-                        write_to_buffer(d->snoop_by, buf, 0);
-                }
-                write_to_buffer(d->snoop_by, "% ", 2);
-                write_to_buffer(d->snoop_by, d->outbuf, d->outtop);
-        }
+        snoop_output(d, d->outbuf, static_cast<size_t>(d->outtop));
 
         /*
          * OS-dependent output.
          */
+        d->oobonly = FALSE;
         if (!write_to_descriptor(d->descriptor, d->outbuf, d->outtop))
         {
                 d->outtop = 0;
@@ -1913,6 +1950,55 @@ bool flush_buffer(DESCRIPTOR_DATA * d, bool fPrompt)
 
 
 
+/*
+ * Make room for length more bytes of output, adding the leading
+ * \n\r before the first text if needed.  Out-of-band bytes queued
+ * ahead of it do not count as text.  Closes the socket on overflow.
+ */
+static bool reserve_outbuf(DESCRIPTOR_DATA * d, int length, bool text)
+{
+        bool      newline = text && !d->fcommand
+                && (d->outtop == 0 || d->oobonly);
+
+        if (newline)
+                length += 2;
+
+        /*
+         * Expand the buffer as needed.
+         */
+        while (d->outtop + length >= static_cast<int>(d->outsize))
+        {
+                if (d->outsize > 64000)
+                {
+                        /*
+                         * empty buffer 
+                         */
+                        d->outtop = 0;
+                        bug("Buffer overflow. Closing (%s).",
+                            d->character ? d->character->name : "???");
+                        close_socket(d, TRUE);
+                        return FALSE;
+                }
+                d->outsize *= 2;
+                #pragma GCC diagnostic push
+                #pragma GCC diagnostic ignored "-Wold-style-cast"
+                RECREATE(d->outbuf, char, d->outsize);
+                #pragma GCC diagnostic pop
+        }
+
+        /*
+         * Initial \n\r if needed. 
+         */
+        if (newline)
+        {
+                d->outbuf[d->outtop++] = '\n';
+                d->outbuf[d->outtop++] = '\r';
+        }
+        if (text)
+                d->oobonly = FALSE;
+        return TRUE;
+}
+
 /*
  * Append onto an output buffer.
  */
@@ -1951,38 +2037,8 @@ bool write_to_buffer(DESCRIPTOR_DATA * d, const char *txt, int length)
         }
 #endif
 
-        /*
-         * Initial \n\r if needed. 
-         */
-        if (d->outtop == 0 && !d->fcommand)
-        {
-                d->outbuf[0] = '\n';
-                d->outbuf[1] = '\r';
-                d->outtop = 2;
-        }
-
-        /*
-         * Expand the buffer as needed.
-         */
-        while (d->outtop + length >= static_cast<int>(d->outsize))
-        {
-                if (d->outsize > 64000)
-                {
-                        /*
-                         * empty buffer 
-                         */
-                        d->outtop = 0;
-                        bug("Buffer overflow. Closing (%s).",
-                            d->character ? d->character->name : "???");
-                        close_socket(d, TRUE);
-                        return FALSE;
-                }
-                d->outsize *= 2;
-                #pragma GCC diagnostic push
-                #pragma GCC diagnostic ignored "-Wold-style-cast"
-                RECREATE(d->outbuf, char, d->outsize);
-                #pragma GCC diagnostic pop
-        }
+        if (!reserve_outbuf(d, length, TRUE))
+                return FALSE;
 
         /*
          * Copy.
@@ -1993,6 +2049,44 @@ bool write_to_buffer(DESCRIPTOR_DATA * d, const char *txt, int length)
         return TRUE;
 }
 
+/*
+ * Append text that is already rendered for this descriptor (color codes
+ * and MXP converted), see render_text() in color.c.
+ */
+static bool append_outbuf(DESCRIPTOR_DATA * d, const char *txt, int length,
+                          bool text)
+{
+        if (!d || !d->outbuf)
+                return FALSE;
+        if (length <= 0)
+                return TRUE;
+        if (!reserve_outbuf(d, length, text))
+                return FALSE;
+        memcpy(d->outbuf + d->outtop, txt, static_cast<size_t>(length));
+        d->outtop += length;
+        d->outbuf[d->outtop] = '\0';
+        return TRUE;
+}
+
+bool write_to_buffer_raw(DESCRIPTOR_DATA * d, const char *txt, int length)
+{
+        return append_outbuf(d, txt, length, TRUE);
+}
+
+/*
+ * Append a telnet subnegotiation.  If nothing else is queued the buffer
+ * is marked out-of-band only, and flush_buffer() sends it without the
+ * leading \n\r, the condition line or a prompt.
+ */
+bool write_to_buffer_oob(DESCRIPTOR_DATA * d, const char *txt, int length)
+{
+        if (!d || !d->outbuf)
+                return FALSE;
+        if (d->outtop == 0)
+                d->oobonly = TRUE;
+        return append_outbuf(d, txt, length, FALSE);
+}
+
 
 /*
 * Lowest level output function. Write a block of text to the file descriptor.
@@ -4060,6 +4154,7 @@ case CON_GET_NAME:
                 write_to_buffer(d, "\n\r\n\r", 0);
                 add_char(ch);
                 d->connected = static_cast<sh_int>(CON_PLAYING);
+                channel_listeners_changed();
 #ifdef ACCOUNT
                 ch->pcdata->account = d->account;
 #endif
@@ -4535,6 +4630,7 @@ bool check_reconnect(DESCRIPTOR_DATA * d, char *name, bool fConn)
                                 ch->pcdata->account->inuse--;
 #endif
                                 d->connected = static_cast<sh_int>(CON_PLAYING);
+                                channel_listeners_changed();
                         }
                         return TRUE;
                 }
@@ -4756,6 +4852,22 @@ char     *obj_short(OBJ_DATA * obj)
 #define NAME(ch)	(IS_NPC((ch)) ? (ch)->short_descr : (ch)->name)
 #define NAME2(ch)	(IS_NPC((ch)) ? (ch)->short_descr : (ch)->pcdata->full_name )
 #define CAN_SEE(ch, vict) ( (OOC && can_see_ooc((vict), (ch))) || (!OOC && can_see((vict), (ch))))
+
+/*
+ * What $n (or $N) expands to when "to" is the one looking at ch.  The
+ * result may live in a static buffer, so copy it before the next call.
+ */
+const char *act_name(CHAR_DATA * ch, CHAR_DATA * to, bool OOC)
+{
+        if (!to)
+                return get_char_desc(ch, to);
+        if (CAN_SEE(ch, to))
+                return (OOC ? NAME(ch) : get_char_desc(ch, to));
+        if (OOC && IS_IMMORTAL(ch))
+                return "An Immortal";
+        return "Someone";
+}
+
 char     *act_string(const char *format, CHAR_DATA * to, CHAR_DATA * ch,
                      void *arg1, void *arg2, bool OOC)
 {
@@ -4818,35 +4930,11 @@ char     *act_string(const char *format, CHAR_DATA * to, CHAR_DATA * ch,
                                      "Someone");
                                 break;
                         case 'n':
-                                {
-                                        if (!to)
-                                        {
-                                                i =  get_char_desc(ch, to);
-                                                break;
-                                        }
-                                        if (CAN_SEE(ch, to))
-                                                i = (OOC ? NAME(ch) : get_char_desc(ch, to) );
-                                        else if (OOC && IS_IMMORTAL(ch))
-                                                i = "An Immortal";
-                                        else
-                                                i = "Someone";
-                                        break;
-                                }
+                                i = act_name(ch, to, OOC);
+                                break;
                         case 'N':
-                                {
-                                        if (!to)
-                                        {
-                                                i =  get_char_desc(vch, NULL);
-                                                break;
-                                        }
-                                        if (CAN_SEE(vch, to))
-                                                i = (OOC ? NAME(vch) : get_char_desc(vch, to) );
-                                        else if (OOC && IS_IMMORTAL(vch))
-                                                i = "An Immortal";
-                                        else
-                                                i = "Someone";
-                                        break;
-                                }
+                                i = act_name(vch, to, OOC);
+                                break;
                         case 'a':
                                 {
                                         i = npc_sex[ch->sex];
@@ -5129,6 +5217,7 @@ CMDF do_name(CHAR_DATA * ch, char *argument)
 
         STRFREE(ch->name);
         ch->name = STRALLOC(argument);
+        name_index_update(ch);
         STRFREE(ch->pcdata->full_name);
         ch->pcdata->full_name = STRALLOC(argument);
         send_to_char("Your name has been changed.  Please apply again.\n\r",
@@ -5189,12 +5278,7 @@ void display_prompt(DESCRIPTOR_DATA * d)
 {
         CHAR_DATA *ch = d->character;
         CHAR_DATA *och = (d->original ? d->original : d->character);
-        CHAR_DATA *victim;
-        bool      ansi = (!IS_NPC(och) && IS_SET(och->act, PLR_ANSI));
         const char *prompt;
-        char      buf[MAX_STRING_LENGTH];
-        char     *pbuf = buf;
-        int       pstat, percent;
                 static const char * no_email_prompt = "Please set your email using setself realemail <your email address>";
         if (!ch)
         {
@@ -5202,9 +5286,6 @@ void display_prompt(DESCRIPTOR_DATA * d)
                 return;
         }
 
-        if (IS_MXP(ch))
-                send_to_char(MXPTAG("Prompt"), ch);
-
         if (!IS_NPC(ch) && ch->substate != SUB_NONE && ch->pcdata->subprompt
             && ch->pcdata->subprompt[0] != '\0')
                 prompt = ch->pcdata->subprompt;
@@ -5222,310 +5303,16 @@ void display_prompt(DESCRIPTOR_DATA * d)
         else
                 prompt = ch->pcdata->prompt;
 
-        if (ansi)
-        {
-                mudstrlcpy(pbuf, ANSI_RESET, MSL);
-                d->prevcolor = 0x08;
-                pbuf += 4;
-        }
         /*
-         * Clear out old color stuff 
+         * Compiled and cached per descriptor, see prompt.cpp 
          */
-/*  make_color_sequence(NULL, NULL, NULL);*/
-        for (; *prompt; prompt++)
-        {
-                /*
-                 * '%' = prompt commands
-                 * Note: foreground changes will revert background to 0 (black)
-                 */
-                if (*prompt != '%')
-                {
-                        *(pbuf++) = *prompt;
-                        continue;
-                }
-                ++prompt;
-                if (!*prompt)
-                        break;
-                if (*prompt == *(prompt - 1))
-                {
-                        *(pbuf++) = *prompt;
-                        continue;
-                }
-                switch (*(prompt - 1))
-                {
-                default:
-                        bug("Display_prompt: bad command char '%c'.",
-                            *(prompt - 1));
-                        break;
-                case '%':
-                        *pbuf = '\0';
-                        pstat = 65543;
-                        switch (*prompt)
-                        {
-                        case '%':
-                                *pbuf++ = '%';
-                                *pbuf = '\0';
-                              break;
-                        case 'a':
-                                if (ch->top_level >= 10)
-                                        pstat = ch->alignment;
-                                else if (IS_GOOD(ch))
-                                        mudstrlcpy(pbuf, "good", MSL);
-                                else if (IS_EVIL(ch))
-                                        mudstrlcpy(pbuf, "evil", MSL);
-                                else
-                                        mudstrlcpy(pbuf, "neutral", MSL);
-                                break;
-                        case 'b': /* Combat XP needed till next level */
-                                snprintf(pbuf, MSL, "%ld", (exp_level(ch->skill_level[COMBAT_ABILITY] + 1) - ch->experience[COMBAT_ABILITY]));                                
-                                break;
-                        case 'C':
-                                if (ch->max_hit > 0)
-                                        percent =
-                                                (100 * ch->hit) / ch->max_hit;
-                                else
-                                        percent = -1;
-                                if (percent >= 60)
-                                        snprintf(pbuf, MSL, "&G%d&w",
-                                                 percent);
-                                else if (percent >= 40 && percent < 60)
-                                        snprintf(pbuf, MSL, "&Y%d&w",
-                                                 percent);
-                                else if (percent >= 20 && percent < 40)
-                                        snprintf(pbuf, MSL, "&B%d&w",
-                                                 percent);
-                                else
-                                        snprintf(pbuf, MSL, "&R%d&w",
-                                                 percent);
-                                break;
-
-                        case 'c':
-                                if ((victim = who_fighting(ch)) != NULL)
-                                {
-                                        if (victim->max_hit > 0)
-                                                percent =
-                                                        (100 * victim->hit) /
-                                                        victim->max_hit;
-                                        else
-                                                percent = -1;
-                                        if (percent >= 60)
-                                                snprintf(pbuf, MSL,
-                                                         "&G%d&w",
-                                                         percent);
-                                        else if (percent >= 40
-                                                 && percent < 60)
-                                                snprintf(pbuf, MSL,
-                                                         "&Y%d&w",
-                                                         percent);
-                                        else if (percent >= 20
-                                                 && percent < 40)
-                                                snprintf(pbuf, MSL,
-                                                         "&B%d&w",
-                                                         percent);
-                                        else
-                                                snprintf(pbuf, MSL,
-                                                         "&R%d&w",
-                                                         percent);
-                                }
-                                break;
+        prompt_write(d, ch, och, prompt);
 
-                        case 'e':
-                                if ((victim = who_fighting(ch)) != NULL)
-                                {
-                                        if (victim->max_hit > 0)
-                                                percent =
-                                                        (100 * victim->hit) /
-                                                        victim->max_hit;
-                                        else
-                                                percent = -1;
-                                        if (percent >= 100)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B||&Y||&G||||&w]");
-                                        else if (percent >= 90)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B||&Y||&G|||&w ]");
-                                        else if (percent >= 80)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B||&Y||&G||&w  ]");
-                                        else if (percent >= 70)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B||&Y||&G|&w   ]");
-                                        else if (percent >= 60)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B||&Y||&G&w    ]");
-                                        else if (percent >= 50)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B||&Y|&G&w      ]");
-                                        else if (percent >= 40)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B||&Y&G&w       ]");
-                                        else if (percent >= 30)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B|&Y&G&w        ]");
-                                        else if (percent >= 20)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R||&B&Y&G&w         ]");
-                                        else if (percent >= 10)
-                                                snprintf(pbuf, MSL,
-                                                         "[&R|&B&Y&G&w          ]");
-                                        else
-                                                snprintf(pbuf, MSL,
-                                                         "[&R    %d%%&w    ]",
-                                                         percent);
-                                }
-                                break;
-
-                        case 'E':
-                                if (ch->max_hit > 0)
-                                        percent =
-                                                (100 * ch->hit) / ch->max_hit;
-                                else
-                                        percent = -1;
-                                if (percent >= 100)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B||&Y||&G||||&w]");
-                                else if (percent >= 90)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B||&Y||&G|||&w ]");
-                                else if (percent >= 80)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B||&Y||&G||&w  ]");
-                                else if (percent >= 70)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B||&Y||&G|&w   ]");
-                                else if (percent >= 60)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B||&Y||&G&w    ]");
-                                else if (percent >= 50)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B||&Y|&G&w      ]");
-                                else if (percent >= 40)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B||&Y&G&w       ]");
-                                else if (percent >= 30)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B|&Y&G&w        ]");
-                                else if (percent >= 20)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R||&B&Y&G&w         ]");
-                                else if (percent >= 10)
-                                        snprintf(pbuf, MSL,
-                                                 "[&R|&B&Y&G&w          ]");
-                                else
-                                        snprintf(pbuf, MSL,
-                                                 "[&R    %d%%&w    ]",
-                                                 percent);
-                                break;
-                        case 'h':
-                                pstat = ch->hit;
-                                break;
-                        case 'H':
-                                pstat = ch->max_hit;
-                                break;
-                        case '_':
-                                mudstrlcpy(pbuf, "\n\r", MSL);
-                                break;
-                        case 'T':
-                                if (time_info.hour < 5)
-                                        mudstrlcpy(pbuf, "night", MSL);
-                                else if (time_info.hour < 6)
-                                        mudstrlcpy(pbuf, "dawn", MSL);
-                                else if (time_info.hour < 19)
-                                        mudstrlcpy(pbuf, "day", MSL);
-                                else if (time_info.hour < 21)
-                                        mudstrlcpy(pbuf, "dusk", MSL);
-                                else
-                                        mudstrlcpy(pbuf, "night", MSL);
-                                break;
-                        case 'u':
-                                {
-                                        sh_int    count = 0;
-
-                                        for (d = first_descriptor; d;
-                                             d = d->next)
-                                                if (d->connected ==
-                                                    CON_PLAYING
-                                                    && d->character
-                                                    && !IS_SET(d->character->
-                                                               act,
-                                                               PLR_WIZINVIS))
-                                                        count++;
-                                        pstat = count;
-                                }
-                                break;
-                        case 'U':
-                                pstat = sysdata.maxplayers;
-                                break;
-                        case 'v':
-                                pstat = ch->endurance;
-                                break;
-                        case 'V':
-                                pstat = ch->max_endurance;
-                                break;
-                        case 'm':
-                                pstat = ch->endurance;
-                                break;
-                        case 'M':
-                                pstat = ch->max_endurance;
-                                break;
-                        case 'g':
-                                pstat = static_cast<int>(ch->gold);
-                                break;
-                        case 'r':
-                                if (IS_IMMORTAL(och))
-                                        pstat = ch->in_room->vnum;
-                                break;
-                        case 'R':
-                                if (IS_SET(och->act, PLR_ROOMVNUM))
-                                        snprintf(pbuf, MSL, "<#%d> ",
-                                                 ch->in_room->vnum);
-                                break;
-                        case 'i':
-                                if ((!IS_NPC(ch)
-                                     && IS_SET(ch->act, PLR_WIZINVIS))
-                                    || (IS_NPC(ch)
-                                        && IS_SET(ch->act, ACT_MOBINVIS)))
-                                        snprintf(pbuf, MSL, "(Invis %d) ",
-                                                 (IS_NPC(ch) ? ch->
-                                                  mobinvis : ch->pcdata->
-                                                  wizinvis));
-                                else if (IS_AFFECTED(ch, AFF_INVISIBLE))
-                                        snprintf(pbuf, MSL, "%s", "(Invis) ");
-                                break;
-                        case 'I':
-                                pstat = (IS_NPC(ch)
-                                         ? (IS_SET(ch->act, ACT_MOBINVIS) ?
-                                            ch->mobinvis : 0) : (IS_SET(ch->
-                                                                        act,
-                                                                        PLR_WIZINVIS)
-                                                                 ? ch->
-                                                                 pcdata->
-                                                                 wizinvis :
-                                                                 0));
-                                break;
-                        }
-                        if (pstat != 65543)
-                                snprintf(pbuf, MSL, "%d", pstat);
-                        pbuf += strlen(pbuf);
-                        break;
-                }
-        }
-        *pbuf = '\0';
-        send_to_char(buf, ch);
-        if (IS_MXP(ch))
-                send_to_char(MXPTAG("/Prompt"), ch);
-        if (d)
-        {
-                send_gmcp_event(d, "Core.Character.Prompt", NULL);
-                /* Send Char.Status for web dashboard integration */
-                char status_buf[512];
-                snprintf(status_buf, sizeof(status_buf),
-                         "{\"name\":\"%s\",\"level\":%d,\"hp\":%d,\"maxhp\":%d,\"endurance\":%d,\"maxendurance\":%d,\"position\":\"%s\"}",
-                         ch->name, ch->top_level, ch->hit, ch->max_hit, 
-                         ch->endurance, ch->max_endurance,
-                         position_name(ch->position));
-                send_gmcp_event(d, "Core.Character.Status", status_buf);
-        }
+        /*
+         * Core.Character.Status now goes out with the telemetry pulse,
+         * and only when it changes 
+         */
+        send_gmcp_event(d, "Core.Character.Prompt", NULL);
         return;
 }
 
@@ -83,6 +83,10 @@ DECLARE_DO_FUN(do_takedrug);
 DECLARE_DO_FUN(do_oldscore);
 DECLARE_DO_FUN(do_rreset);
 DECLARE_DO_FUN(do_reset);
+DECLARE_DO_FUN(do_resetstat);
+DECLARE_DO_FUN(do_logstat);
+DECLARE_DO_FUN(do_persiststat);
+DECLARE_DO_FUN(do_asearch);
 DECLARE_DO_FUN(do_yell);
 DECLARE_DO_FUN(do_hide);
 DECLARE_DO_FUN(do_emote);
@@ -116,6 +120,8 @@ DECLARE_DO_FUN(do_tail);
 
 /* MXP */
 DECLARE_DO_FUN(do_mxp);
+DECLARE_DO_FUN(do_colorbench);
+DECLARE_DO_FUN(do_spacebench);
 
 /* Spells */
 DECLARE_SPELL_FUN(spell_notfound);
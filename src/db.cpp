@@ -53,6 +53,8 @@
 #if !defined(__CYGWIN__) && !defined(__FreeBSD__)
 #include <execinfo.h>
 #endif
+#include <sys/time.h>
+#include <deque>
 #include "mud.hpp"
 #include "ban.hpp"
 #include "homes.hpp"
@@ -69,7 +71,10 @@
 #include "olc_bounty.hpp"
 #include "web-server.hpp"
 #include "space2.hpp"
+#include "logging.hpp"
 #include "installations.hpp"
+#include "bootload.hpp"
+#include "search.hpp"
 
 int const lang_array[] =
         { LANG_BASIC, LANG_WOOKIEE, LANG_TWI_LEK, LANG_RODIAN,
@@ -380,6 +385,9 @@ sh_int    gsn_top_sn = 0;
 MOB_INDEX_DATA *mob_index_hash[MAX_KEY_HASH];
 OBJ_INDEX_DATA *obj_index_hash[MAX_KEY_HASH];
 ROOM_INDEX_DATA *room_index_hash[MAX_KEY_HASH];
+VNUM_TABLE < MOB_INDEX_DATA > mob_index_table;
+VNUM_TABLE < OBJ_INDEX_DATA > obj_index_table;
+VNUM_TABLE < ROOM_INDEX_DATA > room_index_table;
 
 AREA_DATA *first_area;
 AREA_DATA *last_area;
@@ -408,8 +416,8 @@ int       top_vroom;
  * Semi-locals.
  */
 bool      fBootDb;
-FILE     *fpArea;
-char      strArea[MAX_INPUT_LENGTH];
+thread_local FILE *fpArea;
+thread_local char strArea[MAX_INPUT_LENGTH];
 
 
 
@@ -441,6 +449,11 @@ void load_shops args((AREA_DATA * tarea, FILE * fp));
 void load_repairs args((AREA_DATA * tarea, FILE * fp));
 void load_specials args((AREA_DATA * tarea, FILE * fp));
 void load_ranges args((AREA_DATA * tarea, FILE * fp));
+void load_area_done args((AREA_DATA * tarea, char *filename));
+void link_help args((HELP_DATA * pHelp));
+void link_mob_index args((MOB_INDEX_DATA * pMobIndex));
+void link_obj_index args((OBJ_INDEX_DATA * pObjIndex));
+void link_room_index args((ROOM_INDEX_DATA * pRoomIndex));
 void load_protoships args((void));
 void load_buildlist args((void));
 bool load_systemdata args((SYSTEM_DATA * sys));
@@ -476,7 +489,7 @@ MPROG_DATA *rprog_file_read
 args((char *f, MPROG_DATA * mprg, ROOM_INDEX_DATA * pRoomIndex));
 
 
-void shutdown_mud(char *reason)
+void shutdown_mud(const char *reason)
 {
         FILE     *fp;
 
@@ -521,6 +534,8 @@ void initialize_sysdata(void)
         sysdata.alltimemax = 0;
         sysdata.GREET = 0;
         sysdata.DEBUG = 0;
+        sysdata.boot_threads = BOOT_THREADS_AUTO;
+        sysdata.reset_budget = RESET_BUDGET_DEFAULT;
 }
 
 void initialize_new_sysdata(void)
@@ -834,6 +849,7 @@ void initialize_gsns(void)
 void initialize_areas(void)
 {
         FILE     *fpList;
+        std::vector < std::string > files;
 
         if ((fpList = fopen(FILE_AREA_LIST, "r")) == NULL)
         {
@@ -843,14 +859,15 @@ void initialize_areas(void)
 
         for (;;)
         {
-                mudstrlcpy(strArea, fread_word(fpList), MIL);
-                if (strArea[0] == '$')
-                        break;
-
-                load_area_file(last_area, strArea);
+                char     *word = fread_word(fpList);
 
+                if (word[0] == '$')
+                        break;
+                files.push_back(word);
         }
         FCLOSE(fpList);
+
+        boot_load_areas(files);
 }
 
 void initialize_skills(void)
@@ -1083,6 +1100,14 @@ void load_area(FILE * fp)
         pArea->low_hard_range = 0;
         pArea->hi_hard_range = MAX_LEVEL;
 
+        /*
+         * A boot worker leaves linking to boot_link_area() 
+         */
+        if (boot_stage)
+        {
+                boot_stage->area = pArea;
+                return;
+        }
         LINK(pArea, first_area, last_area, next, prev);
         top_area++;
         return;
@@ -1289,13 +1314,21 @@ void load_helps(AREA_DATA * tarea, FILE * fp)
                         continue;
                 }
 
-                if (!str_cmp(pHelp->keyword, "greeting"))
-                        help_greeting = pHelp->text;
-                add_help(pHelp);
+                if (boot_stage)
+                        boot_stage->sections.back().helps.push_back(pHelp);
+                else
+                        link_help(pHelp);
         }
         return;
 }
 
+void link_help(HELP_DATA * pHelp)
+{
+        if (!str_cmp(pHelp->keyword, "greeting"))
+                help_greeting = pHelp->text;
+        add_help(pHelp);
+}
+
 
 /*
  * Add a character to the list of all characters		-Thoric
@@ -1303,9 +1336,31 @@ void load_helps(AREA_DATA * tarea, FILE * fp)
 void add_char(CHAR_DATA * ch)
 {
         LINK(ch, first_char, last_char, next, prev);
+        name_index_add(ch);
+        if (IS_NPC(ch) && ch->pIndexData)
+                LINK(ch, ch->pIndexData->first_instance,
+                     ch->pIndexData->last_instance, next_instance,
+                     prev_instance);
 }
 
 
+/*
+ * Capitalise a hashed string.  Writing to it in place would change it for
+ * every other holder too, and race with boot workers hashing the same
+ * text.
+ */
+static char *upper_first(char *str)
+{
+        char      buf[MAX_STRING_LENGTH];
+
+        if (str[0] == UPPER(str[0]))
+                return str;
+        mudstrlcpy(buf, str, MSL);
+        buf[0] = UPPER(buf[0]);
+        STRFREE(str);
+        return STRALLOC(buf);
+}
+
 /*
  * Load a mob section.
  */
@@ -1331,7 +1386,6 @@ void load_mobiles(AREA_DATA * tarea, FILE * fp)
                 char      buf[MAX_STRING_LENGTH];
                 int       vnum;
                 char      letter;
-                int       iHash;
                 bool      oldmob = FALSE;
                 bool      tmpBootDb;
 
@@ -1352,37 +1406,45 @@ void load_mobiles(AREA_DATA * tarea, FILE * fp)
                 if (vnum == 0)
                         break;
 
-                tmpBootDb = fBootDb;
-                fBootDb = FALSE;
-
-                if (get_mob_index(vnum))
+                /*
+                 * Duplicates in a staged file are caught when it is linked 
+                 */
+                if (boot_stage)
+                        CREATE(pMobIndex, MOB_INDEX_DATA, 1);
+                else
                 {
-                        if (tmpBootDb)
+                        tmpBootDb = fBootDb;
+                        fBootDb = FALSE;
+
+                        if (get_mob_index(vnum))
                         {
-                                bug("Load_mobiles: vnum %d duplicated.",
-                                    vnum);
-                                shutdown_mud("duplicate vnum");
+                                if (tmpBootDb)
+                                {
+                                        bug("Load_mobiles: vnum %d duplicated.",
+                                            vnum);
+                                        shutdown_mud("duplicate vnum");
+                                }
+                                else
+                                {
+                                        pMobIndex = get_mob_index(vnum);
+                                        snprintf(buf, MSL, "Cleaning mobile: %d",
+                                                 vnum);
+                                        log_string_plus(buf, LOG_BUILD,
+                                                        sysdata.log_level);
+                                        clean_mob(pMobIndex);
+                                        oldmob = TRUE;
+                                }
                         }
+
                         else
                         {
-                                pMobIndex = get_mob_index(vnum);
-                                snprintf(buf, MSL, "Cleaning mobile: %d",
-                                         vnum);
-                                log_string_plus(buf, LOG_BUILD,
-                                                sysdata.log_level);
-                                clean_mob(pMobIndex);
-                                oldmob = TRUE;
+                                oldmob = FALSE;
+                                CREATE(pMobIndex, MOB_INDEX_DATA, 1);
                         }
-                }
 
-                else
-                {
-                        oldmob = FALSE;
-                        CREATE(pMobIndex, MOB_INDEX_DATA, 1);
+                        fBootDb = tmpBootDb;
                 }
 
-                fBootDb = tmpBootDb;
-
                 pMobIndex->vnum = vnum;
 
                 if (fBootDb)
@@ -1406,8 +1468,8 @@ void load_mobiles(AREA_DATA * tarea, FILE * fp)
                 }
                 pMobIndex->speaking = get_language(fread_string_noalloc(fp));
 
-                pMobIndex->long_descr[0] = UPPER(pMobIndex->long_descr[0]);
-                pMobIndex->description[0] = UPPER(pMobIndex->description[0]);
+                pMobIndex->long_descr = upper_first(pMobIndex->long_descr);
+                pMobIndex->description = upper_first(pMobIndex->description);
 
                 pMobIndex->act = fread_number(fp) | ACT_IS_NPC;
                 pMobIndex->affected_by = fread_number(fp);
@@ -1551,17 +1613,25 @@ void load_mobiles(AREA_DATA * tarea, FILE * fp)
                 }
                 else
                         ungetc(letter, fp);
-                if (!oldmob)
-                {
-                        iHash = vnum % MAX_KEY_HASH;
-                        pMobIndex->next = mob_index_hash[iHash];
-                        mob_index_hash[iHash] = pMobIndex;
-                        top_mob_index++;
-                }
+                if (boot_stage)
+                        boot_stage->sections.back().mobs.push_back(pMobIndex);
+                else if (!oldmob)
+                        link_mob_index(pMobIndex);
         }
         return;
 }
 
+void link_mob_index(MOB_INDEX_DATA * pMobIndex)
+{
+        int       iHash = pMobIndex->vnum % MAX_KEY_HASH;
+
+        pMobIndex->next = mob_index_hash[iHash];
+        mob_index_hash[iHash] = pMobIndex;
+        mob_index_table.set(pMobIndex->vnum, pMobIndex);
+        search_invalidate();
+        top_mob_index++;
+}
+
 
 
 /*
@@ -1589,7 +1659,6 @@ void load_objects(AREA_DATA * tarea, FILE * fp)
         {
                 char      buf[MAX_STRING_LENGTH];
                 int       vnum;
-                int       iHash;
                 bool      tmpBootDb;
                 bool      oldobj = FALSE;
 
@@ -1609,34 +1678,42 @@ void load_objects(AREA_DATA * tarea, FILE * fp)
                 if (vnum == 0)
                         break;
 
-                tmpBootDb = fBootDb;
-                fBootDb = FALSE;
-                if (get_obj_index(vnum))
+                /*
+                 * Duplicates in a staged file are caught when it is linked 
+                 */
+                if (boot_stage)
+                        CREATE(pObjIndex, OBJ_INDEX_DATA, 1);
+                else
                 {
-                        if (tmpBootDb)
+                        tmpBootDb = fBootDb;
+                        fBootDb = FALSE;
+                        if (get_obj_index(vnum))
                         {
-                                bug("Load_objects: vnum %d duplicated.",
-                                    vnum);
-                                shutdown_mud("duplicate vnum");
+                                if (tmpBootDb)
+                                {
+                                        bug("Load_objects: vnum %d duplicated.",
+                                            vnum);
+                                        shutdown_mud("duplicate vnum");
+                                }
+                                else
+                                {
+                                        pObjIndex = get_obj_index(vnum);
+                                        snprintf(buf, MSL, "Cleaning object: %d",
+                                                 vnum);
+                                        log_string_plus(buf, LOG_BUILD,
+                                                        sysdata.log_level);
+                                        clean_obj(pObjIndex);
+                                        oldobj = TRUE;
+                                }
                         }
                         else
                         {
-                                pObjIndex = get_obj_index(vnum);
-                                snprintf(buf, MSL, "Cleaning object: %d",
-                                         vnum);
-                                log_string_plus(buf, LOG_BUILD,
-                                                sysdata.log_level);
-                                clean_obj(pObjIndex);
-                                oldobj = TRUE;
+                                oldobj = FALSE;
+                                CREATE(pObjIndex, OBJ_INDEX_DATA, 1);
                         }
-                }
-                else
-                {
-                        oldobj = FALSE;
-                        CREATE(pObjIndex, OBJ_INDEX_DATA, 1);
-                }
 
-                fBootDb = tmpBootDb;
+                        fBootDb = tmpBootDb;
+                }
 
                 pObjIndex->vnum = vnum;
                 if (fBootDb)
@@ -1651,7 +1728,7 @@ void load_objects(AREA_DATA * tarea, FILE * fp)
                 pObjIndex->description = fread_string(fp);
                 pObjIndex->action_desc = fread_string(fp);
 
-                pObjIndex->description[0] = UPPER(pObjIndex->description[0]);
+                pObjIndex->description = upper_first(pObjIndex->description);
 
                 ln = fread_line(fp);
                 x1 = x2 = x3 = x4 = 0;
@@ -1698,7 +1775,7 @@ void load_objects(AREA_DATA * tarea, FILE * fp)
                                 paf->bitvector = 0;
                                 LINK(paf, pObjIndex->first_affect,
                                      pObjIndex->last_affect, next, prev);
-                                top_affect++;
+                                BOOT_TALLY(top_affect);
                         }
 
                         else if (letter == 'E')
@@ -1710,7 +1787,7 @@ void load_objects(AREA_DATA * tarea, FILE * fp)
                                 ed->description = fread_string(fp);
                                 LINK(ed, pObjIndex->first_extradesc,
                                      pObjIndex->last_extradesc, next, prev);
-                                top_ed++;
+                                BOOT_TALLY(top_ed);
                         }
 
                         else if (letter == '>')
@@ -1753,17 +1830,25 @@ void load_objects(AREA_DATA * tarea, FILE * fp)
                         break;
                 }
 
-                if (!oldobj)
-                {
-                        iHash = vnum % MAX_KEY_HASH;
-                        pObjIndex->next = obj_index_hash[iHash];
-                        obj_index_hash[iHash] = pObjIndex;
-                        top_obj_index++;
-                }
+                if (boot_stage)
+                        boot_stage->sections.back().objs.push_back(pObjIndex);
+                else if (!oldobj)
+                        link_obj_index(pObjIndex);
         }
         return;
 }
 
+void link_obj_index(OBJ_INDEX_DATA * pObjIndex)
+{
+        int       iHash = pObjIndex->vnum % MAX_KEY_HASH;
+
+        pObjIndex->next = obj_index_hash[iHash];
+        obj_index_hash[iHash] = pObjIndex;
+        obj_index_table.set(pObjIndex->vnum, pObjIndex);
+        search_invalidate();
+        top_obj_index++;
+}
+
 
 
 /*
@@ -1968,7 +2053,6 @@ void load_rooms(AREA_DATA * tarea, FILE * fp)
                 int       vnum;
                 char      letter;
                 int       door;
-                int       iHash;
                 bool      tmpBootDb;
                 bool      oldroom = FALSE;
                 int       x1, x2, x3, x4, x5, x6, x7, x8;
@@ -1988,36 +2072,44 @@ void load_rooms(AREA_DATA * tarea, FILE * fp)
                 if ((vnum = fread_number(fp)) == 0)
                         break;
 
-                tmpBootDb = fBootDb;
-                fBootDb = FALSE;
-                if (get_room_index(vnum) != NULL)
+                /*
+                 * Duplicates in a staged file are caught when it is linked 
+                 */
+                if (boot_stage)
+                        CREATE(pRoomIndex, ROOM_INDEX_DATA, 1);
+                else
                 {
-                        if (tmpBootDb)
+                        tmpBootDb = fBootDb;
+                        fBootDb = FALSE;
+                        if (get_room_index(vnum) != NULL)
                         {
-                                bug("Load_rooms: vnum %d duplicated.", vnum);
-                                shutdown_mud("duplicate vnum");
+                                if (tmpBootDb)
+                                {
+                                        bug("Load_rooms: vnum %d duplicated.", vnum);
+                                        shutdown_mud("duplicate vnum");
+                                }
+                                else
+                                {
+                                        pRoomIndex = get_room_index(vnum);
+                                        snprintf(buf, MSL, "Cleaning room: %d", vnum);
+                                        log_string_plus(buf, LOG_BUILD,
+                                                        sysdata.log_level);
+                                        clean_room(pRoomIndex);
+                                        oldroom = TRUE;
+                                }
                         }
                         else
                         {
-                                pRoomIndex = get_room_index(vnum);
-                                snprintf(buf, MSL, "Cleaning room: %d", vnum);
-                                log_string_plus(buf, LOG_BUILD,
-                                                sysdata.log_level);
-                                clean_room(pRoomIndex);
-                                oldroom = TRUE;
+                                oldroom = FALSE;
+                                CREATE(pRoomIndex, ROOM_INDEX_DATA, 1);
+                                pRoomIndex->first_person = NULL;
+                                pRoomIndex->last_person = NULL;
+                                pRoomIndex->first_content = NULL;
+                                pRoomIndex->last_content = NULL;
                         }
-                }
-                else
-                {
-                        oldroom = FALSE;
-                        CREATE(pRoomIndex, ROOM_INDEX_DATA, 1);
-                        pRoomIndex->first_person = NULL;
-                        pRoomIndex->last_person = NULL;
-                        pRoomIndex->first_content = NULL;
-                        pRoomIndex->last_content = NULL;
-                }
 
-                fBootDb = tmpBootDb;
+                        fBootDb = tmpBootDb;
+                }
                 pRoomIndex->area = tarea;
                 pRoomIndex->vnum = vnum;
                 pRoomIndex->first_extradesc = NULL;
@@ -2033,7 +2125,7 @@ void load_rooms(AREA_DATA * tarea, FILE * fp)
                 pRoomIndex->name = fread_string(fp);
                 pRoomIndex->description = fread_string(fp);
 
-                x1 = x2 = x3 = x4 = x5 = x6 = x7 = 0;
+                x1 = x2 = x3 = x4 = x5 = x6 = x7 = x8 = 0;
                 fread_number(fp);
                 pRoomIndex->room_flags = fread_bitvector(fp);
                 ln = fread_line(fp);
@@ -2061,6 +2153,7 @@ void load_rooms(AREA_DATA * tarea, FILE * fp)
                 pRoomIndex->light = 0;
                 pRoomIndex->first_exit = NULL;
                 pRoomIndex->last_exit = NULL;
+                index_exits(pRoomIndex);
 
                 for (;;)
                 {
@@ -2124,7 +2217,7 @@ void load_rooms(AREA_DATA * tarea, FILE * fp)
                                 ed->description = fread_string(fp);
                                 LINK(ed, pRoomIndex->first_extradesc,
                                      pRoomIndex->last_extradesc, next, prev);
-                                top_ed++;
+                                BOOT_TALLY(top_ed);
                         }
                         else if (letter == '>')
                         {
@@ -2139,17 +2232,24 @@ void load_rooms(AREA_DATA * tarea, FILE * fp)
 
                 }
 
-                if (!oldroom)
-                {
-                        iHash = vnum % MAX_KEY_HASH;
-                        pRoomIndex->next = room_index_hash[iHash];
-                        room_index_hash[iHash] = pRoomIndex;
-                        top_room++;
-                }
+                if (boot_stage)
+                        boot_stage->sections.back().rooms.push_back(pRoomIndex);
+                else if (!oldroom)
+                        link_room_index(pRoomIndex);
         }
         return;
 }
 
+void link_room_index(ROOM_INDEX_DATA * pRoomIndex)
+{
+        int       iHash = pRoomIndex->vnum % MAX_KEY_HASH;
+
+        pRoomIndex->next = room_index_hash[iHash];
+        room_index_hash[iHash] = pRoomIndex;
+        room_index_table.set(pRoomIndex->vnum, pRoomIndex);
+        top_room++;
+}
+
 
 
 /*
@@ -2523,6 +2623,7 @@ void sort_exits(ROOM_INDEX_DATA * room)
                 else
                         exits[x]->next = exits[x + 1];
         }
+        index_exits(room);
 }
 
 void randomize_exits(ROOM_INDEX_DATA * room, sh_int maxdir)
@@ -2556,6 +2657,31 @@ void randomize_exits(ROOM_INDEX_DATA * room, sh_int maxdir)
 }
 
 
+/*
+ * Areas that are due for a reset.  area_update() only decides which areas
+ * are due; area_reset_update() runs them each pulse within
+ * sysdata.reset_budget, so a PULSE_AREA that catches many areas at once
+ * no longer stalls the game loop.
+ */
+static std::deque<AREA_DATA *> reset_queue;
+
+static void run_area_reset(AREA_DATA * pArea)
+{
+        ROOM_INDEX_DATA *pRoomIndex;
+        int       reset_age =
+                pArea->reset_frequency ? pArea->reset_frequency : 15;
+
+        reset_area(pArea);
+        if (reset_age == -1)
+                pArea->age = -1;
+        else
+                pArea->age = number_range(0, reset_age / 5);
+        pRoomIndex = get_room_index(ROOM_VNUM_SCHOOL);
+        if (pRoomIndex != NULL && pArea == pRoomIndex->area
+            && pArea->reset_frequency == 0)
+                pArea->age = 15 - 3;
+}
+
 /*
  * Repopulate areas periodically.
  */
@@ -2569,6 +2695,9 @@ void area_update(void)
                 int       reset_age =
                         pArea->reset_frequency ? pArea->reset_frequency : 15;
 
+                if (pArea->reset_queued)
+                        continue;
+
                 if ((reset_age == -1 && pArea->age == -1)
                     || ++pArea->age < (reset_age - 1))
                         continue;
@@ -2589,11 +2718,10 @@ void area_update(void)
                                 mudstrlcpy(buf,
                                            "You hear some squeaking sounds...\n\r",
                                            MSL);
-                        for (pch = first_char; pch; pch = pch->next)
+                        for (pch = pArea->first_person; pch;
+                             pch = pch->next_in_area)
                         {
-                                if (!IS_NPC(pch) && IS_AWAKE(pch)
-                                    && pch->in_room
-                                    && pch->in_room->area == pArea)
+                                if (IS_AWAKE(pch))
                                 {
                                         set_char_color(AT_RESET, pch);
                                         send_to_char(buf, pch);
@@ -2604,25 +2732,84 @@ void area_update(void)
                 /*
                  * Check age and reset.
                  * Note: Mud Academy resets every 3 minutes (not 15).
+                 * Boot resets everything at once, afterwards resets are
+                 * queued for area_reset_update().
                  */
                 if (pArea->nplayer == 0 || pArea->age >= reset_age)
                 {
-                        ROOM_INDEX_DATA *pRoomIndex;
-
-                        reset_area(pArea);
-                        if (reset_age == -1)
-                                pArea->age = -1;
-                        else
-                                pArea->age = number_range(0, reset_age / 5);
-                        pRoomIndex = get_room_index(ROOM_VNUM_SCHOOL);
-                        if (pRoomIndex != NULL && pArea == pRoomIndex->area
-                            && pArea->reset_frequency == 0)
-                                pArea->age = 15 - 3;
+                        if (fBootDb)
+                        {
+                                run_area_reset(pArea);
+                                continue;
+                        }
+                        pArea->reset_queued = TRUE;
+                        reset_queue.push_back(pArea);
                 }
         }
         return;
 }
 
+/*
+ * Run queued area resets, called every pulse.  Empty areas go first since
+ * nobody can see them repopulate; at least one area is reset per pulse and
+ * more only while the time budget lasts.
+ */
+void area_reset_update(void)
+{
+        std::deque<AREA_DATA *>::iterator it;
+        struct timeval start_time;
+        struct timeval now_time;
+        AREA_DATA *pArea;
+        long      budget;
+        bool      first = TRUE;
+
+        if (reset_queue.empty())
+                return;
+
+        budget = (sysdata.reset_budget > 0 ? sysdata.reset_budget :
+                  RESET_BUDGET_DEFAULT) * 1000L;
+        gettimeofday(&start_time, NULL);
+        while (!reset_queue.empty())
+        {
+                if (!first)
+                {
+                        gettimeofday(&now_time, NULL);
+                        if ((now_time.tv_sec - start_time.tv_sec) * 1000000L
+                            + (now_time.tv_usec - start_time.tv_usec) >=
+                            budget)
+                                break;
+                }
+                for (it = reset_queue.begin(); it != reset_queue.end(); ++it)
+                        if ((*it)->nplayer == 0)
+                                break;
+                if (it == reset_queue.end())
+                        it = reset_queue.begin();
+                pArea = *it;
+                reset_queue.erase(it);
+                pArea->reset_queued = FALSE;
+                run_area_reset(pArea);
+                first = FALSE;
+        }
+}
+
+/*
+ * Drop an area from the reset queue, for areas about to be freed.
+ */
+void cancel_area_reset(AREA_DATA * pArea)
+{
+        std::deque<AREA_DATA *>::iterator it;
+
+        if (!pArea->reset_queued)
+                return;
+        for (it = reset_queue.begin(); it != reset_queue.end(); ++it)
+                if (*it == pArea)
+                {
+                        reset_queue.erase(it);
+                        break;
+                }
+        pArea->reset_queued = FALSE;
+}
+
 
 /*
  * Create an instance of a mobile.
@@ -2934,6 +3121,8 @@ OBJ_DATA *create_object(OBJ_INDEX_DATA * pObjIndex, int level)
         }
 
         LINK(obj, first_object, last_object, next, prev);
+        LINK(obj, pObjIndex->first_instance, pObjIndex->last_instance,
+             next_instance, prev_instance);
         ++pObjIndex->count;
         ++numobjsloaded;
         ++physicalobjects;
@@ -3198,7 +3387,7 @@ char     *get_extra_descr(const char *name, EXTRA_DESCR_DATA * ed)
 
 /*
  * Translates mob virtual number to its mob index struct.
- * Hash table lookup.
+ * Direct vnum table lookup.
  */
 MOB_INDEX_DATA *get_mob_index(int vnum)
 {
@@ -3207,10 +3396,8 @@ MOB_INDEX_DATA *get_mob_index(int vnum)
         if (vnum < 0)
                 vnum = 0;
 
-        for (pMobIndex = mob_index_hash[vnum % MAX_KEY_HASH]; pMobIndex;
-             pMobIndex = pMobIndex->next)
-                if (pMobIndex->vnum == vnum)
-                        return pMobIndex;
+        if ((pMobIndex = mob_index_table.get(vnum)) != NULL)
+                return pMobIndex;
 
         if (fBootDb)
                 bug("Get_mob_index: bad vnum %d.", vnum);
@@ -3222,7 +3409,7 @@ MOB_INDEX_DATA *get_mob_index(int vnum)
 
 /*
  * Translates obj virtual number to its obj index struct.
- * Hash table lookup.
+ * Direct vnum table lookup.
  */
 OBJ_INDEX_DATA *get_obj_index(int vnum)
 {
@@ -3231,10 +3418,8 @@ OBJ_INDEX_DATA *get_obj_index(int vnum)
         if (vnum < 0)
                 vnum = 0;
 
-        for (pObjIndex = obj_index_hash[vnum % MAX_KEY_HASH]; pObjIndex;
-             pObjIndex = pObjIndex->next)
-                if (pObjIndex->vnum == vnum)
-                        return pObjIndex;
+        if ((pObjIndex = obj_index_table.get(vnum)) != NULL)
+                return pObjIndex;
 
         if (fBootDb)
                 bug("Get_obj_index: bad vnum %d.", vnum);
@@ -3246,7 +3431,7 @@ OBJ_INDEX_DATA *get_obj_index(int vnum)
 
 /*
  * Translates room virtual number to its room index struct.
- * Hash table lookup.
+ * Direct vnum table lookup.
  */
 ROOM_INDEX_DATA *get_room_index(int vnum)
 {
@@ -3255,10 +3440,8 @@ ROOM_INDEX_DATA *get_room_index(int vnum)
         if (vnum < 0)
                 vnum = 0;
 
-        for (pRoomIndex = room_index_hash[vnum % MAX_KEY_HASH]; pRoomIndex;
-             pRoomIndex = pRoomIndex->next)
-                if (pRoomIndex->vnum == vnum)
-                        return pRoomIndex;
+        if ((pRoomIndex = room_index_table.get(vnum)) != NULL)
+                return pRoomIndex;
 
         if (fBootDb)
                 bug("Get_room_index: bad vnum %d.", vnum);
@@ -3521,7 +3704,7 @@ long fread_long(FILE * fp)
  */
 char     *str_dup(char const *str)
 {
-        static char *ret;
+        char     *ret;
         int       len;
 
         if (!str)
@@ -3689,7 +3872,7 @@ char     *fread_string_nohash(FILE * fp)
  */
 char     *fread_string_noalloc(FILE * fp)
 {
-        static char buf[MAX_STRING_LENGTH];
+        static thread_local char buf[MAX_STRING_LENGTH];
         char     *plast;
         char      c;
         int       ln;
@@ -3795,7 +3978,7 @@ void fread_to_eol(FILE * fp)
  */
 char     *fread_line(FILE * fp)
 {
-        static char line[MAX_STRING_LENGTH];
+        static thread_local char line[MAX_STRING_LENGTH];
         char     *pline;
         char      c;
         int       ln;
@@ -3862,7 +4045,7 @@ char     *fread_line(FILE * fp)
  */
 char     *fread_word(FILE * fp)
 {
-        static char word[MAX_INPUT_LENGTH];
+        static thread_local char word[MAX_INPUT_LENGTH];
         char     *pword;
         char      cEnd;
 
@@ -4335,6 +4518,19 @@ char     *strupper(const char *str)
         return strup;
 }
 
+/*
+ * Lowercased copy of a name, for case-insensitive index keys.  Unlike
+ * strlower() there's no static buffer and no length limit.
+ */
+std::string lower_key(const char *str)
+{
+        std::string key;
+
+        for (; *str != '\0'; str++)
+                key += static_cast < char >(LOWER(*str));
+        return key;
+}
+
 /*
  * Returns TRUE or FALSE if a letter is a vowel			-Thoric
  */
@@ -4378,24 +4574,19 @@ char     *aoran(const char *str)
  */
 void append_file(CHAR_DATA * ch, char *file, char *str)
 {
-        FILE     *fp;
+        char      buf[MAX_STRING_LENGTH];
 
         if (IS_NPC(ch) || str[0] == '\0')
                 return;
 
-        FCLOSE(fpLOG);
-        if ((fp = fopen(file, "a")) == NULL)
+        if (!log_writable(file))
         {
                 send_to_char("Could not open the file!\n\r", ch);
+                return;
         }
-        else
-        {
-                fprintf(fp, "[%5d] %s: %s\n",
-                        ch->in_room ? ch->in_room->vnum : 0, ch->name, str);
-                FCLOSE(fp);
-        }
-
-        fpLOG = fopen(NULL_FILE, "r");
+        snprintf(buf, MSL, "[%5d] %s: %s",
+                 ch->in_room ? ch->in_room->vnum : 0, ch->name, str);
+        log_record_to(file, buf, LOGSEV_INFO, LOG_NORMAL);
         return;
 }
 
@@ -4404,17 +4595,7 @@ void append_file(CHAR_DATA * ch, char *file, char *str)
  */
 void append_to_file(char *file, char *str)
 {
-        FILE     *fp;
-
-        if ((fp = fopen(file, "a")) == NULL)
-        {
-        }
-        else
-        {
-                fprintf(fp, "%s\n", str);
-                FCLOSE(fp);
-        }
-
+        log_record_to(file, str, LOGSEV_INFO, LOG_NORMAL);
         return;
 }
 
@@ -4425,8 +4606,6 @@ void append_to_file(char *file, char *str)
 void bug(const char *str, ...)
 {
         char      buf[MAX_STRING_LENGTH];
-        FILE     *fp;
-        struct stat fst;
 #if !defined(__CYGWIN__) && !defined(__FreeBSD__)
         void *array[20];
         size_t size, i;
@@ -4456,15 +4635,14 @@ void bug(const char *str, ...)
 
                 snprintf(buf, MSL, "[*****] FILE: %s LINE: %d", strArea,
                                 iLine);
-                log_string(buf);
-
-                if (stat(SHUTDOWN_FILE, &fst) != -1)
+                log_string_sev(buf, LOG_NORMAL, LEVEL_LOG, LOGSEV_BUG);
                 {
-                        if ((fp = fopen(SHUTDOWN_FILE, "a")) != NULL)
-                        {
-                                fprintf(fp, "[*****] %s\n", buf);
-                                FCLOSE(fp);
-                        }
+                        char      shutdown_line[MAX_STRING_LENGTH + 8];
+
+                        snprintf(shutdown_line, sizeof(shutdown_line),
+                                 "[*****] %s", buf);
+                        log_record_existing(SHUTDOWN_FILE, shutdown_line,
+                                            LOGSEV_BUG, LOG_NORMAL);
                 }
         }
 
@@ -4478,7 +4656,7 @@ void bug(const char *str, ...)
         }
         if (fBootDb)
                 boot_log(buf);
-        log_string(buf);
+        log_string_sev(buf, LOG_NORMAL, LEVEL_LOG, LOGSEV_BUG);
 #if !defined(__CYGWIN__) && !defined(__FreeBSD__)
         if( !fBootDb && sysdata.DEBUG )
         {
@@ -4502,23 +4680,14 @@ void bug(const char *str, ...)
 void boot_log(const char *str, ...)
 {
         char      buf[MAX_STRING_LENGTH];
-        FILE     *fp;
         va_list   param;
 
         mudstrlcpy(buf, "[*****] BOOT: ", MSL);
         va_start(param, str);
         vsnprintf(buf + strlen(buf), MSL, str, param);
         va_end(param);
-        log_string(buf);
-
-        FCLOSE(fpLOG);
-        if ((fp = fopen(BOOTLOG_FILE, "a")) != NULL)
-        {
-                fprintf(fp, "%s\n", buf);
-                FCLOSE(fp);
-        }
-        fpLOG = fopen(NULL_FILE, "r");
-
+        log_string_sev(buf, LOG_NORMAL, LEVEL_LOG, LOGSEV_BOOT);
+        log_record_to(BOOTLOG_FILE, buf, LOGSEV_BOOT, LOG_NORMAL);
         return;
 }
 
@@ -4586,12 +4755,19 @@ CMDF do_dmesg(CHAR_DATA * ch, char *argument)
  */
 void log_string_plus(const char *str, sh_int log_type, sh_int level)
 {
-        char     *strtime;
+        log_string_sev(str, log_type, level, LOGSEV_INFO);
+}
+
+/*
+ * The file half is queued for the log writer; only the echo to the log
+ * channels happens here.
+ */
+void log_string_sev(const char *str, sh_int log_type, sh_int level,
+                    int severity)
+{
         int       offset;
 
-        strtime = ctime(&current_time);
-        strtime[strlen(strtime) - 1] = '\0';
-        fprintf(stderr, "%s :: %s\n", strtime, str);
+        log_record_main(str, severity, log_type);
         if (strncmp(str, "Log ", 4) == 0)
                 offset = 4;
         else
@@ -5807,6 +5983,7 @@ bool delete_room(ROOM_INDEX_DATA * room)
 
         if (!room)
                 return FALSE;
+        invalidate_reset_progs();
         wipe_resets(room->area, room);
 
         iHash = room->vnum % MAX_KEY_HASH;
@@ -5834,6 +6011,7 @@ bool delete_room(ROOM_INDEX_DATA * room)
         {
                 room_index_hash[iHash] = room->next;
         }
+        room_index_table.remove(room->vnum, room);
 
         /*
          * Free up the ram for all strings attached to the room. 
@@ -5882,20 +6060,17 @@ bool delete_obj(OBJ_INDEX_DATA * obj)
 {
         int       hash;
         OBJ_INDEX_DATA *prev;
-        OBJ_DATA *o, *o_next;
+        OBJ_DATA *o;
         EXTRA_DESCR_DATA *ed;
         AFFECT_DATA *af;
         MPROG_DATA *mp;
 
+        invalidate_reset_progs();
         /*
          * Remove references to object index 
          */
-        for (o = first_object; o; o = o_next)
-        {
-                o_next = o->next;
-                if (o->pIndexData == obj)
-                        extract_obj(o);
-        }
+        while ((o = obj->first_instance) != NULL)
+                extract_obj(o);
         while ((ed = obj->first_extradesc) != NULL)
         {
                 obj->first_extradesc = ed->next;
@@ -5936,6 +6111,8 @@ bool delete_obj(OBJ_INDEX_DATA * obj)
                         bug("delete_obj: object %d not in hash bucket %d.",
                             obj->vnum, hash);
         }
+        obj_index_table.remove(obj->vnum, obj);
+        search_invalidate();
         DISPOSE(obj);
         --top_obj_index;
         return TRUE;
@@ -5949,6 +6126,7 @@ bool delete_mob(MOB_INDEX_DATA * mob)
         CHAR_DATA *ch, *ch_next;
         MPROG_DATA *mp;
 
+        invalidate_reset_progs();
         for (ch = first_char; ch; ch = ch_next)
         {
                 ch_next = ch->next;
@@ -6002,6 +6180,8 @@ bool delete_mob(MOB_INDEX_DATA * mob)
                         bug("delete_mob: mobile %d not in hash bucket %d.",
                             mob->vnum, hash);
         }
+        mob_index_table.remove(mob->vnum, mob);
+        search_invalidate();
         DISPOSE(mob);
         --top_mob_index;
         return TRUE;
@@ -6018,6 +6198,7 @@ ROOM_INDEX_DATA *make_room( int vnum, AREA_DATA *area )
         int       iHash;
 
         CREATE(pRoomIndex, ROOM_INDEX_DATA, 1);
+        invalidate_reset_progs();
         pRoomIndex->first_person = NULL;
         pRoomIndex->last_person = NULL;
         pRoomIndex->first_content = NULL;
@@ -6035,11 +6216,13 @@ ROOM_INDEX_DATA *make_room( int vnum, AREA_DATA *area )
         pRoomIndex->light = 0;
         pRoomIndex->first_exit = NULL;
         pRoomIndex->last_exit = NULL;
+        index_exits(pRoomIndex);
 		pRoomIndex->home = NULL;
 
         iHash = vnum % MAX_KEY_HASH;
         pRoomIndex->next = room_index_hash[iHash];
         room_index_hash[iHash] = pRoomIndex;
+        room_index_table.set(vnum, pRoomIndex);
         top_room++;
 
         return pRoomIndex;
@@ -6060,6 +6243,7 @@ OBJ_INDEX_DATA *make_object(int vnum, int cvnum, char *name)
         else
                 cObjIndex = NULL;
         CREATE(pObjIndex, OBJ_INDEX_DATA, 1);
+        invalidate_reset_progs();
         pObjIndex->vnum = vnum;
         pObjIndex->name = STRALLOC(name);
         pObjIndex->first_affect = NULL;
@@ -6133,6 +6317,8 @@ OBJ_INDEX_DATA *make_object(int vnum, int cvnum, char *name)
         iHash = vnum % MAX_KEY_HASH;
         pObjIndex->next = obj_index_hash[iHash];
         obj_index_hash[iHash] = pObjIndex;
+        obj_index_table.set(vnum, pObjIndex);
+        search_invalidate();
         top_obj_index++;
 
         return pObjIndex;
@@ -6153,6 +6339,7 @@ MOB_INDEX_DATA *make_mobile(int vnum, int cvnum, char *name)
         else
                 cMobIndex = NULL;
         CREATE(pMobIndex, MOB_INDEX_DATA, 1);
+        invalidate_reset_progs();
         pMobIndex->vnum = vnum;
         pMobIndex->count = 0;
         pMobIndex->killed = 0;
@@ -6257,6 +6444,8 @@ MOB_INDEX_DATA *make_mobile(int vnum, int cvnum, char *name)
         iHash = vnum % MAX_KEY_HASH;
         pMobIndex->next = mob_index_hash[iHash];
         mob_index_hash[iHash] = pMobIndex;
+        mob_index_table.set(vnum, pMobIndex);
+        search_invalidate();
         top_mob_index++;
 
         return pMobIndex;
@@ -6311,7 +6500,8 @@ EXIT_DATA *make_exit(ROOM_INDEX_DATA * pRoomIndex, ROOM_INDEX_DATA * to_room,
                         pexit->prev = texit->prev;
                         pexit->next = texit;
                         texit->prev = pexit;
-                        top_exit++;
+                        BOOT_TALLY(top_exit);
+                        index_exits(pRoomIndex);
                         return pexit;
                 }
                 pRoomIndex->last_exit->next = pexit;
@@ -6319,7 +6509,8 @@ EXIT_DATA *make_exit(ROOM_INDEX_DATA * pRoomIndex, ROOM_INDEX_DATA * to_room,
         pexit->next = NULL;
         pexit->prev = pRoomIndex->last_exit;
         pRoomIndex->last_exit = pexit;
-        top_exit++;
+        BOOT_TALLY(top_exit);
+        index_exits(pRoomIndex);
         return pexit;
 }
 
@@ -6478,6 +6669,15 @@ void load_area_file(AREA_DATA * tarea, char *filename)
         }
         FCLOSE(fpArea);
         fpArea = NULL;
+        load_area_done(tarea, filename);
+}
+
+/*
+ * Finish off an area once all of its file has been read.
+ */
+void load_area_done(AREA_DATA * tarea, char *filename)
+{
+        invalidate_reset_progs();
         if (tarea)
         {
                 if (fBootDb)
@@ -6497,6 +6697,249 @@ void load_area_file(AREA_DATA * tarea, char *filename)
                 boot_log("(%s)", filename);
 }
 
+/*
+ * Skip a section on a boot worker, leaving fp on the '#' that opens the
+ * next one.
+ */
+static void boot_skip_section(FILE * fp)
+{
+        int       c;
+        bool      bol = FALSE;
+
+        while ((c = getc(fp)) != EOF)
+        {
+                if (c == '\n')
+                        bol = TRUE;
+                else if (c == '#' && bol)
+                {
+                        ungetc(c, fp);
+                        return;
+                }
+                else if (!isspace(c))
+                        bol = FALSE;
+        }
+}
+
+static void boot_add_section(BOOT_STAGE * stage, int type, AREA_DATA * area,
+                             BOOT_LOADER * loader, long offset)
+{
+        boot_section section;
+
+        section.type = type;
+        section.area = area;
+        section.loader = loader;
+        section.offset = offset;
+        stage->sections.push_back(section);
+}
+
+/*
+ * Parse an area file into its staging record on a boot worker.  This is
+ * load_area_file() with everything that touches the world left for
+ * boot_link_area(): areas, helps, mobiles, objects and rooms are queued
+ * on the record, and the sections that look things up by vnum are only
+ * noted, to be read again once everything before them is linked.
+ *
+ * Any file this cannot stage (it could not be opened, or it adds to the
+ * previous file's area) is marked serial and left to load_area_file().
+ */
+void boot_parse_area(BOOT_STAGE * stage)
+{
+        AREA_DATA *tarea = NULL;
+        BOOT_LOADER *loader;
+
+        boot_stage = stage;
+        mudstrlcpy(strArea, stage->filename.c_str(), MIL);
+        if ((fpArea = fopen(strArea, "r")) == NULL)
+        {
+                stage->serial = TRUE;
+                boot_stage = NULL;
+                return;
+        }
+
+        for (;;)
+        {
+                char     *word;
+
+                if (fread_letter(fpArea) != '#')
+                {
+                        bug(strArea);
+                        bug("load_area: # not found.");
+                        exit(1);
+                }
+
+                word = fread_word(fpArea);
+
+                if (word[0] == '$')
+                        break;
+
+                if (!str_cmp(word, "HELPS"))
+                {
+                        boot_add_section(stage, BOOT_SECTION_HELPS, tarea,
+                                         NULL, 0);
+                        load_helps(tarea, fpArea);
+                        continue;
+                }
+                if (!str_cmp(word, "AREA"))
+                {
+                        boot_add_section(stage, BOOT_SECTION_AREA, NULL,
+                                         NULL, 0);
+                        load_area(fpArea);
+                        tarea = stage->sections.back().area = stage->area;
+                        continue;
+                }
+                if (!tarea)
+                {
+                        stage->serial = TRUE;
+                        break;
+                }
+
+                loader = NULL;
+                if (!str_cmp(word, "AUTHOR"))
+                        load_author(tarea, fpArea);
+                else if (!str_cmp(word, "VERSION"))
+                        tarea->version = fread_number(fpArea);
+                else if (!str_cmp(word, "FLAGS"))
+                        load_flags(tarea, fpArea);
+                else if (!str_cmp(word, "RANGES"))
+                        load_ranges(tarea, fpArea);
+                else if (!str_cmp(word, "ECONOMY"))
+                        load_economy(tarea, fpArea);
+                else if (!str_cmp(word, "RESETMSG"))
+                        load_resetmsg(tarea, fpArea);
+                else if (!str_cmp(word, "MOBILES"))
+                {
+                        boot_add_section(stage, BOOT_SECTION_MOBILES, tarea,
+                                         NULL, 0);
+                        load_mobiles(tarea, fpArea);
+                }
+                else if (!str_cmp(word, "OBJECTS"))
+                {
+                        boot_add_section(stage, BOOT_SECTION_OBJECTS, tarea,
+                                         NULL, 0);
+                        load_objects(tarea, fpArea);
+                }
+                else if (!str_cmp(word, "ROOMS"))
+                {
+                        boot_add_section(stage, BOOT_SECTION_ROOMS, tarea,
+                                         NULL, 0);
+                        load_rooms(tarea, fpArea);
+                }
+                else if (!str_cmp(word, "MUDPROGS"))
+                        loader = load_mudprogs;
+                else if (!str_cmp(word, "OBJPROGS"))
+                        loader = load_objprogs;
+                else if (!str_cmp(word, "RESETS"))
+                        loader = load_resets;
+                else if (!str_cmp(word, "SHOPS"))
+                        loader = load_shops;
+                else if (!str_cmp(word, "REPAIRS"))
+                        loader = load_repairs;
+                else if (!str_cmp(word, "SPECIALS"))
+                        loader = load_specials;
+                else
+                {
+                        bug(tarea->filename);
+                        bug("load_area: bad section name.");
+                        exit(1);
+                }
+
+                if (loader)
+                {
+                        boot_add_section(stage, BOOT_SECTION_DEFERRED, tarea,
+                                         loader, ftell(fpArea));
+                        boot_skip_section(fpArea);
+                }
+        }
+        FCLOSE(fpArea);
+        fpArea = NULL;
+        boot_stage = NULL;
+}
+
+/*
+ * Link a parsed area file into the world on the game thread, in the
+ * order load_area_file() would have.
+ */
+void boot_link_area(BOOT_STAGE * stage)
+{
+        AREA_DATA *tarea = last_area;
+        char      filename[MAX_INPUT_LENGTH];
+
+        mudstrlcpy(filename, stage->filename.c_str(), MIL);
+        if (stage->serial)
+        {
+                mudstrlcpy(strArea, filename, MIL);
+                load_area_file(last_area, strArea);
+                return;
+        }
+
+        for (boot_section & section:stage->sections)
+        {
+                switch (section.type)
+                {
+                case BOOT_SECTION_AREA:
+                        LINK(section.area, first_area, last_area, next, prev);
+                        top_area++;
+                        tarea = section.area;
+                        break;
+                case BOOT_SECTION_HELPS:
+                        for (HELP_DATA * pHelp:section.helps)
+                                link_help(pHelp);
+                        break;
+                case BOOT_SECTION_MOBILES:
+                        for (MOB_INDEX_DATA * pMobIndex:section.mobs)
+                        {
+                                if (mob_index_table.get(pMobIndex->vnum))
+                                {
+                                        bug("Load_mobiles: vnum %d duplicated.", pMobIndex->vnum);
+                                        shutdown_mud("duplicate vnum");
+                                }
+                                link_mob_index(pMobIndex);
+                        }
+                        break;
+                case BOOT_SECTION_OBJECTS:
+                        for (OBJ_INDEX_DATA * pObjIndex:section.objs)
+                        {
+                                if (obj_index_table.get(pObjIndex->vnum))
+                                {
+                                        bug("Load_objects: vnum %d duplicated.", pObjIndex->vnum);
+                                        shutdown_mud("duplicate vnum");
+                                }
+                                link_obj_index(pObjIndex);
+                        }
+                        break;
+                case BOOT_SECTION_ROOMS:
+                        for (ROOM_INDEX_DATA * pRoomIndex:section.rooms)
+                        {
+                                if (room_index_table.get(pRoomIndex->vnum))
+                                {
+                                        bug("Load_rooms: vnum %d duplicated.", pRoomIndex->vnum);
+                                        shutdown_mud("duplicate vnum");
+                                }
+                                link_room_index(pRoomIndex);
+                        }
+                        break;
+                case BOOT_SECTION_DEFERRED:
+                        mudstrlcpy(strArea, filename, MIL);
+                        if ((fpArea = fopen(strArea, "r")) == NULL)
+                        {
+                                bug("load_area: error loading file (can't open)");
+                                bug(filename);
+                                exit(1);
+                        }
+                        fseek(fpArea, section.offset, SEEK_SET);
+                        section.loader(section.area, fpArea);
+                        FCLOSE(fpArea);
+                        fpArea = NULL;
+                        break;
+                }
+        }
+
+        top_affect += stage->top_affect;
+        top_ed += stage->top_ed;
+        top_exit += stage->top_exit;
+        load_area_done(tarea, filename);
+}
+
 
 
 /* Build list of in_progress areas.  Do not load areas.
@@ -6875,6 +7318,8 @@ void save_sysdata(SYSTEM_DATA sys)
                 fprintf(fp, "Channellog		 %d\n", sys.channellog);
                 fprintf(fp, "Web   		 %d\n", sys.web);
                 fprintf(fp, "DEBUG		 %d\n", sys.DEBUG);
+                fprintf(fp, "Bootthreads    %d\n", sys.boot_threads);
+                fprintf(fp, "Resetbudget    %d\n", sys.reset_budget);
                 fprintf(fp, "End\n\n");
                 fprintf(fp, "#END\n");
                 FCLOSE(fp);
@@ -6912,6 +7357,8 @@ void fread_sysdata(SYSTEM_DATA * sys, FILE * fp)
                             fread_number(fp));
                         KEY("BanRaceLevel", sys->ban_race_level,
                             fread_number(fp));
+                        KEY("Bootthreads", sys->boot_threads,
+                            fread_number(fp));
                         break;
                 case 'C':
                         KEY("Channellog", sys->channellog, fread_number(fp));
@@ -6992,6 +7439,8 @@ void fread_sysdata(SYSTEM_DATA * sys, FILE * fp)
                             fread_number(fp));
                         KEY("Regular_purge", sys->regular_purge,
                             fread_number(fp));
+                        KEY("Resetbudget", sys->reset_budget,
+                            fread_number(fp));
                         break;
 
                 case 'S':
@@ -60,6 +60,7 @@
 #endif
 #include "space2.hpp"
 #include "installations.hpp"
+#include "economy.hpp"
 
 
 void write_ship_list args((void));
@@ -299,21 +300,9 @@ CMDF do_designship(CHAR_DATA * ch, char *argument)
                         return;
                 }
                 cost = 10;
-                if (planet->cargoimport[CARGO_TRANSPARISTEEL] > 0)
-                        cost += planet->cargoimport[CARGO_TRANSPARISTEEL] +
-                                planet->cargoimport[CARGO_TRANSPARISTEEL] / 2;
-                else if (planet->cargoexport[CARGO_TRANSPARISTEEL] > 0)
-                        cost += planet->cargoexport[CARGO_TRANSPARISTEEL];
-                else
-                        cost += 10;
+                cost += economy_material_price(planet, CARGO_TRANSPARISTEEL);
 
-                if (planet->cargoimport[CARGO_DURASTEEL] > 0)
-                        cost += planet->cargoimport[CARGO_DURASTEEL] +
-                                planet->cargoimport[CARGO_DURASTEEL] / 2;
-                else if (planet->cargoexport[CARGO_DURASTEEL] > 0)
-                        cost += planet->cargoexport[CARGO_DURASTEEL];
-                else
-                        cost += 10;
+                cost += economy_material_price(planet, CARGO_DURASTEEL);
 
                 cost *= durasteel + transparisteel;
                 fee = cost * ((ship_class * 5) / 100);
@@ -428,22 +417,10 @@ CMDF do_designship(CHAR_DATA * ch, char *argument)
         }
 
         cost = 10;
-        if (planet->cargoimport[CARGO_TRANSPARISTEEL] > 0)
-                cost += planet->cargoimport[CARGO_TRANSPARISTEEL] +
-                        planet->cargoimport[CARGO_TRANSPARISTEEL] / 2;
-        else if (planet->cargoexport[CARGO_TRANSPARISTEEL] > 0)
-                cost += planet->cargoexport[CARGO_TRANSPARISTEEL];
-        else
-                cost += 10;
+        cost += economy_material_price(planet, CARGO_TRANSPARISTEEL);
 
 
-        if (planet->cargoimport[CARGO_DURASTEEL] > 0)
-                cost += planet->cargoimport[CARGO_DURASTEEL] +
-                        planet->cargoimport[CARGO_DURASTEEL] / 2;
-        else if (planet->cargoexport[CARGO_DURASTEEL] > 0)
-                cost += planet->cargoexport[CARGO_DURASTEEL];
-        else
-                cost += 10;
+        cost += economy_material_price(planet, CARGO_DURASTEEL);
 
         cost *= durasteel + transparisteel;
         fee = cost * ((ship_class * 5) / 100);
@@ -456,8 +433,8 @@ CMDF do_designship(CHAR_DATA * ch, char *argument)
                 return;
         }
         ch->gold -= cost;
-        planet->resource[CARGO_TRANSPARISTEEL] -= transparisteel;
-        planet->resource[CARGO_DURASTEEL] -= durasteel;
+        economy_consume(planet, CARGO_TRANSPARISTEEL, transparisteel);
+        economy_consume(planet, CARGO_DURASTEEL, durasteel);
 
         checktool = FALSE;
         checkdura = FALSE;
@@ -1529,21 +1506,9 @@ void fleet_make(CHAR_DATA * ch, char *argument)
                         return;
                 }
                 cost = 10;
-                if (planet->cargoimport[CARGO_TRANSPARISTEEL] > 0)
-                        cost += planet->cargoimport[CARGO_TRANSPARISTEEL] +
-                                planet->cargoimport[CARGO_TRANSPARISTEEL] / 2;
-                else if (planet->cargoexport[CARGO_TRANSPARISTEEL] > 0)
-                        cost += planet->cargoexport[CARGO_TRANSPARISTEEL];
-                else
-                        cost += 10;
+                cost += economy_material_price(planet, CARGO_TRANSPARISTEEL);
 
-                if (planet->cargoimport[CARGO_DURASTEEL] > 0)
-                        cost += planet->cargoimport[CARGO_DURASTEEL] +
-                                planet->cargoimport[CARGO_DURASTEEL] / 2;
-                else if (planet->cargoexport[CARGO_DURASTEEL] > 0)
-                        cost += planet->cargoexport[CARGO_DURASTEEL];
-                else
-                        cost += 10;
+                cost += economy_material_price(planet, CARGO_DURASTEEL);
 
                 cost *= durasteel + transparisteel;
                 if (clan->funds < cost)
@@ -1641,22 +1606,10 @@ void fleet_make(CHAR_DATA * ch, char *argument)
         }
 
         cost = 10;
-        if (planet->cargoimport[CARGO_TRANSPARISTEEL] > 0)
-                cost += planet->cargoimport[CARGO_TRANSPARISTEEL] +
-                        planet->cargoimport[CARGO_TRANSPARISTEEL] / 2;
-        else if (planet->cargoexport[CARGO_TRANSPARISTEEL] > 0)
-                cost += planet->cargoexport[CARGO_TRANSPARISTEEL];
-        else
-                cost += 10;
+        cost += economy_material_price(planet, CARGO_TRANSPARISTEEL);
 
 
-        if (planet->cargoimport[CARGO_DURASTEEL] > 0)
-                cost += planet->cargoimport[CARGO_DURASTEEL] +
-                        planet->cargoimport[CARGO_DURASTEEL] / 2;
-        else if (planet->cargoexport[CARGO_DURASTEEL] > 0)
-                cost += planet->cargoexport[CARGO_DURASTEEL];
-        else
-                cost += 10;
+        cost += economy_material_price(planet, CARGO_DURASTEEL);
 
         cost *= durasteel + transparisteel;
         if (clan->funds < cost)
@@ -1667,8 +1620,8 @@ void fleet_make(CHAR_DATA * ch, char *argument)
                 return;
         }
         clan->funds -= cost;
-        planet->resource[CARGO_TRANSPARISTEEL] -= transparisteel;
-        planet->resource[CARGO_DURASTEEL] -= durasteel;
+        economy_consume(planet, CARGO_TRANSPARISTEEL, transparisteel);
+        economy_consume(planet, CARGO_DURASTEEL, durasteel);
 
         snprintf(filename, MSL, "%s.mship", arg2);
 
@@ -444,7 +444,7 @@ void resolve_dns(DESCRIPTOR_DATA * d, long ip)
                 bug("resolve_dns: Exec failed; Closing child.", 0);
                 d->ifd = -1;
                 d->ipid = -1;
-                exit(0);
+                _exit(0);
         }
         else
         {
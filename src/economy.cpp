@@ -0,0 +1,288 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                            SWTFE Planetary Economy Module                             *
+ ****************************************************************************************/
+#include <sys/types.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include "mud.hpp"
+#include "persist.hpp"
+#include "economy.hpp"
+
+/*
+ * Stock bands.  Band b covers stock strictly between economy_floor[b]
+ * and economy_floor[b + 1]; stock of 1 or less, or sitting exactly on a
+ * floor, is band 0, as it always was.
+ */
+static const int economy_floor[ECONOMY_BANDS] = {
+        0, 1, 10, 100, 1000, 10000, 50000, 100000, 500000, 1000000
+};
+
+/* How strongly a band pulls in imports or pushes out exports */
+static const sh_int economy_import_weight[ECONOMY_BANDS] = {
+        0, 10, 9, 8, 7, 6, 5, 4, 3, 2
+};
+static const sh_int economy_export_weight[ECONOMY_BANDS] = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9
+};
+
+/* Planets still to be stepped before the hour is up */
+static std::deque < PLANET_DATA * >economy_due;
+static bool economy_primed;
+
+int economy_band(int stock)
+{
+        const int *floor;
+
+        if (stock <= economy_floor[1])
+                return 0;
+        floor = std::upper_bound(economy_floor, economy_floor + ECONOMY_BANDS,
+                                 stock);
+        if (floor[-1] == stock)
+                return 0;
+        return static_cast < int >(floor - economy_floor) - 1;
+}
+
+static bool economy_cargo(int cargo)
+{
+        return cargo > CARGO_NONE && cargo < CONTRABAND_MAX
+                && cargo != CARGO_MAX && cargo != CONTRABAND_NONE;
+}
+
+/*
+ * What the planet pays per ton delivered, 0 if it isn't buying.
+ */
+int economy_import_price(PLANET_DATA * planet, int cargo)
+{
+        return economy_cargo(cargo) ? planet->cargoimport[cargo] : 0;
+}
+
+/*
+ * What the planet charges per ton loaded, 0 if it isn't selling.
+ */
+int economy_export_price(PLANET_DATA * planet, int cargo)
+{
+        return economy_cargo(cargo) ? planet->cargoexport[cargo] : 0;
+}
+
+int economy_stock(PLANET_DATA * planet, int cargo)
+{
+        return economy_cargo(cargo) ? planet->resource[cargo] : 0;
+}
+
+/*
+ * Per ton price of building materials bought locally: scarce goods cost
+ * half again their import price, surplus goods their export price.
+ */
+int economy_material_price(PLANET_DATA * planet, int cargo)
+{
+        int       price;
+
+        if ((price = economy_import_price(planet, cargo)) > 0)
+                return price + price / 2;
+        if ((price = economy_export_price(planet, cargo)) > 0)
+                return price;
+        return 10;
+}
+
+/*
+ * Remove up to amount tons from the planet's stock, returning how much
+ * was actually there to take.
+ */
+int economy_take(PLANET_DATA * planet, int cargo, int amount)
+{
+        if (!economy_cargo(cargo) || amount <= 0)
+                return 0;
+        if (amount > planet->resource[cargo])
+                amount = UMAX(planet->resource[cargo], 0);
+        planet->resource[cargo] -= amount;
+        persist_mark(PERSIST_PLANET, planet->filename);
+        return amount;
+}
+
+/*
+ * Construction takes its materials whether or not the planet has them.
+ * A shortfall leaves the stock negative, and the next economy_step()
+ * answers that with an emergency import.
+ */
+void economy_consume(PLANET_DATA * planet, int cargo, int amount)
+{
+        if (!economy_cargo(cargo) || amount <= 0)
+                return;
+        planet->resource[cargo] -= amount;
+        persist_mark(PERSIST_PLANET, planet->filename);
+}
+
+/*
+ * One hour of trade for one planet.
+ */
+static void economy_step(PLANET_DATA * planet)
+{
+        char      buf[MAX_STRING_LENGTH];
+        bool      needy = FALSE, emergency = FALSE;
+        int       i, band, iv, ev;
+
+        for (i = 1; i < CARGO_MAX; i++)
+        {
+                band = economy_band(planet->resource[i]);
+                iv = economy_import_weight[band];
+                ev = economy_export_weight[band];
+                if (iv > ev)
+                {
+                        planet->cargoimport[i] =
+                                ((10 * i) * (iv)) +
+                                static_cast<int>(number_percent() * 0.1);
+                        planet->cargoexport[i] = 0;
+                        planet->produces[i] =
+                                static_cast<int>(1.6 * number_percent() * (iv - ev)) +
+                                (number_percent());
+                        planet->consumes[i] =
+                                (number_percent() * (iv - ev)) +
+                                (number_percent());
+                }
+                else
+                {
+                        planet->cargoexport[i] =
+                                ((10 * i) * (iv)) +
+                                static_cast<int>(number_percent() * 0.1);
+                        planet->cargoimport[i] = 0;
+                        planet->produces[i] =
+                                (number_percent() * (ev - iv)) +
+                                (number_percent());
+                        planet->consumes[i] =
+                                static_cast<int>(1.6 * number_percent() * (ev - iv)) +
+                                (number_percent());
+                }
+
+                planet->resource[i] += planet->produces[i];
+                planet->resource[i] -= planet->consumes[i];
+
+                if (planet->resource[i] < 10000 && planet->resource[i] > 0)
+                        needy = TRUE;
+                /*
+                 * Reset negative values to 1 and do emergency import stuff
+                 */
+                if (planet->resource[i] < 0)
+                {
+                        planet->resource[i] = 1;
+                        planet->cargoimport[i] =
+                                ((100 * i) + static_cast<int>(number_percent() * 0.1));
+                        planet->cargoexport[i] = 0;
+                        emergency = TRUE;
+                }
+        }
+
+        if (needy)
+        {
+                snprintf(buf, MSL, "Trade Alert: %s is in need of imports!",
+                         planet->name);
+                echo_to_all(AT_GOLD, buf, 0);
+        }
+        if (emergency)
+        {
+                snprintf(buf, MSL,
+                         "Trade Alert: %s is in need of emergency imports!",
+                         planet->name);
+                echo_to_all(AT_GOLD, buf, 0);
+        }
+
+        if (planet->governed_by)
+        {
+                planet->governed_by->funds += get_taxes(planet) / 360;
+                persist_mark(PERSIST_CLAN, planet->governed_by->filename);
+        }
+        persist_mark(PERSIST_PLANET, planet->filename);
+}
+
+static void economy_queue(void)
+{
+        PLANET_DATA *planet;
+
+        economy_due.clear();
+        for (planet = first_planet; planet; planet = planet->next)
+                economy_due.push_back(planet);
+        economy_primed = TRUE;
+}
+
+/*
+ * Called every pulse with the pulses left before the hour.  Steps just
+ * enough planets to keep pace.
+ */
+void economy_update(int pulses_left)
+{
+        size_t    count;
+
+        if (!economy_primed)
+                economy_queue();
+        if (economy_due.empty())
+                return;
+
+        count = (economy_due.size() + UMAX(pulses_left, 1) - 1)
+                / UMAX(pulses_left, 1);
+        while (count-- > 0 && !economy_due.empty())
+        {
+                economy_step(economy_due.front());
+                economy_due.pop_front();
+        }
+}
+
+/*
+ * The hour is up: step whoever is left and start the next hour.
+ */
+void economy_settle(void)
+{
+        if (!economy_primed)
+                economy_queue();
+        while (!economy_due.empty())
+        {
+                economy_step(economy_due.front());
+                economy_due.pop_front();
+        }
+        economy_queue();
+}
+
+/*
+ * The planet is going away.
+ */
+void economy_forget(PLANET_DATA * planet)
+{
+        economy_due.erase(std::remove(economy_due.begin(), economy_due.end(),
+                                      planet), economy_due.end());
+}
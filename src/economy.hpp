@@ -0,0 +1,74 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                            SWTFE Planetary Economy Module                             *
+ ****************************************************************************************/
+#ifndef _ECONOMY_H_
+#define _ECONOMY_H_
+
+/*
+ * Planetary trade.
+ *
+ * Once every PULSE_TAXES each planet's stock of each cargo moves a step.
+ * The stock falls into one of ECONOMY_BANDS price bands.  The band sets
+ * the import or export price and how much the planet produces and
+ * consumes.  The governing clan is paid its share of taxes in the same
+ * step.
+ *
+ * Planets used to be stepped all together on the hour.  Now
+ * economy_update() steps a few every pulse, so each planet has moved
+ * once by the time the hour is up.  economy_settle() runs on the hour,
+ * finishes any planets still due and queues them all for the next hour.
+ *
+ * Stock and prices still live in the PLANET_DATA arrays that planet
+ * files and setplanet use.  Commands should read and take them through
+ * the economy_* calls rather than doing the arithmetic themselves.
+ */
+#define ECONOMY_BANDS		10
+
+int       economy_band(int stock);
+int       economy_import_price(PLANET_DATA * planet, int cargo);
+int       economy_export_price(PLANET_DATA * planet, int cargo);
+int       economy_stock(PLANET_DATA * planet, int cargo);
+int       economy_material_price(PLANET_DATA * planet, int cargo);
+int       economy_take(PLANET_DATA * planet, int cargo, int amount);
+void      economy_consume(PLANET_DATA * planet, int cargo, int amount);
+void      economy_update(int pulses_left);
+void      economy_settle(void);
+void      economy_forget(PLANET_DATA * planet);
+
+#endif
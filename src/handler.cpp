@@ -44,6 +44,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "mud.hpp"
 #include "homes.hpp"
 #include "account.hpp"
@@ -51,6 +56,7 @@
 #include "races.hpp"
 #include "space2.hpp"
 #include "greet.hpp"
+#include "persist.hpp"
 
 
 #define BFS_MARK         1
@@ -1224,7 +1230,13 @@ void char_from_room(CHAR_DATA * ch)
                 UNLINK(ch, ch->in_room->area->first_person,
                                 ch->in_room->area->last_person, next_in_area,
                                 prev_in_area);
+                --ch->in_room->nplayer;
+                UNLINK(ch, ch->in_room->first_pc, ch->in_room->last_pc,
+                                next_in_kind, prev_in_kind);
         }
+        else
+                UNLINK(ch, ch->in_room->first_npc, ch->in_room->last_npc,
+                                next_in_kind, prev_in_kind);
 
         if ((obj = get_eq_char(ch, WEAR_LIGHT)) != NULL
                         && obj->item_type == ITEM_LIGHT
@@ -1236,6 +1248,8 @@ void char_from_room(CHAR_DATA * ch)
         ch->in_room = NULL;
         ch->next_in_room = NULL;
         ch->prev_in_room = NULL;
+        ch->next_in_kind = NULL;
+        ch->prev_in_kind = NULL;
 
         if (!IS_NPC(ch) && get_timer(ch, TIMER_SHOVEDRAG) > 0)
                 remove_timer(ch, TIMER_SHOVEDRAG);
@@ -1295,7 +1309,13 @@ void char_to_room(CHAR_DATA * ch, ROOM_INDEX_DATA * pRoomIndex)
                 LINK(ch, pRoomIndex->area->first_person,
                                 pRoomIndex->area->last_person, next_in_area,
                                 prev_in_area);
+                ++pRoomIndex->nplayer;
+                LINK(ch, pRoomIndex->first_pc, pRoomIndex->last_pc,
+                                next_in_kind, prev_in_kind);
         }
+        else
+                LINK(ch, pRoomIndex->first_npc, pRoomIndex->last_npc,
+                                next_in_kind, prev_in_kind);
 
         if ((obj = get_eq_char(ch, WEAR_LIGHT)) != NULL
                         && obj->item_type == ITEM_LIGHT && obj->value[2] != 0)
@@ -1363,6 +1383,7 @@ OBJ_DATA *obj_to_char(OBJ_DATA * obj, CHAR_DATA * ch)
                 obj->carried_by = ch;
                 obj->in_room = NULL;
                 obj->in_obj = NULL;
+                obj_reown(obj);
         }
         if (wear_loc == WEAR_NONE)
         {
@@ -1407,6 +1428,7 @@ void obj_from_char(OBJ_DATA * obj)
 
         obj->in_room = NULL;
         obj->carried_by = NULL;
+        obj_reown(obj);
 
         ch->carry_number -= get_obj_number(obj);
         ch->carry_weight -= get_obj_weight(obj);
@@ -1613,6 +1635,134 @@ void write_corpses args((CHAR_DATA * ch, char *name));
 
 int       falling;
 
+/*
+ * Homes save their contents, so queue a save when something in one of
+ * their rooms, or inside something there, comes or goes.
+ */
+static void home_contents_changed(OBJ_DATA * obj)
+{
+        while (obj->in_obj)
+                obj = obj->in_obj;
+        if (obj->in_room && obj->in_room->home)
+                persist_mark(PERSIST_HOME, obj->in_room->home->filename);
+}
+
+/*
+ * Live objects by owner, so "every corpse of X" or "everything in that
+ * home" doesn't walk first_object.  Keys are the OWNER_xxx type followed
+ * by the lowercased owner name; each list runs through next_owned.
+ * Only objects lying loose in a room or carried directly are indexed,
+ * except PC corpses, which stay with their owner wherever they go.
+ */
+struct owned_list
+{
+        OBJ_DATA *first;
+        OBJ_DATA *last;
+};
+
+static std::map < std::string, owned_list > owned_objects;
+
+static std::string owner_key(int type, const char *owner)
+{
+        return std::string(1, static_cast < char >('0' + type))
+                + lower_key(owner);
+}
+
+static int owner_of(OBJ_DATA * obj, char **owner)
+{
+        CHAR_DATA *ch;
+
+        if (obj->pIndexData->vnum == OBJ_VNUM_CORPSE_PC
+            && obj->short_descr && strlen(obj->short_descr) > 14)
+        {
+                *owner = obj->short_descr + 14;
+                return OWNER_CORPSE;
+        }
+        if ((ch = obj->carried_by) != NULL && IS_NPC(ch)
+            && ch->pIndexData->vnum == MOB_VNUM_VENDOR
+            && ch->owner && ch->owner[0] != '\0')
+        {
+                *owner = ch->owner;
+                return OWNER_VENDOR;
+        }
+        if (obj->in_room && obj->in_room->home
+            && obj->in_room->home->owner
+            && obj->in_room->home->owner[0] != '\0')
+        {
+                *owner = obj->in_room->home->owner;
+                return OWNER_HOME;
+        }
+        *owner = NULL;
+        return OWNER_NONE;
+}
+
+void obj_disown(OBJ_DATA * obj)
+{
+        std::map < std::string, owned_list >::iterator it;
+
+        if (obj->owner_type == OWNER_NONE)
+                return;
+
+        it = owned_objects.find(owner_key(obj->owner_type, obj->owner));
+        if (it != owned_objects.end())
+        {
+                UNLINK(obj, it->second.first, it->second.last, next_owned,
+                       prev_owned);
+                if (!it->second.first)
+                        owned_objects.erase(it);
+        }
+        else
+                bug("obj_disown: %s not listed under %s",
+                    obj->short_descr, obj->owner);
+
+        STRFREE(obj->owner);
+        obj->owner_type = OWNER_NONE;
+}
+
+/*
+ * Move obj to the owner list its place in the world calls for.
+ */
+void obj_reown(OBJ_DATA * obj)
+{
+        char     *owner;
+        int       type = owner_of(obj, &owner);
+
+        if (type == obj->owner_type
+            && (type == OWNER_NONE || !str_cmp(owner, obj->owner)))
+                return;
+
+        obj_disown(obj);
+        if (type == OWNER_NONE)
+                return;
+
+        owned_list & list = owned_objects[owner_key(type, owner)];
+
+        LINK(obj, list.first, list.last, next_owned, prev_owned);
+        obj->owner_type = static_cast < sh_int > (type);
+        obj->owner = STRALLOC(owner);
+}
+
+/*
+ * A room joined or left a home, or the home changed hands.
+ */
+void room_reown(ROOM_INDEX_DATA * room)
+{
+        OBJ_DATA *obj;
+
+        for (obj = room->first_content; obj; obj = obj->next_content)
+                obj_reown(obj);
+}
+
+OBJ_DATA *first_owned(int type, const char *owner)
+{
+        std::map < std::string, owned_list >::iterator it;
+
+        if (!owner || owner[0] == '\0')
+                return NULL;
+        it = owned_objects.find(owner_key(type, owner));
+        return it == owned_objects.end() ? NULL : it->second.first;
+}
+
 void obj_from_room(OBJ_DATA * obj)
 {
         ROOM_INDEX_DATA *in_room;
@@ -1623,6 +1773,9 @@ void obj_from_room(OBJ_DATA * obj)
                 return;
         }
 
+        if (in_room->home)
+                persist_mark(PERSIST_HOME, in_room->home->filename);
+
         UNLINK(obj, in_room->first_content, in_room->last_content,
                         next_content, prev_content);
 
@@ -1659,6 +1812,7 @@ void obj_from_room(OBJ_DATA * obj)
         obj->carried_by = NULL;
         obj->in_obj = NULL;
         obj->in_room = NULL;
+        obj_reown(obj);
         if (obj->pIndexData->vnum == OBJ_VNUM_CORPSE_PC && falling == 0)
                 write_corpses(NULL, obj->short_descr + 14);
         return;
@@ -1678,6 +1832,8 @@ OBJ_DATA *obj_to_room(OBJ_DATA * obj, ROOM_INDEX_DATA * pRoomIndex)
                 return obj;
         count = obj->count;
         item_type = obj->item_type;
+        if (pRoomIndex->home)
+                persist_mark(PERSIST_HOME, pRoomIndex->home->filename);
 
         for (otmp = pRoomIndex->first_content; otmp;
                         otmp = otmp->next_content)
@@ -1694,6 +1850,7 @@ OBJ_DATA *obj_to_room(OBJ_DATA * obj, ROOM_INDEX_DATA * pRoomIndex)
         obj->carried_by = NULL;
         obj->in_obj = NULL;
         obj->room_vnum = pRoomIndex->vnum;  /* hotboot tracker */
+        obj_reown(obj);
         if (item_type == ITEM_FIRE)
                 pRoomIndex->light += count;
         falling++;
@@ -1759,6 +1916,7 @@ OBJ_DATA *obj_to_obj(OBJ_DATA * obj, OBJ_DATA * obj_to)
                                 get_obj_weight(obj);
         }
 
+        home_contents_changed(obj_to);
         for (otmp = obj_to->first_content; otmp; otmp = otmp->next_content)
                 if ((oret = group_object(otmp, obj)) == otmp)
                         return oret;
@@ -1768,6 +1926,7 @@ OBJ_DATA *obj_to_obj(OBJ_DATA * obj, OBJ_DATA * obj_to)
         obj->in_obj = obj_to;
         obj->in_room = NULL;
         obj->carried_by = NULL;
+        obj_reown(obj);
 
         return obj;
 }
@@ -1786,6 +1945,7 @@ void obj_from_obj(OBJ_DATA * obj)
                 return;
         }
 
+        home_contents_changed(obj_from);
         UNLINK(obj, obj_from->first_content, obj_from->last_content,
                         next_content, prev_content);
 
@@ -1795,6 +1955,7 @@ void obj_from_obj(OBJ_DATA * obj)
         obj->in_obj = NULL;
         obj->in_room = NULL;
         obj->carried_by = NULL;
+        obj_reown(obj);
 
         for (; obj_from; obj_from = obj_from->in_obj)
                 if (obj_from->carried_by)
@@ -1886,6 +2047,9 @@ void extract_obj(OBJ_DATA * obj)
                 gobj_prev = obj->prev;
 
         UNLINK(obj, first_object, last_object, next, prev);
+        UNLINK(obj, obj->pIndexData->first_instance,
+               obj->pIndexData->last_instance, next_instance, prev_instance);
+        obj_disown(obj);
         /*
          * shove onto extraction queue 
          */
@@ -2009,6 +2173,14 @@ void extract_char(CHAR_DATA * ch, bool fPull)
                 if (wch->oreply == ch)
                         wch->oreply = NULL;
         }
+        if (fPull)
+        {
+                MISSILE_DATA *missile;
+
+                for (missile = first_missile; missile; missile = missile->next)
+                        if (missile->fired_by == ch)
+                                missile->fired_by = NULL;
+        }
 
         if (ch->holding)
         {
@@ -2036,6 +2208,12 @@ void extract_char(CHAR_DATA * ch, bool fPull)
 #endif
 
         UNLINK(ch, first_char, last_char, next, prev);
+        name_index_remove(ch);
+        if (ch->pIndexData
+            && (ch->prev_instance || ch->pIndexData->first_instance == ch))
+                UNLINK(ch, ch->pIndexData->first_instance,
+                       ch->pIndexData->last_instance, next_instance,
+                       prev_instance);
 
         if (ch->desc)
         {
@@ -2124,14 +2302,221 @@ CHAR_DATA *get_char_room(CHAR_DATA * ch, char *argument)
 }
 
 
+/*
+ * Name index for get_char_world and friends.  Every character in
+ * first_char is filed under each keyword of its name, as is_name2 splits
+ * it, and players are also filed under their whole name.  Lists are kept
+ * in first_char order (name_seq) so counted lookups like 2.guard pick
+ * the same victim a walk of first_char would.
+ */
+typedef std::vector < CHAR_DATA * >NAME_LIST;
+
+static std::map < std::string, NAME_LIST > char_keywords;
+static std::unordered_map < std::string, NAME_LIST > player_names;
+static unsigned long name_seq_top;
+
+static bool name_seq_less(CHAR_DATA * a, CHAR_DATA * b)
+{
+        return a->name_seq < b->name_seq;
+}
+
+static void name_list_add(NAME_LIST & list, CHAR_DATA * ch)
+{
+        if (list.empty() || list.back()->name_seq < ch->name_seq)
+                list.push_back(ch);
+        else
+                list.insert(std::lower_bound(list.begin(), list.end(), ch,
+                                             name_seq_less), ch);
+}
+
+static void name_list_remove(NAME_LIST & list, CHAR_DATA * ch)
+{
+        NAME_LIST::iterator it =
+                std::lower_bound(list.begin(), list.end(), ch,
+                                 name_seq_less);
+
+        if (it != list.end() && *it == ch)
+                list.erase(it);
+}
+
+/*
+ * File or unfile ch under the words of indexed_name.  Stops at the first
+ * empty word, as is_name2 does.
+ */
+static void name_index_file(CHAR_DATA * ch, bool fAdd)
+{
+        char      word[MAX_INPUT_LENGTH];
+        char     *names = ch->indexed_name;
+
+        if (!names)
+                return;
+
+        for (names = one_argument2(names, word); word[0] != '\0';
+             names = one_argument2(names, word))
+        {
+                std::string key = lower_key(word);
+
+                if (fAdd)
+                        name_list_add(char_keywords[key], ch);
+                else
+                {
+                        std::map < std::string, NAME_LIST >::iterator it =
+                                char_keywords.find(key);
+
+                        if (it == char_keywords.end())
+                                continue;
+                        name_list_remove(it->second, ch);
+                        if (it->second.empty())
+                                char_keywords.erase(it);
+                }
+        }
+
+        if (IS_NPC(ch))
+                return;
+
+        std::string key = lower_key(ch->indexed_name);
+
+        if (fAdd)
+                name_list_add(player_names[key], ch);
+        else
+        {
+                std::unordered_map < std::string, NAME_LIST >::iterator it =
+                        player_names.find(key);
+
+                if (it == player_names.end())
+                        return;
+                name_list_remove(it->second, ch);
+                if (it->second.empty())
+                        player_names.erase(it);
+        }
+}
+
+/*
+ * ch has just been linked onto the end of first_char.
+ */
+void name_index_add(CHAR_DATA * ch)
+{
+        if (ch->name_seq)
+        {
+                bug("name_index_add: %s already indexed", ch->name);
+                return;
+        }
+        ch->name_seq = ++name_seq_top;
+        ch->indexed_name = ch->name ? QUICKLINK(ch->name) : NULL;
+        name_index_file(ch, TRUE);
+}
+
+void name_index_remove(CHAR_DATA * ch)
+{
+        if (!ch->name_seq)
+                return;
+        name_index_file(ch, FALSE);
+        if (ch->indexed_name)
+                STRFREE(ch->indexed_name);
+        ch->name_seq = 0;
+}
+
+/*
+ * Call after changing the name of a character already in the world.
+ */
+void name_index_update(CHAR_DATA * ch)
+{
+        if (!ch->name_seq || ch->indexed_name == ch->name)
+                return;
+
+        name_index_file(ch, FALSE);
+        if (ch->indexed_name)
+                STRFREE(ch->indexed_name);
+        ch->indexed_name = ch->name ? QUICKLINK(ch->name) : NULL;
+        name_index_file(ch, TRUE);
+}
+
+/*
+ * A player in the game by exact name, linkdead or not.
+ */
+CHAR_DATA *get_player_world(const char *name)
+{
+        std::unordered_map < std::string, NAME_LIST >::iterator it;
+
+        if (!name || name[0] == '\0')
+                return NULL;
+        it = player_names.find(lower_key(name));
+        return it == player_names.end() ? NULL : it->second.front();
+}
+
+/*
+ * Everyone in first_char whose name could match arg, in first_char order.
+ * Callers still test each one with nifty_is_name or nifty_is_name_prefix.
+ * An arg with no first word matches everybody, so that falls back to the
+ * whole list.
+ */
+static void name_candidates(char *arg, int vnum, bool prefix,
+                            NAME_LIST & list)
+{
+        char      word[MAX_INPUT_LENGTH];
+        MOB_INDEX_DATA *pMobIndex;
+        CHAR_DATA *wch;
+        int       sources = 0;
+
+        list.clear();
+        one_argument2(arg, word);
+        if (word[0] == '\0')
+        {
+                for (wch = first_char; wch; wch = wch->next)
+                        list.push_back(wch);
+                return;
+        }
+
+        std::string key = lower_key(word);
+
+        if (!prefix)
+        {
+                std::map < std::string, NAME_LIST >::iterator it =
+                        char_keywords.find(key);
+
+                if (it != char_keywords.end())
+                {
+                        list = it->second;
+                        sources++;
+                }
+        }
+        else
+                for (std::map < std::string, NAME_LIST >::iterator it =
+                     char_keywords.lower_bound(key);
+                     it != char_keywords.end()
+                     && !it->first.compare(0, key.size(), key); ++it)
+                {
+                        list.insert(list.end(), it->second.begin(),
+                                    it->second.end());
+                        sources++;
+                }
+
+        if (vnum >= 0 && (pMobIndex = get_mob_index(vnum)) != NULL
+            && pMobIndex->first_instance)
+        {
+                for (wch = pMobIndex->first_instance; wch;
+                     wch = wch->next_instance)
+                        list.push_back(wch);
+                sources++;
+        }
+
+        if (sources > 1)
+        {
+                std::sort(list.begin(), list.end(), name_seq_less);
+                list.erase(std::unique(list.begin(), list.end()), list.end());
+        }
+}
+
 /*
  * Find a char in the world with nothing to check against.
  */
 CHAR_DATA *get_char_world_nocheck(char *argument)
 {
         char      arg[MAX_INPUT_LENGTH];
+        NAME_LIST list;
         CHAR_DATA *wch;
         int       number, count, vnum;
+        size_t    i;
 
         number = number_argument(argument, arg);
         count = 0;
@@ -2144,7 +2529,10 @@ CHAR_DATA *get_char_world_nocheck(char *argument)
         /*
          * check the world for an exact match 
          */
-        for (wch = first_char; wch; wch = wch->next)
+        name_candidates(arg, vnum, FALSE, list);
+        for (i = 0; i < list.size(); i++)
+        {
+                wch = list[i];
                 if ((nifty_is_name(arg, wch->name)
                                         || (IS_NPC(wch) && vnum == wch->pIndexData->vnum)))
                 {
@@ -2153,6 +2541,7 @@ CHAR_DATA *get_char_world_nocheck(char *argument)
                         else if (++count == number)
                                 return wch;
                 }
+        }
 
         /*
          * bail out if looking for a vnum match 
@@ -2167,8 +2556,10 @@ CHAR_DATA *get_char_world_nocheck(char *argument)
          * Added by Narn, Sept/96
          */
         count = 0;
-        for (wch = first_char; wch; wch = wch->next)
+        name_candidates(arg, -1, TRUE, list);
+        for (i = 0; i < list.size(); i++)
         {
+                wch = list[i];
                 if (!nifty_is_name_prefix(arg, wch->name))
                         continue;
                 if (number == 0 && !IS_NPC(wch))
@@ -2186,8 +2577,10 @@ CHAR_DATA *get_char_world_nocheck(char *argument)
 CHAR_DATA *get_char_world(CHAR_DATA * ch, char *argument)
 {
         char      arg[MAX_INPUT_LENGTH];
+        NAME_LIST list;
         CHAR_DATA *wch;
         int       number, count, vnum;
+        size_t    i;
 
         number = number_argument(argument, arg);
         count = 0;
@@ -2221,7 +2614,10 @@ CHAR_DATA *get_char_world(CHAR_DATA * ch, char *argument)
         /*
          * check the world for an exact match 
          */
-        for (wch = first_char; wch; wch = wch->next)
+        name_candidates(arg, vnum, FALSE, list);
+        for (i = 0; i < list.size(); i++)
+        {
+                wch = list[i];
                 if ((nifty_is_name(arg, wch->name)
                                         || (IS_NPC(wch) && vnum == wch->pIndexData->vnum))
                                 && is_wizvis(ch, wch))
@@ -2231,6 +2627,7 @@ CHAR_DATA *get_char_world(CHAR_DATA * ch, char *argument)
                         else if (++count == number)
                                 return wch;
                 }
+        }
 
         /*
          * bail out if looking for a vnum match 
@@ -2260,8 +2657,10 @@ CHAR_DATA *get_char_world(CHAR_DATA * ch, char *argument)
          * Added by Narn, Sept/96
          */
         count = 0;
-        for (wch = first_char; wch; wch = wch->next)
+        name_candidates(arg, -1, TRUE, list);
+        for (i = 0; i < list.size(); i++)
         {
+                wch = list[i];
                 if (!nifty_is_name_prefix(arg, wch->name))
                         continue;
                 if (number == 0 && !IS_NPC(wch) && is_wizvis(ch, wch))
@@ -2281,13 +2680,7 @@ CHAR_DATA *get_char_world(CHAR_DATA * ch, char *argument)
  */
 OBJ_DATA *get_obj_type(OBJ_INDEX_DATA * pObjIndex)
 {
-        OBJ_DATA *obj;
-
-        for (obj = last_object; obj; obj = obj->prev)
-                if (obj->pIndexData == pObjIndex)
-                        return obj;
-
-        return NULL;
+        return pObjIndex ? pObjIndex->last_instance : NULL;
 }
 
 
@@ -3574,6 +3967,7 @@ OBJ_DATA *get_trap(OBJ_DATA * obj)
 void extract_exit(ROOM_INDEX_DATA * room, EXIT_DATA * pexit)
 {
         UNLINK(pexit, room->first_exit, room->last_exit, next, prev);
+        index_exits(room);
         if (pexit->rexit)
                 pexit->rexit->rexit = NULL;
         STRFREE(pexit->keyword);
@@ -3632,6 +4026,7 @@ void clean_room(ROOM_INDEX_DATA * room)
         }
         room->first_exit = NULL;
         room->last_exit = NULL;
+        index_exits(room);
         room->room_flags = meb(0);
         room->sector_type = 0;
         room->light = 0;
@@ -3744,6 +4139,7 @@ void clean_resets(AREA_DATA * tarea)
 {
         RESET_DATA *pReset, *pReset_next;
 
+        invalidate_reset_progs();
         for (pReset = tarea->first_reset; pReset; pReset = pReset_next)
         {
                 pReset_next = pReset->next;
@@ -4234,6 +4630,8 @@ OBJ_DATA *clone_object(OBJ_DATA * obj)
         ++physicalobjects;
         cur_obj_serial = UMAX((cur_obj_serial + 1) & (BV30 - 1), 1);
         LINK(clone, first_object, last_object, next, prev);
+        LINK(clone, clone->pIndexData->first_instance,
+             clone->pIndexData->last_instance, next_instance, prev_instance);
         return clone;
 }
 
@@ -4337,6 +4735,7 @@ void split_obj(OBJ_DATA * obj, int num)
                 rest->in_room = NULL;
                 rest->carried_by = NULL;
         }
+        obj_reown(rest);
 }
 
 void separate_obj(OBJ_DATA * obj)
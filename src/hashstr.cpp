@@ -42,9 +42,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <mutex>
 #include "mud.hpp"
 
 #define STR_HASH_SIZE	1024
+#define STR_HASH_LOCKS	64
 
 struct hashstr_data
 {
@@ -55,6 +57,31 @@ struct hashstr_data
 
 struct hashstr_data *string_hash[STR_HASH_SIZE];
 
+/*
+ * While the boot workers parse area files, each bucket is guarded by one
+ * of a set of striped locks.  The rest of the time the game is single
+ * threaded and the locks are skipped.
+ */
+static std::mutex str_hash_locks[STR_HASH_LOCKS];
+static bool str_hash_shared = FALSE;
+
+static std::unique_lock < std::mutex > str_hash_lock(int hash)
+{
+        if (!str_hash_shared)
+                return std::unique_lock < std::mutex > ();
+        return std::unique_lock < std::mutex >
+                (str_hash_locks[hash % STR_HASH_LOCKS]);
+}
+
+/*
+ * Turn the bucket locks on or off.  Only call this while no other thread
+ * is using the hash.
+ */
+void str_hash_threads(bool shared)
+{
+        str_hash_shared = shared;
+}
+
 /*
  * Check hash table for existing occurance of string.
  * If found, increase link count, and return pointer,
@@ -69,6 +96,9 @@ char     *str_alloc(char *str)
         len = strlen(str);
         psize = sizeof(struct hashstr_data);
         hash = len % STR_HASH_SIZE;
+
+        std::unique_lock < std::mutex > lock = str_hash_lock(hash);
+
         for (ptr = string_hash[hash]; ptr; ptr = ptr->next)
                 if (len == ptr->length && !strcmp(str, (char *) ptr + psize))
                 {
@@ -98,6 +128,8 @@ char     *quick_link(char *str)
 {
         /* Removed 'register' keyword for C++17 compatibility */
         struct hashstr_data *ptr;
+        std::unique_lock < std::mutex > lock =
+                str_hash_lock(strlen(str) % STR_HASH_SIZE);
 
         ptr = (struct hashstr_data *) (str - sizeof(struct hashstr_data));
         if (ptr->links == 0)
@@ -124,6 +156,9 @@ int str_free(char *str)
 
         len = strlen(str);
         hash = len % STR_HASH_SIZE;
+
+        std::unique_lock < std::mutex > lock = str_hash_lock(hash);
+
         ptr = (struct hashstr_data *) (str - sizeof(struct hashstr_data));
         if (ptr->links == 65535)    /* permanent */
                 return ptr->links;
@@ -300,6 +335,9 @@ int in_hash_table(char *str)
         len = strlen(str);
         psize = sizeof(struct hashstr_data);
         hash = len % STR_HASH_SIZE;
+
+        std::unique_lock < std::mutex > lock = str_hash_lock(hash);
+
         for (ptr = string_hash[hash]; ptr; ptr = ptr->next)
                 if (len == ptr->length && str == ((char *) ptr + psize))
                         return 1;
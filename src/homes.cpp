@@ -52,6 +52,7 @@
 #include "grid.hpp"
 #include "installations.hpp"
 #include "cpp_compat.hpp"
+#include "persist.hpp"
 
 #ifndef CMDF
 #define CMDF void
@@ -247,7 +248,10 @@ HOME_DATA::~HOME_DATA()
 			delete roomie;
         }
 		FOR_EACH_LIST(ROOM_LIST, this->rooms, room)
+		{
 			room->home = NULL;
+			room_reown(room);
+		}
 		UNLINK(this, first_home, last_home, next, prev);
 		this->roommates.clear();
 		this->rooms.clear();
@@ -345,6 +349,7 @@ void fread_home(HOME_DATA * home, FILE * fp)
                                         home->owner = STRALLOC("Unowned");
                                 if (!home->description)
                                         home->description = STRALLOC("");
+                                home->reown();
                                 return;
                         }
 						/* Temporary */
@@ -619,7 +624,7 @@ void HOME_DATA::save(void)
         snprintf(filename, 256, "%s%s", HOMEDIR, this->filename);
 
         FCLOSE(fpReserve);
-        if ((fp = fopen(filename, "w")) == NULL)
+        if ((fp = persist_open(filename)) == NULL)
         {
                 bug("HOME_DATA::save fopen", 0);
                 perror(filename);
@@ -665,7 +670,7 @@ void HOME_DATA::save(void)
                 }
                 fprintf(fp, "#END\n");
         }
-        FCLOSE(fp);
+        persist_close(fp);
         fpReserve = fopen(NULL_FILE, "r");
         return;
 }
@@ -716,6 +721,7 @@ CMDF do_sethome(CHAR_DATA * ch, char *argument)
         {
                 STRFREE(home->owner);
                 home->owner = STRALLOC(argument);
+                home->reown();
         }
         else if (!str_cmp(arg2, "name"))
         {
@@ -929,6 +935,7 @@ void HOME_DATA::reset()
         {
                 STRFREE(this->owner);
                 this->owner = STRALLOC("Unowned");
+                this->reown();
 
 				FOR_EACH_LIST(ROOMMATE_LIST, this->roommates, roomie)
                 {
@@ -1057,6 +1064,7 @@ CMDF do_buyhome2(CHAR_DATA * ch, char *argument)
         if (home->owner)
                 STRFREE(home->owner);
         home->owner = STRALLOC(ch->name);
+        home->reown();
 
 		home->save();
 }
@@ -1276,6 +1284,11 @@ CMDF do_freehomes(CHAR_DATA * ch, char *argument)
 			 ch);
 }
 
+/*
+ * Objects coming and going mark their home dirty, but changes to an
+ * object sitting in one (charges, condition, timers, restrings) don't,
+ * so every home is still queued for a save every HOME_SAVE_TIME.
+ */
 void save_homes_check()
 {
         HOME_DATA *home = NULL;
@@ -1284,7 +1297,7 @@ void save_homes_check()
                 return;
 
         for (home = first_home; home; home = home->next)
-			home->save();
+                persist_mark(PERSIST_HOME, home->filename);
 
         /*
          * 60 seconds * 20 minutes 
@@ -104,11 +104,20 @@ struct HOME_DATA
 		inline void remove(ROOM_INDEX_DATA * room) {
 			this->rooms.erase(find(this->rooms.begin(), this->rooms.end(), room));
 			room->home = NULL;
+			room_reown(room);
 		}
 		/** Add a roommate */
 		inline void add(ROOM_INDEX_DATA * room) {
 			this->rooms.push_back(room);
 			room->home = this;
+			room_reown(room);
+		}
+		/** Refile the contents of every room after owner changes */
+		inline void reown(void) {
+			ROOM_INDEX_DATA * room;
+
+			FOR_EACH_LIST(ROOM_LIST, this->rooms, room)
+				room_reown(room);
 		}
 };
 
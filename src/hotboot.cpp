@@ -57,6 +57,11 @@
 #include <sys/wait.h>
 #include <dirent.h>
 #include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
 #include <stdio.h>
 #include <dlfcn.h>
 
@@ -68,6 +73,9 @@
 #include "account.hpp"
 #include "channels.hpp"
 #include "space2.hpp"
+#include "logging.hpp"
+#include "persist.hpp"
+#include "search.hpp"
 
 // Constants
 #define MAX_NEST          100
@@ -188,51 +196,64 @@ void write_ship(FILE * fp, SHIP_DATA * ship)
 // Channel History Save/Load Functions
 // =============================================================================
 
-void load_oochistory(void)
+void fread_oochistory(FILE * fp)
 {
-        FILE     *fp;
-        int       i, ccount = 0, x;
+        int       i, count, ccount = 0, x;
         CHANNEL_DATA *channel;
 
-
-        if (!(fp = fopen(OOCHISTORY_FILE, "r")))
-        {
-                bug("Could not open OOChistory File for reading.", 0);
-                return;
-        }
         ccount = fread_number(fp);
         for (x = 0; x < ccount; x++)
         {
                 channel = get_channel(fread_string_noalloc(fp));
-                channel->logpos = fread_number(fp);
-                CREATE(channel->log, LOG_DATA, sysdata.channellog);
+                count = fread_number(fp) + 1;
 
-                for (i = 0; i < channel->logpos + 1; i++)
+                for (i = 0; i < count; i++)
                 {
-                        channel->log[i].name = fread_string(fp);
-                        channel->log[i].message = fread_string_nohash(fp);
-                        channel->log[i].time = fread_number(fp);
-                        channel->log[i].language =
+                        char     *name = fread_string(fp);
+                        char     *message = fread_string_nohash(fp);
+                        time_t    time = fread_number(fp);
+                        LANGUAGE_DATA *language =
                                 get_language(fread_string_noalloc(fp));
+
+                        if (channel)
+                                push_channel_log(channel, name, message, time,
+                                                 language);
+                        else
+                        {
+                                STRFREE(name);
+                                DISPOSE(message);
+                        }
                 }
-                continue;
         }
-        FCLOSE(fp);
-        unlink(OOCHISTORY_FILE);
         return;
 }
 
-void save_oochistory(void)
+void load_oochistory(void)
 {
         FILE     *fp;
-        int       i, ccount = 0;
-        CHANNEL_DATA *channel;
 
-        if (!(fp = fopen(OOCHISTORY_FILE, "w")))
+        if (!(fp = fopen(OOCHISTORY_FILE, "r")))
         {
-                perror(OOCHISTORY_FILE);
+                bug("Could not open OOChistory File for reading.", 0);
                 return;
         }
+        fread_oochistory(fp);
+        FCLOSE(fp);
+        unlink(OOCHISTORY_FILE);
+        return;
+}
+
+static bool history_entry_ok(LOG_DATA * entry)
+{
+        return entry && entry->name && entry->name[0] != '\0'
+                && entry->message && entry->message[0] != '\0'
+                && entry->language;
+}
+
+void fwrite_oochistory(FILE * fp)
+{
+        int       i, count, ccount = 0;
+        CHANNEL_DATA *channel;
 
         for (channel = first_channel; channel; channel = channel->next)
                 if (channel->history && channel->log)
@@ -243,23 +264,42 @@ void save_oochistory(void)
                 if (!channel->history || !channel->log)
                         continue;
 
+                /*
+                 * Oldest first, and the count has to match what is written
+                 * or the reader loses its place.
+                 */
+                for (count = 0, i = 0; i < channel->logcount; i++)
+                        if (history_entry_ok(channel_log_entry(channel, i)))
+                                count++;
                 fprintf(fp, "%s~\n", channel->name);
-                fprintf(fp, "%d\n", channel->logpos);
-                for (i = 0; i <= channel->logpos; i++)
+                fprintf(fp, "%d\n", count - 1);
+                for (i = 0; i < channel->logcount; i++)
                 {
-                        if (!channel->log[i].name ||
-                            channel->log[i].name[0] == '\0' ||
-                            !channel->log[i].message ||
-                            channel->log[i].message[0] == '\0')
+                        LOG_DATA *entry = channel_log_entry(channel, i);
+
+                        if (!history_entry_ok(entry))
                                 continue;
-                        fprintf(fp, "%s~\n", channel->log[i].name);
-                        fprintf(fp, "%s~\n", channel->log[i].message);
-                        fprintf(fp, "%ld\n", channel->log[i].time);
-                        fprintf(fp, "%s~\n", channel->log[i].language->name);
+                        fprintf(fp, "%s~\n", entry->name);
+                        fprintf(fp, "%s~\n", entry->message);
+                        fprintf(fp, "%ld\n", entry->time);
+                        fprintf(fp, "%s~\n", entry->language->name);
                 }
 
         }
         fprintf(fp, "\n");
+        return;
+}
+
+void save_oochistory(void)
+{
+        FILE     *fp;
+
+        if (!(fp = fopen(OOCHISTORY_FILE, "w")))
+        {
+                perror(OOCHISTORY_FILE);
+                return;
+        }
+        fwrite_oochistory(fp);
         FCLOSE(fp);
         return;
 }
@@ -547,29 +587,251 @@ void save_mobile(FILE * fp, CHAR_DATA * mob)
 // World State Save/Load Functions
 // =============================================================================
 
-void save_world(CHAR_DATA * ch)
+/*
+ * Rooms whose contents survive a hotboot through the world state.  Homes,
+ * clan storerooms and player homes save their own contents elsewhere.
+ */
+static bool world_room_saved(ROOM_INDEX_DATA * pRoomIndex)
+{
+        if (!pRoomIndex->first_content
+#ifdef OLC_HOMES
+            || pRoomIndex->home
+#endif
+            || xIS_SET(pRoomIndex->room_flags, ROOM_CLANSTOREROOM)
+            || xIS_SET(pRoomIndex->room_flags, ROOM_PLR_HOME))
+                return FALSE;
+        return TRUE;
+}
+
+static void fwrite_world_room(FILE * fp, ROOM_INDEX_DATA * pRoomIndex)
+{
+        fwrite_obj(NULL, pRoomIndex->last_content, fp, 0, OS_CARRY, TRUE);
+        fprintf(fp, "%s", "#END\n");
+}
+
+static void fwrite_world_mobs(FILE * fp)
+{
+        CHAR_DATA *rch;
+
+        for (rch = first_char; rch; rch = rch->next)
+        {
+                if (!IS_NPC(rch) || rch == supermob
+                    || IS_SET(rch->act, ACT_PROTOTYPE)
+                    || IS_SET(rch->act, ACT_PET) || rch->owner != NULL)
+                        continue;
+                save_mobile(fp, rch);
+        }
+        fprintf(fp, "%s", "#END\n");
+}
+
+static void fwrite_world_ships(FILE * fp)
+{
+        SHIP_DATA *ship;
+
+        for (ship = first_ship; ship; ship = ship->next)
+                write_ship(fp, ship);
+        fprintf(fp, "%s", "#END\n");
+}
+
+// =============================================================================
+// World Snapshot
+// =============================================================================
+
+/*
+ * The snapshot is a single file holding everything save_world() used to
+ * scatter over one file per room plus the mob, ship and history files.
+ *
+ *   header  | section | payload | section | payload | ...
+ *
+ * Each section carries its type, a key (the room vnum for room contents),
+ * the payload length and a CRC32 of the payload.  Payloads are the same
+ * records fwrite_obj()/save_mobile()/write_ship() have always written, so
+ * the object format keeps a single definition; what the snapshot saves is
+ * the few hundred create/unlink/readdir round trips of the old layout.
+ * Restoring still re-parses every record with fread_obj() and friends, so
+ * the parse cost is the same as with the text files.
+ * Recovery mmaps the file and verifies every section before applying any
+ * of them.  If the snapshot is missing or fails a check, load_world() falls
+ * back to the text files a pre-snapshot binary may have left behind.
+ */
+#define SNAPSHOT_MAGIC		"SWTFSNAP"
+#define SNAPSHOT_VERSION	1
+
+typedef enum
+{
+        SNAP_ROOM = 1, SNAP_MOBS, SNAP_SHIPS, SNAP_OOCHISTORY
+} snapshot_types;
+
+struct snapshot_header
+{
+        char      magic[8];
+        uint32_t  version;
+        uint32_t  sections;
+        uint64_t  length;   /* Bytes following the header */
+        int64_t   saved;
+};
+
+struct snapshot_section
+{
+        uint32_t  type;
+        int32_t   key;
+        uint32_t  length;
+        uint32_t  crc;
+};
+
+typedef void SNAPSHOT_WRITER(FILE * fp, void *data);
+
+static void snapshot_room_writer(FILE * fp, void *data)
+{
+        fwrite_world_room(fp, static_cast < ROOM_INDEX_DATA * >(data));
+}
+
+static void snapshot_mobs_writer(FILE * fp, void *data)
+{
+        (void) data;
+        fwrite_world_mobs(fp);
+}
+
+static void snapshot_ships_writer(FILE * fp, void *data)
+{
+        (void) data;
+        fwrite_world_ships(fp);
+}
+
+static void snapshot_history_writer(FILE * fp, void *data)
+{
+        (void) data;
+        fwrite_oochistory(fp);
+}
+
+/*
+ * Render one section into memory and append it to the snapshot.
+ */
+static bool write_snapshot_section(FILE * fp, snapshot_header & header,
+                                   uint32_t type, int32_t key,
+                                   SNAPSHOT_WRITER * writer, void *data)
+{
+        snapshot_section section;
+        char     *payload = NULL;
+        size_t    length = 0;
+        FILE     *mem;
+        bool      ok;
+
+        if ((mem = open_memstream(&payload, &length)) == NULL)
+                return FALSE;
+        (*writer) (mem, data);
+        fclose(mem);
+
+        section.type = type;
+        section.key = key;
+        section.length = static_cast < uint32_t > (length);
+        section.crc = static_cast < uint32_t >
+                (crc32(0L, reinterpret_cast < const Bytef * >(payload),
+                       static_cast < uInt > (length)));
+
+        ok = fwrite(&section, sizeof(section), 1, fp) == 1
+                && (length == 0 || fwrite(payload, length, 1, fp) == 1);
+        free(payload);
+
+        if (ok)
+        {
+                header.sections++;
+                header.length += sizeof(section) + length;
+        }
+        return ok;
+}
+
+/*
+ * Write the whole live world in one pass.  The snapshot is built under a
+ * temporary name and renamed into place, so a crash mid-write never leaves
+ * a half snapshot for the next boot to trip over.
+ */
+static bool save_world_snapshot(void)
+{
+        snapshot_header header;
+        char      tmpname[FILENAME_SIZE];
+        ROOM_INDEX_DATA *pRoomIndex;
+        FILE     *fp;
+        int       iHash;
+        bool      ok = TRUE;
+
+        snprintf(tmpname, FILENAME_SIZE, "%s.tmp", WORLD_SNAPSHOT_FILE);
+        if ((fp = fopen(tmpname, "w")) == NULL)
+        {
+                perror(tmpname);
+                return FALSE;
+        }
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.saved = static_cast < int64_t > (current_time);
+        ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+        for (iHash = 0; ok && iHash < MAX_KEY_HASH; iHash++)
+                for (pRoomIndex = room_index_hash[iHash]; ok && pRoomIndex;
+                     pRoomIndex = pRoomIndex->next)
+                        if (world_room_saved(pRoomIndex))
+                                ok = write_snapshot_section(fp, header,
+                                                            SNAP_ROOM,
+                                                            pRoomIndex->vnum,
+                                                            snapshot_room_writer,
+                                                            pRoomIndex);
+
+        if (ok)
+                ok = write_snapshot_section(fp, header, SNAP_MOBS, 0,
+                                            snapshot_mobs_writer, NULL);
+#ifdef HOTBOOT_SHIPS
+        if (ok)
+                ok = write_snapshot_section(fp, header, SNAP_SHIPS, 0,
+                                            snapshot_ships_writer, NULL);
+#endif
+        if (ok)
+                ok = write_snapshot_section(fp, header, SNAP_OOCHISTORY, 0,
+                                            snapshot_history_writer, NULL);
+
+        /*
+         * Now that the counts are known, rewrite the header in place 
+         */
+        if (ok)
+                ok = fseek(fp, 0, SEEK_SET) == 0
+                        && fwrite(&header, sizeof(header), 1, fp) == 1;
+        if (fclose(fp) != 0)
+                ok = FALSE;
+
+        if (!ok || rename(tmpname, WORLD_SNAPSHOT_FILE) != 0)
+        {
+                perror(WORLD_SNAPSHOT_FILE);
+                unlink(tmpname);
+                return FALSE;
+        }
+
+        snprintf(log_buf, MSL, "World snapshot: %u sections, %lu bytes.",
+                 header.sections,
+                 static_cast < unsigned long >(header.length));
+        log_string(log_buf);
+        return TRUE;
+}
+
+/*
+ * Plain text world state, one file per room under HOTBOOT_DIR.  Only used
+ * now if the snapshot could not be written.
+ */
+static void save_world_text(void)
 {
         FILE     *mobfp;
         FILE     *shipfp;
         FILE     *objfp;
-        int       mobfile = 0;
-        int       shipfile = 0;
         char      filename[FILENAME_SIZE];
-        CHAR_DATA *rch;
         ROOM_INDEX_DATA *pRoomIndex;
         int       iHash;
 
-        ch = NULL;
-        log_string("Preserving world state....");
-
         snprintf(filename, FILENAME_SIZE, "%s%s", SYSTEM_DIR, MOB_FILE);
         if ((mobfp = fopen(filename, "w")) == NULL)
         {
                 bug("%s", "save_world: fopen mob file");
                 perror(filename);
         }
-        else
-                mobfile++;
 
         snprintf(filename, FILENAME_SIZE, "%s%s", SYSTEM_DIR, SHIP_FILE);
         if ((shipfp = fopen(filename, "w")) == NULL)
@@ -577,54 +839,31 @@ void save_world(CHAR_DATA * ch)
                 bug("%s", "save_world: fopen ship file");
                 perror(filename);
         }
-        else
-                shipfile++;
 
         for (iHash = 0; iHash < MAX_KEY_HASH; iHash++)
         {
                 for (pRoomIndex = room_index_hash[iHash]; pRoomIndex;
                      pRoomIndex = pRoomIndex->next)
                 {
-                        if (pRoomIndex)
-                        {
-                                if (!pRoomIndex->first_content  /* Skip room if nothing in it */
-#ifdef OLC_HOMES
-                                    || pRoomIndex->home
-#endif
-                                    || xIS_SET(pRoomIndex->room_flags, ROOM_CLANSTOREROOM)  /* These rooms save on their own */
-                                    || xIS_SET(pRoomIndex->room_flags, ROOM_PLR_HOME))
-                                        continue;
+                        if (!world_room_saved(pRoomIndex))
+                                continue;
 
-                                snprintf(filename, FILENAME_SIZE, "%s%d", HOTBOOT_DIR,
-                                         pRoomIndex->vnum);
-                                if ((objfp = fopen(filename, "w")) == NULL)
-                                {
-                                        bug("save_world: fopen %d",
-                                            pRoomIndex->vnum);
-                                        perror(filename);
-                                        continue;
-                                }
-                                fwrite_obj(NULL, pRoomIndex->last_content,
-                                           objfp, 0, OS_CARRY, TRUE);
-                                fprintf(objfp, "%s", "#END\n");
-                                FCLOSE(objfp);
+                        snprintf(filename, FILENAME_SIZE, "%s%d", HOTBOOT_DIR,
+                                 pRoomIndex->vnum);
+                        if ((objfp = fopen(filename, "w")) == NULL)
+                        {
+                                bug("save_world: fopen %d", pRoomIndex->vnum);
+                                perror(filename);
+                                continue;
                         }
+                        fwrite_world_room(objfp, pRoomIndex);
+                        FCLOSE(objfp);
                 }
         }
 
-        if (mobfile)
+        if (mobfp)
         {
-                for (rch = first_char; rch; rch = rch->next)
-                {
-                        if (!IS_NPC(rch) || rch == supermob
-                            || IS_SET(rch->act, ACT_PROTOTYPE)
-                            || IS_SET(rch->act, ACT_PET)
-                            || rch->owner != NULL)
-                                continue;
-                        else
-                                save_mobile(mobfp, rch);
-                }
-                fprintf(mobfp, "%s", "#END\n");
+                fwrite_world_mobs(mobfp);
                 FCLOSE(mobfp);
         }
 
@@ -633,27 +872,32 @@ void save_world(CHAR_DATA * ch)
          * * Problem would be to make sure they are uniquely identified, so you don't set 2 ships that are set exactly the same way here.
          * * If its in space. Store the system its in, and its coords.. Current energy too?
          */
-#ifdef HOTBOOT_SHIPS
-        if (shipfile)
+        if (shipfp)
         {
-                SHIP_DATA *ship = NULL;
-
-                for (ship = first_ship; ship; ship = ship->next)
-                {
-                        write_ship(shipfp, ship);
-                }
-                fprintf(shipfp, "%s", "#END\n");
-                FCLOSE(shipfp); /* This should be here instead of below the brace */
+#ifdef HOTBOOT_SHIPS
+                fwrite_world_ships(shipfp);
+#endif
+                FCLOSE(shipfp);
         }
 
-#endif
+        save_oochistory();
+}
+
+void save_world(CHAR_DATA * ch)
+{
+        ch = NULL;
+        log_string("Preserving world state....");
+
+        if (!save_world_snapshot())
+        {
+                bug("%s", "save_world: snapshot failed, writing text world state");
+                save_world_text();
+        }
 
         /*
          * Save sysdata, so that we have the proper number when we read in oochistory log 
          */
         save_sysdata(sysdata);
-        save_oochistory();
-
         return;
 }
 
@@ -852,6 +1096,73 @@ CHAR_DATA *load_mobile(FILE * fp)
 // Object File Handling
 // =============================================================================
 
+/*
+ * Read one room's saved contents and put them back in the room.
+ */
+static void fread_world_room(ROOM_INDEX_DATA * room, FILE * fp)
+{
+        sh_int    iNest;
+        OBJ_DATA *tobj, *tobj_next;
+
+        rset_supermob(room);
+        for (iNest = 0; iNest < MAX_NEST; iNest++)
+                rgObjNest[iNest] = NULL;
+
+        for (;;)
+        {
+                char      letter;
+                char     *word;
+
+                letter = fread_letter(fp);
+                if (letter == '*')
+                {
+                        fread_to_eol(fp);
+                        continue;
+                }
+
+                if (letter != '#')
+                {
+                        bug("%s", "fread_world_room: # not found.");
+                        break;
+                }
+
+                word = fread_word(fp);
+                if (!str_cmp(word, "OBJECT"))   /* Objects  */
+                        fread_obj(supermob, fp, OS_CARRY);
+                else if (!str_cmp(word, "END")) /* Done     */
+                        break;
+                else
+                {
+                        bug("fread_world_room: bad section: %s", word);
+                        break;
+                }
+        }
+        for (tobj = supermob->first_carrying; tobj; tobj = tobj_next)
+        {
+                tobj_next = tobj->next_content;
+#ifdef OVERLANDCODE
+                if (IS_OBJ_STAT(tobj, ITEM_ONMAP))
+                {
+                        SET_ACT_FLAG(supermob, ACT_ONMAP);
+                        supermob->map = tobj->map;
+                        supermob->x = tobj->x;
+                        supermob->y = tobj->y;
+                }
+#endif
+                obj_from_char(tobj);
+#ifndef OVERLANDCODE
+                obj_to_room(tobj, room);
+#else
+                obj_to_room(tobj, room, supermob);
+                REMOVE_ACT_FLAG(supermob, ACT_ONMAP);
+                supermob->map = -1;
+                supermob->x = -1;
+                supermob->y = -1;
+#endif
+        }
+        release_supermob();
+}
+
 void read_obj_file(char *dirname, char *filename)
 {
         ROOM_INDEX_DATA *room;
@@ -871,70 +1182,9 @@ void read_obj_file(char *dirname, char *filename)
 
         if ((fp = fopen(fname, "r")) != NULL)
         {
-                sh_int    iNest;
-                bool      found;
-                OBJ_DATA *tobj, *tobj_next;
-
-                rset_supermob(room);
-                for (iNest = 0; iNest < MAX_NEST; iNest++)
-                        rgObjNest[iNest] = NULL;
-
-                found = TRUE;
-                for (;;)
-                {
-                        char      letter;
-                        char     *word;
-
-                        letter = fread_letter(fp);
-                        if (letter == '*')
-                        {
-                                fread_to_eol(fp);
-                                continue;
-                        }
-
-                        if (letter != '#')
-                        {
-                                bug("%s", "read_obj_file: # not found.");
-                                break;
-                        }
-
-                        word = fread_word(fp);
-                        if (!str_cmp(word, "OBJECT"))   /* Objects  */
-                                fread_obj(supermob, fp, OS_CARRY);
-                        else if (!str_cmp(word, "END")) /* Done     */
-                                break;
-                        else
-                        {
-                                bug("read_obj_file: bad section: %s", word);
-                                break;
-                        }
-                }
+                fread_world_room(room, fp);
                 FCLOSE(fp);
                 unlink(fname);
-                for (tobj = supermob->first_carrying; tobj; tobj = tobj_next)
-                {
-                        tobj_next = tobj->next_content;
-#ifdef OVERLANDCODE
-                        if (IS_OBJ_STAT(tobj, ITEM_ONMAP))
-                        {
-                                SET_ACT_FLAG(supermob, ACT_ONMAP);
-                                supermob->map = tobj->map;
-                                supermob->x = tobj->x;
-                                supermob->y = tobj->y;
-                        }
-#endif
-                        obj_from_char(tobj);
-#ifndef OVERLANDCODE
-                        obj_to_room(tobj, room);
-#else
-                        obj_to_room(tobj, room, supermob);
-                        REMOVE_ACT_FLAG(supermob, ACT_ONMAP);
-                        supermob->map = -1;
-                        supermob->x = -1;
-                        supermob->y = -1;
-#endif
-                }
-                release_supermob();
         }
         else
                 log_string("Cannot open obj file");
@@ -970,18 +1220,196 @@ void load_obj_files(void)
         return;
 }
 
-void load_world(CHAR_DATA * ch)
+static void fread_world_mobs(FILE * fp)
+{
+        char     *word;
+
+        while (!feof(fp))
+        {
+                word = fread_word(fp);
+                if (!str_cmp(word, "#END"))
+                        break;
+                load_mobile(fp);
+        }
+}
+
+static void fread_world_ships(FILE * fp)
+{
+        char     *word;
+
+        while (!feof(fp))
+        {
+                word = fread_word(fp);
+                if (!str_cmp(word, "#END"))
+                        break;
+                load_ship(fp);
+        }
+}
+
+/*
+ * Apply every section of one type from a verified snapshot.
+ */
+static void apply_snapshot_sections(const char *base, size_t size,
+                                    uint32_t type)
+{
+        snapshot_section section;
+        ROOM_INDEX_DATA *room;
+        size_t    pos;
+        FILE     *fp;
+
+        for (pos = sizeof(snapshot_header); pos < size;
+             pos += sizeof(snapshot_section) + section.length)
+        {
+                /*
+                 * Payloads have arbitrary lengths, so the headers after the
+                 * first are not aligned; copy them out rather than cast.
+                 */
+                memcpy(&section, base + pos, sizeof(section));
+                if (section.type != type || section.length == 0)
+                        continue;
+
+                room = NULL;
+                if (type == SNAP_ROOM
+                    && (room = get_room_index(section.key)) == NULL)
+                {
+                        bug("load_world_snapshot: Missing room index for %d!",
+                            section.key);
+                        continue;
+                }
+
+                if ((fp = fmemopen(const_cast < char *>(base + pos + sizeof(snapshot_section)),
+                                   section.length, "r")) == NULL)
+                {
+                        bug("load_world_snapshot: fmemopen failed for section %u",
+                            type);
+                        continue;
+                }
+
+                switch (type)
+                {
+                case SNAP_ROOM:
+                        fread_world_room(room, fp);
+                        break;
+                case SNAP_MOBS:
+                        fread_world_mobs(fp);
+                        break;
+                case SNAP_SHIPS:
+                        fread_world_ships(fp);
+                        break;
+                case SNAP_OOCHISTORY:
+                        fread_oochistory(fp);
+                        break;
+                }
+                fclose(fp);
+        }
+}
+
+/*
+ * Map the snapshot, check the header and every section checksum, and only
+ * then apply it.  Returns FALSE without touching the world if anything is
+ * off, so the caller can fall back to the text files.
+ */
+static bool load_world_snapshot(void)
+{
+        snapshot_header header;
+        snapshot_section section;
+        struct stat fst;
+        const char *base;
+        void     *map;
+        size_t    size, pos;
+        uint32_t  count = 0;
+        int       fd;
+        bool      ok = TRUE;
+
+        if ((fd = open(WORLD_SNAPSHOT_FILE, O_RDONLY)) < 0)
+                return FALSE;
+        if (fstat(fd, &fst) != 0
+            || static_cast < size_t > (fst.st_size) < sizeof(snapshot_header))
+        {
+                bug("%s", "load_world_snapshot: snapshot truncated");
+                close(fd);
+                unlink(WORLD_SNAPSHOT_FILE);
+                return FALSE;
+        }
+
+        size = static_cast < size_t > (fst.st_size);
+        map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        /*
+         * Purge it right away, a snapshot that crashes us must not be
+         * picked up again by the crash hotboot.
+         */
+        unlink(WORLD_SNAPSHOT_FILE);
+        if (map == MAP_FAILED)
+        {
+                perror(WORLD_SNAPSHOT_FILE);
+                return FALSE;
+        }
+
+        base = static_cast < const char *>(map);
+        memcpy(&header, base, sizeof(header));
+        if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic))
+            || header.version != SNAPSHOT_VERSION
+            || header.length != size - sizeof(snapshot_header))
+        {
+                bug("%s", "load_world_snapshot: bad header, ignoring snapshot");
+                ok = FALSE;
+        }
+
+        pos = sizeof(snapshot_header);
+        while (ok && pos < size)
+        {
+                if (size - pos < sizeof(snapshot_section))
+                {
+                        bug("load_world_snapshot: section %u truncated, ignoring snapshot",
+                            count);
+                        ok = FALSE;
+                        break;
+                }
+                memcpy(&section, base + pos, sizeof(section));
+                if (section.length > size - pos - sizeof(snapshot_section)
+                    || section.crc != static_cast < uint32_t >
+                    (crc32(0L,
+                           reinterpret_cast < const Bytef * >(base + pos + sizeof(snapshot_section)),
+                           section.length)))
+                {
+                        bug("load_world_snapshot: section %u corrupt, ignoring snapshot",
+                            count);
+                        ok = FALSE;
+                        break;
+                }
+                pos += sizeof(snapshot_section) + section.length;
+                count++;
+        }
+        if (ok && count != header.sections)
+        {
+                bug("%s", "load_world_snapshot: section count mismatch");
+                ok = FALSE;
+        }
+
+        if (ok)
+        {
+                boot_log("World state: loading snapshot (%u sections)",
+                         count);
+                apply_snapshot_sections(base, size, SNAP_MOBS);
+                apply_snapshot_sections(base, size, SNAP_ROOM);
+#ifdef HOTBOOT_SHIPS
+                apply_snapshot_sections(base, size, SNAP_SHIPS);
+#endif
+                apply_snapshot_sections(base, size, SNAP_OOCHISTORY);
+                boot_log("World_state:  Done");
+        }
+
+        munmap(map, size);
+        return ok;
+}
+
+static void load_world_text(void)
 {
         FILE     *mobfp;
         FILE     *shipfp;
         char      file1[FILENAME_SIZE];
         char      file2[FILENAME_SIZE];
-        char     *word;
-        int       done = 0;
-        bool      mobfile = FALSE;
-        bool      shipfile = FALSE;
-
-        ch = NULL;
 
         snprintf(file1, FILENAME_SIZE, "%s%s", SYSTEM_DIR, MOB_FILE);
         if ((mobfp = fopen(file1, "r")) == NULL)
@@ -989,61 +1417,32 @@ void load_world(CHAR_DATA * ch)
                 bug("%s", "load_world: fopen mob file");
                 perror(file1);
         }
-        else
-                mobfile = TRUE;
 
         snprintf(file2, FILENAME_SIZE, "%s%s", SYSTEM_DIR, SHIP_FILE);
         if ((shipfp = fopen(file2, "r")) == NULL)
         {
                 bug("%s", "load_world: fopen ship file");
-                perror(file1);
+                perror(file2);
         }
-        else
-                shipfile = TRUE;
 
-        if (mobfile)
+        if (mobfp)
         {
                 boot_log("World state: loading mobs");
-                while (done == 0)
-                {
-                        if (feof(mobfp))
-                                done++;
-                        else
-                        {
-                                word = fread_word(mobfp);
-                                if (str_cmp(word, "#END"))
-                                        load_mobile(mobfp);
-                                else
-                                        done++;
-                        }
-                }
+                fread_world_mobs(mobfp);
                 FCLOSE(mobfp);
         }
 
         load_obj_files();
 
-#ifdef HOTBOOT_SHIPS
-        if (shipfile)
+        if (shipfp)
         {
-                done = 0;
+#ifdef HOTBOOT_SHIPS
                 boot_log("World state: loading ships");
-                while (done == 0)
-                {
-                        if (feof(shipfp))
-                                done++;
-                        else
-                        {
-                                word = fread_word(shipfp);
-                                if (str_cmp(word, "#END"))
-                                        load_ship(shipfp);
-                                else
-                                        done++;
-                        }
-                }
-                FCLOSE(shipfp);
+                fread_world_ships(shipfp);
                 boot_log("World_state:  Done");
-        }
 #endif
+                FCLOSE(shipfp);
+        }
 
         /*
          * Once loaded, the data needs to be purged in the event it causes a crash so that it won't try to reload 
@@ -1054,6 +1453,14 @@ void load_world(CHAR_DATA * ch)
         boot_log("World_state: Loading Channel History");
         load_oochistory();
         boot_log("World_state:  Done");
+}
+
+void load_world(CHAR_DATA * ch)
+{
+        ch = NULL;
+
+        if (!load_world_snapshot())
+                load_world_text();
         return;
 }
 
@@ -1312,7 +1719,13 @@ void hotboot(bool debug, bool save)
 #else
                                 0,
 #endif
-                                (int) d->msp_detected,
+                                /*
+                                 * MSP in bit 0, GMCP and MSDP above it, so
+                                 * older hotboot files still read 
+                                 */
+                                (int) d->msp_detected
+                                | (d->gmcp_detected ? BV01 : 0)
+                                | (d->msdp_detected ? BV02 : 0),
                                 (int) d->mxp_detected,
                                 och->name, d->host, d->client);
                         /*
@@ -1377,6 +1790,10 @@ void hotboot(bool debug, bool save)
          * Uncomment this bfd_close line if you've installed the dlsym snippet, you'll need it. 
          */
         dlclose(sysdata.dlHandle);
+        shutdown_shell();
+        shutdown_search();
+        shutdown_persist();
+        shutdown_log();
         execl(EXE_FILE, "swr", buf, "hotboot", buf2, buf3, (char *) NULL);
 
         /*
@@ -1401,6 +1818,8 @@ void hotboot(bool debug, bool save)
                 perror(NULL_FILE);
                 exit(1);
         }
+        init_log();
+        init_persist();
         bug("%s", "Hotboot execution failed!!");
 }
 
@@ -1472,7 +1891,9 @@ void hotboot_recover()
                         STRFREE(d->client);
                 d->client = STRALLOC(client);
                 d->mxp_detected = (bool) mxp;
-                d->msp_detected = (bool) msp;
+                d->msp_detected = IS_SET(msp, BV00);
+                d->gmcp_detected = IS_SET(msp, BV01);
+                d->msdp_detected = IS_SET(msp, BV02);
                 d->host = STRALLOC(host);
                 d->ifd = -1;
                 d->ipid = -1;
@@ -1516,10 +1937,12 @@ void hotboot_recover()
                          * Insert in the char_list 
                          */
                         LINK(d->character, first_char, last_char, next, prev);
+                        name_index_add(d->character);
 
                         char_to_room(d->character, d->character->in_room);
                         load_home(d->character);
                         d->connected = CON_PLAYING;
+                        channel_listeners_changed();
 #ifdef ACCOUNT
                         d->account = d->character->pcdata->account;
 #endif
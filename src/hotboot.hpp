@@ -57,6 +57,7 @@
 #define MOB_FILE	"mobs.dat"  /* For storing mobs across hotboots */
 #define SHIP_FILE	"ships.dat" /* For storing ships across hotboots */
 #define OOCHISTORY_FILE SYSTEM_DIR "oochistory.dat" /* For storing oochistory across hotboots */
+#define WORLD_SNAPSHOT_FILE SYSTEM_DIR "world.snap" /* Single file world state for hotboots */
 
 
 #define HOTBOOT_SHIPS
@@ -774,16 +774,16 @@ char     *escape_string(const char *src)
  */
 CHAR_DATA *imc_find_user(char *name)
 {
-        DESCRIPTOR_DATA *d;
-        CHAR_DATA *vch = NULL;
+        CHAR_DATA *vch;
 
-        for (d = first_descriptor; d; d = d->next)
-        {
-                if ((vch = d->character ? d->character : d->original) != NULL
-                    && !strcasecmp(CH_IMCNAME(vch), name)
-                    && d->connected == CON_PLAYING)
-                        return vch;
-        }
+        /*
+         * A switched immortal's descriptor sits on the mob, so they are
+         * not found by their own name, same as the old descriptor walk.
+         */
+        if ((vch = get_player_world(name)) != NULL && vch->desc
+            && vch->desc->character == vch
+            && vch->desc->connected == CON_PLAYING)
+                return vch;
         return NULL;
 }
 
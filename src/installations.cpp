@@ -45,6 +45,7 @@
 #include "body.hpp"
 #include "installations.hpp"
 #include "space2.hpp"
+#include "economy.hpp"
 
 INSTALLATION_DATA *first_installation;
 INSTALLATION_DATA *last_installation;
@@ -777,21 +778,9 @@ CMDF do_makeinstallation(CHAR_DATA * ch, char *argument)
                 }
 
                 cost = 10;
-                if (planet->cargoimport[CARGO_DURACRETE] > 0)
-                        cost += planet->cargoimport[CARGO_DURACRETE] +
-                                planet->cargoimport[CARGO_DURACRETE] / 2;
-                else if (planet->cargoexport[CARGO_DURACRETE] > 0)
-                        cost += planet->cargoexport[CARGO_DURACRETE];
-                else
-                        cost += 10;
+                cost += economy_material_price(planet, CARGO_DURACRETE);
 
-                if (planet->cargoimport[CARGO_ELECTRONICS] > 0)
-                        cost += planet->cargoimport[CARGO_ELECTRONICS] +
-                                planet->cargoimport[CARGO_ELECTRONICS] / 2;
-                else if (planet->cargoexport[CARGO_ELECTRONICS] > 0)
-                        cost += planet->cargoexport[CARGO_ELECTRONICS];
-                else
-                        cost += 10;
+                cost += economy_material_price(planet, CARGO_ELECTRONICS);
 
                 cost *= duracrete + electronics;
                 if (clan->funds < cost)
@@ -1001,21 +990,9 @@ CMDF do_makeinstallation(CHAR_DATA * ch, char *argument)
         }
 
         cost = 10;
-        if (planet->cargoimport[CARGO_DURACRETE] > 0)
-                cost += planet->cargoimport[CARGO_DURACRETE] +
-                        planet->cargoimport[CARGO_DURACRETE] / 2;
-        else if (planet->cargoexport[CARGO_DURACRETE] > 0)
-                cost += planet->cargoexport[CARGO_DURACRETE];
-        else
-                cost += 10;
+        cost += economy_material_price(planet, CARGO_DURACRETE);
 
-        if (planet->cargoimport[CARGO_ELECTRONICS] > 0)
-                cost += planet->cargoimport[CARGO_ELECTRONICS] +
-                        planet->cargoimport[CARGO_ELECTRONICS] / 2;
-        else if (planet->cargoexport[CARGO_ELECTRONICS] > 0)
-                cost += planet->cargoexport[CARGO_ELECTRONICS];
-        else
-                cost += 10;
+        cost += economy_material_price(planet, CARGO_ELECTRONICS);
 
         cost *= duracrete + electronics;
         if (clan->funds < cost)
@@ -1028,8 +1005,8 @@ CMDF do_makeinstallation(CHAR_DATA * ch, char *argument)
 
         clan->funds -= cost;
         save_clan(clan);
-        planet->resource[CARGO_DURACRETE] -= duracrete;
-        planet->resource[CARGO_ELECTRONICS] -= electronics;
+        economy_consume(planet, CARGO_DURACRETE, duracrete);
+        economy_consume(planet, CARGO_ELECTRONICS, electronics);
 
         vnum = find_pvnum_block(installation_table[type].rooms,
                                 INSTALLATION_AREA);
@@ -47,6 +47,7 @@
 #include <string.h>
 #include <time.h>
 #include "mud.hpp"
+#include "logging.hpp"
 #include <stdlib.h>
 #include "account.hpp"
 #include "alias.hpp"
@@ -934,19 +935,35 @@ bool valid_watch(char *logline)
 }
 
 
+/*
+ * Queue a watch line for one imm's watch file.  The log writer keeps the
+ * file open and flushes it in batches, see logging.cpp.
+ */
+static void write_watch_line(WATCH_DATA * pw, const char *line)
+{
+        char      fname[MAX_INPUT_LENGTH];
+
+        snprintf(fname, MIL, "%s%s", WATCH_DIR, strlower(pw->imm_name));
+        log_record_raw(fname, line, LOGSEV_INFO, LOG_NORMAL);
+}
+
 /*
  * Write input line to watch files if applicable
  */
 void write_watch_files(CHAR_DATA * ch, CMDTYPE * cmd, char *logline)
 {
         WATCH_DATA *pw;
-        FILE     *fp;
-        char      fname[MAX_INPUT_LENGTH], buf[MAX_STRING_LENGTH];
-        struct tm *t = localtime(&current_time);
+        char      buf[MAX_STRING_LENGTH];
+        struct tm *t;
 
         if (!first_watch)   /* no active watches */
                 return;
 
+        t = localtime(&current_time);
+        snprintf(buf, MSL, "%.2d/%.2d %.2d:%.2d %s: %s\n\r",
+                 t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min,
+                 ch->name, logline);
+
         /*
          * if we're watching a command we need to do some special stuff 
          */
@@ -985,24 +1002,7 @@ void write_watch_files(CHAR_DATA * ch, CMDTYPE * cmd, char *logline)
                                                      ch->pcdata->account->
                                                      name))))
                                 {
-                                        sprintf(fname, "%s%s", WATCH_DIR,
-                                                strlower(pw->imm_name));
-                                        if (!(fp = fopen(fname, "a+")))
-                                        {
-                                                sprintf(buf, "%s%s",
-                                                        "Write_watch_files: Cannot open ",
-                                                        fname);
-                                                bug(buf, 0);
-                                                perror(fname);
-                                                return;
-                                        }
-                                        sprintf(buf,
-                                                "%.2d/%.2d %.2d:%.2d %s: %s\n\r",
-                                                t->tm_mon + 1, t->tm_mday,
-                                                t->tm_hour, t->tm_min,
-                                                ch->name, logline);
-                                        fputs(buf, fp);
-                                        fclose(fp);
+                                        write_watch_line(pw, buf);
                                         found = TRUE;
                                 }
                         }
@@ -1021,24 +1021,7 @@ void write_watch_files(CHAR_DATA * ch, CMDTYPE * cmd, char *logline)
                                  && !str_cmp(pw->player_account,
                                              ch->pcdata->account->name)))
                             && get_trust(ch) < pw->imm_level && ch->desc)
-                        {
-                                sprintf(fname, "%s%s", WATCH_DIR,
-                                        strlower(pw->imm_name));
-                                if (!(fp = fopen(fname, "a+")))
-                                {
-                                        sprintf(buf, "%s%s",
-                                                "Write_watch_files: Cannot open ",
-                                                fname);
-                                        bug(buf, 0);
-                                        perror(fname);
-                                        return;
-                                }
-                                sprintf(buf, "%.2d/%.2d %.2d:%.2d %s: %s\n\r",
-                                        t->tm_mon + 1, t->tm_mday, t->tm_hour,
-                                        t->tm_min, ch->name, logline);
-                                fputs(buf, fp);
-                                fclose(fp);
-                        }
+                                write_watch_line(pw, buf);
         }
 
         return;
@@ -0,0 +1,516 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                             SWTFE Ship Kinematics Module                              *
+ ****************************************************************************************/
+#include <sys/time.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "mud.hpp"
+#include "kinematics.hpp"
+
+void kin_missiles::clear(void)
+{
+        x.clear();
+        y.clear();
+        z.clear();
+        tx.clear();
+        ty.clear();
+        tz.clear();
+        step.clear();
+        age.clear();
+        tsame.clear();
+}
+
+void kin_ships::clear(void)
+{
+        x.clear();
+        y.clear();
+        z.clear();
+        hx.clear();
+        hy.clear();
+        hz.clear();
+        speed.clear();
+        autofly.clear();
+}
+
+void kin_bodies::clear(void)
+{
+        x.clear();
+        y.clear();
+        z.clear();
+        gravity.clear();
+        sun.clear();
+        well.clear();
+}
+
+/*
+ * Home every missile straight at its target, step units along the line
+ * between them, then report hits, burn-outs and missiles whose target has
+ * left the system.  A missile that could reach its target this tick, or
+ * ends within MISSILE_HIT_RANGE of it, hits.
+ */
+void kin_step_missiles(kin_missiles & m, std::vector < kin_event > &events)
+{
+        static std::vector < float > rest;
+        size_t    i, n = m.size();
+        kin_event ev;
+
+        rest.resize(n);
+        for (i = 0; i < n; i++)
+        {
+                float     dx = m.tx[i] - m.x[i];
+                float     dy = m.ty[i] - m.y[i];
+                float     dz = m.tz[i] - m.z[i];
+                float     d = sqrtf(dx * dx + dy * dy + dz * dz);
+                float     f = d > m.step[i] ? m.step[i] / d : 1.0f;
+
+                m.x[i] += dx * f;
+                m.y[i] += dy * f;
+                m.z[i] += dz * f;
+                rest[i] = d > m.step[i] ? d - m.step[i] : 0.0f;
+        }
+
+        ev.body = -1;
+        for (i = 0; i < n; i++)
+        {
+                ev.index = static_cast<int>(i);
+                if (!m.tsame[i])
+                        ev.type = KIN_MISSILE_LOST;
+                else if (rest[i] <= MISSILE_HIT_RANGE)
+                        ev.type = KIN_MISSILE_HIT;
+                else if (++m.age[i] >= MISSILE_MAX_AGE)
+                        ev.type = KIN_MISSILE_EXPIRED;
+                else
+                        continue;
+                events.push_back(ev);
+        }
+}
+
+/*
+ * BODY_DATA::distance() truncates each axis to int and the root to int;
+ * comparing the squared sum against squared limits gives the same answers
+ * without the root.
+ */
+static inline long long kin_distance2(float x, float y, float z, int bx,
+                                      int by, int bz)
+{
+        long long dx = static_cast<int>(x - static_cast<float>(bx));
+        long long dy = static_cast<int>(y - static_cast<float>(by));
+        long long dz = static_cast<int>(z - static_cast<float>(bz));
+
+        return dx * dx + dy * dy + dz * dz;
+}
+
+/*
+ * Move every ship along its heading, then check the ships under manual
+ * control against the system's bodies.  The first body that catches a
+ * ship, in list order, decides what happens to it, so bodies are the
+ * outer loop and a ship drops out once caught.
+ */
+void kin_step_ships(kin_ships & s, const kin_bodies & b,
+                    std::vector < kin_event > &events)
+{
+        static std::vector < int > caught;
+        static std::vector < unsigned char > caught_type;
+        size_t    i, j, n = s.size(), nb = b.size();
+        kin_event ev;
+
+        for (i = 0; i < n; i++)
+        {
+                float     change;
+
+                if (s.speed[i] <= 0)
+                        continue;
+                change = sqrtf(s.hx[i] * s.hx[i] + s.hy[i] * s.hy[i]
+                               + s.hz[i] * s.hz[i]);
+                if (change > 0)
+                {
+                        s.x[i] += (s.hx[i] / change) * static_cast<float>(s.speed[i]) / 5;
+                        s.y[i] += (s.hy[i] / change) * static_cast<float>(s.speed[i]) / 5;
+                        s.z[i] += (s.hz[i] / change) * static_cast<float>(s.speed[i]) / 5;
+                }
+        }
+
+        if (nb == 0)
+                return;
+        caught.assign(n, -1);
+        caught_type.assign(n, 0);
+        for (i = 0; i < n; i++)
+                if (s.autofly[i] || s.speed[i] <= 0)
+                        caught[i] = static_cast<int>(nb);
+
+        for (j = 0; j < nb; j++)
+        {
+                long long sun2, well2;
+
+                if (!b.sun[j] && !b.well[j])
+                        continue;
+                sun2 = b.sun[j] ? static_cast<long long>(b.gravity[j] / 10) * (b.gravity[j] / 10) : 0;
+                well2 = b.well[j] ? static_cast<long long>(b.gravity[j]) * b.gravity[j] : 0;
+                if (b.gravity[j] <= 0)
+                        continue;
+                for (i = 0; i < n; i++)
+                {
+                        long long d2;
+                        bool      sun, well;
+
+                        if (caught[i] >= 0)
+                                continue;
+                        d2 = kin_distance2(s.x[i], s.y[i], s.z[i], b.x[j],
+                                           b.y[j], b.z[j]);
+                        sun = d2 > 0 && d2 < sun2;
+                        well = d2 < well2;
+                        if (sun || well)
+                        {
+                                caught[i] = static_cast<int>(j);
+                                caught_type[i] = sun ? KIN_SHIP_SUN : KIN_SHIP_ORBIT;
+                        }
+                }
+        }
+
+        for (i = 0; i < n; i++)
+        {
+                if (caught[i] < 0 || caught[i] >= static_cast<int>(nb))
+                        continue;
+                ev.type = caught_type[i];
+                ev.index = static_cast<int>(i);
+                ev.body = caught[i];
+                events.push_back(ev);
+        }
+}
+
+/*
+ * spacebench: the old one-object-at-a-time movement against the packed
+ * pass, on a synthetic system.  Ships must end up in the same place;
+ * missiles home differently now (straight line rather than per axis), so
+ * for them only the cost is compared.
+ */
+struct bench_ship
+{
+        float     vx, vy, vz;
+        float     hx, hy, hz;
+        int       currspeed;
+        bool      autofly;
+};
+
+struct bench_missile
+{
+        int       mx, my, mz;
+        int       speed;
+        int       age;
+        bench_ship *target;
+};
+
+struct bench_body
+{
+        int       x, y, z;
+        int       gravity;
+        bool      sun, well;
+};
+
+static long bench_usec(struct timeval *start)
+{
+        struct timeval now;
+
+        gettimeofday(&now, NULL);
+        return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_usec - start->tv_usec);
+}
+
+/*
+ * One axis of the old per-axis homing: close in by step without passing
+ * the target.
+ */
+static void legacy_home(int *m, float v, int step)
+{
+        float     pos = static_cast<float>(*m);
+
+        if (pos < v)
+                *m += UMIN(step, static_cast<int>(v - pos));
+        else if (pos > v)
+                *m -= UMIN(step, static_cast<int>(pos - v));
+}
+
+static int legacy_missile_tick(std::vector < bench_missile * >&missiles)
+{
+        int       events = 0;
+
+        for (bench_missile * missile : missiles)
+        {
+                bench_ship *target = missile->target;
+
+                legacy_home(&missile->mx, target->vx, missile->speed / 5);
+                legacy_home(&missile->my, target->vy, missile->speed / 5);
+                legacy_home(&missile->mz, target->vz, missile->speed / 5);
+
+                if (abs(static_cast<int>(missile->mx)) - abs(static_cast<int>(target->vx)) <= 20
+                    && abs(static_cast<int>(missile->mx)) - abs(static_cast<int>(target->vx)) >= -20
+                    && abs(static_cast<int>(missile->my)) - abs(static_cast<int>(target->vy)) <= 20
+                    && abs(static_cast<int>(missile->my)) - abs(static_cast<int>(target->vy)) >= -20
+                    && abs(static_cast<int>(missile->mz)) - abs(static_cast<int>(target->vz)) <= 20
+                    && abs(static_cast<int>(missile->mz)) - abs(static_cast<int>(target->vz)) >= -20)
+                {
+                        events++;
+                        missile->mx = static_cast<int>(target->vx) + 5000;
+                        missile->age = 0;
+                }
+                else if (++missile->age >= 50)
+                {
+                        events++;
+                        missile->mx = static_cast<int>(target->vx) + 5000;
+                        missile->age = 0;
+                }
+        }
+        return events;
+}
+
+static int legacy_ship_tick(std::vector < bench_ship * >&ships,
+                            std::vector < bench_body > &bench_bodies)
+{
+        int       events = 0;
+
+        for (bench_ship * ship : ships)
+        {
+                if (ship->currspeed > 0)
+                {
+                        float     change = sqrt(ship->hx * ship->hx + ship->hy * ship->hy
+                                                + ship->hz * ship->hz);
+
+                        if (change > 0)
+                        {
+                                float     dx = ship->hx / change;
+                                float     dy = ship->hy / change;
+                                float     dz = ship->hz / change;
+
+                                ship->vx += (dx * static_cast<float>(ship->currspeed) / 5);
+                                ship->vy += (dy * static_cast<float>(ship->currspeed) / 5);
+                                ship->vz += (dz * static_cast<float>(ship->currspeed) / 5);
+                        }
+                }
+                if (ship->autofly)
+                        continue;
+                for (bench_body & body : bench_bodies)
+                {
+                        int       distance;
+
+                        if (ship->currspeed <= 0)
+                                continue;
+                        distance = static_cast<int>(sqrt(pow(static_cast<int>(ship->vx - static_cast<float>(body.x)), 2)
+                                                         + pow(static_cast<int>(ship->vy - static_cast<float>(body.y)), 2)
+                                                         + pow(static_cast<int>(ship->vz - static_cast<float>(body.z)), 2)));
+                        if (distance < body.gravity / 10 && body.sun && distance > 0)
+                        {
+                                events++;
+                                ship->currspeed = 0;
+                                break;
+                        }
+                        if (distance < body.gravity && body.well)
+                        {
+                                events++;
+                                ship->currspeed = 0;
+                                continue;
+                        }
+                }
+        }
+        return events;
+}
+
+CMDF do_spacebench(CHAR_DATA * ch, char *argument)
+{
+        char      arg1[MAX_INPUT_LENGTH], arg2[MAX_INPUT_LENGTH];
+        std::vector < bench_ship * >ships;
+        std::vector < bench_missile * >missiles;
+        std::vector < bench_body > bench_bodies;
+        std::vector < kin_event > events;
+        std::vector < int > mtarget;
+        kin_ships ks;
+        kin_missiles km;
+        kin_bodies kb;
+        struct timeval start;
+        long      old_usec, new_usec;
+        int       nships = 2000, nmissiles = 2000, ticks = 100;
+        int       old_events = 0, new_events = 0, old_ship_events = 0;
+        int       new_ship_events = 0, mismatches = 0;
+        int       i, t;
+
+        argument = one_argument(argument, arg1);
+        argument = one_argument(argument, arg2);
+        if (arg1[0] != '\0')
+                nships = atoi(arg1);
+        if (arg2[0] != '\0')
+                nmissiles = atoi(arg2);
+        if (argument[0] != '\0')
+                ticks = atoi(argument);
+        if (nships < 1 || nships > 100000 || nmissiles < 0
+            || nmissiles > 100000 || ticks < 1 || ticks > 1000)
+        {
+                send_to_char("Syntax: spacebench [ships 1-100000] [missiles 0-100000] [ticks 1-1000]\n\r",
+                             ch);
+                return;
+        }
+
+        for (i = 0; i < 12; i++)
+        {
+                bench_body body;
+
+                body.x = number_range(-50000, 50000);
+                body.y = number_range(-50000, 50000);
+                body.z = number_range(-50000, 50000);
+                body.sun = (i == 0);
+                body.well = (i != 0);
+                body.gravity = body.sun ? 20000 : number_range(500, 3000);
+                bench_bodies.push_back(body);
+                kb.x.push_back(body.x);
+                kb.y.push_back(body.y);
+                kb.z.push_back(body.z);
+                kb.gravity.push_back(body.gravity);
+                kb.sun.push_back(body.sun);
+                kb.well.push_back(body.well);
+        }
+        for (i = 0; i < nships; i++)
+        {
+                bench_ship *ship = new bench_ship;
+
+                ship->vx = static_cast<float>(number_range(-60000, 60000));
+                ship->vy = static_cast<float>(number_range(-60000, 60000));
+                ship->vz = static_cast<float>(number_range(-60000, 60000));
+                ship->hx = static_cast<float>(number_range(-100, 100));
+                ship->hy = static_cast<float>(number_range(-100, 100));
+                ship->hz = static_cast<float>(number_range(-100, 100));
+                ship->currspeed = number_range(0, 150);
+                ship->autofly = number_percent() <= 20;
+                ships.push_back(ship);
+                ks.x.push_back(ship->vx);
+                ks.y.push_back(ship->vy);
+                ks.z.push_back(ship->vz);
+                ks.hx.push_back(ship->hx);
+                ks.hy.push_back(ship->hy);
+                ks.hz.push_back(ship->hz);
+                ks.speed.push_back(ship->currspeed);
+                ks.autofly.push_back(ship->autofly);
+        }
+        for (i = 0; i < nmissiles; i++)
+        {
+                bench_missile *missile = new bench_missile;
+                int       target = number_range(0, nships - 1);
+
+                missile->target = ships[static_cast<size_t>(target)];
+                missile->mx = static_cast<int>(missile->target->vx) + number_range(-5000, 5000);
+                missile->my = static_cast<int>(missile->target->vy) + number_range(-5000, 5000);
+                missile->mz = static_cast<int>(missile->target->vz) + number_range(-5000, 5000);
+                missile->speed = number_range(100, 400);
+                missile->age = 0;
+                missiles.push_back(missile);
+                mtarget.push_back(target);
+                km.x.push_back(static_cast<float>(missile->mx));
+                km.y.push_back(static_cast<float>(missile->my));
+                km.z.push_back(static_cast<float>(missile->mz));
+                km.step.push_back(static_cast<float>(missile->speed) / 5);
+                km.age.push_back(0);
+                km.tsame.push_back(1);
+        }
+        km.tx.resize(km.size());
+        km.ty.resize(km.size());
+        km.tz.resize(km.size());
+
+        gettimeofday(&start, NULL);
+        for (t = 0; t < ticks; t++)
+        {
+                old_events += legacy_missile_tick(missiles);
+                old_ship_events += legacy_ship_tick(ships, bench_bodies);
+        }
+        old_usec = bench_usec(&start);
+
+        gettimeofday(&start, NULL);
+        for (t = 0; t < ticks; t++)
+        {
+                size_t    m;
+
+                for (m = 0; m < km.size(); m++)
+                {
+                        km.tx[m] = ks.x[static_cast<size_t>(mtarget[m])];
+                        km.ty[m] = ks.y[static_cast<size_t>(mtarget[m])];
+                        km.tz[m] = ks.z[static_cast<size_t>(mtarget[m])];
+                }
+                events.clear();
+                kin_step_missiles(km, events);
+                for (const kin_event & ev : events)
+                {
+                        km.x[static_cast<size_t>(ev.index)] = km.tx[static_cast<size_t>(ev.index)] + 5000;
+                        km.age[static_cast<size_t>(ev.index)] = 0;
+                }
+                new_events += static_cast<int>(events.size());
+
+                events.clear();
+                kin_step_ships(ks, kb, events);
+                for (const kin_event & ev : events)
+                        ks.speed[static_cast<size_t>(ev.index)] = 0;
+                new_ship_events += static_cast<int>(events.size());
+        }
+        new_usec = bench_usec(&start);
+
+        for (i = 0; i < nships; i++)
+        {
+                size_t    s = static_cast<size_t>(i);
+
+                if (ships[s]->vx != ks.x[s] || ships[s]->vy != ks.y[s]
+                    || ships[s]->vz != ks.z[s])
+                        mismatches++;
+                delete    ships[s];
+        }
+        for (i = 0; i < nmissiles; i++)
+                delete    missiles[static_cast<size_t>(i)];
+
+        ch_printf(ch, "%d ships, %d missiles, %d bodies, %d ticks.\n\r",
+                  nships, nmissiles, static_cast<int>(bench_bodies.size()), ticks);
+        ch_printf(ch, "%-10s %12s %10s %10s %12s\n\r", "Pass", "usec",
+                  "ship evts", "missile", "nsec/object");
+        ch_printf(ch, "%-10s %12ld %10d %10d %12.1f\n\r", "legacy", old_usec,
+                  old_ship_events, old_events,
+                  static_cast<double>(old_usec) * 1000.0 / ticks / (nships + nmissiles));
+        ch_printf(ch, "%-10s %12ld %10d %10d %12.1f\n\r", "packed", new_usec,
+                  new_ship_events, new_events,
+                  static_cast<double>(new_usec) * 1000.0 / ticks / (nships + nmissiles));
+        if (mismatches || old_ship_events != new_ship_events)
+                ch_printf(ch, "&R%d ships ended up somewhere else!&w\n\r",
+                          mismatches);
+        else
+                send_to_char("Ship movement agrees.\n\r", ch);
+}
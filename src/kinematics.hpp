@@ -0,0 +1,125 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                             SWTFE Ship Kinematics Module                              *
+ ****************************************************************************************/
+#ifndef _KINEMATICS_H_
+#define _KINEMATICS_H_
+
+#include <vector>
+
+/*
+ * Space movement is done in two passes.  The kinematics pass below works
+ * on packed arrays and knows nothing about the game: it moves things and
+ * reports what happened as events.  move_ships() in space.cpp fills the
+ * arrays, copies positions back and turns the events into messages,
+ * damage and orbits.
+ */
+#define MISSILE_HIT_RANGE	20  /* Distance that counts as a hit */
+#define MISSILE_MAX_AGE		50  /* Ticks before a missile burns out */
+
+typedef enum
+{
+        KIN_MISSILE_HIT, KIN_MISSILE_EXPIRED, KIN_MISSILE_LOST,
+        KIN_SHIP_SUN, KIN_SHIP_ORBIT
+} kin_event_types;
+
+struct kin_event
+{
+        int       type;
+        int       index;  /* Missile or ship, as packed */
+        int       body;   /* Body for KIN_SHIP_* */
+};
+
+/*
+ * Missiles, with their targets' positions alongside.  tsame is 0 once the
+ * target is no longer in the missile's starsystem.
+ */
+struct kin_missiles
+{
+        std::vector < float > x, y, z;
+        std::vector < float > tx, ty, tz;
+        std::vector < float > step;     /* Distance per tick, speed / 5 */
+        std::vector < int > age;
+        std::vector < unsigned char > tsame;
+
+        void      clear(void);
+        size_t    size(void) const
+        {
+                return x.size();
+        }
+};
+
+/*
+ * The ships of one starsystem.  Heading need not be normalised.
+ */
+struct kin_ships
+{
+        std::vector < float > x, y, z;
+        std::vector < float > hx, hy, hz;
+        std::vector < int > speed;
+        std::vector < unsigned char > autofly;  /* Skips the body checks */
+
+        void      clear(void);
+        size_t    size(void) const
+        {
+                return x.size();
+        }
+};
+
+/*
+ * The bodies of the same starsystem, in list order.
+ */
+struct kin_bodies
+{
+        std::vector < int > x, y, z;
+        std::vector < int > gravity;
+        std::vector < unsigned char > sun;   /* Flying into it is fatal */
+        std::vector < unsigned char > well;  /* Ships entering gravity orbit */
+
+        void      clear(void);
+        size_t    size(void) const
+        {
+                return x.size();
+        }
+};
+
+void      kin_step_missiles(kin_missiles & m, std::vector < kin_event > &events);
+void      kin_step_ships(kin_ships & s, const kin_bodies & b,
+                         std::vector < kin_event > &events);
+
+#endif
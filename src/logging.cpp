@@ -0,0 +1,591 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                            SWTFE Asynchronous Log Module                              *
+ ****************************************************************************************/
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "mud.hpp"
+#include "logging.hpp"
+
+/*
+ * One queued line.  An empty file means the main log on stderr.
+ */
+struct log_record
+{
+        std::string file;
+        std::string text;
+        time_t    time;
+        long      limit;     /* Rotate the file past this many bytes, 0 = never */
+        int       severity;
+        int       category;
+        int       mode;
+};
+
+typedef enum
+{
+        LOGREC_LINE,      /* Append text and a newline */
+        LOGREC_EXISTING,  /* Same, but only if the file is already there */
+        LOGREC_RAW,       /* Append text as is */
+        LOGREC_RELEASE    /* Close the handle once earlier records are out */
+} log_record_modes;
+
+/*
+ * Bounded multi-producer ring (Vyukov): a producer claims a position by
+ * bumping log_tail and publishes the record through the slot's sequence
+ * number, so nothing on the game thread ever takes a lock.
+ */
+struct log_slot
+{
+        std::atomic < size_t > seq;
+        log_record rec;
+};
+
+struct log_file
+{
+        FILE     *fp;
+        long      size;
+};
+
+static log_slot log_ring[LOG_RING_SIZE];
+static std::atomic < size_t > log_tail;
+static std::atomic < size_t > log_head;
+static std::atomic < size_t > log_done;
+static std::atomic < bool > log_running;
+static std::atomic < bool > log_stop;
+static std::atomic < bool > log_crashed;
+static std::thread *log_writer;
+static std::mutex log_wake_mutex;
+static std::condition_variable log_wake;
+
+/* Held by the writer for each batch, so fork() never copies half a write */
+static std::mutex log_batch_mutex;
+
+/* Owned by whoever is writing: the writer thread, or the caller when it isn't running */
+static std::unordered_map < std::string, log_file > log_files;
+
+static std::atomic < unsigned long > log_count[LOGSEV_MAX];
+static std::atomic < unsigned long > log_written;
+static std::atomic < unsigned long > log_stalls;
+static std::atomic < unsigned long > log_rotations;
+static std::atomic < size_t > log_open_files;
+
+static const char *const log_severity_name[LOGSEV_MAX] = {
+        "info", "warn", "bug", "boot"
+};
+
+static const char *const log_category_name[LOG_ALL + 1] = {
+        "normal", "always", "never", "build", "high", "comm", "all"
+};
+
+/*
+ * "[bug/build] ", so the main log can be grepped by either.
+ */
+static void log_append_tag(std::string & line, const log_record & rec)
+{
+        line.append("[").append(log_severity_name[rec.severity]).append("/")
+                .append(log_category_name[rec.category]).append("] ");
+}
+
+static bool log_ring_push(log_record & rec)
+{
+        size_t    pos = log_tail.load(std::memory_order_relaxed);
+        log_slot *slot;
+
+        for (;;)
+        {
+                size_t    seq;
+                long      dif;
+
+                slot = &log_ring[pos & (LOG_RING_SIZE - 1)];
+                seq = slot->seq.load(std::memory_order_acquire);
+                dif = static_cast<long>(seq) - static_cast<long>(pos);
+                if (dif == 0)
+                {
+                        if (log_tail.compare_exchange_weak(pos, pos + 1,
+                                                           std::memory_order_relaxed))
+                                break;
+                }
+                else if (dif < 0)
+                        return FALSE;
+                else
+                        pos = log_tail.load(std::memory_order_relaxed);
+        }
+        slot->rec = std::move(rec);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return TRUE;
+}
+
+static bool log_ring_pop(log_record & rec)
+{
+        size_t    pos = log_head.load(std::memory_order_relaxed);
+        log_slot *slot = &log_ring[pos & (LOG_RING_SIZE - 1)];
+
+        if (slot->seq.load(std::memory_order_acquire) != pos + 1)
+                return FALSE;
+        rec = std::move(slot->rec);
+        slot->seq.store(pos + LOG_RING_SIZE, std::memory_order_release);
+        log_head.store(pos + 1, std::memory_order_release);
+        return TRUE;
+}
+
+static log_file *log_open(const std::string & path, bool existing)
+{
+        auto      it = log_files.find(path);
+        log_file  lf;
+        struct stat st;
+
+        if (it != log_files.end())
+        {
+                /*
+                 * Still linked?  The shutdown file in particular is removed
+                 * by the startup script while we may hold it open. 
+                 */
+                if (fstat(fileno(it->second.fp), &st) == 0 && st.st_nlink > 0)
+                        return &it->second;
+                fclose(it->second.fp);
+                log_files.erase(it);
+                log_open_files.store(log_files.size());
+        }
+        if (existing && access(path.c_str(), F_OK) != 0)
+                return NULL;
+        if ((lf.fp = fopen(path.c_str(), "ae")) == NULL)
+        {
+                fprintf(stderr, "log: can't open %s: %s\n", path.c_str(),
+                        strerror(errno));
+                return NULL;
+        }
+        fseek(lf.fp, 0, SEEK_END);
+        lf.size = ftell(lf.fp);
+        log_open_files.store(log_files.size() + 1);
+        return &log_files.emplace(path, lf).first->second;
+}
+
+/*
+ * file -> file.1 -> file.2 ... dropping the oldest.
+ */
+static void log_rotate(const std::string & path, log_file & lf)
+{
+        char      from[MAX_STRING_LENGTH];
+        char      to[MAX_STRING_LENGTH];
+        int       i;
+
+        fclose(lf.fp);
+        for (i = LOG_ROTATE_KEEP - 1; i > 0; i--)
+        {
+                snprintf(from, MSL, "%s.%d", path.c_str(), i);
+                snprintf(to, MSL, "%s.%d", path.c_str(), i + 1);
+                rename(from, to);
+        }
+        snprintf(to, MSL, "%s.1", path.c_str());
+        rename(path.c_str(), to);
+        log_rotations++;
+
+        if ((lf.fp = fopen(path.c_str(), "ae")) == NULL)
+        {
+                fprintf(stderr, "log: can't reopen %s after rotation: %s\n",
+                        path.c_str(), strerror(errno));
+                log_files.erase(path);
+                log_open_files.store(log_files.size());
+                return;
+        }
+        lf.size = 0;
+}
+
+/*
+ * Write one record.  Main log lines are gathered into "main" so a whole
+ * batch reaches stderr in one write.
+ */
+static void log_write_record(log_record & rec, std::string & main)
+{
+        static time_t stamp_time = -1;
+        static char stamp[32];
+        log_file *lf;
+
+        if (rec.file.empty())
+        {
+                if (rec.time != stamp_time)
+                {
+                        ctime_r(&rec.time, stamp);
+                        stamp[strcspn(stamp, "\n")] = '\0';
+                        stamp_time = rec.time;
+                }
+                main.append(stamp).append(" :: ");
+                log_append_tag(main, rec);
+                main.append(rec.text).append("\n");
+                log_written++;
+                return;
+        }
+
+        if (rec.mode == LOGREC_RELEASE)
+        {
+                auto      it = log_files.find(rec.file);
+
+                if (it != log_files.end())
+                {
+                        fclose(it->second.fp);
+                        log_files.erase(it);
+                        log_open_files.store(log_files.size());
+                }
+                return;
+        }
+        if ((lf = log_open(rec.file, rec.mode == LOGREC_EXISTING)) == NULL)
+                return;
+        if (rec.mode != LOGREC_RAW)
+                rec.text.push_back('\n');
+        if (fwrite(rec.text.data(), 1, rec.text.size(), lf->fp) == rec.text.size())
+                lf->size += static_cast<long>(rec.text.size());
+        log_written++;
+        if (rec.limit > 0 && lf->size > rec.limit)
+        {
+                fflush(lf->fp);
+                log_rotate(rec.file, *lf);
+        }
+}
+
+/*
+ * After log_crash(), records skip the ring and the file handles, which
+ * the writer may still be using, and go straight to stderr.
+ */
+static void log_write_crash(const log_record & rec)
+{
+        char      stamp[32];
+        std::string line;
+
+        if (rec.mode == LOGREC_RELEASE)
+                return;
+        ctime_r(&rec.time, stamp);
+        stamp[strcspn(stamp, "\n")] = '\0';
+        line.append(stamp).append(" :: ");
+        log_append_tag(line, rec);
+        if (!rec.file.empty())
+                line.append(rec.file).append(": ");
+        line.append(rec.text).append("\n");
+        if (write(STDERR_FILENO, line.data(), line.size()) < 0)
+                return;
+}
+
+static void log_flush_files(std::string & main)
+{
+        if (!main.empty())
+        {
+                fwrite(main.data(), 1, main.size(), stderr);
+                fflush(stderr);
+                main.clear();
+        }
+        for (auto &it : log_files)
+                fflush(it.second.fp);
+}
+
+static void log_writer_loop(void)
+{
+        std::string main;
+        log_record rec;
+
+        for (;;)
+        {
+                bool      any = FALSE;
+
+                {
+                        std::lock_guard < std::mutex > batch(log_batch_mutex);
+
+                        while (log_ring_pop(rec))
+                        {
+                                log_write_record(rec, main);
+                                log_done++;
+                                any = TRUE;
+                        }
+                        if (any)
+                                log_flush_files(main);
+                }
+                if (any)
+                        continue;
+                if (log_stop.load())
+                        break;
+
+                std::unique_lock < std::mutex > lock(log_wake_mutex);
+                log_wake.wait_for(lock, std::chrono::milliseconds(25));
+        }
+}
+
+static void log_push(const char *file, const char *text, int severity,
+                     int category, int mode)
+{
+        log_record rec;
+
+        rec.file = file ? file : "";
+        rec.text = text;
+        rec.time = current_time;
+        rec.limit = sysdata.log_size;
+        rec.severity = URANGE(0, severity, LOGSEV_MAX - 1);
+        rec.category = URANGE(LOG_NORMAL, category, LOG_ALL);
+        rec.mode = mode;
+        if (mode != LOGREC_RELEASE)
+                log_count[rec.severity]++;
+
+        if (log_crashed.load())
+        {
+                log_write_crash(rec);
+                return;
+        }
+        if (!log_running.load())
+        {
+                std::string main;
+
+                log_write_record(rec, main);
+                log_flush_files(main);
+                return;
+        }
+
+        while (!log_ring_push(rec))
+        {
+                log_stalls++;
+                log_wake.notify_one();
+                std::this_thread::yield();
+        }
+}
+
+/*
+ * Append a line to the main log.
+ */
+void log_record_main(const char *text, int severity, int category)
+{
+        log_push(NULL, text, severity, category, LOGREC_LINE);
+}
+
+/*
+ * Append a line to a file, creating it if need be.
+ */
+void log_record_to(const char *file, const char *text, int severity,
+                   int category)
+{
+        log_push(file, text, severity, category, LOGREC_LINE);
+}
+
+/*
+ * Append a line to a file only if it already exists (the shutdown file).
+ */
+void log_record_existing(const char *file, const char *text, int severity,
+                         int category)
+{
+        log_push(file, text, severity, category, LOGREC_EXISTING);
+}
+
+/*
+ * Append text to a file exactly as given, for callers that keep their
+ * own line endings (watch files).
+ */
+void log_record_raw(const char *file, const char *text, int severity,
+                    int category)
+{
+        log_push(file, text, severity, category, LOGREC_RAW);
+}
+
+/*
+ * Close our handle on a file once everything queued for it is written,
+ * so it can be removed or read back safely.  Waits for the writer.
+ */
+void log_release(const char *file)
+{
+        log_push(file, "", LOGSEV_INFO, LOG_NORMAL, LOGREC_RELEASE);
+        log_flush();
+}
+
+/*
+ * Can a line be appended to this file?  The write itself happens later on
+ * the writer, so callers that report failure to a player ask first.
+ */
+bool log_writable(const char *file)
+{
+        char      dir[MAX_STRING_LENGTH];
+
+        if (access(file, F_OK) == 0)
+                return access(file, W_OK) == 0;
+        mudstrlcpy(dir, file, MSL);
+        return access(dirname(dir), W_OK) == 0;
+}
+
+/*
+ * Not after a crash: the faulting thread may be the writer, holding the
+ * lock while it forks for a core.
+ */
+static bool log_fork_locked;
+
+static void log_fork_prepare(void)
+{
+        log_fork_locked = !log_crashed.load();
+        if (log_fork_locked)
+                log_batch_mutex.lock();
+}
+
+static void log_fork_parent(void)
+{
+        if (log_fork_locked)
+                log_batch_mutex.unlock();
+}
+
+/*
+ * The writer does not exist in a forked child.  Forget it (its thread
+ * object is leaked, never joined) and have the child write synchronously
+ * through the handles it inherited, which were flushed before the fork.
+ */
+static void log_fork_child(void)
+{
+        if (log_fork_locked)
+                log_batch_mutex.unlock();
+        log_writer = NULL;
+        log_running.store(FALSE);
+}
+
+void init_log(void)
+{
+        size_t    i;
+
+        static bool registered = FALSE;
+
+        if (log_running.load())
+                return;
+        if (!registered)
+        {
+                atexit(shutdown_log);
+                pthread_atfork(log_fork_prepare, log_fork_parent,
+                               log_fork_child);
+                registered = TRUE;
+        }
+        for (i = 0; i < LOG_RING_SIZE; i++)
+                log_ring[i].seq.store(i);
+        log_tail.store(0);
+        log_head.store(0);
+        log_done.store(0);
+        log_stop.store(FALSE);
+        log_crashed.store(FALSE);
+        log_running.store(TRUE);
+        log_writer = new std::thread(log_writer_loop);
+}
+
+/*
+ * Wait until everything queued so far has been written.
+ */
+void log_flush(void)
+{
+        size_t    target = log_tail.load();
+        int       waited;
+
+        for (waited = 0; log_running.load() && log_done.load() < target
+             && waited < 5000; waited++)
+        {
+                log_wake.notify_one();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+}
+
+/*
+ * Drain the ring and stop the writer.  Logging carries on synchronously,
+ * which is what the crash, shutdown and hotboot paths need.
+ */
+void shutdown_log(void)
+{
+        if (!log_running.load())
+                return;
+        if (log_crashed.load())
+        {
+                /*
+                 * The writer may be the thread that faulted, so it is
+                 * never joined.  If it is alive, let it drain what it can. 
+                 */
+                if (log_writer
+                    && log_writer->get_id() != std::this_thread::get_id())
+                        log_flush();
+                log_running.store(FALSE);
+                return;
+        }
+        log_stop.store(TRUE);
+        log_wake.notify_one();
+        if (log_writer && log_writer->joinable())
+                log_writer->join();
+        delete log_writer;
+        log_writer = NULL;
+        log_running.store(FALSE);
+}
+
+/*
+ * For the SIGSEGV handler.  Nothing waits on or joins the writer from
+ * here on; every record is written to stderr on the calling thread.
+ */
+void log_crash(void)
+{
+        log_crashed.store(TRUE);
+}
+
+CMDF do_logstat(CHAR_DATA * ch, char *argument)
+{
+        int       i;
+
+        (void) argument;
+        set_pager_color(AT_PLAIN, ch);
+        pager_printf(ch, "&BWriter:&w   %s\n\r",
+                     log_running.load() ? "running" : "stopped (writing synchronously)");
+        pager_printf(ch, "&BQueued:&w   %lu records, %lu waiting\n\r",
+                     static_cast<unsigned long>(log_tail.load()),
+                     static_cast<unsigned long>(log_tail.load() - log_head.load()));
+        pager_printf(ch, "&BWritten:&w  %lu\n\r", log_written.load());
+        pager_printf(ch, "&BStalls:&w   %lu (ring of %d full)\n\r",
+                     log_stalls.load(), LOG_RING_SIZE);
+        pager_printf(ch, "&BFiles:&w    %lu open, %lu rotations (limit %d bytes, keep %d)\n\r",
+                     static_cast<unsigned long>(log_open_files.load()),
+                     log_rotations.load(), sysdata.log_size, LOG_ROTATE_KEEP);
+        send_to_pager("&BBy severity:&w", ch);
+        for (i = 0; i < LOGSEV_MAX; i++)
+                pager_printf(ch, " %s %lu", log_severity_name[i],
+                             log_count[i].load());
+        send_to_pager("\n\r", ch);
+}
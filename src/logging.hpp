@@ -0,0 +1,85 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                            SWTFE Asynchronous Log Module                              *
+ ****************************************************************************************/
+#ifndef _LOGGING_H_
+#define _LOGGING_H_
+
+/*
+ * Asynchronous logging.
+ *
+ * Every log line, bug, boot message and append to one of the text files
+ * (bugs, ideas, typos, logged rooms) is queued as a record and written by a
+ * single writer thread.  The game thread only formats the text and pushes it
+ * onto a lock-free ring; timestamps, file opens and flushing all happen on
+ * the writer, which keeps one handle per file open and rotates a file once
+ * it grows past sysdata.log_size.
+ *
+ * The main log still goes to stderr, since the startup scripts redirect it
+ * to the dated log file, as "<time> :: [<severity>/<category>] <text>".
+ * The other files get the text alone; players read those back in game.
+ *
+ * Before the ring is running, and again after shutdown_log(), records are
+ * written straight through on the calling thread, so boot messages and
+ * anything logged on the way down to exec() or abort() are never lost.
+ * A forked child does the same.  After log_crash() every record goes
+ * straight to stderr and the writer is never waited on.
+ */
+#define LOG_RING_SIZE		8192	/* Records the ring holds, power of two */
+#define LOG_ROTATE_KEEP		3	/* Rotated generations kept: file.1 .. file.3 */
+
+typedef enum
+{
+        LOGSEV_INFO, LOGSEV_WARN, LOGSEV_BUG, LOGSEV_BOOT, LOGSEV_MAX
+} log_severities;
+
+void      init_log(void);
+void      shutdown_log(void);
+void      log_crash(void);
+bool      log_writable(const char *file);
+void      log_flush(void);
+void      log_record_to(const char *file, const char *text, int severity,
+                        int category);
+void      log_record_existing(const char *file, const char *text,
+                              int severity, int category);
+void      log_record_raw(const char *file, const char *text, int severity,
+                         int category);
+void      log_release(const char *file);
+void      log_record_main(const char *text, int severity, int category);
+
+#endif
@@ -46,6 +46,7 @@
 #include <time.h>
 #include "mud.hpp"
 #include "races.hpp"
+#include "channels.hpp"
 
 /*
  * Local functions.
@@ -3847,6 +3848,7 @@ SPELLF spell_possess(int sn, int level, CHAR_DATA * ch, void *vo)
         victim->desc = ch->desc;
         ch->desc = NULL;
         ch->switched = victim;
+        channel_listeners_changed();
         send_to_char(buf, victim);
 
         return rNONE;
@@ -3962,6 +3964,7 @@ SPELLF spell_polymorph(int sn, int level, CHAR_DATA * ch, void *vo)
         poly_mob->desc = ch->desc;
         ch->desc = NULL;
         ch->switched = poly_mob;
+        channel_listeners_changed();
 
         return rNONE;
 }
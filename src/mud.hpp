@@ -59,6 +59,7 @@
 #endif
 #include <list>
 #include <map>
+#include <string>
 //#include <bits/stl_alloc.h>
 
 typedef int ch_ret;
@@ -128,6 +129,8 @@ typedef struct char_data CHAR_DATA;
 typedef struct hunt_hate_fear HHF_DATA;
 typedef struct fighting_data FIGHT_DATA;
 typedef struct descriptor_data DESCRIPTOR_DATA;
+typedef struct prompt_cache PROMPT_CACHE;
+typedef struct telemetry_data TELEMETRY_DATA;
 typedef struct exit_data EXIT_DATA;
 typedef struct extra_descr_data EXTRA_DESCR_DATA;
 typedef struct help_data HELP_DATA;
@@ -137,6 +140,7 @@ typedef struct obj_data OBJ_DATA;
 typedef struct obj_index_data OBJ_INDEX_DATA;
 typedef struct pc_data PC_DATA;
 typedef struct reset_data RESET_DATA;
+typedef struct reset_prog RESET_PROG;
 typedef struct room_index_data ROOM_INDEX_DATA;
 typedef struct shop_data SHOP_DATA;
 typedef struct repairshop_data REPAIR_DATA;
@@ -194,6 +198,8 @@ typedef ch_ret SPELL_FUN(int sn, int level, CHAR_DATA * ch, void *vo);
 #define BANK_DIR	"../banks/"
 #define BACCOUNT_DIR	"../banks/accounts/"
 #define BACCOUNT_LIST	"accounts.lst"
+#define BANK_JOURNAL	"journal"
+#define BANK_JOURNAL_MAX	2000	/* Journal records between snapshots */
 typedef struct bank_account BANK_ACCOUNT;
 
 struct bank_account
@@ -335,6 +341,7 @@ struct bank_account
 #include "autobuild.hpp"
 #include "color.hpp"
 #include "hotboot.hpp"
+#include "vnumtable.hpp"
 #include "implants.hpp"
 
 #ifdef CALLOC
@@ -373,6 +380,7 @@ struct bank_account
 #define PULSE_MOBILE		  (  4 * PULSE_PER_SECOND)
 #define PULSE_TICK		  ( 70 * PULSE_PER_SECOND)
 #define PULSE_AREA		  ( 60 * PULSE_PER_SECOND)
+#define RESET_BUDGET_DEFAULT	  20    /* msec of area resets per pulse */
 #define PULSE_AUCTION             ( 10 * PULSE_PER_SECOND)
 #define PULSE_SPACE               ( 10 * PULSE_PER_SECOND)
 #define PULSE_TAXES               ( 60 * PULSE_MINUTE)
@@ -531,7 +539,7 @@ typedef enum
         CON_GET_PKILL, CON_READ_IMOTD, CON_GET_NEW_EMAIL,
         CON_GET_MSP, CON_GET_NEW_CLASS, CON_ROLL_STATS,
         CON_SHOW_STAT_OPTIONS, CON_EDIT_STATS, CON_STATS_OK,
-        CON_COPYOVER_RECOVER, CON_FORKED, CON_IAFORKED,
+        CON_COPYOVER_RECOVER,
         CON_WIZINVIS, CON_EDIT_STAT_NUM, CON_MENU
 #ifdef ACCOUNT
                 , CON_NEW_ACCOUNT, CON_GET_ACCOUNT,
@@ -585,6 +593,7 @@ struct descriptor_data
         sh_int lines;
         sh_int scrlen;
         bool fcommand;
+        bool oobonly;   /* outbuf holds only out-of-band bytes */
         char inbuf[MAX_INBUF_SIZE];
         char incomm[MAX_INPUT_LENGTH];
         char inlast[MAX_INPUT_LENGTH];
@@ -613,6 +622,10 @@ struct descriptor_data
 #endif
         bool mxp_detected;  /* player using MXP flag */
         bool msp_detected;  /* player using MSP flag */
+        bool gmcp_detected; /* client agreed to GMCP */
+        bool msdp_detected; /* client agreed to MSDP */
+        PROMPT_CACHE *prompt_cache; /* Compiled prompts, see prompt.cpp */
+        TELEMETRY_DATA *telemetry;  /* Last state sent, see telemetry.cpp */
 #ifdef ACCOUNT
         struct account_data *account;
 #endif
@@ -1234,7 +1247,7 @@ struct missile_data
         SPACE_DATA *starsystem;
         SHIP_DATA *target;
         SHIP_DATA *fired_from;
-        char     *fired_by;
+        CHAR_DATA *fired_by;    /* Player who fired it, cleared by extract_char */
         sh_int missiletype;
         sh_int age;
         int speed;
@@ -1610,6 +1623,16 @@ typedef enum
 #define TRAP_SE			   BV19
 #define TRAP_SW			   BV20
 
+/*
+ * Who a live object belongs to, for first_owned().  A PC corpse belongs
+ * to the player it came from wherever it is; other objects belong to a
+ * player vendor carrying them or to the home whose room they lie in.
+ */
+#define OWNER_NONE		   0
+#define OWNER_CORPSE		   1
+#define OWNER_VENDOR		   2
+#define OWNER_HOME		   3
+
 /*
  * Well known object virtual numbers.
  * Defined in #OBJECTS.
@@ -2217,6 +2240,8 @@ struct mob_index_data
 {
         MOB_INDEX_DATA *next;
         MOB_INDEX_DATA *next_sort;
+        CHAR_DATA *first_instance;  /* Live mobs made from this */
+        CHAR_DATA *last_instance;
         SPEC_FUN *spec_fun;
         SPEC_FUN *spec_2;
         SHOP_DATA *pShop;
@@ -2346,6 +2371,12 @@ struct char_data
         CHAR_DATA *prev_in_room;
         CHAR_DATA *next_in_area;
         CHAR_DATA *prev_in_area;
+        CHAR_DATA *next_in_kind;    /* Room's first_pc or first_npc list */
+        CHAR_DATA *prev_in_kind;
+        CHAR_DATA *next_instance;   /* pIndexData's first_instance list */
+        CHAR_DATA *prev_instance;
+        char     *indexed_name; /* name as filed in the name index */
+        unsigned long name_seq; /* first_char order, 0 when not indexed */
         CHAR_DATA *master;
         CHAR_DATA *leader;
         FIGHT_DATA *fighting;
@@ -2640,6 +2671,8 @@ struct obj_index_data
 {
         OBJ_INDEX_DATA *next;
         OBJ_INDEX_DATA *next_sort;
+        OBJ_DATA *first_instance;   /* Live objects made from this */
+        OBJ_DATA *last_instance;
         EXTRA_DESCR_DATA *first_extradesc;
         EXTRA_DESCR_DATA *last_extradesc;
         AFFECT_DATA *first_affect;
@@ -2672,6 +2705,10 @@ struct obj_data
 {
         OBJ_DATA *next;
         OBJ_DATA *prev;
+        OBJ_DATA *next_instance;    /* pIndexData's first_instance list */
+        OBJ_DATA *prev_instance;
+        OBJ_DATA *next_owned;   /* first_owned() list for owner */
+        OBJ_DATA *prev_owned;
         OBJ_DATA *next_content;
         OBJ_DATA *prev_content;
         OBJ_DATA *first_content;
@@ -2705,6 +2742,8 @@ struct obj_data
         int value[6];
         sh_int count;   /* support for object grouping */
         int room_vnum;  /* hotboot tracker */
+        sh_int owner_type;  /* OWNER_xxx, kept by obj_reown */
+        char     *owner;
 };
 
 
@@ -2827,6 +2866,8 @@ struct area_data
         int illegal_pk;
         int high_economy;
         int low_economy;
+        RESET_PROG *reset_prog; /* Compiled resets, see reset.c */
+        bool reset_queued;      /* Waiting in the reset queue, see db.c */
 };
 
 
@@ -2899,6 +2940,8 @@ struct system_data
 
         int DEBUG; /* Cset to toggle backtrace and other debugging information */
         int GREET; /* Toggle Greet System - 2005-11-26 - Gavin */
+        int boot_threads; /* Area parsing threads at boot, 0 = auto, 1 = serial */
+        int reset_budget; /* Msec per pulse spent on queued area resets */
 
 
         /* Pulses */
@@ -2924,6 +2967,11 @@ struct room_index_data
         ROOM_INDEX_DATA *next_sort;
         CHAR_DATA *first_person;
         CHAR_DATA *last_person;
+        CHAR_DATA *first_pc;    /* Occupants split by kind, see char_to_room() */
+        CHAR_DATA *last_pc;
+        CHAR_DATA *first_npc;
+        CHAR_DATA *last_npc;
+        sh_int nplayer;
         OBJ_DATA *first_content;
         OBJ_DATA *last_content;
         EXTRA_DESCR_DATA *first_extradesc;
@@ -2931,6 +2979,7 @@ struct room_index_data
         AREA_DATA *area;
         EXIT_DATA *first_exit;
         EXIT_DATA *last_exit;
+        EXIT_DATA *exit_dir[DIR_SOMEWHERE + 1];  /* First exit each way, see index_exits() */
         SHIP_DATA *first_ship;
         SHIP_DATA *last_ship;
 #ifdef OLC_SHUTTLE
@@ -3373,8 +3422,7 @@ char     *show_ext_flag_string args((int len, const char *const flagarray[]));
 #define IS_QUESTOR(ch)  (IS_SET((ch)->act, PLR_QUESTOR))
 #define IS_IMMORTAL(ch)		(get_trust((ch)) >= LEVEL_IMMORTAL)
 #define IS_HERO(ch)		(get_trust((ch)) >= LEVEL_HERO)
-#define IS_PLAYING(d)		((d)->connected == CON_PLAYING || \
-		(d)->connected == CON_FORKED || (d)->connected == CON_IAFORKED )
+#define IS_PLAYING(d)		((d)->connected == CON_PLAYING)
 #define IS_AFFECTED(ch, sn)	(IS_SET((ch)->affected_by, (sn)))
 #define HAS_BODYPART(ch, part)	((ch)->xflags == 0 || IS_SET((ch)->xflags, (part)))
 
@@ -3689,6 +3737,8 @@ extern CLAN_DATA *first_clan;
 extern CLAN_DATA *last_clan;
 extern SHIP_DATA *first_ship;
 extern SHIP_DATA *last_ship;
+extern MISSILE_DATA *first_missile;
+extern MISSILE_DATA *last_missile;
 extern SPACE_DATA *first_starsystem;
 extern SPACE_DATA *last_starsystem;
 extern PLANET_DATA *first_planet;
@@ -3944,6 +3994,7 @@ int	fread		args( ( void *ptr, int size, int n, FILE *stream ) );
                    void clear_vrooms args((void));
                    EXIT_DATA * find_door args((CHAR_DATA * ch, char *arg, bool quiet));
                    EXIT_DATA * get_exit args((ROOM_INDEX_DATA * room, sh_int dir));
+                   void index_exits args((ROOM_INDEX_DATA * room));
                    EXIT_DATA * get_exit_to args((ROOM_INDEX_DATA * room, sh_int dir, int vnum));
                    EXIT_DATA * get_exit_num args((ROOM_INDEX_DATA * room, sh_int count));
                    ch_ret move_char args((CHAR_DATA * ch, EXIT_DATA * pexit, int fall,bool running));
@@ -4068,8 +4119,14 @@ int	fread		args( ( void *ptr, int size, int n, FILE *stream ) );
                    args((DESCRIPTOR_DATA * dclose, bool force));
                    bool write_to_buffer
                    args((DESCRIPTOR_DATA * d, const char *txt, int length));
+                   bool write_to_buffer_raw
+                   args((DESCRIPTOR_DATA * d, const char *txt, int length));
+                   bool write_to_buffer_oob
+                   args((DESCRIPTOR_DATA * d, const char *txt, int length));
                    void write_to_pager
                    args((DESCRIPTOR_DATA * d, const char *txt, int length));
+                   bool write_to_pager_raw
+                   args((DESCRIPTOR_DATA * d, const char *txt, int length));
                    void send_to_char args((const char *txt, CHAR_DATA * ch));
                    void center_to_char
                    args((char *argument, CHAR_DATA * ch, int columns));
@@ -4086,6 +4143,8 @@ int	fread		args( ( void *ptr, int size, int n, FILE *stream ) );
                    void act
                    args((sh_int AType, const char *format, CHAR_DATA * ch,
                          void *arg1, void *arg2, int type));
+                   const char *act_name
+                   args((CHAR_DATA * ch, CHAR_DATA * to, bool OOC));
                    int strlen_color args((char *argument));
                    extern const unsigned char do_termtype_str[];
                    extern const unsigned char will_compress_str[];
@@ -4104,6 +4163,8 @@ int	fread		args( ( void *ptr, int size, int n, FILE *stream ) );
                    args((AREA_DATA * tarea, char letter, int extra, int arg1,
                          int arg2, int arg3));
                    void reset_area args((AREA_DATA * pArea));
+                   void invalidate_reset_progs args((void));
+                   void free_reset_prog args((AREA_DATA * pArea));
                    void instaroom
                    args((AREA_DATA * pArea, ROOM_INDEX_DATA * pRoom,
                          bool dodoors));
@@ -4126,6 +4187,8 @@ int	fread		args( ( void *ptr, int size, int n, FILE *stream ) );
                    char *str_dup args((char const *str));
                    void boot_db args((bool fCopyOver));
                    void area_update args((void));
+                   void area_reset_update args((void));
+                   void cancel_area_reset args((AREA_DATA * pArea));
                    void add_char args((CHAR_DATA * ch));
                    CD * create_mobile args((MOB_INDEX_DATA * pMobIndex));
                    OD *
@@ -4168,6 +4231,7 @@ int	fread		args( ( void *ptr, int size, int n, FILE *stream ) );
                    const char *capitalize args((const char *str));
                    char *strlower args((const char *str));
                    char *strupper args((const char *str));
+                   std::string lower_key args((const char *str));
                    char *aoran args((const char *str));
                    void append_file
                    args((CHAR_DATA * ch, const char *file, const char *str));
@@ -4175,6 +4239,9 @@ int	fread		args( ( void *ptr, int size, int n, FILE *stream ) );
                    void bug args((const char *str,...));
                    void log_string_plus
                    args((const char *str, sh_int log_type, sh_int level));
+                   void log_string_sev
+                   args((const char *str, sh_int log_type, sh_int level,
+                         int severity));
                    RID *make_room( int vnum, AREA_DATA *area );
                    OID * make_object args((int vnum, int cvnum, char *name));
                    MID * make_mobile args((int vnum, int cvnum, char *name));
@@ -4404,6 +4471,10 @@ void	room_sort	args( ( ROOM_INDEX_DATA *pRoom ) );*/
                    OD * obj_to_obj args((OBJ_DATA * obj, OBJ_DATA * obj_to));
                    void obj_from_obj args((OBJ_DATA * obj));
                    void extract_obj args((OBJ_DATA * obj));
+                   void obj_reown args((OBJ_DATA * obj));
+                   void obj_disown args((OBJ_DATA * obj));
+                   void room_reown args((ROOM_INDEX_DATA * room));
+                   OD * first_owned args((int type, const char *owner));
                    void extract_exit
                    args((ROOM_INDEX_DATA * room, EXIT_DATA * pexit));
                    void extract_room args((ROOM_INDEX_DATA * room));
@@ -4415,6 +4486,10 @@ void	room_sort	args( ( ROOM_INDEX_DATA *pRoom ) );*/
                    CD * get_char_room args((CHAR_DATA * ch, char *argument));
                    CD * get_char_world args((CHAR_DATA * ch, char *argument));
                    CD * get_char_world_nocheck args((char *argument));
+                   CD * get_player_world args((const char *name));
+                   void name_index_add args((CHAR_DATA * ch));
+                   void name_index_remove args((CHAR_DATA * ch));
+                   void name_index_update args((CHAR_DATA * ch));
                    OD * get_obj_type args((OBJ_INDEX_DATA * pObjIndexData));
                    OD *
                    get_obj_list
@@ -4497,7 +4572,7 @@ void	room_sort	args( ( ROOM_INDEX_DATA *pRoom ) );*/
                    char *num_punct args((int foo));
                    char *num_punct_long args((long int foo));
                    int count_users args((OBJ_DATA * obj));
-                   char *smash_color args((char *str));
+                   char *smash_color args((const char *str));
                    char *full_color args((char *str));
                    char *smash_space args((const char *str));
                    void add_request
@@ -4622,6 +4697,7 @@ void	room_sort	args( ( ROOM_INDEX_DATA *pRoom ) );*/
                    char *str_alloc args((char *str));
                    char *quick_link args((char *str));
                    int str_free args((char *str));
+                   void str_hash_threads args((bool shared));
                    int allocated_strings args((void));
                    void show_hash args((int count));
                    char *hash_stats args((void));
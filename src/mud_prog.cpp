@@ -424,9 +424,9 @@ int mprog_do_ifcheck(char *ifcheck, CHAR_DATA * mob, CHAR_DATA * actor,
                         return BERR;
                 }
                 lhsvl = 0;
-                for (oMob = mob->in_room->first_person; oMob;
-                     oMob = oMob->next_in_room)
-                        if (IS_NPC(oMob) && oMob->pIndexData->vnum == vnum)
+                for (oMob = mob->in_room->first_npc; oMob;
+                     oMob = oMob->next_in_kind)
+                        if (oMob->pIndexData->vnum == vnum)
                                 lhsvl++;
                 rhsvl = atoi(rval);
                 if (rhsvl < 1)
@@ -1572,13 +1572,12 @@ void mprog_driver(char *com_list, CHAR_DATA * mob, CHAR_DATA * actor,
          */
 
         count = 0;
-        for (vch = mob->in_room->first_person; vch; vch = vch->next_in_room)
-                if (!IS_NPC(vch))
-                {
-                        if (number_range(0, count) == 0)
-                                rndm = vch;
-                        count++;
-                }
+        for (vch = mob->in_room->first_pc; vch; vch = vch->next_in_kind)
+        {
+                if (number_range(0, count) == 0)
+                        rndm = vch;
+                count++;
+        }
 
         mudstrlcpy(tmpcmndlst, com_list, MSL);
         command_list = tmpcmndlst;
@@ -2556,10 +2555,10 @@ void mprog_greet_trigger(CHAR_DATA * ch)
  log_string( buf );
 #endif
 */
-        for (vmob = ch->in_room->first_person; vmob; vmob = vmob_next)
+        for (vmob = ch->in_room->first_npc; vmob; vmob = vmob_next)
         {
-                vmob_next = vmob->next_in_room;
-                if (!IS_NPC(vmob) || vmob->fighting || !IS_AWAKE(vmob))
+                vmob_next = vmob->next_in_kind;
+                if (vmob->fighting || !IS_AWAKE(vmob))
                         continue;
 
                 /*
@@ -2627,11 +2626,10 @@ void mprog_speech_trigger(char *txt, CHAR_DATA * actor)
 
         CHAR_DATA *vmob;
 
-        for (vmob = actor->in_room->first_person; vmob;
-             vmob = vmob->next_in_room)
+        for (vmob = actor->in_room->first_npc; vmob;
+             vmob = vmob->next_in_kind)
         {
-                if (IS_NPC(vmob)
-                    && (vmob->pIndexData->progtypes & SPEECH_PROG))
+                if (vmob->pIndexData->progtypes & SPEECH_PROG)
                 {
                         if (IS_NPC(actor)
                             && actor->pIndexData == vmob->pIndexData)
@@ -3186,6 +3184,7 @@ void rset_supermob(ROOM_INDEX_DATA * room)
                 supermob->short_descr = QUICKLINK(room->name);
                 STRFREE(supermob->name);
                 supermob->name = QUICKLINK(room->name);
+                name_index_update(supermob);
 
                 supermob->mpscriptpos = room->mpscriptpos;
 
@@ -0,0 +1,498 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                               SWTFE Persistence Module                                *
+ ****************************************************************************************/
+#include <sys/types.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "mud.hpp"
+#include "homes.hpp"
+#include "space2.hpp"
+#include "logging.hpp"
+#include "persist.hpp"
+
+void save_baccount args((BANK_ACCOUNT * account));
+BANK_ACCOUNT *account_by_code args((const char *code));
+extern bool fBootDb;
+
+/*
+ * A file waiting for the writer.  Without data it is a delete.
+ */
+struct persist_write
+{
+        std::string path;
+        std::string data;
+        bool      remove;
+};
+
+/*
+ * A save function's output while it is being built in memory.
+ */
+struct persist_buffer
+{
+        std::string path;
+        char     *data;
+        size_t    size;
+};
+
+struct persist_dirty_entry
+{
+        int       kind;
+        std::string key;
+};
+
+static std::deque < persist_dirty_entry > persist_queue;
+static std::unordered_set < std::string > persist_marked[PERSIST_MAX];
+static std::unordered_map < FILE *, persist_buffer * > persist_buffers;
+
+static std::deque < persist_write > persist_writes;
+static std::mutex persist_mutex;
+static std::condition_variable persist_wake;
+static std::condition_variable persist_idle;
+static std::thread persist_writer;
+static bool persist_running;
+static bool persist_stop;
+static bool persist_busy;
+
+static unsigned long persist_marks[PERSIST_MAX];
+static unsigned long persist_saves[PERSIST_MAX];
+static unsigned long persist_save_usec;
+static unsigned long persist_over_budget;
+static size_t persist_peak;
+static time_t persist_since;
+static std::atomic < unsigned long > persist_written;
+static std::atomic < unsigned long > persist_deleted;
+static std::atomic < unsigned long > persist_failed;
+static std::atomic < unsigned long > persist_bytes;
+static std::atomic < unsigned long > persist_write_usec;
+
+static const char *const persist_kind_name[PERSIST_MAX] = {
+        "homes", "accounts", "clans", "planets", "ships"
+};
+
+static bool persist_save_home(const char *key)
+{
+        HOME_DATA *home;
+
+        for (home = first_home; home; home = home->next)
+                if (home->filename && !str_cmp(home->filename, key))
+                {
+                        home->save();
+                        return TRUE;
+                }
+        return FALSE;
+}
+
+static bool persist_save_account(const char *key)
+{
+        BANK_ACCOUNT *account;
+
+        if ((account = account_by_code(key)) == NULL)
+                return FALSE;
+        save_baccount(account);
+        return TRUE;
+}
+
+static bool persist_save_clan(const char *key)
+{
+        CLAN_DATA *clan;
+
+        for (clan = first_clan; clan; clan = clan->next)
+                if (clan->filename && !str_cmp(clan->filename, key))
+                {
+                        save_clan(clan);
+                        return TRUE;
+                }
+        return FALSE;
+}
+
+static bool persist_save_planet(const char *key)
+{
+        PLANET_DATA *planet;
+
+        for (planet = first_planet; planet; planet = planet->next)
+                if (planet->filename && !str_cmp(planet->filename, key))
+                {
+                        save_planet(planet, FALSE);
+                        return TRUE;
+                }
+        return FALSE;
+}
+
+static bool persist_save_ship(const char *key)
+{
+        SHIP_DATA *ship;
+
+        for (ship = first_ship; ship; ship = ship->next)
+                if (ship->filename && !str_cmp(ship->filename, key))
+                {
+                        save_ship(ship);
+                        return TRUE;
+                }
+        return FALSE;
+}
+
+static bool (*const persist_savers[PERSIST_MAX]) (const char *key) = {
+        persist_save_home, persist_save_account, persist_save_clan,
+        persist_save_planet, persist_save_ship
+};
+
+static long persist_usec_since(const struct timeval &start)
+{
+        struct timeval now;
+
+        gettimeofday(&now, NULL);
+        return (now.tv_sec - start.tv_sec) * 1000000L + (now.tv_usec -
+                                                         start.tv_usec);
+}
+
+/*
+ * Write one file: data to "<path>.tmp", synced, then renamed over path.
+ */
+static void persist_do_write(persist_write & w)
+{
+        std::string tmp = w.path + ".tmp";
+        struct timeval start;
+        char      buf[MAX_STRING_LENGTH];
+        FILE     *fp;
+        bool      ok;
+
+        if (w.remove)
+        {
+                if (::remove(w.path.c_str()) == 0)
+                        persist_deleted++;
+                return;
+        }
+
+        gettimeofday(&start, NULL);
+        if ((fp = fopen(tmp.c_str(), "we")) == NULL)
+        {
+                snprintf(buf, MSL, "persist: can't open %s: %s",
+                         tmp.c_str(), strerror(errno));
+                log_record_main(buf, LOGSEV_BUG, LOG_NORMAL);
+                persist_failed++;
+                return;
+        }
+        ok = fwrite(w.data.data(), 1, w.data.size(), fp) == w.data.size();
+        ok = fflush(fp) == 0 && ok;
+        ok = fsync(fileno(fp)) == 0 && ok;
+        ok = fclose(fp) == 0 && ok;
+        if (!ok || rename(tmp.c_str(), w.path.c_str()) != 0)
+        {
+                snprintf(buf, MSL, "persist: can't write %s: %s",
+                         w.path.c_str(), strerror(errno));
+                log_record_main(buf, LOGSEV_BUG, LOG_NORMAL);
+                ::remove(tmp.c_str());
+                persist_failed++;
+                return;
+        }
+        persist_written++;
+        persist_bytes += w.data.size();
+        persist_write_usec +=
+                static_cast<unsigned long>(UMAX(0, persist_usec_since(start)));
+}
+
+static void persist_writer_loop(void)
+{
+        std::unique_lock < std::mutex > lock(persist_mutex);
+
+        for (;;)
+        {
+                if (persist_writes.empty())
+                {
+                        persist_busy = FALSE;
+                        persist_idle.notify_all();
+                        if (persist_stop)
+                                break;
+                        persist_wake.wait(lock);
+                        continue;
+                }
+
+                persist_write w = std::move(persist_writes.front());
+
+                persist_writes.pop_front();
+                persist_busy = TRUE;
+                lock.unlock();
+                persist_do_write(w);
+                lock.lock();
+        }
+}
+
+static void persist_push(persist_write & w)
+{
+        if (!persist_running)
+        {
+                persist_do_write(w);
+                return;
+        }
+
+        std::lock_guard < std::mutex > lock(persist_mutex);
+
+        persist_writes.push_back(std::move(w));
+        if (persist_writes.size() > persist_peak)
+                persist_peak = persist_writes.size();
+        persist_wake.notify_one();
+}
+
+/*
+ * Queue an object for saving.  Marks during boot are ignored, since
+ * loading is what puts objects into homes in the first place.
+ */
+void persist_mark(int kind, const char *key)
+{
+        if (fBootDb || kind < 0 || kind >= PERSIST_MAX || !key || !*key)
+                return;
+        if (!persist_marked[kind].insert(key).second)
+                return;
+        persist_marks[kind]++;
+        persist_queue.push_back({ kind, key });
+}
+
+bool persist_dirty(int kind, const char *key)
+{
+        if (kind < 0 || kind >= PERSIST_MAX || !key)
+                return FALSE;
+        return persist_marked[kind].count(key) > 0;
+}
+
+/*
+ * Save the oldest dirty object.  Returns FALSE once there are none.
+ */
+static bool persist_save_next(void)
+{
+        persist_dirty_entry entry;
+
+        if (persist_queue.empty())
+                return FALSE;
+        entry = std::move(persist_queue.front());
+        persist_queue.pop_front();
+        persist_marked[entry.kind].erase(entry.key);
+        if ((*persist_savers[entry.kind]) (entry.key.c_str()))
+                persist_saves[entry.kind]++;
+        return TRUE;
+}
+
+/*
+ * Called every pulse.  At least one object is saved per pulse, more
+ * while the budget lasts.
+ */
+void persist_update(void)
+{
+        struct timeval start;
+        long      used = 0;
+
+        if (persist_queue.empty())
+                return;
+        gettimeofday(&start, NULL);
+        while (persist_save_next())
+                if ((used = persist_usec_since(start)) >= PERSIST_BUDGET)
+                        break;
+        if (used < 0)
+                used = 0;
+        persist_save_usec += static_cast<unsigned long>(used);
+        if (!persist_queue.empty())
+                persist_over_budget++;
+}
+
+/*
+ * Start building a file in memory.  Pair with persist_close().
+ */
+FILE     *persist_open(const char *path)
+{
+        persist_buffer *pb = new persist_buffer;
+        FILE     *fp;
+
+        pb->data = NULL;
+        pb->size = 0;
+        if ((fp = open_memstream(&pb->data, &pb->size)) == NULL)
+        {
+                delete    pb;
+
+                return NULL;
+        }
+        pb->path = path;
+        persist_buffers[fp] = pb;
+        return fp;
+}
+
+/*
+ * Finish a file from persist_open() and queue it for writing.
+ */
+void persist_close(FILE * fp)
+{
+        persist_write w;
+        persist_buffer *pb;
+        auto      it = persist_buffers.find(fp);
+
+        if (!fp)
+                return;
+        if (it == persist_buffers.end())
+        {
+                bug("persist_close: not a persist_open() file", 0);
+                fclose(fp);
+                return;
+        }
+        pb = it->second;
+        persist_buffers.erase(it);
+        fclose(fp);
+        w.path = pb->path;
+        w.data.assign(pb->data, pb->size);
+        w.remove = FALSE;
+        free(pb->data);
+        delete    pb;
+
+        persist_push(w);
+}
+
+/*
+ * Delete a file once any write already queued for it is done.
+ */
+void persist_remove(const char *path)
+{
+        persist_write w;
+
+        w.path = path;
+        w.remove = TRUE;
+        persist_push(w);
+}
+
+void init_persist(void)
+{
+        if (persist_running)
+                return;
+        if (!persist_since)
+                persist_since = current_time;
+        persist_stop = FALSE;
+        persist_busy = FALSE;
+        persist_running = TRUE;
+        persist_writer = std::thread(persist_writer_loop);
+}
+
+/*
+ * Wait until everything queued for the writer is on disk.
+ */
+void persist_flush(void)
+{
+        std::unique_lock < std::mutex > lock(persist_mutex);
+
+        if (!persist_running)
+                return;
+        persist_idle.wait(lock, [] {
+                          return persist_writes.empty() && !persist_busy;}
+        );
+}
+
+/*
+ * Save everything still dirty, then stop the writer once it has caught
+ * up.  Needed before exit and before hotboot's exec().
+ */
+void shutdown_persist(void)
+{
+        while (persist_save_next())
+                ;
+        if (!persist_running)
+                return;
+        {
+                std::lock_guard < std::mutex > lock(persist_mutex);
+
+                persist_stop = TRUE;
+                persist_wake.notify_one();
+        }
+        if (persist_writer.joinable())
+                persist_writer.join();
+        persist_running = FALSE;
+}
+
+CMDF do_persiststat(CHAR_DATA * ch, char *argument)
+{
+        unsigned long saves = 0;
+        size_t    backlog;
+        long      uptime;
+        int       i;
+
+        (void) argument;
+        {
+                std::lock_guard < std::mutex > lock(persist_mutex);
+
+                backlog = persist_writes.size();
+        }
+        uptime = UMAX(1, static_cast<long>(current_time - persist_since));
+
+        set_pager_color(AT_PLAIN, ch);
+        pager_printf(ch, "&BWriter:&w    %s\n\r",
+                     persist_running ? "running" : "stopped (writing synchronously)");
+        pager_printf(ch, "&BDirty:&w     %lu objects waiting to be saved\n\r",
+                     static_cast<unsigned long>(persist_queue.size()));
+        pager_printf(ch, "&BBacklog:&w   %lu files waiting to be written, peak %lu\n\r",
+                     static_cast<unsigned long>(backlog),
+                     static_cast<unsigned long>(persist_peak));
+        send_to_pager("\n\r&BKind       Marked    Saved  Waiting&w\n\r", ch);
+        for (i = 0; i < PERSIST_MAX; i++)
+        {
+                pager_printf(ch, "%-8s %8lu %8lu %8lu\n\r",
+                             persist_kind_name[i], persist_marks[i],
+                             persist_saves[i],
+                             static_cast<unsigned long>(persist_marked[i].size()));
+                saves += persist_saves[i];
+        }
+        pager_printf(ch, "\n\r&BSaving:&w    %lu usec total, %lu pulses left work over (budget %d usec)\n\r",
+                     persist_save_usec, persist_over_budget, PERSIST_BUDGET);
+        pager_printf(ch, "&BWritten:&w   %lu files, %lu bytes, %lu deleted, %lu failed\n\r",
+                     persist_written.load(), persist_bytes.load(),
+                     persist_deleted.load(), persist_failed.load());
+        pager_printf(ch, "&BRates:&w     %.2f saves/min, %.2f writes/min, %.1f bytes/sec, %lu usec/write\n\r",
+                     static_cast<double>(saves) * 60.0 / static_cast<double>(uptime),
+                     static_cast<double>(persist_written.load()) * 60.0 /
+                     static_cast<double>(uptime),
+                     static_cast<double>(persist_bytes.load()) /
+                     static_cast<double>(uptime),
+                     persist_written.load() ?
+                     persist_write_usec.load() / persist_written.load() : 0);
+}
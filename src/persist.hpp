@@ -0,0 +1,83 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                               SWTFE Persistence Module                                *
+ ****************************************************************************************/
+#ifndef _PERSIST_H_
+#define _PERSIST_H_
+
+/*
+ * Deferred, atomic saving of homes, bank accounts, clans, planets and
+ * ships.
+ *
+ * Code that changes one of these marks it dirty with persist_mark()
+ * instead of saving on the spot.  Homes are also marked wholesale on a
+ * slow timer by save_homes_check().  Each pulse,
+ * persist_update() saves dirty objects until PERSIST_BUDGET is spent.
+ * An object is marked by its file name (its code, for bank accounts) and
+ * looked up again when its turn comes, so nothing needs unmarking when
+ * one is destroyed.
+ *
+ * The save functions write through persist_open()/persist_close().  The
+ * file is built in memory and handed to a writer thread, which writes
+ * "<file>.tmp", syncs it and renames it over the old one.  A crash leaves
+ * either the old file or the new one, never half of one.  persist_remove()
+ * queues a delete behind any pending write of the same file.
+ *
+ * Before init_persist() and after shutdown_persist(), files are written
+ * on the calling thread.  shutdown_persist() saves everything still
+ * dirty first.
+ */
+#define PERSIST_BUDGET		2000	/* Microseconds of saving per pulse */
+
+typedef enum
+{
+        PERSIST_HOME, PERSIST_ACCOUNT, PERSIST_CLAN, PERSIST_PLANET,
+        PERSIST_SHIP, PERSIST_MAX
+} persist_kinds;
+
+void      init_persist(void);
+void      shutdown_persist(void);
+void      persist_flush(void);
+void      persist_update(void);
+void      persist_mark(int kind, const char *key);
+bool      persist_dirty(int kind, const char *key);
+FILE     *persist_open(const char *path);
+void      persist_close(FILE * fp);
+void      persist_remove(const char *path);
+
+#endif
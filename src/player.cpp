@@ -55,16 +55,8 @@
 #include "bounty.hpp"
 #include "account.hpp"
 #include "races.hpp"
-/* Telnet protocol constants for GMCP */
-#ifndef IAC
-#define IAC 255
-#endif
-#ifndef SB
-#define SB 250
-#endif
-#ifndef SE
-#define SE 240
-#endif
+#include "telemetry.hpp"
+#include "channels.hpp"
 // Standard library includes for STL and C string usage
 #include <vector>
 #include <string>
@@ -1416,48 +1408,6 @@ int count_obj_in_inventory(CHAR_DATA * ch, int vnum)
     return count;
 }
 
-/*
- * Helper to send a GMCP event over the descriptor, framing with Telnet IAC SB ... IAC SE
- * and doubling any IAC bytes inside the payload.
- */
-static void send_gmcp_event(DESCRIPTOR_DATA *d, const char *event, const char *data)
-{
-    if (!d || !event)
-        return;
-
-    std::string sb;
-    size_t event_len = strlen(event);
-    size_t data_len = data ? strlen(data) : 0;
-
-    sb.reserve(6 + event_len + (data_len ? (1 + data_len) : 0));
-
-    sb.push_back((char)IAC);
-    sb.push_back((char)SB);
-
-    /* Many MUD implementations put the literal "GMCP" after SB */
-    sb += "GMCP ";
-    sb += event;
-
-    if (data && data_len > 0)
-    {
-        sb.push_back(' ');
-        /* escape any IAC bytes inside the data by doubling them */
-        for (size_t i = 0; i < data_len; ++i)
-        {
-            unsigned char c = static_cast<unsigned char>(data[i]);
-            if (c == IAC)
-                sb.push_back((char)IAC);
-            sb.push_back((char)c);
-        }
-    }
-
-    sb.push_back((char)IAC);
-    sb.push_back((char)SE);
-
-    /* write_to_descriptor expects an int length and a modifiable buffer pointer */
-    write_to_descriptor(d->descriptor, const_cast<char*>(sb.c_str()), (int)sb.size());
-}
-
 CMDF do_inventory(CHAR_DATA *ch, char *argument)
 {
         OBJ_DATA *obj;
@@ -1531,20 +1481,6 @@ CMDF do_inventory(CHAR_DATA *ch, char *argument)
                                 items += "]";
 
                 // 2c) Send Telnet/GMCP framing + payload
-
-                // Ensure protocol macros are defined
-#ifndef IAC
-#define IAC 255
-#endif
-#ifndef SB
-#define SB 250
-#endif
-#ifndef SE
-#define SE 240
-#endif
-                /* Use centralized helper to send GMCP events with proper framing
-                 * and IAC escaping. send_gmcp_event will send: IAC SB GMCP <event> <data> IAC SE
-                 */
                 send_gmcp_event(ch->desc, "Core.Character.Inventory", items.c_str());
         }
 
@@ -2033,7 +1969,7 @@ CMDF do_prompt(CHAR_DATA * ch, char *argument)
         return;
 }
 
-char     *smash_color(char *str)
+char     *smash_color(const char *str)
 {
         static char ret[MAX_STRING_LENGTH];
         char     *retptr;
@@ -2286,6 +2222,7 @@ CMDF do_rpreward(CHAR_DATA * ch, char *argument)
                         ("&GYour new clan has been created. Use clanstat and clanset to modify.&D\n\r",
                          ch);
                 ch->pcdata->clan = clan;
+                channel_listeners_changed();
                 ch->pcdata->account->rpcurrent -= 10;
                 save_account(ch->pcdata->account);
                 return;
@@ -0,0 +1,465 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                             SWTFE Compiled Prompt Module                              *
+ ****************************************************************************************/
+#include <sys/types.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <string>
+#include <vector>
+#include "mud.hpp"
+#include "mxp.hpp"
+#include "prompt.hpp"
+
+#define PROMPT_NONE	LLONG_MIN   /* The code shows nothing */
+
+/*
+ * A run of literal text (code 0) or one % code.
+ */
+struct prompt_op
+{
+        char      code;
+        std::string text;
+};
+
+struct prompt_slot
+{
+        std::string source;     /* The prompt string compiled */
+        std::vector < prompt_op > ops;
+        std::vector < long long >keys;  /* Value behind each code */
+        std::vector < std::string > parts;      /* Each op, rendered */
+        std::string rendered;   /* Whole prompt, ready to send */
+        long long mode;         /* Profile, flags and colours rendered for */
+        bool      compiled;
+        bool      split;        /* Ops can be rendered one at a time */
+        bool      valid;
+        unsigned long used;
+};
+
+struct prompt_cache
+{
+        prompt_slot slots[PROMPT_SLOTS];
+        unsigned long uses;
+};
+
+static const char *const prompt_bars[11] = {
+        NULL,
+        "[&R|&B&Y&G&w          ]",
+        "[&R||&B&Y&G&w         ]",
+        "[&R||&B|&Y&G&w        ]",
+        "[&R||&B||&Y&G&w       ]",
+        "[&R||&B||&Y|&G&w      ]",
+        "[&R||&B||&Y||&G&w    ]",
+        "[&R||&B||&Y||&G|&w   ]",
+        "[&R||&B||&Y||&G||&w  ]",
+        "[&R||&B||&Y||&G|||&w ]",
+        "[&R||&B||&Y||&G||||&w]"
+};
+
+static void prompt_compile(prompt_slot & slot, const char *prompt)
+{
+        prompt_op literal, code;
+
+        slot.source = prompt;
+        slot.ops.clear();
+        literal.code = 0;
+
+        for (; *prompt; prompt++)
+        {
+                if (*prompt != '%')
+                {
+                        literal.text += *prompt;
+                        continue;
+                }
+                if (!*++prompt)
+                        break;
+                switch (*prompt)
+                {
+                case '%':
+                        literal.text += '%';
+                        continue;
+                case '_':
+                        literal.text += "\n\r";
+                        continue;
+                case 'a': case 'b': case 'C': case 'c': case 'e': case 'E':
+                case 'h': case 'H': case 'T': case 'u': case 'U': case 'v':
+                case 'V': case 'm': case 'M': case 'g': case 'r': case 'R':
+                case 'i': case 'I':
+                        break;
+                default:
+                        /*
+                         * Unknown codes print nothing 
+                         */
+                        continue;
+                }
+                if (!literal.text.empty())
+                {
+                        slot.ops.push_back(literal);
+                        literal.text.clear();
+                }
+                code.code = *prompt;
+                slot.ops.push_back(code);
+        }
+        if (!literal.text.empty())
+                slot.ops.push_back(literal);
+
+        /*
+         * Literal text ending in a color lead, or carrying MXP markup,
+         * could run into the op after it, so such prompts are rendered
+         * whole. 
+         */
+        slot.split = TRUE;
+        for (const prompt_op & op:slot.ops)
+                if (!op.code && (strchr("&}^", op.text.back())
+                                 || op.text.find_first_of(MXP_BEG MXP_END
+                                                          MXP_AMP) !=
+                                 std::string::npos))
+                        slot.split = FALSE;
+
+        slot.keys.assign(slot.ops.size(), PROMPT_NONE);
+        slot.parts.assign(slot.ops.size(), std::string());
+        slot.compiled = TRUE;
+        slot.valid = FALSE;
+}
+
+/*
+ * The slot holding prompt, compiling it over the least recently used
+ * slot if need be.
+ */
+static prompt_slot *prompt_find(PROMPT_CACHE * cache, const char *prompt)
+{
+        prompt_slot *slot = &cache->slots[0];
+        int       i;
+
+        for (i = 0; i < PROMPT_SLOTS; i++)
+        {
+                if (cache->slots[i].compiled
+                    && cache->slots[i].source == prompt)
+                {
+                        slot = &cache->slots[i];
+                        slot->used = ++cache->uses;
+                        return slot;
+                }
+                if (cache->slots[i].used < slot->used)
+                        slot = &cache->slots[i];
+        }
+        prompt_compile(*slot, prompt);
+        slot->used = ++cache->uses;
+        return slot;
+}
+
+/*
+ * Visible players, counted once a second rather than once per prompt.
+ */
+static int prompt_users(void)
+{
+        static time_t counted = -1;
+        static int count;
+        DESCRIPTOR_DATA *d;
+
+        if (counted == current_time)
+                return count;
+        counted = current_time;
+        count = 0;
+        for (d = first_descriptor; d; d = d->next)
+                if (d->connected == CON_PLAYING && d->character
+                    && !IS_SET(d->character->act, PLR_WIZINVIS))
+                        count++;
+        return count;
+}
+
+static int prompt_percent(CHAR_DATA * victim)
+{
+        if (victim->max_hit > 0)
+                return (100 * victim->hit) / victim->max_hit;
+        return -1;
+}
+
+/*
+ * The value a code shows.  Two calls giving the same key format the
+ * same.
+ */
+static long long prompt_key(char code, CHAR_DATA * ch, CHAR_DATA * och)
+{
+        CHAR_DATA *victim;
+
+        switch (code)
+        {
+        case 'a':
+                if (ch->top_level >= 10)
+                        return ch->alignment;
+                /*
+                 * The words sit above any alignment 
+                 */
+                return IS_GOOD(ch) ? 100000 : IS_EVIL(ch) ? 100001 : 100002;
+        case 'b':
+                return exp_level(ch->skill_level[COMBAT_ABILITY] + 1) -
+                        ch->experience[COMBAT_ABILITY];
+        case 'C':
+        case 'E':
+                return prompt_percent(ch);
+        case 'c':
+        case 'e':
+                if ((victim = who_fighting(ch)) == NULL)
+                        return PROMPT_NONE;
+                return prompt_percent(victim);
+        case 'h':
+                return ch->hit;
+        case 'H':
+                return ch->max_hit;
+        case 'T':
+                if (time_info.hour < 5)
+                        return 0;
+                if (time_info.hour < 6)
+                        return 1;
+                if (time_info.hour < 19)
+                        return 2;
+                if (time_info.hour < 21)
+                        return 3;
+                return 0;
+        case 'u':
+                return prompt_users();
+        case 'U':
+                return sysdata.maxplayers;
+        case 'v':
+        case 'm':
+                return ch->endurance;
+        case 'V':
+        case 'M':
+                return ch->max_endurance;
+        case 'g':
+                return static_cast<int>(ch->gold);
+        case 'r':
+                if (IS_IMMORTAL(och) && ch->in_room)
+                        return ch->in_room->vnum;
+                return PROMPT_NONE;
+        case 'R':
+                if (IS_SET(och->act, PLR_ROOMVNUM) && ch->in_room)
+                        return ch->in_room->vnum;
+                return PROMPT_NONE;
+        case 'i':
+                if (!IS_NPC(ch) && IS_SET(ch->act, PLR_WIZINVIS))
+                        return ch->pcdata->wizinvis;
+                if (IS_NPC(ch) && IS_SET(ch->act, ACT_MOBINVIS))
+                        return ch->mobinvis;
+                if (IS_AFFECTED(ch, AFF_INVISIBLE))
+                        return -1;
+                return PROMPT_NONE;
+        case 'I':
+                if (IS_NPC(ch))
+                        return IS_SET(ch->act, ACT_MOBINVIS) ? ch->mobinvis : 0;
+                return IS_SET(ch->act, PLR_WIZINVIS) ? ch->pcdata->wizinvis : 0;
+        }
+        return PROMPT_NONE;
+}
+
+static void prompt_format(char *buf, size_t size, char code, long long key)
+{
+        static const char *const times[4] = { "night", "dawn", "day", "dusk" };
+        buf[0] = '\0';
+        if (key != PROMPT_NONE)
+                switch (code)
+                {
+                default:
+                        snprintf(buf, size, "%lld", key);
+                        break;
+                case 'a':
+                        if (key >= 100000)
+                                mudstrlcpy(buf, key == 100000 ? "good"
+                                           : key == 100001 ? "evil" :
+                                           "neutral", size);
+                        else
+                                snprintf(buf, size, "%lld", key);
+                        break;
+                case 'C':
+                case 'c':
+                        snprintf(buf, size, "&%c%lld&w",
+                                 key >= 60 ? 'G' : key >= 40 ? 'Y' : key >=
+                                 20 ? 'B' : 'R', key);
+                        break;
+                case 'E':
+                case 'e':
+                        if (key >= 10)
+                                mudstrlcpy(buf, prompt_bars[UMIN(key / 10, 10)],
+                                           size);
+                        else
+                                snprintf(buf, size,
+                                         "[&R    %lld%%&w    ]", key);
+                        break;
+                case 'T':
+                        mudstrlcpy(buf, times[key], size);
+                        break;
+                case 'R':
+                        snprintf(buf, size, "<#%lld> ", key);
+                        break;
+                case 'i':
+                        if (key >= 0)
+                                snprintf(buf, size, "(Invis %lld) ",
+                                         key);
+                        else
+                                mudstrlcpy(buf, "(Invis) ", size);
+                        break;
+                }
+}
+
+/*
+ * Render one op into its part.
+ */
+static void prompt_part(prompt_slot * slot, size_t i, int profile,
+                        CHAR_DATA * ch)
+{
+        char      buf[MAX_INPUT_LENGTH];
+        const char *txt = buf;
+        int       len;
+
+        if (slot->ops[i].code)
+        {
+                prompt_format(buf, sizeof(buf), slot->ops[i].code,
+                              slot->keys[i]);
+                len = static_cast<int>(strlen(buf));
+        }
+        else
+        {
+                txt = slot->ops[i].text.data();
+                len = static_cast<int>(slot->ops[i].text.size());
+        }
+        slot->parts[i].clear();
+        render_to_string(slot->parts[i], txt, len, profile, ch);
+}
+
+/*
+ * Send prompt to d, as seen by ch (och if switched).
+ */
+void prompt_write(DESCRIPTOR_DATA * d, CHAR_DATA * ch, CHAR_DATA * och,
+                  const char *prompt)
+{
+        bool      ansi = (!IS_NPC(och) && IS_SET(och->act, PLR_ANSI));
+        bool      mxp = IS_MXP(ch);
+        int       profile = render_profile(d, ch);
+        int       pagecolor = static_cast<unsigned char>(d->pagecolor);
+        long long mode;
+        prompt_slot *slot;
+        long long key;
+        size_t    i;
+        bool      fRemode, fChanged;
+
+        if (!d->prompt_cache)
+                d->prompt_cache = new PROMPT_CACHE();
+        slot = prompt_find(d->prompt_cache, prompt);
+
+        /*
+         * &D resets to color_str(pagecolor), which is the user's own
+         * colour for that slot, so a 'color' change has to re-render.
+         */
+        mode = profile | (ansi ? BV08 : 0) | (mxp ? BV09 : 0)
+                | (static_cast<long long>(pagecolor) << 16);
+        if (pagecolor < MAX_COLORS)
+                mode |= static_cast<long long>(static_cast<unsigned short>(ch->colors[pagecolor])) << 24;
+        fRemode = !slot->valid || slot->mode != mode;
+        fChanged = fRemode;
+
+        for (i = 0; i < slot->ops.size(); i++)
+        {
+                if (!slot->ops[i].code)
+                {
+                        if (fRemode && slot->split)
+                                prompt_part(slot, i, profile, ch);
+                        continue;
+                }
+                key = prompt_key(slot->ops[i].code, ch, och);
+                if (!fRemode && key == slot->keys[i])
+                        continue;
+                slot->keys[i] = key;
+                if (slot->split)
+                        prompt_part(slot, i, profile, ch);
+                fChanged = TRUE;
+        }
+
+        if (fChanged)
+        {
+                slot->rendered.clear();
+                if (mxp)
+                        render_to_string(slot->rendered, MXPTAG("Prompt"),
+                                         static_cast<int>(strlen(MXPTAG("Prompt"))),
+                                         profile, ch);
+                if (ansi)
+                        slot->rendered += ANSI_RESET;
+                if (slot->split)
+                        for (i = 0; i < slot->parts.size(); i++)
+                                slot->rendered += slot->parts[i];
+                else
+                {
+                        std::string text;
+                        char      buf[MAX_INPUT_LENGTH];
+
+                        for (i = 0; i < slot->ops.size(); i++)
+                        {
+                                if (!slot->ops[i].code)
+                                {
+                                        text += slot->ops[i].text;
+                                        continue;
+                                }
+                                prompt_format(buf, sizeof(buf),
+                                              slot->ops[i].code,
+                                              slot->keys[i]);
+                                text += buf;
+                        }
+                        render_to_string(slot->rendered, text.data(),
+                                         static_cast<int>(text.size()),
+                                         profile, ch);
+                }
+                if (mxp)
+                        render_to_string(slot->rendered, MXPTAG("/Prompt"),
+                                         static_cast<int>(strlen(MXPTAG("/Prompt"))),
+                                         profile, ch);
+                slot->mode = mode;
+                slot->valid = TRUE;
+        }
+
+        if (ansi)
+                d->prevcolor = 0x08;
+        write_to_buffer_raw(d, slot->rendered.data(),
+                            static_cast<int>(slot->rendered.size()));
+}
+
+void free_prompt_cache(DESCRIPTOR_DATA * d)
+{
+        delete d->prompt_cache;
+        d->prompt_cache = NULL;
+}
@@ -0,0 +1,63 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                             SWTFE Compiled Prompt Module                              *
+ ****************************************************************************************/
+#ifndef _PROMPT_H_
+#define _PROMPT_H_
+
+/*
+ * Compiled prompts.
+ *
+ * A prompt string is parsed once into a list of ops, each a run of
+ * literal text or a single % code, and kept on the descriptor with its
+ * last rendering.  Each flush reads the raw value behind every % code
+ * (hit points, endurance, the victim's condition and so on).  Only codes
+ * whose value moved are formatted again; if none did, the bytes already
+ * rendered for the client's color and MXP profile are sent as they are.
+ *
+ * A descriptor keeps PROMPT_SLOTS compiled prompts, so switching between
+ * prompt and fprompt in a fight does not recompile either.  A changed
+ * prompt string is compiled the next time it is shown.
+ */
+#define PROMPT_SLOTS		2
+
+void      prompt_write(DESCRIPTOR_DATA * d, CHAR_DATA * ch, CHAR_DATA * och,
+                       const char *prompt);
+void      free_prompt_cache(DESCRIPTOR_DATA * d);
+
+#endif
@@ -54,6 +54,7 @@
 #include <string.h>
 #include <ctype.h>
 #include "mud.hpp"
+#include "search.hpp"
 
 #define NOT_FOUND (-1)
 enum
@@ -456,6 +457,7 @@ void renumber_area(CHAR_DATA * ch, AREA_DATA * area, RENUMBER_AREA * r_area,
         high = UMAX(area->hi_r_vnum, UMIN(area->hi_o_vnum, area->hi_m_vnum));
         low = UMIN(area->low_r_vnum,
                    UMIN(area->low_o_vnum, area->low_m_vnum));
+        invalidate_reset_progs();
 
         pager_printf(ch, "(Room) Renumbering...\n\r");
 
@@ -508,6 +510,8 @@ void renumber_area(CHAR_DATA * ch, AREA_DATA * area, RENUMBER_AREA * r_area,
                         room->next = NULL;
                 }
 
+                room_index_table.remove(r_data->old_vnum, room);
+
                 /*
                  * change the vnum 
                  */
@@ -531,6 +535,7 @@ void renumber_area(CHAR_DATA * ch, AREA_DATA * area, RENUMBER_AREA * r_area,
                 iHash = room->vnum % MAX_KEY_HASH;
                 room->next = room_index_hash[iHash];
                 room_index_hash[iHash] = room;
+                room_index_table.set(room->vnum, room);
         }
         /*
          * if nothing was moved, or if the area is proto, dont change this 
@@ -599,6 +604,9 @@ void renumber_area(CHAR_DATA * ch, AREA_DATA * area, RENUMBER_AREA * r_area,
                         mob->next = NULL;
                 }
 
+                mob_index_table.remove(r_data->old_vnum, mob);
+                search_invalidate();
+
                 /*
                  * change the vnum 
                  */
@@ -619,6 +627,8 @@ void renumber_area(CHAR_DATA * ch, AREA_DATA * area, RENUMBER_AREA * r_area,
                 iHash = mob->vnum % MAX_KEY_HASH;
                 mob->next = mob_index_hash[iHash];
                 mob_index_hash[iHash] = mob;
+                mob_index_table.set(mob->vnum, mob);
+                search_invalidate();
         }
         if (r_area->r_mob && !area_is_proto)
         {
@@ -661,6 +671,9 @@ void renumber_area(CHAR_DATA * ch, AREA_DATA * area, RENUMBER_AREA * r_area,
                         obj->next = NULL;
                 }
 
+                obj_index_table.remove(r_data->old_vnum, obj);
+                search_invalidate();
+
                 /*
                  * change the vnum 
                  */
@@ -681,6 +694,8 @@ void renumber_area(CHAR_DATA * ch, AREA_DATA * area, RENUMBER_AREA * r_area,
                 iHash = obj->vnum % MAX_KEY_HASH;
                 obj->next = obj_index_hash[iHash];
                 obj_index_hash[iHash] = obj;
+                obj_index_table.set(obj->vnum, obj);
+                search_invalidate();
         }
         if (r_area->r_obj && !area_is_proto)
         {
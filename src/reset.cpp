@@ -49,6 +49,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <vector>
 #include "mud.hpp"
 #include "installations.hpp"
 
@@ -216,6 +219,7 @@ void delete_reset(AREA_DATA * pArea, RESET_DATA * pReset)
         RESET_DATA *reset;
         RESET_DATA *reset_prev;
 
+        invalidate_reset_progs();
         if (pReset->command == 'M')
         {
                 for (reset = pReset->next; reset; reset = reset->next)
@@ -536,6 +540,7 @@ void edit_reset(CHAR_DATA * ch, char *argument, AREA_DATA * pArea,
                         pArea->last_reset = reset;
                 else
                         pReset->next->prev = reset;
+                invalidate_reset_progs();
                 DISPOSE(pReset);
                 send_to_char("Done.\n\r", ch);
                 return;
@@ -624,6 +629,7 @@ void edit_reset(CHAR_DATA * ch, char *argument, AREA_DATA * pArea,
                                next, prev);
                         if (pReset == pArea->last_mob_reset)
                                 pArea->last_mob_reset = NULL;
+                        invalidate_reset_progs();
                         DISPOSE(pReset);
                         top_reset--;
                         found = TRUE;
@@ -1404,25 +1410,259 @@ int generate_itemlevel(AREA_DATA * pArea, OBJ_INDEX_DATA * pObjIndex)
         return olevel;
 }
 
+/*
+ * Compiled reset programs.
+ *
+ * Every index lookup a reset needs is resolved once into a flat array of
+ * ops, so an area reset only walks pointers.  Anything that can change
+ * what a reset resolves to (reset edits, index creation/deletion,
+ * renumbering) bumps reset_generation and the program is rebuilt on the
+ * next reset.  Exits are still looked up at run time.
+ */
+struct reset_op
+{
+        RESET_DATA *reset;
+        MOB_INDEX_DATA *mob;
+        OBJ_INDEX_DATA *obj;
+        OBJ_INDEX_DATA *obj_to;
+        ROOM_INDEX_DATA *room;
+        ROOM_INDEX_DATA *room_prev;     /* 'M': checked for ROOM_PET_SHOP */
+};
+
+struct reset_prog
+{
+        std::vector<reset_op> ops;
+        int       generation;
+        int       bad;
+        int       compiles;
+        int       runs;
+        long long last_usec;
+        long long max_usec;
+        long long total_usec;
+};
+
+static int reset_generation = 1;
+
+void invalidate_reset_progs(void)
+{
+        reset_generation++;
+}
+
+void free_reset_prog(AREA_DATA * pArea)
+{
+        delete pArea->reset_prog;
+        pArea->reset_prog = NULL;
+}
+
+/*
+ * Resolve a single reset, returns FALSE (after logging) if it can never run.
+ */
+static bool compile_reset(RESET_DATA * pReset, reset_op & op)
+{
+        op.reset = pReset;
+        op.mob = NULL;
+        op.obj = NULL;
+        op.obj_to = NULL;
+        op.room = NULL;
+        op.room_prev = NULL;
+
+        switch (pReset->command)
+        {
+        default:
+                bug("Reset_area: bad command %c.", pReset->command);
+                return FALSE;
+
+        case 'M':
+                if (!(op.mob = get_mob_index(pReset->arg1)))
+                {
+                        bug("Reset_area: 'M': bad mob vnum %d.",
+                            pReset->arg1);
+                        return FALSE;
+                }
+                if (!(op.room = get_room_index(pReset->arg3)))
+                {
+                        bug("Reset_area: 'M': bad room vnum %d.",
+                            pReset->arg3);
+                        return FALSE;
+                }
+                op.room_prev = get_room_index(pReset->arg3 - 1);
+                break;
+
+        case 'G':
+        case 'E':
+                if (!(op.obj = get_obj_index(pReset->arg1)))
+                {
+                        bug("Reset_area: 'E' or 'G': bad obj vnum %d.",
+                            pReset->arg1);
+                        return FALSE;
+                }
+                break;
+
+        case 'O':
+                if (!(op.obj = get_obj_index(pReset->arg1)))
+                {
+                        bug("Reset_area: 'O': bad obj vnum %d.",
+                            pReset->arg1);
+                        return FALSE;
+                }
+                if (!(op.room = get_room_index(pReset->arg3)))
+                {
+                        bug("Reset_area: 'O': bad room vnum %d.",
+                            pReset->arg3);
+                        return FALSE;
+                }
+                break;
+
+        case 'P':
+                if (!(op.obj = get_obj_index(pReset->arg1)))
+                {
+                        bug("Reset_area: 'P': bad obj vnum %d.",
+                            pReset->arg1);
+                        return FALSE;
+                }
+                if (pReset->arg3 > 0
+                    && !(op.obj_to = get_obj_index(pReset->arg3)))
+                {
+                        bug("Reset_area: 'P': bad objto vnum %d.",
+                            pReset->arg3);
+                        return FALSE;
+                }
+                break;
+
+        case 'T':
+                if (IS_SET(pReset->extra, TRAP_OBJ))
+                {
+                        if (pReset->arg3 > 0
+                            && !(op.obj_to = get_obj_index(pReset->arg3)))
+                        {
+                                bug("Reset_area: 'T': bad objto vnum %d.",
+                                    pReset->arg3);
+                                return FALSE;
+                        }
+                }
+                else
+                {
+                        if (!(op.room = get_room_index(pReset->arg3)))
+                        {
+                                bug("Reset_area: 'T': bad room %d.",
+                                    pReset->arg3);
+                                return FALSE;
+                        }
+                        op.obj = get_obj_index(OBJ_VNUM_TRAP);
+                }
+                break;
+
+        case 'H':
+                if (pReset->arg1 > 0
+                    && !(op.obj_to = get_obj_index(pReset->arg1)))
+                {
+                        bug("Reset_area: 'H': bad objto vnum %d.",
+                            pReset->arg1);
+                        return FALSE;
+                }
+                break;
+
+        case 'B':
+                switch (pReset->arg2 & BIT_RESET_TYPE_MASK)
+                {
+                case BIT_RESET_DOOR:
+                        if (!(op.room = get_room_index(pReset->arg1)))
+                        {
+                                bug("Reset_area: 'B': door: bad room vnum %d.", pReset->arg1);
+                                return FALSE;
+                        }
+                        break;
+                case BIT_RESET_ROOM:
+                        if (!(op.room = get_room_index(pReset->arg1)))
+                        {
+                                bug("Reset_area: 'B': room: bad room vnum %d.", pReset->arg1);
+                                return FALSE;
+                        }
+                        break;
+                case BIT_RESET_OBJECT:
+                        if (pReset->arg1 > 0
+                            && !(op.obj_to = get_obj_index(pReset->arg1)))
+                        {
+                                bug("Reset_area: 'B': object: bad objto vnum %d.", pReset->arg1);
+                                return FALSE;
+                        }
+                        break;
+                case BIT_RESET_MOBILE:
+                        break;
+                default:
+                        bug("Reset_area: 'B': bad options %d.",
+                            pReset->arg2);
+                        return FALSE;
+                }
+                break;
+
+        case 'D':
+        case 'R':
+                if (!(op.room = get_room_index(pReset->arg1)))
+                {
+                        bug("Reset_area: '%c': bad room vnum %d.",
+                            pReset->command, pReset->arg1);
+                        return FALSE;
+                }
+                break;
+        }
+        return TRUE;
+}
+
+/*
+ * (Re)build the reset program for an area if it is missing or stale.
+ * Broken resets are reported here, once, and left out of the program.
+ */
+static RESET_PROG *compile_resets(AREA_DATA * pArea)
+{
+        RESET_PROG *prog = pArea->reset_prog;
+        RESET_DATA *pReset;
+        reset_op  op;
+
+        if (!prog)
+        {
+                prog = new RESET_PROG();
+                pArea->reset_prog = prog;
+        }
+        else if (prog->generation == reset_generation)
+                return prog;
+
+        prog->ops.clear();
+        prog->bad = 0;
+        for (pReset = pArea->first_reset; pReset; pReset = pReset->next)
+        {
+                if (compile_reset(pReset, op))
+                        prog->ops.push_back(op);
+                else
+                        prog->bad++;
+        }
+        prog->generation = reset_generation;
+        prog->compiles++;
+        return prog;
+}
+
 /*
  * Reset one area.
  */
 void reset_area(AREA_DATA * pArea)
 {
+        RESET_PROG *prog;
         RESET_DATA *pReset;
         CHAR_DATA *mob;
         OBJ_DATA *obj;
         OBJ_DATA *lastobj;
         ROOM_INDEX_DATA *pRoomIndex;
-        MOB_INDEX_DATA *pMobIndex;
         OBJ_INDEX_DATA *pObjIndex;
-        OBJ_INDEX_DATA *pObjToIndex;
         EXIT_DATA *pexit;
         OBJ_DATA *to_obj;
         int       level = 0;
         int      *plc = NULL;
         EXT_BV   *xplc;
         INSTALLATION_DATA *installation;
+        struct timeval start_time;
+        struct timeval end_time;
+        long long usec;
+        size_t    i;
 
         if (!pArea)
         {
@@ -1438,43 +1678,29 @@ void reset_area(AREA_DATA * pArea)
                 bug("%s: reset_area: no resets", pArea->filename);
                 return;
         }
+        gettimeofday(&start_time, NULL);
+        prog = compile_resets(pArea);
         level = 0;
-        for (pReset = pArea->first_reset; pReset; pReset = pReset->next)
+        for (i = 0; i < prog->ops.size(); i++)
         {
+                const reset_op &op = prog->ops[i];
+
+                pReset = op.reset;
+                pObjIndex = op.obj;
+                pRoomIndex = op.room;
                 switch (pReset->command)
                 {
-                default:
-                        bug("Reset_area: bad command %c.", pReset->command);
-                        break;
-
                 case 'M':
-                        if (!(pMobIndex = get_mob_index(pReset->arg1)))
-                        {
-                                bug("Reset_area: 'M': bad mob vnum %d.",
-                                    pReset->arg1);
-                                continue;
-                        }
-                        if (!(pRoomIndex = get_room_index(pReset->arg3)))
-                        {
-                                bug("Reset_area: 'M': bad room vnum %d.",
-                                    pReset->arg3);
-                                continue;
-                        }
-                        if (pMobIndex->count >= pReset->arg2)
+                        if (op.mob->count >= pReset->arg2)
                         {
                                 mob = NULL;
                                 break;
                         }
-                        mob = create_mobile(pMobIndex);
-                        {
-                                ROOM_INDEX_DATA *pRoomPrev =
-                                        get_room_index(pReset->arg3 - 1);
-
-                                if (pRoomPrev
-                                    && xIS_SET(pRoomPrev->room_flags,
-                                               ROOM_PET_SHOP))
-                                        SET_BIT(mob->act, ACT_PET);
-                        }
+                        mob = create_mobile(op.mob);
+                        if (op.room_prev
+                            && xIS_SET(op.room_prev->room_flags,
+                                       ROOM_PET_SHOP))
+                                SET_BIT(mob->act, ACT_PET);
                         if (room_is_dark(pRoomIndex))
                                 SET_BIT(mob->affected_by, AFF_INFRARED);
                         char_to_room(mob, pRoomIndex);
@@ -1490,11 +1716,6 @@ void reset_area(AREA_DATA * pArea)
 
                 case 'G':
                 case 'E':
-                        if (!(pObjIndex = get_obj_index(pReset->arg1)))
-                        {
-                                bug("Reset_area: 'E' or 'G': bad obj vnum %d.", pReset->arg1);
-                                continue;
-                        }
                         if (!mob)
                         {
                                 lastobj = NULL;
@@ -1525,18 +1746,6 @@ void reset_area(AREA_DATA * pArea)
                         break;
 
                 case 'O':
-                        if (!(pObjIndex = get_obj_index(pReset->arg1)))
-                        {
-                                bug("Reset_area: 'O': bad obj vnum %d.",
-                                    pReset->arg1);
-                                continue;
-                        }
-                        if (!(pRoomIndex = get_room_index(pReset->arg3)))
-                        {
-                                bug("Reset_area: 'O': bad room vnum %d.",
-                                    pReset->arg3);
-                                continue;
-                        }
                         if (count_obj_list
                             (pObjIndex, pRoomIndex->first_content) > 0)
                         {
@@ -1554,23 +1763,10 @@ void reset_area(AREA_DATA * pArea)
                         break;
 
                 case 'P':
-                        if (!(pObjIndex = get_obj_index(pReset->arg1)))
-                        {
-                                bug("Reset_area: 'P': bad obj vnum %d.",
-                                    pReset->arg1);
-                                continue;
-                        }
                         if (pReset->arg3 > 0)
                         {
-                                if (!
-                                    (pObjToIndex =
-                                     get_obj_index(pReset->arg3)))
-                                {
-                                        bug("Reset_area: 'P': bad objto vnum %d.", pReset->arg3);
-                                        continue;
-                                }
                                 if (pArea->nplayer > 0 ||
-                                    !(to_obj = get_obj_type(pObjToIndex)) ||
+                                    !(to_obj = get_obj_type(op.obj_to)) ||
                                     !to_obj->in_room ||
                                     count_obj_list(pObjIndex,
                                                    to_obj->first_content) > 0)
@@ -1617,16 +1813,9 @@ void reset_area(AREA_DATA * pArea)
 
                                 if (pReset->arg3 > 0)
                                 {
-                                        if (!
-                                            (pObjToIndex =
-                                             get_obj_index(pReset->arg3)))
-                                        {
-                                                bug("Reset_area: 'T': bad objto vnum %d.", pReset->arg3);
-                                                continue;
-                                        }
                                         if (pArea->nplayer > 0 ||
                                             !(to_obj =
-                                              get_obj_type(pObjToIndex))
+                                              get_obj_type(op.obj_to))
                                             || (to_obj->carried_by
                                                 && !IS_NPC(to_obj->
                                                            carried_by))
@@ -1646,17 +1835,8 @@ void reset_area(AREA_DATA * pArea)
                         }
                         else
                         {
-                                if (!
-                                    (pRoomIndex =
-                                     get_room_index(pReset->arg3)))
-                                {
-                                        bug("Reset_area: 'T': bad room %d.",
-                                            pReset->arg3);
-                                        continue;
-                                }
                                 if (pArea->nplayer > 0 ||
-                                    count_obj_list(get_obj_index
-                                                   (OBJ_VNUM_TRAP),
+                                    count_obj_list(pObjIndex,
                                                    pRoomIndex->
                                                    first_content) > 0)
                                         break;
@@ -1669,15 +1849,8 @@ void reset_area(AREA_DATA * pArea)
                 case 'H':
                         if (pReset->arg1 > 0)
                         {
-                                if (!
-                                    (pObjToIndex =
-                                     get_obj_index(pReset->arg1)))
-                                {
-                                        bug("Reset_area: 'H': bad objto vnum %d.", pReset->arg1);
-                                        continue;
-                                }
                                 if (pArea->nplayer > 0 ||
-                                    !(to_obj = get_obj_type(pObjToIndex)) ||
+                                    !(to_obj = get_obj_type(op.obj_to)) ||
                                     !to_obj->in_room ||
                                     to_obj->in_room->area != pArea ||
                                     IS_OBJ_STAT(to_obj, ITEM_HIDDEN))
@@ -1699,13 +1872,6 @@ void reset_area(AREA_DATA * pArea)
                                 {
                                         int       doornum;
 
-                                        if (!
-                                            (pRoomIndex =
-                                             get_room_index(pReset->arg1)))
-                                        {
-                                                bug("Reset_area: 'B': door: bad room vnum %d.", pReset->arg1);
-                                                continue;
-                                        }
                                         doornum =
                                                 (pReset->
                                                  arg2 & BIT_RESET_DOOR_MASK)
@@ -1718,28 +1884,14 @@ void reset_area(AREA_DATA * pArea)
                                 }
                                 break;
                         case BIT_RESET_ROOM:
-                                if (!
-                                    (pRoomIndex =
-                                     get_room_index(pReset->arg1)))
-                                {
-                                        bug("Reset_area: 'B': room: bad room vnum %d.", pReset->arg1);
-                                        continue;
-                                }
                                 xplc = &pRoomIndex->room_flags;
                                 break;
                         case BIT_RESET_OBJECT:
                                 if (pReset->arg1 > 0)
                                 {
-                                        if (!
-                                            (pObjToIndex =
-                                             get_obj_index(pReset->arg1)))
-                                        {
-                                                bug("Reset_area: 'B': object: bad objto vnum %d.", pReset->arg1);
-                                                continue;
-                                        }
                                         if (!
                                             (to_obj =
-                                             get_obj_type(pObjToIndex))
+                                             get_obj_type(op.obj_to))
                                             || !to_obj->in_room
                                             || to_obj->in_room->area != pArea)
                                                 continue;
@@ -1757,10 +1909,6 @@ void reset_area(AREA_DATA * pArea)
                                         continue;
                                 plc = &mob->affected_by;
                                 break;
-                        default:
-                                bug("Reset_area: 'B': bad options %d.",
-                                    pReset->arg2);
-                                continue;
                         }
                         if (IS_SET(pReset->arg2, BIT_RESET_SET))
                                 SET_BIT(*plc, pReset->arg3);
@@ -1771,12 +1919,6 @@ void reset_area(AREA_DATA * pArea)
                         break;
 
                 case 'D':
-                        if (!(pRoomIndex = get_room_index(pReset->arg1)))
-                        {
-                                bug("Reset_area: 'D': bad room vnum %d.",
-                                    pReset->arg1);
-                                continue;
-                        }
                         if (!(pexit = get_exit(pRoomIndex, pReset->arg2)))
                                 break;
                         switch (pReset->arg3)
@@ -1801,19 +1943,83 @@ void reset_area(AREA_DATA * pArea)
                         break;
 
                 case 'R':
-                        if (!(pRoomIndex = get_room_index(pReset->arg1)))
-                        {
-                                bug("Reset_area: 'R': bad room vnum %d.",
-                                    pReset->arg1);
-                                continue;
-                        }
                         randomize_exits(pRoomIndex, pReset->arg2 - 1);
                         break;
                 }
         }
+        gettimeofday(&end_time, NULL);
+        usec = static_cast<long long>(end_time.tv_sec - start_time.tv_sec) * 1000000
+                + (end_time.tv_usec - start_time.tv_usec);
+        prog->runs++;
+        prog->last_usec = usec;
+        prog->total_usec += usec;
+        if (usec > prog->max_usec)
+                prog->max_usec = usec;
         return;
 }
 
+static bool resetstat_cmp(AREA_DATA * a, AREA_DATA * b)
+{
+        return a->reset_prog->total_usec > b->reset_prog->total_usec;
+}
+
+/*
+ * Show what area resets are costing, most expensive areas first.
+ */
+CMDF do_resetstat(CHAR_DATA * ch, char *argument)
+{
+        std::vector<AREA_DATA *> areas;
+        AREA_DATA *pArea;
+        RESET_PROG *prog;
+        long long total = 0;
+        int       count = 20;
+        size_t    i;
+
+        if (argument[0] != '\0')
+        {
+                if (!is_number(argument))
+                {
+                        send_to_char("Syntax: resetstat [number of areas]\n\r",
+                                     ch);
+                        return;
+                }
+                count = atoi(argument);
+        }
+
+        for (pArea = first_area; pArea; pArea = pArea->next)
+                if (pArea->reset_prog && pArea->reset_prog->runs > 0)
+                        areas.push_back(pArea);
+        for (pArea = first_build; pArea; pArea = pArea->next)
+                if (pArea->reset_prog && pArea->reset_prog->runs > 0)
+                        areas.push_back(pArea);
+        if (areas.empty())
+        {
+                send_to_char("No areas have been reset yet.\n\r", ch);
+                return;
+        }
+        std::sort(areas.begin(), areas.end(), resetstat_cmp);
+
+        set_char_color(AT_PLAIN, ch);
+        ch_printf(ch, "%-24s %5s %4s %5s %8s %8s %8s %9s\n\r",
+                  "Area", "Ops", "Bad", "Runs", "Last us", "Avg us",
+                  "Max us", "Total ms");
+        for (i = 0; i < areas.size(); i++)
+        {
+                prog = areas[i]->reset_prog;
+                total += prog->total_usec;
+                if (static_cast<int>(i) >= count)
+                        continue;
+                ch_printf(ch, "%-24.24s %5d %4d %5d %8lld %8lld %8lld %9.1f\n\r",
+                          areas[i]->filename, static_cast<int>(prog->ops.size()),
+                          prog->bad, prog->runs, prog->last_usec,
+                          prog->total_usec / prog->runs, prog->max_usec,
+                          static_cast<double>(prog->total_usec) / 1000.0);
+        }
+        ch_printf(ch, "%d area%s reset, %.1f ms total, program generation %d.\n\r",
+                  static_cast<int>(areas.size()), areas.size() == 1 ? "" : "s",
+                  static_cast<double>(total) / 1000.0, reset_generation);
+}
+
 void list_resets(CHAR_DATA * ch, AREA_DATA * pArea, ROOM_INDEX_DATA * pRoom,
                  int start, int end)
 {
@@ -2220,6 +2426,7 @@ RESET_DATA *make_reset(char letter, int extra, int arg1, int arg2, int arg3)
         RESET_DATA *pReset;
 
         CREATE(pReset, RESET_DATA, 1);
+        invalidate_reset_progs();
         pReset->command = letter;
         pReset->extra = extra;
         pReset->arg1 = arg1;
@@ -58,6 +58,7 @@
 #include "races.hpp"
 #include "space2.hpp"
 #include "greet.hpp"
+#include "persist.hpp"
 
 /*
  * Increment with every major format change.
@@ -292,7 +293,7 @@ void save_char_obj(CHAR_DATA * ch)
          * save pc's clan's data while we're at it to keep the data in sync 
          */
         if (!IS_NPC(ch) && ch->pcdata->clan)
-                save_clan(ch->pcdata->clan);
+                persist_mark(PERSIST_CLAN, ch->pcdata->clan->filename);
 
         if (ch->desc && ch->desc->original)
                 ch = ch->desc->original;
@@ -999,8 +1000,8 @@ bool load_char_obj(DESCRIPTOR_DATA * d, char *name, bool preload,
         bool      found;
         struct stat fst;
         int       i, x;
-        extern FILE *fpArea;
-        extern char strArea[MAX_INPUT_LENGTH];
+        extern thread_local FILE *fpArea;
+        extern thread_local char strArea[MAX_INPUT_LENGTH];
         char      buf[MAX_INPUT_LENGTH];
 
         CREATE(ch, CHAR_DATA, 1);
@@ -2506,6 +2507,10 @@ void fread_obj(CHAR_DATA * ch, FILE * fp, sh_int os_type)
                                                 obj->armed_by = STRALLOC("");
                                         LINK(obj, first_object, last_object,
                                              next, prev);
+                                        LINK(obj,
+                                             obj->pIndexData->first_instance,
+                                             obj->pIndexData->last_instance,
+                                             next_instance, prev_instance);
                                         obj->pIndexData->count += obj->count;
                                         if (fNest)
                                                 rgObjNest[iNest] = obj;
@@ -2782,11 +2787,11 @@ void write_corpses(CHAR_DATA * ch, char *name)
                 name = ch->name;
         /*
          * Go by vnum, less chance of screwups. -- Altrag 
+         * The owner index only holds PC corpses, so that is a given.
          */
-        for (corpse = first_object; corpse; corpse = corpse->next)
-                if (corpse->pIndexData->vnum == OBJ_VNUM_CORPSE_PC &&
-                    corpse->in_room != NULL &&
-                    !str_cmp(corpse->short_descr + 14, name))
+        for (corpse = first_owned(OWNER_CORPSE, name); corpse;
+             corpse = corpse->next_owned)
+                if (corpse->in_room != NULL)
                 {
                         if (!fp)
                         {
@@ -2822,8 +2827,8 @@ void load_corpses(void)
 {
         DIR      *dp;
         struct dirent *de;
-        extern FILE *fpArea;
-        extern char strArea[MAX_INPUT_LENGTH];
+        extern thread_local FILE *fpArea;
+        extern thread_local char strArea[MAX_INPUT_LENGTH];
         extern int falling;
 
         if (!(dp = opendir(CORPSE_DIR)))
@@ -2891,8 +2896,8 @@ void load_vendors(void)
         DIR      *dp;
         CHAR_DATA *mob = NULL;
         struct dirent *de;
-        extern FILE *fpArea;
-        extern char strArea[MAX_INPUT_LENGTH];
+        extern thread_local FILE *fpArea;
+        extern thread_local char strArea[MAX_INPUT_LENGTH];
         extern int falling;
 
         if (!(dp = opendir(VENDOR_DIR)))
@@ -0,0 +1,662 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                              SWTFE World Search Module                                *
+ ****************************************************************************************/
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mud.hpp"
+#include "vnumtable.hpp"
+#include "search.hpp"
+
+extern VNUM_TABLE < MOB_INDEX_DATA > mob_index_table;
+extern VNUM_TABLE < OBJ_INDEX_DATA > obj_index_table;
+
+/*
+ * Name word -> prototypes with that word in their name, in vnum order.
+ */
+static std::map < std::string, std::vector < MOB_INDEX_DATA * > >mob_words;
+static std::map < std::string, std::vector < OBJ_INDEX_DATA * > >obj_words;
+static bool search_stale = TRUE;
+
+/*
+ * An asearch in progress.  The worker owns everything but lines and done,
+ * which it shares with search_update() under lock.
+ */
+struct search_job
+{
+        std::string requester;
+        std::string pattern;
+        std::vector < std::string > files;
+        std::mutex lock;
+        std::vector < std::string > lines;
+        bool      done;
+        int       hits;
+        std::atomic < bool > cancel;
+        std::thread worker;
+};
+
+static std::list < std::unique_ptr < search_job > >search_jobs;
+
+/*
+ * Mobs have no type; search_parse turns the filter away for them.
+ */
+static int index_type(MOB_INDEX_DATA * pMobIndex)
+{
+        (void) pMobIndex;
+        return -1;
+}
+
+static int index_type(OBJ_INDEX_DATA * pObjIndex)
+{
+        return pObjIndex->item_type;
+}
+
+/*
+ * Split a name list the way is_name2 does: on spaces and dashes, quotes
+ * grouping, stopping at the first empty word.  Words come back lowercased.
+ */
+static void name_words(char *namelist, std::vector < std::string > &words)
+{
+        char      name[MAX_INPUT_LENGTH];
+        char     *p;
+
+        words.clear();
+        if (!namelist)
+                return;
+        for (;;)
+        {
+                namelist = one_argument2(namelist, name);
+                if (name[0] == '\0')
+                        return;
+                for (p = name; *p; p++)
+                        *p = LOWER(*p);
+                words.push_back(name);
+        }
+}
+
+static void search_index(void)
+{
+        MOB_INDEX_DATA *pMobIndex;
+        OBJ_INDEX_DATA *pObjIndex;
+        std::vector < std::string > words;
+
+        if (!search_stale)
+                return;
+
+        mob_words.clear();
+        obj_words.clear();
+        for (pMobIndex = mob_index_table.first(); pMobIndex;
+             pMobIndex = mob_index_table.next(pMobIndex->vnum))
+        {
+                name_words(pMobIndex->player_name, words);
+                for (const std::string & word:words)
+                {
+                        std::vector < MOB_INDEX_DATA * >&list =
+                                mob_words[word];
+
+                        if (list.empty() || list.back() != pMobIndex)
+                                list.push_back(pMobIndex);
+                }
+        }
+        for (pObjIndex = obj_index_table.first(); pObjIndex;
+             pObjIndex = obj_index_table.next(pObjIndex->vnum))
+        {
+                name_words(pObjIndex->name, words);
+                for (const std::string & word:words)
+                {
+                        std::vector < OBJ_INDEX_DATA * >&list =
+                                obj_words[word];
+
+                        if (list.empty() || list.back() != pObjIndex)
+                                list.push_back(pObjIndex);
+                }
+        }
+        search_stale = FALSE;
+}
+
+void search_invalidate(void)
+{
+        search_stale = TRUE;
+}
+
+/*
+ * Read a "lo-hi" or single number range.
+ */
+static bool search_range(char *arg, int *lo, int *hi)
+{
+        switch (sscanf(arg, "%d-%d", lo, hi))
+        {
+        case 1:
+                *hi = *lo;
+                return TRUE;
+        case 2:
+                return *lo <= *hi;
+        default:
+                return FALSE;
+        }
+}
+
+/*
+ * Fill a query from command arguments.  The type filter is only taken
+ * when the search is over objects.
+ */
+bool search_parse(CHAR_DATA * ch, char *argument, SEARCH_QUERY * query,
+                  bool objects)
+{
+        char      arg[MAX_INPUT_LENGTH];
+        char      value[MAX_INPUT_LENGTH];
+
+        query->words[0] = '\0';
+        query->all = FALSE;
+        query->vnum_lo = query->level_lo = INT_MIN;
+        query->vnum_hi = query->level_hi = INT_MAX;
+        query->type = -1;
+        query->page = 0;
+
+        while (argument[0] != '\0')
+        {
+                argument = one_argument(argument, arg);
+                if (!str_cmp(arg, "vnum") || !str_cmp(arg, "level")
+                    || !str_cmp(arg, "type") || !str_cmp(arg, "page"))
+                {
+                        argument = one_argument(argument, value);
+                        if (value[0] == '\0')
+                        {
+                                ch_printf(ch, "%s what?\n\r",
+                                          capitalize(arg));
+                                return FALSE;
+                        }
+                        if (!str_cmp(arg, "vnum")
+                            && !search_range(value, &query->vnum_lo,
+                                             &query->vnum_hi))
+                        {
+                                send_to_char("Vnum ranges look like 100-199.\n\r", ch);
+                                return FALSE;
+                        }
+                        if (!str_cmp(arg, "level")
+                            && !search_range(value, &query->level_lo,
+                                             &query->level_hi))
+                        {
+                                send_to_char("Level ranges look like 10-20.\n\r", ch);
+                                return FALSE;
+                        }
+                        if (!str_cmp(arg, "type") && !objects)
+                        {
+                                send_to_char("Only objects can be searched by type.\n\r", ch);
+                                return FALSE;
+                        }
+                        if (!str_cmp(arg, "type")
+                            && (query->type = get_otype(value)) < 0)
+                        {
+                                ch_printf(ch, "Unknown item type: %s\n\r",
+                                          value);
+                                return FALSE;
+                        }
+                        if (!str_cmp(arg, "page")
+                            && (query->page = atoi(value)) < 1)
+                        {
+                                send_to_char("Pages start at 1.\n\r", ch);
+                                return FALSE;
+                        }
+                        continue;
+                }
+                if (query->words[0] != '\0')
+                        mudstrlcat(query->words, " ", MIL);
+                mudstrlcat(query->words, arg, MIL);
+        }
+
+        /*
+         * With only filters given, everything passing them matches.
+         */
+        if (query->words[0] == '\0' || !str_cmp(query->words, "all"))
+                query->all = TRUE;
+        return TRUE;
+}
+
+/*
+ * Does every query word appear in the name list?  Same answer as
+ * nifty_is_name, plus trailing '*' prefix words.
+ */
+bool search_name(SEARCH_QUERY * query, char *namelist)
+{
+        std::vector < std::string > want, have;
+
+        if (query->all)
+                return TRUE;
+
+        name_words(query->words, want);
+        name_words(namelist, have);
+        for (const std::string & word:want)
+        {
+                bool      prefix = word.size() > 1 && word.back() == '*';
+                std::string stem =
+                        prefix ? word.substr(0, word.size() - 1) : word;
+                bool      found = FALSE;
+
+                for (const std::string & name:have)
+                        if (prefix ? !name.compare(0, stem.size(), stem)
+                            : name == stem)
+                        {
+                                found = TRUE;
+                                break;
+                        }
+                if (!found)
+                        return FALSE;
+        }
+        return TRUE;
+}
+
+template < class T > static bool search_filter(SEARCH_QUERY * query,
+                                               T * pIndex)
+{
+        return pIndex->vnum >= query->vnum_lo
+                && pIndex->vnum <= query->vnum_hi
+                && pIndex->level >= query->level_lo
+                && pIndex->level <= query->level_hi
+                && (query->type < 0 || index_type(pIndex) == query->type);
+}
+
+template < class T > static bool by_vnum(T * a, T * b)
+{
+        return a->vnum < b->vnum;
+}
+
+template < class T > static bool by_index_vnum(T * a, T * b)
+{
+        return a->pIndexData->vnum < b->pIndexData->vnum;
+}
+
+/*
+ * Intersect the word lists for the query, then apply the filters.
+ */
+template < class T > static void search_protos(SEARCH_QUERY * query,
+                                               std::map < std::string,
+                                               std::vector < T * > >&index,
+                                               VNUM_TABLE < T > &table,
+                                               std::vector < T * > &result)
+{
+        std::vector < std::string > want;
+        std::vector < T * >hits, next;
+        bool      first = TRUE;
+        T        *pIndex;
+
+        result.clear();
+        search_index();
+
+        if (query->all)
+        {
+                for (pIndex = table.next(UMAX(query->vnum_lo, 0) - 1); pIndex;
+                     pIndex = table.next(pIndex->vnum))
+                {
+                        if (pIndex->vnum > query->vnum_hi)
+                                break;
+                        if (search_filter(query, pIndex))
+                                result.push_back(pIndex);
+                }
+                return;
+        }
+
+        name_words(query->words, want);
+        for (const std::string & word:want)
+        {
+                next.clear();
+                if (word.size() > 1 && word.back() == '*')
+                {
+                        std::string stem = word.substr(0, word.size() - 1);
+
+                        for (auto it = index.lower_bound(stem);
+                             it != index.end()
+                             && !it->first.compare(0, stem.size(), stem);
+                             ++it)
+                                next.insert(next.end(), it->second.begin(),
+                                            it->second.end());
+                        std::sort(next.begin(), next.end(), by_vnum < T >);
+                        next.erase(std::unique(next.begin(), next.end()),
+                                   next.end());
+                }
+                else
+                {
+                        auto      it = index.find(word);
+
+                        if (it != index.end())
+                                next = it->second;
+                }
+
+                if (first)
+                        hits.swap(next);
+                else
+                {
+                        std::vector < T * >both;
+
+                        std::set_intersection(hits.begin(), hits.end(),
+                                              next.begin(), next.end(),
+                                              std::back_inserter(both),
+                                              by_vnum < T >);
+                        hits.swap(both);
+                }
+                first = FALSE;
+                if (hits.empty())
+                        return;
+        }
+
+        for (T * hit:hits)
+                if (search_filter(query, hit))
+                        result.push_back(hit);
+}
+
+void search_mobs(SEARCH_QUERY * query, std::vector < MOB_INDEX_DATA * >&result)
+{
+        search_protos(query, mob_words, mob_index_table, result);
+}
+
+void search_objs(SEARCH_QUERY * query, std::vector < OBJ_INDEX_DATA * >&result)
+{
+        search_protos(query, obj_words, obj_index_table, result);
+}
+
+/*
+ * Live mobs in a room matching the query, in vnum order.  Mobs still
+ * sharing their prototype's name come off the matching prototypes'
+ * instance lists.  Renamed ones are not indexed, so finding them still
+ * takes a pass over every live mob; only those get a name check.
+ */
+void search_mob_instances(SEARCH_QUERY * query,
+                          std::vector < CHAR_DATA * >&result)
+{
+        std::vector < MOB_INDEX_DATA * >protos;
+        CHAR_DATA *victim;
+
+        result.clear();
+        search_mobs(query, protos);
+        for (MOB_INDEX_DATA * pMobIndex:protos)
+                for (victim = pMobIndex->first_instance; victim;
+                     victim = victim->next_instance)
+                        if (victim->in_room
+                            && (query->all
+                                || victim->name == pMobIndex->player_name))
+                                result.push_back(victim);
+
+        if (query->all)
+                return;
+        for (victim = first_char; victim; victim = victim->next)
+        {
+                if (!IS_NPC(victim) || !victim->in_room
+                    || victim->name == victim->pIndexData->player_name)
+                        continue;
+                if (search_filter(query, victim->pIndexData)
+                    && search_name(query, victim->name))
+                        result.push_back(victim);
+        }
+        std::stable_sort(result.begin(), result.end(), by_index_vnum < CHAR_DATA >);
+}
+
+/*
+ * Same for objects anywhere in the world; restrung objects and corpses
+ * are the ones the full pass is for.
+ */
+void search_obj_instances(SEARCH_QUERY * query,
+                          std::vector < OBJ_DATA * >&result)
+{
+        std::vector < OBJ_INDEX_DATA * >protos;
+        OBJ_DATA *obj;
+
+        result.clear();
+        search_objs(query, protos);
+        for (OBJ_INDEX_DATA * pObjIndex:protos)
+                for (obj = pObjIndex->first_instance; obj;
+                     obj = obj->next_instance)
+                        if (query->all || obj->name == pObjIndex->name)
+                                result.push_back(obj);
+
+        if (query->all)
+                return;
+        for (obj = first_object; obj; obj = obj->next)
+        {
+                if (obj->name == obj->pIndexData->name)
+                        continue;
+                if (search_filter(query, obj->pIndexData)
+                    && search_name(query, obj->name))
+                        result.push_back(obj);
+        }
+        std::stable_sort(result.begin(), result.end(), by_index_vnum < OBJ_DATA >);
+}
+
+/*
+ * Work out which of count results the requested page covers.
+ */
+bool search_page(CHAR_DATA * ch, SEARCH_QUERY * query, size_t count,
+                 size_t * first, size_t * last)
+{
+        size_t    pages = (count + SEARCH_PAGE_SIZE - 1) / SEARCH_PAGE_SIZE;
+        size_t    page = static_cast < size_t > (query->page);
+
+        if (query->page == 0 || count == 0)
+        {
+                *first = 0;
+                *last = count;
+                return TRUE;
+        }
+        if (page > pages)
+        {
+                ch_printf(ch, "There %s only %d page%s.\n\r",
+                          pages == 1 ? "is" : "are", static_cast < int >(pages),
+                          pages == 1 ? "" : "s");
+                return FALSE;
+        }
+        *first = (page - 1) * SEARCH_PAGE_SIZE;
+        *last = UMIN(count, *first + SEARCH_PAGE_SIZE);
+        pager_printf(ch, "Page %d of %d:\n\r", query->page,
+                     static_cast < int >(pages));
+        return TRUE;
+}
+
+/*
+ * Worker thread for asearch.  Touches nothing but its own job.
+ */
+static void search_files(search_job * job)
+{
+        char     *line = NULL;
+        size_t    size = 0;
+        ssize_t   len;
+
+        for (const std::string & file:job->files)
+        {
+                FILE     *fp;
+                int       lineno = 0;
+
+                if (job->cancel || job->hits >= SEARCH_MAX_LINES)
+                        break;
+                if ((fp = fopen(file.c_str(), "r")) == NULL)
+                        continue;
+                while ((len = getline(&line, &size, fp)) >= 0)
+                {
+                        std::string lower;
+
+                        ++lineno;
+                        while (len > 0
+                               && (line[len - 1] == '\n'
+                                   || line[len - 1] == '\r'))
+                                line[--len] = '\0';
+                        lower.resize(static_cast < size_t > (len));
+                        for (ssize_t i = 0; i < len; i++)
+                                lower[static_cast < size_t > (i)] =
+                                        static_cast < char >(tolower(line[i]));
+                        if (lower.find(job->pattern) == std::string::npos)
+                                continue;
+
+                        std::string hit = file + ":" +
+                                std::to_string(lineno) + ": " + line +
+                                "\n\r";
+                        std::lock_guard < std::mutex > guard(job->lock);
+
+                        job->lines.push_back(hit);
+                        if (++job->hits >= SEARCH_MAX_LINES || job->cancel)
+                                break;
+                }
+                fclose(fp);
+        }
+        free(line);
+
+        std::lock_guard < std::mutex > guard(job->lock);
+        job->done = TRUE;
+}
+
+static CHAR_DATA *search_requester(search_job * job)
+{
+        DESCRIPTOR_DATA *d;
+        CHAR_DATA *och;
+
+        for (d = first_descriptor; d; d = d->next)
+        {
+                if (d->connected != CON_PLAYING || !d->character)
+                        continue;
+                och = d->original ? d->original : d->character;
+                if (!str_cmp(och->name, job->requester.c_str()))
+                        return d->character;
+        }
+        return NULL;
+}
+
+/*
+ * Hand finished lines to their requesters and reap finished jobs.
+ */
+void search_update(void)
+{
+        for (auto it = search_jobs.begin(); it != search_jobs.end();)
+        {
+                search_job *job = it->get();
+                std::vector < std::string > lines;
+                CHAR_DATA *ch = search_requester(job);
+                bool      done;
+
+                {
+                        std::lock_guard < std::mutex > guard(job->lock);
+
+                        lines.swap(job->lines);
+                        done = job->done;
+                }
+                if (!ch)
+                        job->cancel = TRUE;
+                else
+                {
+                        for (const std::string & line:lines)
+                                send_to_pager(line.c_str(), ch);
+                        if (done)
+                                pager_printf(ch,
+                                             "asearch: %d match%s for '%s'%s.\n\r",
+                                             job->hits,
+                                             job->hits == 1 ? "" : "es",
+                                             job->pattern.c_str(),
+                                             job->hits >=
+                                             SEARCH_MAX_LINES ?
+                                             " (stopped there)" : "");
+                }
+                if (!done)
+                {
+                        ++it;
+                        continue;
+                }
+                job->worker.join();
+                it = search_jobs.erase(it);
+        }
+}
+
+void shutdown_search(void)
+{
+        for (auto & job:search_jobs)
+                job->cancel = TRUE;
+        for (auto & job:search_jobs)
+                job->worker.join();
+        search_jobs.clear();
+}
+
+CMDF do_asearch(CHAR_DATA * ch, char *argument)
+{
+        AREA_DATA *pArea;
+        CHAR_DATA *och = ch->desc && ch->desc->original
+                ? ch->desc->original : ch;
+        std::unique_ptr < search_job > job;
+
+        if (!ch->desc)
+                return;
+        while (isspace(*argument))
+                argument++;
+        if (argument[0] == '\0')
+        {
+                send_to_char("Syntax: asearch <text>\n\r", ch);
+                send_to_char("Searches every area file for lines containing the text.\n\r", ch);
+                return;
+        }
+        for (auto & running:search_jobs)
+                if (!str_cmp(running->requester.c_str(), och->name))
+                {
+                        send_to_char("You already have a search running.\n\r",
+                                     ch);
+                        return;
+                }
+
+        job.reset(new search_job());
+        job->requester = och->name;
+        for (char *p = argument; *p; p++)
+                job->pattern += static_cast < char >(LOWER(*p));
+        for (pArea = first_area; pArea; pArea = pArea->next)
+                if (pArea->filename && pArea->filename[0] != '\0')
+                        job->files.push_back(pArea->filename);
+        job->done = FALSE;
+        job->hits = 0;
+        job->cancel = FALSE;
+        job->worker = std::thread(search_files, job.get());
+        search_jobs.push_back(std::move(job));
+
+        set_pager_color(AT_PLAIN, ch);
+        ch_printf(ch, "Searching %d area files for '%s'...\n\r",
+                  static_cast < int >(search_jobs.back()->files.size()),
+                  argument);
+}
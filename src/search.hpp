@@ -0,0 +1,99 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                              SWTFE World Search Module                                *
+ ****************************************************************************************/
+#ifndef _SEARCH_H_
+#define _SEARCH_H_
+
+#include <vector>
+
+/*
+ * World search for the immortal find/where commands.
+ *
+ * Mob and object prototypes are indexed by the words of their names, each
+ * word holding its prototypes in vnum order, so mfind and ofind intersect
+ * a few short lists instead of calling nifty_is_name on every prototype.
+ * The index is rebuilt on first use after search_invalidate(), which
+ * whatever creates, deletes or renames a prototype must call.
+ *
+ * Live mobs and objects are kept on their prototype's instance list
+ * (first_instance/next_instance), so a search by vnum only visits the
+ * copies of that one prototype.
+ *
+ * asearch greps the area files on a worker thread.  search_update() hands
+ * each pulse's lines to the requester's pager until the job is done.
+ */
+#define SEARCH_PAGE_SIZE	100	/* Lines per "page N" of find output */
+#define SEARCH_MAX_LINES	500	/* asearch stops after this many hits */
+
+/*
+ * A parsed query: name words plus optional filters.
+ *   <words|all> [vnum <lo>[-<hi>]] [level <lo>[-<hi>]] [type <itemtype>]
+ *   [page <n>]
+ * The type filter is for object searches only.
+ * A word ending in '*' matches any name word starting with the rest.
+ */
+typedef struct search_query SEARCH_QUERY;
+struct search_query
+{
+        char      words[MAX_INPUT_LENGTH];
+        bool      all;
+        int       vnum_lo, vnum_hi;
+        int       level_lo, level_hi;
+        int       type;
+        int       page;
+};
+
+bool      search_parse(CHAR_DATA * ch, char *argument, SEARCH_QUERY * query,
+                       bool objects);
+bool      search_name(SEARCH_QUERY * query, char *namelist);
+void      search_mobs(SEARCH_QUERY * query,
+                      std::vector < MOB_INDEX_DATA * >&result);
+void      search_objs(SEARCH_QUERY * query,
+                      std::vector < OBJ_INDEX_DATA * >&result);
+void      search_mob_instances(SEARCH_QUERY * query,
+                                 std::vector < CHAR_DATA * >&result);
+void      search_obj_instances(SEARCH_QUERY * query,
+                                 std::vector < OBJ_DATA * >&result);
+bool      search_page(CHAR_DATA * ch, SEARCH_QUERY * query, size_t count,
+                      size_t * first, size_t * last);
+void      search_invalidate(void);
+void      search_update(void);
+void      shutdown_search(void);
+
+#endif
@@ -55,7 +55,8 @@
 #include <unistd.h>
 #include <sys/wait.h>   /* Samson 4-16-98 - For new shell command */
 #include <fcntl.h>
-#include <arpa/telnet.h>
+#include <errno.h>
+#include <signal.h>
 #include <string.h>
 #include <sys/types.h>
 #include <ctype.h>
@@ -71,94 +72,206 @@
 bool      compilelock = FALSE;  /* Reboot/shutdown commands locked during compiles */
 bool      bootlock = FALSE; /* Protects compiler from being used during boot timers */
 
-#if !defined(FNDELAY)
-#define FNDELAY O_NDELAY
-#endif
+SHELL_PROC *first_shell;
+SHELL_PROC *last_shell;
 
-#ifndef USEGLOB
-/* OLD command shell provided by Ferris - ferris@FootPrints.net Installed by Samson 4-6-98
- * For safety reasons, this is only available if the USEGLOB define is commented out.
- */
 /*
- * Local functions.
+ * The immortal who started a process, found by name so that a quit or
+ * relog never leaves us holding a dangling character.
  */
-FILE     *popen args((const char *command, const char *type));
-int pclose args((FILE * stream));
+static CHAR_DATA *shell_requester(SHELL_PROC * proc)
+{
+        DESCRIPTOR_DATA *d;
+        CHAR_DATA *och;
 
-#ifdef MCCP
-extern const char will_compress_str[];
-extern const char will_compress2_str[];
-#endif
+        for (d = first_descriptor; d; d = d->next)
+        {
+                if (d->connected != CON_PLAYING || !d->character)
+                        continue;
+                och = d->original ? d->original : d->character;
+                if (!str_cmp(och->name, proc->requester))
+                        return d->character;
+        }
+        return NULL;
+}
 
-char     *fgetf(char *s, int n, register FILE * iop)
+bool shell_running(CHAR_DATA * ch)
 {
-        register int c;
-        register char *cs;
-
-        c = '\0';
-        cs = s;
-        while (--n > 0 && (c = getc(iop)) != EOF)
-                if ((*cs++ = c) == '\0')
-                        break;
-        *cs = '\0';
-        return ((c == EOF && cs == s) ? NULL : s);
+        SHELL_PROC *proc;
+
+        for (proc = first_shell; proc; proc = proc->next)
+                if (!str_cmp(proc->requester, ch->name))
+                        return TRUE;
+        return FALSE;
 }
 
-/* NOT recommended to be used as a conventional command! */
-void command_pipe(CHAR_DATA * ch, char *argument)
+/*
+ * Copy text with its colour codes doubled, so that compiler output full
+ * of '&' and '^' comes through as written.  dst needs room for 2*len+1.
+ */
+static int shell_escape(const char *src, int len, char *dst)
 {
-        char      buf[MAX_STRING_LENGTH];
-        FILE     *fp;
+        int       i, out = 0;
 
-#ifdef MCCP
-        int       compressing = ch->desc->compressing;
+        for (i = 0; i < len; i++)
+        {
+                if (src[i] == '\r')
+                        continue;
+                if (src[i] == '&' || src[i] == '^' || src[i] == '}')
+                        dst[out++] = src[i];
+                dst[out++] = src[i];
+        }
+        dst[out] = '\0';
+        return out;
+}
 
-        compressEnd(ch->desc);
+/*
+ * Send one line of process output.
+ */
+static void shell_line(SHELL_PROC * proc, CHAR_DATA * ch)
+{
+        char      buf[MAX_STRING_LENGTH * 2 + 3];
+        int       len;
+
+        len = shell_escape(proc->line, proc->linelen, buf);
+        proc->linelen = 0;
+        mudstrlcpy(buf + len, "\n\r", sizeof(buf) - len);
+        if (ch)
+                send_to_pager(buf, ch);
+}
+
+/*
+ * Signal the whole process group, or just the child if it has not got
+ * as far as setting up its group yet.
+ */
+static void shell_kill(SHELL_PROC * proc, int sig)
+{
+        if (kill(-proc->pid, sig) != 0)
+                kill(proc->pid, sig);
+}
+
+/*
+ * Child side of shell_exec: hook stdout and stderr to the pipe, drop
+ * every other descriptor, and exec.  Never returns.
+ */
+static void shell_child(char *argument, int out)
+{
+        int       fd;
+#ifdef USEGLOB
+        glob_t    g;
+        char     *p;
+#else
+        char     *argv[MAX_INPUT_LENGTH / 2 + 2];
+        int       argc = 0;
 #endif
 
-        set_char_color(AT_RED, ch);
+        setpgid(0, 0);  /* Own process group, so a kill reaches make's children */
+        if ((fd = open("/dev/null", O_RDONLY)) >= 0)
+                dup2(fd, STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        dup2(out, STDERR_FILENO);
+        for (fd = 3; fd < 1024; fd++)
+                close(fd);
+        setenv("TERM", "dumb", 1);
+        setenv("COLUMNS", "80", 1);
+        setenv("LINES", "24", 1);
 
-        fp = popen(argument, "r");
+#ifdef USEGLOB
+        g.gl_offs = 1;
+        p = strtok(argument, " ");
 
-        fgetf(buf, MAX_STRING_LENGTH, fp);
+        if (p && (p = strtok(NULL, " ")) != NULL)
+        {
+                glob(p, GLOB_DOOFFS | GLOB_NOCHECK, NULL, &g);
+                if (!g.gl_pathv[g.gl_pathc - 1])
+                        g.gl_pathv[g.gl_pathc - 1] = p;
+        }
+        else
+        {
+                glob(argument, GLOB_DOOFFS | GLOB_NOCHECK, NULL, &g);
+                ++(g.gl_pathv);
+        }
 
-        send_to_pager(buf, ch);
+        while (p && (p = strtok(NULL, " ")) != NULL)
+        {
+                glob(p, GLOB_DOOFFS | GLOB_NOCHECK | GLOB_APPEND, NULL, &g);
+                if (!g.gl_pathv[g.gl_pathc - 1])
+                        g.gl_pathv[g.gl_pathc - 1] = p;
+        }
+        g.gl_pathv[0] = argument;
 
-        pclose(fp);
+        execvp(g.gl_pathv[0], g.gl_pathv);
+#else
+        argv[argc] = strtok(argument, " ");
+        while (argc < MAX_INPUT_LENGTH / 2
+               && (argv[++argc] = strtok(NULL, " ")) != NULL);
+        argv[argc] = NULL;
 
-#ifdef MCCP
-        if (compressing)
-                compressstart(ch->desc, compressing);
+        execvp(argv[0], argv);
 #endif
-        return;
-}
 
-/* End OLD shell command code */
-#endif
+        fprintf(stderr, "Shell process: %s failed: %s\n", argument,
+                strerror(errno));
+        _exit(127);
+}
 
-/* New command shell code by Thoric - Installed by Samson 4-16-98 */
-void send_telcode(int desc, int ddww, int code)
+/*
+ * Start a command with its output streaming back to ch's pager.  The game
+ * never waits on it: shell_update() reads whatever the pipe has each
+ * loop and reaps the process when it exits.
+ */
+bool shell_exec(CHAR_DATA * ch, char *argument, bool compile)
 {
-        unsigned char buf[4];
+        SHELL_PROC *proc;
+        CHAR_DATA *och;
+        int       fds[2];
+        pid_t     pid;
+
+        if (!ch->desc || !argument || argument[0] == '\0')
+                return FALSE;
+        och = ch->desc->original ? ch->desc->original : ch;
+
+        if (pipe(fds) != 0)
+        {
+                perror("shell_exec: pipe");
+                send_to_char("Unable to start the process.\n\r", ch);
+                return FALSE;
+        }
 
-        buf[0] = IAC;
-        buf[1] = ddww;
-        buf[2] = code;
-        buf[3] = 0;
-        write(desc, (char *) buf, 4);
+        if ((pid = fork()) == 0)
+                shell_child(argument, fds[1]);
+
+        close(fds[1]);
+        if (pid < 0)
+        {
+                perror("shell_exec: fork");
+                close(fds[0]);
+                send_to_char("Process fork failed.\n\r", ch);
+                return FALSE;
+        }
+        setpgid(pid, pid);
+
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+        CREATE(proc, SHELL_PROC, 1);
+        shell_escape(argument,
+                     UMIN(static_cast < int >(strlen(argument)),
+                          MAX_INPUT_LENGTH - 1), proc->command);
+        proc->pid = pid;
+        proc->fd = fds[0];
+        proc->requester = STRALLOC(och->name);
+        proc->started = current_time;
+        proc->compile = compile;
+        LINK(proc, first_shell, last_shell, next, prev);
+
+        set_pager_color(AT_PLAIN, ch);
+        ch_printf(ch, "Started: %s\n\r", proc->command);
+        return TRUE;
 }
 
 CMDF do_mudexec(CHAR_DATA * ch, char *argument)
 {
-        int       desc;
-        int       flags;
-        pid_t     pid;
-        bool      iafork = FALSE;
-
-#ifdef MCCP
-        int       compressing = 0;
-#endif
-
         if (!ch->desc)
                 return;
 
@@ -167,180 +280,171 @@ CMDF do_mudexec(CHAR_DATA * ch, char *argument)
 
         if (strncasecmp(argument, "ia ", 3) == 0)
         {
-                argument += 3;
-                iafork = TRUE;
+                send_to_char
+                        ("Interactive processes are not supported; output is paged instead.\n\r",
+                         ch);
+                return;
         }
 
-        desc = ch->desc->descriptor;
-
-        set_char_color(AT_PLAIN, ch);
-
-#ifdef MCCP
-        compressing = ch->desc->compressing;
-        compressEnd(ch->desc);
-#endif
-
-        if ((pid = fork()) == 0)
-        {
-                char      buf[1024];
-                char     *p = argument;
+        shell_exec(ch, argument, FALSE);
+}
 
-#ifdef USEGLOB
-                glob_t    g;
-#else
-                char    **argv;
-                int       argc = 1;
-#endif
-#ifdef DEBUGGLOB
-                int       argc = 0;
-#endif
+/*
+ * Add the descriptors of running processes to the game loop's read set.
+ */
+void shell_fdset(fd_set * in, int *maxfd)
+{
+        SHELL_PROC *proc;
 
-                flags = fcntl(desc, F_GETFL, 0);
-                flags &= ~FNDELAY;
-                fcntl(desc, F_SETFL, flags);
-                if (iafork)
+        for (proc = first_shell; proc; proc = proc->next)
+                if (proc->fd >= 0)
                 {
-                        send_telcode(desc, WILL, TELOPT_SGA);
-                        /*
-                         * send_telcode( desc, DO, TELOPT_NAWS );  
-                         */
-                        send_telcode(desc, DO, TELOPT_LFLOW);
-                        send_telcode(desc, DONT, TELOPT_LINEMODE);
-                        send_telcode(desc, WILL, TELOPT_STATUS);
-                        send_telcode(desc, DO, TELOPT_ECHO);
-                        send_telcode(desc, WILL, TELOPT_ECHO);
-                        read(desc, buf, 1024);  /* read replies */
+                        FD_SET(proc->fd, in);
+                        *maxfd = UMAX(*maxfd, proc->fd);
                 }
-                dup2(desc, STDIN_FILENO);
-                dup2(desc, STDOUT_FILENO);
-                dup2(desc, STDERR_FILENO);
-                setenv("TERM", "vt100", 1);
-                setenv("COLUMNS", "80", 1);
-                setenv("LINES", "24", 1);
+}
 
-#ifdef USEGLOB
-                g.gl_offs = 1;
-                p = strtok(argument, " ");
+/*
+ * Drain whatever a process has written without blocking.
+ */
+static void shell_read(SHELL_PROC * proc, CHAR_DATA * ch)
+{
+        char      buf[4096];
+        ssize_t   got;
+        ssize_t   i;
 
-                if (p && (p = strtok(NULL, " ")) != NULL)
+        for (;;)
+        {
+                got = read(proc->fd, buf, sizeof(buf));
+                if (got < 0 && errno == EINTR)
+                        continue;
+                if (got < 0)
                 {
-                        glob(p, GLOB_DOOFFS | GLOB_NOCHECK, NULL, &g);
-                        if (!g.gl_pathv[g.gl_pathc - 1])
-                                g.gl_pathv[g.gl_pathc - 1] = p;
+                        if (errno != EAGAIN && errno != EWOULDBLOCK)
+                        {
+                                close(proc->fd);
+                                proc->fd = -1;
+                        }
+                        return;
                 }
-                else
+                if (got == 0)
                 {
-                        glob(argument, GLOB_DOOFFS | GLOB_NOCHECK, NULL, &g);
-                        ++(g.gl_pathv);
+                        if (proc->linelen > 0 && !proc->truncated)
+                                shell_line(proc, ch);
+                        close(proc->fd);
+                        proc->fd = -1;
+                        return;
                 }
 
-                while (p && (p = strtok(NULL, " ")) != NULL)
+                proc->output += static_cast < int >(got);
+                if (proc->truncated)
+                        continue;
+                if (proc->output > SHELL_OUTPUT_LIMIT)
                 {
-                        glob(p, GLOB_DOOFFS | GLOB_NOCHECK | GLOB_APPEND,
-                             NULL, &g);
-                        if (!g.gl_pathv[g.gl_pathc - 1])
-                                g.gl_pathv[g.gl_pathc - 1] = p;
+                        proc->truncated = TRUE;
+                        if (ch)
+                                ch_printf(ch,
+                                          "&R[Output passed %d bytes; the rest is discarded.]&w\n\r",
+                                          SHELL_OUTPUT_LIMIT);
+                        continue;
                 }
-                g.gl_pathv[0] = argument;
-
-#ifdef DEBUGGLOB
-                for (argc = 0; argc < g.gl_pathc; argc++)
-                        printf("arg %d: %s\n\r", argc, g.gl_pathv[argc]);
-                fflush(stdout);
-#endif
-
-                execvp(g.gl_pathv[0], g.gl_pathv);
-#else
-                while (*p)
+                for (i = 0; i < got; i++)
                 {
-                        while (isspace(*p))
-                                ++p;
-                        if (*p == '\0')
-                                break;
-                        ++argc;
-                        while (!isspace(*p) && *p)
-                                ++p;
+                        if (buf[i] == '\n'
+                            || proc->linelen >= MAX_STRING_LENGTH - 1)
+                        {
+                                shell_line(proc, ch);
+                                if (buf[i] == '\n')
+                                        continue;
+                        }
+                        proc->line[proc->linelen++] = buf[i];
                 }
-                p = argument;
-                argv = CALLOC(argc + 1, sizeof(char *));
-
-                argc = 0;
-                /*
-                 * make sure it has at least one space 
-                 */
-                argv[argc] = strtok(argument, " ");
-                while ((argv[++argc] = strtok(NULL, " ")) != NULL);
-
-                execvp(argv[0], argv);
-#endif
-
-#ifdef MCCP
-                if (compressing)
-                        compressStart(ch->desc, compressing);
-#endif
-                fprintf(stderr, "Shell process: %s failed!\n", argument);
-                perror("mudexec");
-                exit(0);
         }
-        else if (pid < 2)
+}
+
+static void shell_finish(SHELL_PROC * proc, CHAR_DATA * ch, int status)
+{
+        if (ch)
         {
-                send_to_char("Process fork failed.\n\r", ch);
-                fprintf(stderr, "%s", "Shell process: fork failed!\n");
-                return;
+                if (proc->killed)
+                        ch_printf(ch,
+                                  "&R[%s stopped after %d seconds.]&w\n\r",
+                                  proc->command, SHELL_TIME_LIMIT);
+                else if (WIFEXITED(status))
+                        ch_printf(ch, "&G[%s exited with status %d.]&w\n\r",
+                                  proc->command, WEXITSTATUS(status));
+                else if (WIFSIGNALED(status))
+                        ch_printf(ch, "&R[%s killed by signal %d.]&w\n\r",
+                                  proc->command, WTERMSIG(status));
         }
-        else
+        if (proc->compile && compilelock)
         {
-                ch->desc->process = pid;
-                ch->desc->connected = iafork ? CON_IAFORKED : CON_FORKED;
+                echo_to_all(AT_GREEN,
+                            "Compiler operation completed. Reboot and shutdown commands unlocked.",
+                            ECHOTAR_IMM);
+                compilelock = FALSE;
         }
+        if (proc->fd >= 0)
+                close(proc->fd);
+        UNLINK(proc, first_shell, last_shell, next, prev);
+        STRFREE(proc->requester);
+        DISPOSE(proc);
 }
 
-/* End NEW shell command code */
-
-bool check_forks(DESCRIPTOR_DATA * d, char *cmdline)
+/*
+ * Called every game loop after select: stream output, enforce the time
+ * limit and reap finished processes.
+ */
+void shell_update(fd_set * in)
 {
-        if (d->connected == CON_FORKED || d->connected == CON_IAFORKED)
+        SHELL_PROC *proc, *proc_next;
+        CHAR_DATA *ch;
+        int       status;
+
+        for (proc = first_shell; proc; proc = proc_next)
         {
-                int       status;
+                proc_next = proc->next;
+                ch = shell_requester(proc);
 
-                if (d->process > 0
-                    && waitpid(d->process, &status, WNOHANG) > 0)
-                {
-                        if (compilelock)
-                        {
-                                echo_to_all(AT_GREEN,
-                                            "Compiler operation completed. Reboot and shutdown commands unlocked.",
-                                            ECHOTAR_IMM);
-                                compilelock = FALSE;
-                        }
-                        d->process = 0;
-                }
-                if (!d->process)
+                if (proc->fd >= 0 && FD_ISSET(proc->fd, in))
+                        shell_read(proc, ch);
+
+                /*
+                 * Without anyone to read it, only a compile is worth
+                 * finishing.
+                 */
+                if (!proc->killed
+                    && (current_time - proc->started > SHELL_TIME_LIMIT
+                        || (!ch && !proc->compile)))
                 {
-                        if (d->connected == CON_IAFORKED)
-                        {
-                                send_telcode(d->descriptor, DO,
-                                             TELOPT_LINEMODE);
-                                send_telcode(d->descriptor, WONT,
-                                             TELOPT_ECHO);
-                                /*
-                                 * send_telcode( d->descriptor, DO, TELOPT_ECHO ); 
-                                 */
-                        }
-                        d->connected = CON_PLAYING;
-                        fcntl(d->descriptor, F_SETFL, FNDELAY);
-                        /*
-                         * clean up garbage 
-                         */
-                        read(d->descriptor, cmdline, MAX_INPUT_LENGTH);
-#ifdef MCCP
-                        if (d->shellcompressing)
-                                compressStart(d, d->shellcompressing);
-#endif
+                        shell_kill(proc, SIGTERM);
+                        proc->killed = current_time;
                 }
-                return TRUE;
+                else if (proc->killed
+                         && current_time - proc->killed > SHELL_KILL_GRACE)
+                        shell_kill(proc, SIGKILL);
+
+                if (proc->fd < 0
+                    && waitpid(proc->pid, &status, WNOHANG) == proc->pid)
+                        shell_finish(proc, ch, status);
+        }
+}
+
+/*
+ * Stop everything before a shutdown or hotboot.
+ */
+void shutdown_shell(void)
+{
+        SHELL_PROC *proc;
+        int       status;
+
+        while ((proc = first_shell) != NULL)
+        {
+                shell_kill(proc, SIGKILL);
+                waitpid(proc->pid, &status, 0);
+                proc->killed = current_time;
+                shell_finish(proc, NULL, status);
         }
-        return FALSE;
 }
 
 /* This function verifies filenames during copy operations - Samson 4-7-98 */
@@ -361,34 +465,20 @@ int copy_file(CHAR_DATA * ch, char *filename)
 }
 
 /* The guts of the compiler code, make any changes to the compiler options here - Samson 4-8-98 */
-void compile_code(CHAR_DATA * ch, char *argument)
+bool compile_code(CHAR_DATA * ch, char *argument)
 {
         char      buf[MAX_STRING_LENGTH];
 
         if (!str_cmp(argument, "cvs"))
-        {
                 mudstrlcpy(buf, "make -C ../src cvs", MSL);
-                do_mudexec(ch, buf);
-                return;
-        }
-
-        if (!str_cmp(argument, "clean"))
-        {
+        else if (!str_cmp(argument, "clean"))
                 mudstrlcpy(buf, "make -C ../src clean", MSL);
-                do_mudexec(ch, buf);
-                return;
-        }
-
-        if (!str_cmp(argument, "dns"))
-        {
+        else if (!str_cmp(argument, "dns"))
                 mudstrlcpy(buf, "make -C ../src dns", MSL);
-                do_mudexec(ch, buf);
-                return;
-        }
+        else
+                mudstrlcpy(buf, "make -C ../src", MSL);
 
-        mudstrlcpy(buf, "make -C ../src", MSL);
-        do_mudexec(ch, buf);
-        return;
+        return shell_exec(ch, buf, TRUE);
 }
 
 /* This command compiles the code on the mud, works only on code port - Samson 4-8-98 */
@@ -419,7 +509,13 @@ CMDF do_compile(CHAR_DATA * ch, char *argument)
                  ch->name);
         echo_to_all(AT_RED, buf, ECHOTAR_IMM);
 
-        compile_code(ch, argument);
+        if (!compile_code(ch, argument))
+        {
+                compilelock = FALSE;
+                echo_to_all(AT_GREEN,
+                            "Compiler operation failed to start. Reboot and shutdown commands unlocked.",
+                            ECHOTAR_IMM);
+        }
 
         return;
 }
@@ -444,10 +540,6 @@ CMDF do_grep(CHAR_DATA * ch, char *argument)
         else
                 snprintf(buf, MSL, "grep -n %s %s", arg1, argument);    /* Line numbers are somewhat important */
 
-#ifdef USEGLOB
-        do_mudexec(ch, buf);
-#else
-        command_pipe(ch, buf);
-#endif
+        shell_exec(ch, buf, FALSE);
         return;
 }
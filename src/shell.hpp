@@ -83,8 +83,40 @@
 #define CODEMAPDIR	HOST_DIR "dist3/maps/"  /* Used in do_copymap - Samson 8-2-99 */
 #endif
 
-void      send_telcode(int desc, int ddww, int code);
-bool      check_forks(DESCRIPTOR_DATA * d, char *cmdline);
+#define SHELL_TIME_LIMIT	600	/* Seconds before a process is stopped */
+#define SHELL_KILL_GRACE	5	/* Seconds from SIGTERM to SIGKILL */
+#define SHELL_OUTPUT_LIMIT	262144	/* Bytes of output passed to the pager */
+
+/*
+ * A child process started by mudexec, compile or grep.  Its stdout and
+ * stderr share one nonblocking pipe that the game loop selects on.
+ */
+typedef struct shell_proc SHELL_PROC;
+struct shell_proc
+{
+        SHELL_PROC *next;
+        SHELL_PROC *prev;
+        pid_t     pid;
+        int       fd;   /* Read end of the output pipe, -1 at EOF */
+        char     *requester;    /* Name of the immortal who gets the output */
+        char      command[MAX_INPUT_LENGTH * 2];  /* Colour-escaped for display */
+        time_t    started;
+        time_t    killed;   /* When SIGTERM was sent, 0 if not yet */
+        int       output;   /* Bytes read so far */
+        bool      truncated;
+        bool      compile;  /* Releases compilelock when done */
+        char      line[MAX_STRING_LENGTH];
+        int       linelen;
+};
+
+extern SHELL_PROC *first_shell;
+extern SHELL_PROC *last_shell;
+
+bool      shell_exec(CHAR_DATA * ch, char *argument, bool compile);
+bool      shell_running(CHAR_DATA * ch);
+void      shell_fdset(fd_set * in, int *maxfd);
+void      shell_update(fd_set * in);
+void      shutdown_shell(void);
 
 extern bool compilelock;
 extern bool bootlock;
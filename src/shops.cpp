@@ -403,6 +403,7 @@ CMDF do_buy(CHAR_DATA * ch, char *argument)
                         snprintf(buf, MSL, "%s %s", pet->name, arg);
                         STRFREE(pet->name);
                         pet->name = STRALLOC(buf);
+                        name_index_update(pet);
                 }
 
                 snprintf(buf, MSL, "%sA neck tag says 'I belong to %s'.\n\r",
@@ -57,6 +57,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <algorithm>
+#include <vector>
 #include "mud.hpp"
 #ifdef MXP
 #  include "mxp.hpp"
@@ -65,6 +67,9 @@
 #include "olc-shuttle.hpp"
 #include "body.hpp"
 #include "space2.hpp"
+#include "kinematics.hpp"
+#include "persist.hpp"
+#include "economy.hpp"
 
 SHIP_DATA *first_ship;
 SHIP_DATA *last_ship;
@@ -160,218 +165,175 @@ void show_ships_to_char(SHIP_DATA * ship, CHAR_DATA * ch)
 
 
 
-void move_ships()
+/*
+ * Hits found during a move_ships() step, resolved once everything has
+ * moved.  extract_missile() blanks entries, so a missile that goes away
+ * while the queue is being worked through (its target destroyed by an
+ * earlier hit, say) is simply skipped.
+ */
+static std::vector < MISSILE_DATA * >missile_hits;
+
+/*
+ * A missile reached its target: chaff, or damage credited to whoever
+ * fired it.  The missile is gone before any damage is done, since
+ * destroying the target clears out missiles aimed at it.
+ */
+static void missile_hit(MISSILE_DATA * missile)
 {
-        SHIP_DATA *ship;
-        MISSILE_DATA *missile;
-        MISSILE_DATA *m_next;
-        SHIP_DATA *target;
-        float     dx, dy, dz, change;
+        SHIP_DATA *ship = missile->fired_from;
+        SHIP_DATA *target = missile->target;
+        CHAR_DATA *ch = missile->fired_by;
+        int       type = missile->missiletype;
         char      buf[MAX_STRING_LENGTH];
-        CHAR_DATA *ch;
-        bool      ch_found = FALSE;
-        BODY_DATA *body = NULL;
 
-        for (missile = first_missile; missile; missile = m_next)
+        extract_missile(missile);
+        if (target->chaff_released > 0)
         {
-                m_next = missile->next;
+                echo_to_room(AT_YELLOW, get_room_index(ship->gunseat),
+                             "Your missile explodes harmlessly in a cloud of chaff!");
+                echo_to_cockpit(AT_YELLOW, target,
+                                "A missile explodes in your chaff.");
+                return;
+        }
 
-                ship = missile->fired_from;
-                target = missile->target;
-
-                if (target->starsystem
-                    && target->starsystem == missile->starsystem)
-                {
-                        if (missile->mx < target->vx)
-                                missile->mx +=
-                                        UMIN(missile->speed / 5,
-                                             (int) (target->vx -
-                                                    missile->mx));
-                        else if (missile->mx > target->vx)
-                                missile->mx -=
-                                        UMIN(missile->speed / 5,
-                                             (int) (missile->mx -
-                                                    target->vx));
-                        if (missile->my < target->vy)
-                                missile->my +=
-                                        UMIN(missile->speed / 5,
-                                             (int) (target->vy -
-                                                    missile->my));
-                        else if (missile->my > target->vy)
-                                missile->my -=
-                                        UMIN(missile->speed / 5,
-                                             (int) (missile->my -
-                                                    target->vy));
-                        if (missile->mz < target->vz)
-                                missile->mz +=
-                                        UMIN(missile->speed / 5,
-                                             (int) (target->vz -
-                                                    missile->mz));
-                        else if (missile->mz > target->vz)
-                                missile->mz -=
-                                        UMIN(missile->speed / 5,
-                                             (int) (missile->mz -
-                                                    target->vz));
-
-                        if (abs((int) missile->mx) - abs((int) target->vx) <=
-                            20
-                            && abs((int) missile->mx) -
-                            abs((int) target->vx) >= -20
-                            && abs((int) missile->my) -
-                            abs((int) target->vy) <= 20
-                            && abs((int) missile->my) -
-                            abs((int) target->vy) >= -20
-                            && abs((int) missile->mz) -
-                            abs((int) target->vz) <= 20
-                            && abs((int) missile->mz) -
-                            abs((int) target->vz) >= -20)
-                        {
-                                if (target->chaff_released <= 0)
-                                {
-                                        echo_to_room(AT_YELLOW,
-                                                     get_room_index(ship->
-                                                                    gunseat),
-                                                     "Your missile hits its target dead on!");
-                                        echo_to_cockpit(AT_BLOOD, target,
-                                                        "The ship is hit by a missile.");
-                                        echo_to_ship(AT_RED, target,
-                                                     "A loud explosion shakes thee ship violently!");
-                                        snprintf(buf, MSL,
-                                                 "You see a small explosion as %s is hit by a missile",
-                                                 target->name);
-                                        echo_to_system(AT_ORANGE, target, buf,
-                                                       ship);
-                                        for (ch = first_char; ch;
-                                             ch = ch->next)
-                                                if (!IS_NPC(ch)
-                                                    && nifty_is_name(missile->
-                                                                     fired_by,
-                                                                     ch->
-                                                                     name))
-                                                {
-                                                        ch_found = TRUE;
-                                                        damage_ship_ch(target,
-                                                                       20 +
-                                                                       missile->
-                                                                       missiletype
-                                                                       *
-                                                                       missile->
-                                                                       missiletype
-                                                                       * 20,
-                                                                       30 +
-                                                                       missile->
-                                                                       missiletype
-                                                                       *
-                                                                       missile->
-                                                                       missiletype
-                                                                       *
-                                                                       missile->
-                                                                       missiletype
-                                                                       * 30,
-                                                                       ch);
-                                                }
-                                        if (!ch_found)
-                                                damage_ship(target,
-                                                            20 +
-                                                            missile->
-                                                            missiletype *
-                                                            missile->
-                                                            missiletype * 20,
-                                                            30 +
-                                                            missile->
-                                                            missiletype *
-                                                            missile->
-                                                            missiletype *
-                                                            ship->
-                                                            missiletype * 30);
-                                        extract_missile(missile);
-                                }
-                                else
-                                {
-                                        echo_to_room(AT_YELLOW,
-                                                     get_room_index(ship->
-                                                                    gunseat),
-                                                     "Your missile explodes harmlessly in a cloud of chaff!");
-                                        echo_to_cockpit(AT_YELLOW, target,
-                                                        "A missile explodes in your chaff.");
-                                        extract_missile(missile);
-                                }
-                                continue;
-                        }
-                        else
-                        {
-                                missile->age++;
-                                if (missile->age >= 50)
-                                {
-                                        extract_missile(missile);
-                                        continue;
-                                }
-                        }
-                }
+        echo_to_room(AT_YELLOW, get_room_index(ship->gunseat),
+                     "Your missile hits its target dead on!");
+        echo_to_cockpit(AT_BLOOD, target, "The ship is hit by a missile.");
+        echo_to_ship(AT_RED, target,
+                     "A loud explosion shakes thee ship violently!");
+        snprintf(buf, MSL, "You see a small explosion as %s is hit by a missile",
+                 target->name);
+        echo_to_system(AT_ORANGE, target, buf, ship);
+        if (ch)
+                damage_ship_ch(target, 20 + type * type * 20,
+                               30 + type * type * type * 30, ch);
+        else
+                damage_ship(target, 20 + type * type * 20,
+                            30 + type * type * ship->missiletype * 30);
+}
+
+/*
+ * Movement runs as a kinematics pass over packed arrays (kinematics.cpp)
+ * followed by this pass, which copies positions back and acts on the
+ * events.  Missiles are taken starsystem by starsystem and home on where
+ * their targets were at the start of the step; their hits are queued and
+ * resolved after the ships have moved.
+ */
+void move_ships()
+{
+        static kin_missiles km;
+        static kin_ships ks;
+        static kin_bodies kb;
+        static std::vector < kin_event > events;
+        static std::vector < MISSILE_DATA * >missiles;
+        static std::vector < SHIP_DATA * >ships;
+        static std::vector < BODY_DATA * >sbodies;
+        SPACE_DATA *starsystem;
+        MISSILE_DATA *missile;
+        SHIP_DATA *ship;
+        BODY_DATA *body = NULL;
+        char      buf[MAX_STRING_LENGTH];
+        size_t    i;
+
+        km.clear();
+        missiles.clear();
+        for (starsystem = first_starsystem; starsystem;
+             starsystem = starsystem->next)
+                for (missile = starsystem->first_missile; missile;
+                     missile = missile->next_in_starsystem)
+                {
+                        SHIP_DATA *target = missile->target;
+
+                        missiles.push_back(missile);
+                        km.x.push_back(static_cast<float>(missile->mx));
+                        km.y.push_back(static_cast<float>(missile->my));
+                        km.z.push_back(static_cast<float>(missile->mz));
+                        km.tx.push_back(target->vx);
+                        km.ty.push_back(target->vy);
+                        km.tz.push_back(target->vz);
+                        km.step.push_back(static_cast<float>(missile->speed) / 5);
+                        km.age.push_back(missile->age);
+                        km.tsame.push_back(target->starsystem == starsystem);
+                }
+
+        events.clear();
+        kin_step_missiles(km, events);
+        for (i = 0; i < missiles.size(); i++)
+        {
+                missiles[i]->mx = static_cast<int>(lroundf(km.x[i]));
+                missiles[i]->my = static_cast<int>(lroundf(km.y[i]));
+                missiles[i]->mz = static_cast<int>(lroundf(km.z[i]));
+                missiles[i]->age = static_cast<sh_int>(km.age[i]);
+        }
+        missile_hits.clear();
+        for (const kin_event & ev : events)
+        {
+                missile = missiles[static_cast<size_t>(ev.index)];
+                if (ev.type == KIN_MISSILE_HIT)
+                        missile_hits.push_back(missile);
                 else
-                {
                         extract_missile(missile);
-                        continue;
-                }
         }
 
-        for (ship = first_ship; ship; ship = ship->next)
+        for (starsystem = first_starsystem; starsystem;
+             starsystem = starsystem->next)
         {
-                if (!ship->starsystem)
+                if (!starsystem->first_ship)
                         continue;
 
-                if (ship->currspeed > 0)
+                ks.clear();
+                ships.clear();
+                for (ship = starsystem->first_ship; ship;
+                     ship = ship->next_in_starsystem)
                 {
-
-                        change = sqrt(ship->hx * ship->hx +
-                                      ship->hy * ship->hy +
-                                      ship->hz * ship->hz);
-
-                        if (change > 0)
-                        {
-                                dx = ship->hx / change;
-                                dy = ship->hy / change;
-                                dz = ship->hz / change;
-                                ship->vx += (dx * ship->currspeed / 5);
-                                ship->vy += (dy * ship->currspeed / 5);
-                                ship->vz += (dz * ship->currspeed / 5);
-                        }
-
+                        ships.push_back(ship);
+                        ks.x.push_back(ship->vx);
+                        ks.y.push_back(ship->vy);
+                        ks.z.push_back(ship->vz);
+                        ks.hx.push_back(ship->hx);
+                        ks.hy.push_back(ship->hy);
+                        ks.hz.push_back(ship->hz);
+                        ks.speed.push_back(ship->currspeed);
+                        ks.autofly.push_back(autofly(ship));
                 }
 
-                if (autofly(ship))
-                        continue;
-
-                FOR_EACH_LIST(BODY_LIST, ship->starsystem->bodies, body)
+                kb.clear();
+                sbodies.clear();
+                FOR_EACH_LIST(BODY_LIST, starsystem->bodies, body)
                 {
-                        int       distance = 0;
+                        sbodies.push_back(body);
+                        kb.x.push_back(body->xpos());
+                        kb.y.push_back(body->ypos());
+                        kb.z.push_back(body->zpos());
+                        kb.gravity.push_back(body->gravity());
+                        kb.sun.push_back(body->type() == STAR_BODY);
+                        kb.well.push_back(body->type() == PLANET_BODY
+                                          || body->type() == MOON_BODY);
+                }
 
-                        if (ship->currspeed <= 0)
-                                continue;
-                        distance = body->distance(ship);
+                events.clear();
+                kin_step_ships(ks, kb, events);
+                for (i = 0; i < ships.size(); i++)
+                {
+                        ships[i]->vx = ks.x[i];
+                        ships[i]->vy = ks.y[i];
+                        ships[i]->vz = ks.z[i];
+                }
 
-                        if ((distance < body->gravity() / 10)
-                            && body->type() == STAR_BODY && distance > 0)
+                for (const kin_event & ev : events)
+                {
+                        ship = ships[static_cast<size_t>(ev.index)];
+                        body = sbodies[static_cast<size_t>(ev.body)];
+                        if (ev.type == KIN_SHIP_SUN)
                         {
                                 echo_to_cockpit(AT_BLOOD + AT_BLINK, ship,
                                                 "You fly directly into the sun.");
-                                snprintf(buf, MSL,
-                                         "%s flys directly into %s!",
+                                snprintf(buf, MSL, "%s flys directly into %s!",
                                          ship->name, body->name());
                                 echo_to_system(AT_ORANGE, ship, buf, NULL);
                                 destroy_ship(ship, NULL);
-                                /*
-                                 * continue; We do not want to continure here, we want to
-                                 * break the for loop here, the ships is not longer in a 
-                                 * system, so we don't need to do any of these checks, lets
-                                 * just go onto the next ship 
-                                 */
-                                break;
                         }
-
-                        if (distance < body->gravity()
-                            && (body->type() == PLANET_BODY
-                                || body->type() == MOON_BODY))
+                        else
                         {
                                 snprintf(buf, MSL, "You begin orbitting %s.",
                                          body->name());
@@ -380,10 +342,24 @@ void move_ships()
                                          ship->name, body->name());
                                 echo_to_system(AT_ORANGE, ship, buf, NULL);
                                 ship->currspeed = 0;
-                                continue;
                         }
                 }
         }
+
+        for (i = 0; i < missile_hits.size(); i++)
+        {
+                if ((missile = missile_hits[i]) == NULL)
+                        continue;
+                missile_hits[i] = NULL;
+                /*
+                 * The target may have jumped or flown into a sun since. 
+                 */
+                if (missile->target->starsystem != missile->starsystem)
+                        extract_missile(missile);
+                else
+                        missile_hit(missile);
+        }
+        missile_hits.clear();
 }
 
 void recharge_ships()
@@ -690,7 +666,8 @@ void update_space()
                                                 STRALLOC(ship->starsystem->
                                                          name);
                                         if (str_cmp("Public", ship->owner))
-                                                save_ship(ship);
+                                                persist_mark(PERSIST_SHIP,
+                                                             ship->filename);
 
                                 }
                         }
@@ -2014,7 +1991,7 @@ void save_ship(SHIP_DATA * ship)
         snprintf(filename, 256, "%s%s", SHIP_DIR, ship->filename);
 
         FCLOSE(fpReserve);
-        if ((fp = fopen(filename, "w")) == NULL)
+        if ((fp = persist_open(filename)) == NULL)
         {
                 bug("save_ship: fopen", 0);
                 perror(filename);
@@ -2099,7 +2076,7 @@ void save_ship(SHIP_DATA * ship)
                 fprintf(fp, "End\n\n");
                 fprintf(fp, "#END\n");
         }
-        FCLOSE(fp);
+        persist_close(fp);
         fpReserve = fopen(NULL_FILE, "r");
         return;
 }
@@ -4097,10 +4074,7 @@ void new_missile(SHIP_DATA * ship, SHIP_DATA * target, CHAR_DATA * ch,
 
         missile->target = target;
         missile->fired_from = ship;
-        if (ch)
-                missile->fired_by = STRALLOC(ch->name);
-        else
-                missile->fired_by = STRALLOC("");
+        missile->fired_by = (ch && !IS_NPC(ch)) ? ch : NULL;
         missile->missiletype = missiletype;
         missile->age = 0;
         if (missile->missiletype == HEAVY_BOMB)
@@ -4179,11 +4153,12 @@ void extract_missile(MISSILE_DATA * missile)
         }
 
         UNLINK(missile, first_missile, last_missile, next, prev);
+        std::replace(missile_hits.begin(), missile_hits.end(), missile,
+                     static_cast<MISSILE_DATA *>(NULL));
 
         missile->target = NULL;
         missile->fired_from = NULL;
-        if (missile->fired_by)
-                STRFREE(missile->fired_by);
+        missile->fired_by = NULL;
 
         DISPOSE(missile);
 
@@ -4627,7 +4602,7 @@ void really_destroy_ship(SHIP_DATA * ship)
 
         extract_ship(ship);
         snprintf(file, MSL, "%s%s", SHIP_DIR, ship->filename);
-        remove(file);
+        persist_remove(file);
         free_ship(ship);
         clear_targets(ship);
         UNLINK(ship, first_ship, last_ship, next, prev);
@@ -4647,7 +4622,7 @@ void really_destroy_mob_ship(SHIP_DATA * ship)
         extract_ship(ship);
         snprintf(file, MSL, "%s%s", SHIP_DIR, ship->filename);
         free_ship(ship);
-        remove(file);
+        persist_remove(file);
 
         clear_targets(ship);
         UNLINK(ship, first_ship, last_ship, next, prev);
@@ -4661,6 +4636,14 @@ void really_destroy_mob_ship(SHIP_DATA * ship)
 void clear_targets(SHIP_DATA * ship)
 {
         SHIP_DATA *target;
+        MISSILE_DATA *missile, *m_next;
+
+        for (missile = first_missile; missile; missile = m_next)
+        {
+                m_next = missile->next;
+                if (missile->target == ship || missile->fired_from == ship)
+                        extract_missile(missile);
+        }
 
         for (target = first_ship; target; target = target->next)
         {
@@ -10235,13 +10218,13 @@ CMDF do_unload_cargo(CHAR_DATA * ch, char *argument)
                 return;
         }
 
-        if (planet->cargoimport[target->cargotype] < 1)
+        if (economy_import_price(planet, target->cargotype) < 1)
         {
                 send_to_char("You can't deliver that here.\r\n", ch);
                 return;
         }
         cost = target->cargo;
-        cost *= planet->cargoimport[target->cargotype];
+        cost *= economy_import_price(planet, target->cargotype);
 
         ch->gold += cost;
         target->cargo = 0;
@@ -10389,25 +10372,21 @@ CMDF do_load_cargo(CHAR_DATA * ch, char *argument)
                 return;
         }
 
-        if (planet->cargoexport[cargo] < 1)
+        if (economy_export_price(planet, cargo) < 1)
         {
                 send_to_char("We don't export those goods here\r\n", ch);
                 return;
         }
 
-        if (planet->resource[cargo] < amount)
+        if (economy_stock(planet, cargo) < amount)
         {
                 send_to_char("&RSorry we do not have that much left.\r\n",
                              ch);
                 return;
         }
 
-        if (amount >= planet->resource[cargo])
-                cost = planet->resource[cargo];
-        else
-                cost = amount;
-
-        cost *= planet->cargoexport[cargo];
+        cost = UMIN(amount, economy_stock(planet, cargo));
+        cost *= economy_export_price(planet, cargo);
 
         if (ch->gold < cost)
         {
@@ -10416,19 +10395,8 @@ CMDF do_load_cargo(CHAR_DATA * ch, char *argument)
         }
         ch->gold -= cost;
 
-        if (amount >= planet->resource[cargo])
-        {
-
-                target->cargo += planet->resource[cargo];
-                planet->resource[cargo] = 0;
-                target->cargotype = cargo;
-        }
-        else
-        {
-                planet->resource[cargo] -= amount;
-                target->cargo += amount;
-                target->cargotype = cargo;
-        }
+        target->cargo += economy_take(planet, cargo, amount);
+        target->cargotype = cargo;
 
         ch_printf(ch, "You pay %d credits for a load of %s.\r\n", cost,
                   cargo_names[cargo]);
@@ -927,10 +927,7 @@ CMDF do_resetbody(CHAR_DATA * ch, char *argument)
 
         FOR_EACH_LIST(BODY_LIST, bodies, tbody)
         {
-                tbody->xpos(tbody->centerx() - (tbody->xmove() * 0));
-                tbody->ypos(tbody->centery() - (tbody->ymove() * 0));
-                tbody->zpos(tbody->centerz() - (tbody->zmove() * 1800));
-                tbody->orbitcount(0);
+                tbody->reset_orbit();
                 tbody->save();
         }
         send_to_char("All Body Coordinates Set.\n\r", ch);
@@ -979,196 +976,80 @@ CMDF do_placebody(CHAR_DATA * ch, char *argument)
 
         if (body)
         {
-                body->xpos(body->centerx() - (body->xmove() * 0));
-                body->ypos(body->centery() - (body->ymove() * 0));
-                body->zpos(body->centerz() - (body->zmove() * 1800));
-                body->orbitcount(0);
+                body->reset_orbit();
                 send_to_char("Body Coordinates Set.\n\r", ch);
                 body->save();
                 return;
         }
 }
 
+/*
+ * Bodies work out their own positions from the clock (see
+ * BODY_DATA::position_at), so all that is left each space pulse is
+ * carrying along ships that sit in a planet's gravity well.
+ */
 void update_orbit(void)
 {
-        BODY_DATA *tbody = NULL;
-        char      buf[MSL];
-        SHIP_DATA *ship;
         BODY_DATA *body = NULL;
-        int       phaze = 0, xtravel, ytravel, ztravel;
 
         FOR_EACH_LIST(BODY_LIST, bodies, body)
         {
-                if (!body->starsystem())
+                if (!body->starsystem() || !body->starsystem()->first_ship)
                         continue;
+                body->carry_ships();
+        }
+}
 
-                /*
-                 * Check to see if orbitcount is valid, reset if the orbit is done its rotation. 
-                 */
-                if (body->orbitcount() < 0)
-                        body->orbitcount(0);
-
-                if (body->orbitcount() >= 360)
-                {
-                        body->orbitcount(0);
-                        body->xpos(body->centerx() - (body->xmove() * 0));
-                        body->ypos(body->centery() - (body->ymove() * 0));
-                        body->zpos(body->centerz() - (body->zmove() * 1800));
-                }
-
-                /*
-                 * Set the planet's phaze to determine movement multipliers. 
-                 */
-                if ((body->orbitcount() >= 0) && (body->orbitcount() <= 45))
-                        phaze = 1;
-                else if ((body->orbitcount() >= 46)
-                         && (body->orbitcount() <= 90))
-                        phaze = 2;
-                else if ((body->orbitcount() >= 91)
-                         && (body->orbitcount() <= 135))
-                        phaze = 3;
-                else if ((body->orbitcount() >= 136)
-                         && (body->orbitcount() <= 180))
-                        phaze = 4;
-                else if ((body->orbitcount() >= 181)
-                         && (body->orbitcount() <= 225))
-                        phaze = 5;
-                else if ((body->orbitcount() >= 226)
-                         && (body->orbitcount() <= 270))
-                        phaze = 6;
-                else if ((body->orbitcount() >= 271)
-                         && (body->orbitcount() <= 315))
-                        phaze = 7;
-                else if ((body->orbitcount() >= 316)
-                         && (body->orbitcount() <= 360))
-                        phaze = 8;
-
-                /*
-                 * Use phaze to calculate the acctual travel distance for each coord. 
-                 */
-                xtravel = 0;
-                ytravel = 0;
-                ztravel = 0;
-
-                if (phaze == 1)
-                {
-                        xtravel = (body->xmove() * 20);
-                        ytravel = (body->ymove() * 10);
-                        ztravel = (body->zmove() * 20);
-                }
-                else if (phaze == 2)
-                {
-                        xtravel = (body->xmove() * 10);
-                        ytravel = (body->ymove() * 20);
-                        ztravel = (body->zmove() * 20);
-                }
-                else if (phaze == 3)
-                {
-                        xtravel = (body->xmove() * -10);
-                        ytravel = (body->ymove() * 20);
-                        ztravel = (body->zmove() * -20);
-                }
-                else if (phaze == 4)
-                {
-                        xtravel = (body->xmove() * -20);
-                        ytravel = (body->ymove() * 10);
-                        ztravel = (body->zmove() * -20);
-                }
-                else if (phaze == 5)
-                {
-                        xtravel = (body->xmove() * -20);
-                        ytravel = (body->ymove() * -10);
-                        ztravel = (body->zmove() * 20);
-                }
-                else if (phaze == 6)
-                {
-                        xtravel = (body->xmove() * -10);
-                        ytravel = (body->ymove() * -20);
-                        ztravel = (body->zmove() * 20);
-                }
-                else if (phaze == 7)
-                {
-                        xtravel = (body->xmove() * 10);
-                        ytravel = (body->ymove() * -20);
-                        ztravel = (body->zmove() * -20);
-                }
-                else if (phaze == 8)
-                {
-                        xtravel = (body->xmove() * 20);
-                        ytravel = (body->ymove() * -10);
-                        ztravel = (body->zmove() * -20);
-                }
+/*
+ * Warn imms about orbits that pass too close to a star.  Every body has
+ * the same period, so sampling one revolution covers every alignment.
+ */
+void check_orbits(void)
+{
+        BODY_DATA *body = NULL, *tbody = NULL;
+        int       i, bx, by, bz, tx, ty, tz;
+        double    dist;
+        time_t    when;
 
-                if (xtravel == 0 && ytravel == 0 && ztravel == 0)
+        FOR_EACH_LIST(BODY_LIST, bodies, body)
+        {
+                if (!body->starsystem() || body->type() == STAR_BODY
+                    || body->type() == ASTEROID_BODY
+                    || body->type() == NEBULA_BODY)
                         continue;
 
-                if (body->starsystem())
-                {
-                        SPACE_DATA *starsystem = body->starsystem();
-
-                        for (ship = starsystem->first_ship; ship;
-                             ship = ship->next_in_starsystem)
-                        {
-                                if (body->distance(ship) < body->gravity()
-                                    && (body->type() == PLANET_BODY
-                                        || body->type() == MOON_BODY))
-                                {
-                                        ship->vx += xtravel;
-                                        ship->vy += ytravel;
-                                        ship->vz += ztravel;
-                                }
-                        }
-                }
-                /*
-                 * Acctually preform the function of moving the body. 
-                 */
-                body->xpos(body->xpos() + xtravel);
-                body->ypos(body->ypos() + ytravel);
-                body->zpos(body->zpos() + ztravel);
-
-                /*
-                 * Advance the orbit count so the planet changes directions 
-                 */
-                body->orbitcount(body->orbitcount() + 1);
-
-                /*
-                 * Send a message to imms if planet is too close to sun 
-                 */
                 FOR_EACH_LIST(BODY_LIST, body->starsystem()->bodies, tbody)
                 {
-                        if (tbody == body)
-                                continue;
-                        if ((body->type() == PLANET_BODY
-                             && tbody->type() == PLANET_BODY)
-                            || (body->type() == STAR_BODY
-                                && tbody->type() == STAR_BODY)
-                            || (body->type() == STAR_BODY)
-                            || (body->type() == ASTEROID_BODY)
-                            || (body->type() == NEBULA_BODY)
-                            || (tbody->type() == ASTEROID_BODY)
-                            || (tbody->type() == NEBULA_BODY))
+                        if (tbody == body
+                            || (body->type() == PLANET_BODY
+                                && tbody->type() == PLANET_BODY)
+                            || tbody->type() == ASTEROID_BODY
+                            || tbody->type() == NEBULA_BODY)
                                 continue;
-                        if ((body->distance(tbody)) <
-                            ((tbody->gravity()) + (100)))
+
+                        for (i = 0; i < ORBIT_STEPS; i += 5)
                         {
-                                snprintf(buf, MSL,
-                                         "Body too close to sun: %s near %s\n\r Distance: %d Gavity: %d",
+                                when = current_time
+                                        + static_cast<time_t>(i) * ORBIT_STEP_SECONDS;
+                                body->position_at(when, bx, by, bz);
+                                tbody->position_at(when, tx, ty, tz);
+                                dist = sqrt(pow(bx - tx, 2) + pow(by - ty, 2)
+                                            + pow(bz - tz, 2));
+                                if (dist >= tbody->gravity() + 100)
+                                        continue;
+                                snprintf(log_buf, MSL,
+                                         "Body too close to sun: %s near %s at orbit step %d\n\r Distance: %d Gavity: %d",
                                          body->name(), tbody->name(),
-                                         body->distance(tbody),
-                                         (tbody->gravity() + 100));
-                                log_string(buf);
+                                         (body->orbitcount() + i) % ORBIT_STEPS,
+                                         static_cast<int>(dist),
+                                         tbody->gravity() + 100);
+                                log_string(log_buf);
+                                break;
                         }
                 }
-
-                /*
-                 * Save the body, go on to the next 
-                 */
-                body->save();   /* I don't think you should constnatly disk write on an update - Gavin */
-                continue;
         }
 }
 
-
 CMDF do_adjship(CHAR_DATA * ch, char *argument)
 {
         char      arg1[MAX_INPUT_LENGTH];
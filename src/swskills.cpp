@@ -4255,6 +4255,7 @@ void add_reinforcements(CHAR_DATA * ch)
                         if (mob->name)
                                 STRFREE(mob->name);
                         mob->name = STRALLOC("Elite guard");;
+                        name_index_update(mob);
                         stralloc_printf(&mob->long_descr,
                                         "(%s) Elite Guard\n",
                                         ch->pcdata->clan->name);
@@ -4272,6 +4273,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                         STRFREE(mob->name);
                         mob->name = STRALLOC("guard");
+                        name_index_update(mob);
                         stralloc_printf(&mob->long_descr, "%ss guard\n",
                                         ch->name);
                         /*
@@ -4319,6 +4321,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                 STRFREE(mob->name);
                 mob->name = STRALLOC("Installation guard");
+                name_index_update(mob);
                 stralloc_printf(&mob->long_descr, "%s", "Installation Guard");
                 if (mob->mob_clan)
                         STRFREE(mob->mob_clan);
@@ -4368,6 +4371,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                 STRFREE(mob->name);
                 mob->name = STRALLOC("Installation Entrance guard");
+                name_index_update(mob);
                 stralloc_printf(&mob->long_descr, "%s", "Installation Entrance Guard");
                 if (mob->mob_clan)
                         STRFREE(mob->mob_clan);
@@ -4419,6 +4423,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                 STRFREE(mob->name);
                 mob->name = STRALLOC("Installation Customs Office");
+                name_index_update(mob);
                 stralloc_printf(&mob->long_descr, "%s", "Installation Customs Officer");
                 if (mob->mob_clan)
                         STRFREE(mob->mob_clan);
@@ -4468,6 +4473,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                 STRFREE(mob->name);
                 mob->name = STRALLOC("Installation doctor");
+                name_index_update(mob);
                 stralloc_printf(&mob->long_descr, "%s",
                                 "Installation Doctor");
                 if (mob->mob_clan)
@@ -4526,6 +4532,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                         STRFREE(mob->name);
                         mob->name = STRALLOC("guard");
+                        name_index_update(mob);
                         stralloc_printf(&mob->long_descr, "(%s) Guard\n",
                                         ch->pcdata->clan->name);
                         if (mob->mob_clan)
@@ -4542,6 +4549,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                         STRFREE(mob->name);
                         mob->name = STRALLOC("guard");
+                        name_index_update(mob);
                         stralloc_printf(&mob->long_descr, "%ss Guard\n",
                                         ch->name);
                         /*
@@ -4585,6 +4593,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                         STRFREE(mob->name);
                         mob->name = STRALLOC("patrol");
+                        name_index_update(mob);
                         stralloc_printf(&mob->long_descr, "(%s) Patrol\n",
                                         ch->pcdata->clan->name);
                         if (mob->mob_clan)
@@ -4601,6 +4610,7 @@ void add_reinforcements(CHAR_DATA * ch)
 
                         STRFREE(mob->name);
                         mob->name = STRALLOC("patrol");
+                        name_index_update(mob);
                         stralloc_printf(&mob->long_descr, "%ss Patrol\n",
                                         ch->name);
                         /*
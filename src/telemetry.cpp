@@ -0,0 +1,407 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                          SWTFE Out-of-Band Telemetry Module                           *
+ ****************************************************************************************/
+#include <sys/types.h>
+#include <stdio.h>
+#include <string.h>
+#include <arpa/telnet.h>
+#include <string>
+#include "mud.hpp"
+#include "telemetry.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+const char *position_name(int position);
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ * What the client was last sent.  Groups are compared field by field and
+ * only formatted when something in them moved.
+ */
+struct telemetry_data
+{
+        CHAR_DATA *ch;          /* Whose values these are */
+        bool      sent;         /* Anything sent yet */
+
+        int       hit, max_hit, endurance, max_endurance;
+        int       position, level;
+
+        int       room;
+
+        bool      aboard;
+        std::string ship, system;
+        int       x, y, z;      /* Rounded, so drift does not resend */
+        int       speed, shield, maxshield, energy, maxenergy;
+        int       hull, maxhull;
+
+        bool      fighting;
+        std::string target;
+        int       target_pct;
+};
+
+/*
+ * Copy a game string out for a client.  Color codes are dropped.  For JSON
+ * quotes and backslashes are escaped; for MSDP the bytes that frame the
+ * subnegotiation are left out.
+ */
+static void telemetry_text(std::string & out, const char *str, bool json)
+{
+        for (; str && *str; str++)
+        {
+                unsigned char c = static_cast < unsigned char >(*str);
+
+                if (c == '&' || c == '^' || c == '}')
+                {
+                        if (!*++str)
+                                break;
+                        continue;
+                }
+                if (c == '\n')
+                {
+                        if (json)
+                                out += "\\n";
+                        continue;
+                }
+                if (c < ' ' || c == IAC)
+                        continue;
+                if (json && (c == '"' || c == '\\'))
+                        out += '\\';
+                out += static_cast < char >(c);
+        }
+}
+
+static void json_str(std::string & out, const char *key, const char *val)
+{
+        out += out.size() > 1 ? ",\"" : "\"";
+        out += key;
+        out += "\":\"";
+        telemetry_text(out, val, TRUE);
+        out += '"';
+}
+
+static void json_int(std::string & out, const char *key, long val)
+{
+        char      buf[32];
+
+        snprintf(buf, sizeof(buf), "%s\"%s\":%ld", out.size() > 1 ? "," : "",
+                 key, val);
+        out += buf;
+}
+
+static void gmcp_send(DESCRIPTOR_DATA * d, const char *event,
+                      std::string & json)
+{
+        json += '}';
+        send_gmcp_event(d, event, json.c_str());
+}
+
+static void msdp_str(std::string & out, const char *var, const char *val)
+{
+        out += static_cast < char >(MSDP_VAR);
+        out += var;
+        out += static_cast < char >(MSDP_VAL);
+        telemetry_text(out, val, FALSE);
+}
+
+static void msdp_int(std::string & out, const char *var, long val)
+{
+        char      buf[32];
+
+        snprintf(buf, sizeof(buf), "%ld", val);
+        msdp_str(out, var, buf);
+}
+
+static void msdp_send(DESCRIPTOR_DATA * d, const std::string & vars)
+{
+        std::string sb;
+
+        sb += static_cast < char >(IAC);
+        sb += static_cast < char >(SB);
+        sb += static_cast < char >(TELOPT_MSDP);
+        sb += vars;
+        sb += static_cast < char >(IAC);
+        sb += static_cast < char >(SE);
+        write_to_buffer_oob(d, sb.data(), static_cast < int >(sb.size()));
+}
+
+static void telemetry_vitals(DESCRIPTOR_DATA * d, TELEMETRY_DATA * t,
+                             CHAR_DATA * ch, std::string & msdp)
+{
+        std::string json = "{";
+
+        if (t->sent && t->hit == ch->hit && t->max_hit == ch->max_hit
+            && t->endurance == ch->endurance
+            && t->max_endurance == ch->max_endurance
+            && t->position == ch->position && t->level == ch->top_level)
+                return;
+        t->hit = ch->hit;
+        t->max_hit = ch->max_hit;
+        t->endurance = ch->endurance;
+        t->max_endurance = ch->max_endurance;
+        t->position = ch->position;
+        t->level = ch->top_level;
+
+        if (d->gmcp_detected)
+        {
+                json_str(json, "name", ch->name);
+                json_int(json, "level", ch->top_level);
+                json_int(json, "hp", ch->hit);
+                json_int(json, "maxhp", ch->max_hit);
+                json_int(json, "endurance", ch->endurance);
+                json_int(json, "maxendurance", ch->max_endurance);
+                json_str(json, "position", position_name(ch->position));
+                gmcp_send(d, "Core.Character.Status", json);
+        }
+        if (d->msdp_detected)
+        {
+                msdp_str(msdp, "CHARACTER_NAME", ch->name);
+                msdp_int(msdp, "LEVEL", ch->top_level);
+                msdp_int(msdp, "HEALTH", ch->hit);
+                msdp_int(msdp, "HEALTH_MAX", ch->max_hit);
+                msdp_int(msdp, "MOVEMENT", ch->endurance);
+                msdp_int(msdp, "MOVEMENT_MAX", ch->max_endurance);
+                msdp_str(msdp, "POSITION", position_name(ch->position));
+        }
+}
+
+static void telemetry_room(DESCRIPTOR_DATA * d, TELEMETRY_DATA * t,
+                           CHAR_DATA * ch, std::string & msdp)
+{
+        ROOM_INDEX_DATA *room = ch->in_room;
+        const char *area = room->area ? room->area->name : "";
+        std::string json = "{";
+
+        if (t->sent && t->room == room->vnum)
+                return;
+        t->room = room->vnum;
+
+        if (d->gmcp_detected)
+        {
+                json_int(json, "num", room->vnum);
+                json_str(json, "name", room->name);
+                json_str(json, "area", area);
+                json_str(json, "desc", room->description);
+                gmcp_send(d, "Core.Room.Info", json);
+        }
+        if (d->msdp_detected)
+        {
+                msdp_int(msdp, "ROOM_VNUM", room->vnum);
+                msdp_str(msdp, "ROOM_NAME", room->name);
+                msdp_str(msdp, "AREA_NAME", area);
+        }
+}
+
+/*
+ * Only rooms flagged as spacecraft are looked up, so characters on the
+ * ground never walk the ship list.
+ */
+static void telemetry_ship(DESCRIPTOR_DATA * d, TELEMETRY_DATA * t,
+                           CHAR_DATA * ch, std::string & msdp)
+{
+        SHIP_DATA *ship = NULL;
+        const char *system;
+        std::string json = "{";
+
+        if (xIS_SET(ch->in_room->room_flags, ROOM_SPACECRAFT))
+                ship = ship_from_room(ch->in_room->vnum);
+
+        if (!ship)
+        {
+                if (t->sent && !t->aboard)
+                        return;
+                t->aboard = FALSE;
+                t->ship.clear();
+                if (d->gmcp_detected)
+                        gmcp_send(d, "Core.Ship.Status", json);
+                if (d->msdp_detected)
+                        msdp_str(msdp, "SHIP_NAME", "");
+                return;
+        }
+
+        system = ship->starsystem ? ship->starsystem->name : "";
+        if (t->sent && t->aboard && t->ship == ship->name
+            && t->system == system && t->x == static_cast < int >(ship->vx)
+            && t->y == static_cast < int >(ship->vy)
+            && t->z == static_cast < int >(ship->vz)
+            && t->speed == ship->currspeed && t->shield == ship->shield
+            && t->maxshield == ship->maxshield && t->energy == ship->energy
+            && t->maxenergy == ship->maxenergy && t->hull == ship->hull
+            && t->maxhull == ship->maxhull)
+                return;
+        t->aboard = TRUE;
+        t->ship = ship->name;
+        t->system = system;
+        t->x = static_cast < int >(ship->vx);
+        t->y = static_cast < int >(ship->vy);
+        t->z = static_cast < int >(ship->vz);
+        t->speed = ship->currspeed;
+        t->shield = ship->shield;
+        t->maxshield = ship->maxshield;
+        t->energy = ship->energy;
+        t->maxenergy = ship->maxenergy;
+        t->hull = ship->hull;
+        t->maxhull = ship->maxhull;
+
+        if (d->gmcp_detected)
+        {
+                json_str(json, "name", ship->name);
+                json_str(json, "system", system);
+                json_int(json, "x", t->x);
+                json_int(json, "y", t->y);
+                json_int(json, "z", t->z);
+                json_int(json, "speed", t->speed);
+                json_int(json, "shield", t->shield);
+                json_int(json, "maxshield", t->maxshield);
+                json_int(json, "energy", t->energy);
+                json_int(json, "maxenergy", t->maxenergy);
+                json_int(json, "hull", t->hull);
+                json_int(json, "maxhull", t->maxhull);
+                gmcp_send(d, "Core.Ship.Status", json);
+        }
+        if (d->msdp_detected)
+        {
+                msdp_str(msdp, "SHIP_NAME", ship->name);
+                msdp_str(msdp, "SHIP_SYSTEM", system);
+                msdp_int(msdp, "SHIP_X", t->x);
+                msdp_int(msdp, "SHIP_Y", t->y);
+                msdp_int(msdp, "SHIP_Z", t->z);
+                msdp_int(msdp, "SHIP_SPEED", t->speed);
+                msdp_int(msdp, "SHIP_SHIELD", t->shield);
+                msdp_int(msdp, "SHIP_SHIELD_MAX", t->maxshield);
+                msdp_int(msdp, "SHIP_ENERGY", t->energy);
+                msdp_int(msdp, "SHIP_ENERGY_MAX", t->maxenergy);
+                msdp_int(msdp, "SHIP_HULL", t->hull);
+                msdp_int(msdp, "SHIP_HULL_MAX", t->maxhull);
+        }
+}
+
+static void telemetry_target(DESCRIPTOR_DATA * d, TELEMETRY_DATA * t,
+                             CHAR_DATA * ch, std::string & msdp)
+{
+        CHAR_DATA *victim = ch->fighting ? ch->fighting->who : NULL;
+        const char *name;
+        int       pct;
+        std::string json = "{";
+
+        if (!victim)
+        {
+                if (t->sent && !t->fighting)
+                        return;
+                t->fighting = FALSE;
+                t->target.clear();
+                if (d->gmcp_detected)
+                        gmcp_send(d, "Core.Combat.Target", json);
+                if (d->msdp_detected)
+                {
+                        msdp_str(msdp, "OPPONENT_NAME", "");
+                        msdp_int(msdp, "OPPONENT_HEALTH", 0);
+                }
+                return;
+        }
+
+        name = PERS(victim, ch);
+        pct = victim->max_hit > 0 ? victim->hit * 100 / victim->max_hit : 0;
+        if (t->sent && t->fighting && t->target_pct == pct
+            && t->target == name)
+                return;
+        t->fighting = TRUE;
+        t->target = name;
+        t->target_pct = pct;
+
+        if (d->gmcp_detected)
+        {
+                json_str(json, "name", name);
+                json_int(json, "percent", pct);
+                gmcp_send(d, "Core.Combat.Target", json);
+        }
+        if (d->msdp_detected)
+        {
+                msdp_str(msdp, "OPPONENT_NAME", name);
+                msdp_int(msdp, "OPPONENT_HEALTH", pct);
+        }
+}
+
+static void telemetry_step(DESCRIPTOR_DATA * d, CHAR_DATA * ch)
+{
+        TELEMETRY_DATA *t = d->telemetry;
+        std::string msdp;
+
+        if (!t)
+                t = d->telemetry = new TELEMETRY_DATA();
+        else if (t->ch != ch)
+                *t = TELEMETRY_DATA();
+        t->ch = ch;
+
+        telemetry_vitals(d, t, ch, msdp);
+        telemetry_room(d, t, ch, msdp);
+        telemetry_ship(d, t, ch, msdp);
+        telemetry_target(d, t, ch, msdp);
+        t->sent = TRUE;
+
+        if (!msdp.empty())
+                msdp_send(d, msdp);
+}
+
+void telemetry_update(void)
+{
+        DESCRIPTOR_DATA *d;
+
+        for (d = first_descriptor; d; d = d->next)
+        {
+                if (!d->gmcp_detected && !d->msdp_detected)
+                        continue;
+                if ((d->connected != CON_PLAYING
+                     && d->connected != CON_EDITING) || !d->character
+                    || !d->character->in_room)
+                {
+                        free_telemetry(d);
+                        continue;
+                }
+                telemetry_step(d, d->character);
+        }
+}
+
+void free_telemetry(DESCRIPTOR_DATA * d)
+{
+        delete d->telemetry;
+        d->telemetry = NULL;
+}
@@ -0,0 +1,67 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                          SWTFE Out-of-Band Telemetry Module                           *
+ ****************************************************************************************/
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+/*
+ * Out-of-band character state for GMCP and MSDP clients.
+ *
+ * Each descriptor that has agreed to GMCP or MSDP keeps the values it was
+ * last sent: vitals, room, the ship it is aboard and its combat target.
+ * telemetry_update() runs once a pulse, after the game has moved.  It
+ * compares each group with what the client already has and sends only the
+ * groups that changed.  GMCP gets one message per group, MSDP gets every
+ * changed variable in one subnegotiation.
+ *
+ * Nothing is sent until the client answers DO GMCP or DO MSDP.  Freeing
+ * the state with free_telemetry() makes the next pulse send everything.
+ */
+#ifndef TELOPT_MSDP
+#define TELOPT_MSDP		69
+#endif
+#define MSDP_VAR		1
+#define MSDP_VAL		2
+
+void      send_gmcp_event(DESCRIPTOR_DATA * d, const char *event,
+                          const char *data);
+void      telemetry_update(void);
+void      free_telemetry(DESCRIPTOR_DATA * d);
+
+#endif
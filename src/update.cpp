@@ -53,6 +53,9 @@
 #include "races.hpp"
 #include "space2.hpp"
 #include "installations.hpp"
+#include "persist.hpp"
+#include "search.hpp"
+#include "economy.hpp"
 
 /* from swskills.c
  * Local functions.
@@ -63,7 +66,6 @@ int move_gain args((CHAR_DATA * ch));
 void gain_addiction args((CHAR_DATA * ch));
 void mobile_update args((void));
 void weather_update args((void));
-void update_taxes args((void));
 void update_salaries args((void));
 void      update_baccounts();
 
@@ -1147,6 +1149,12 @@ void mobile_update(void)
                 if (ch->position < POS_STANDING)
                         continue;
 
+                /*
+                 * Nobody in the area to see the rest, so leave it be
+                 */
+                if (ch->in_room->area->nplayer == 0)
+                        continue;
+
                 /*
                  * Scavenge 
                  */
@@ -1302,166 +1310,6 @@ void update_salaries(void)
         }
 }
 
-void update_taxes(void)
-{
-        PLANET_DATA *planet;
-        int       i, iv, ev;
-        CLAN_DATA *clan;
-        char      buf[MAX_STRING_LENGTH];
-
-        for (planet = first_planet; planet; planet = planet->next)
-        {
-                for (i = 1; i < CARGO_MAX; i++)
-                {
-                        /*
-                         * Set resources value (iv)
-                         */
-                        iv = 0;
-                        ev = 0;
-                        if (planet->resource[i] > 1
-                            && planet->resource[i] < 10)
-                        {
-                                iv = 10;
-                                ev = 1;
-                        }
-                        if (planet->resource[i] > 10
-                            && planet->resource[i] < 100)
-                        {
-                                iv = 9;
-                                ev = 2;
-                        }
-                        if (planet->resource[i] > 100
-                            && planet->resource[i] < 1000)
-                        {
-                                iv = 8;
-                                ev = 3;
-                        }
-                        if (planet->resource[i] > 1000
-                            && planet->resource[i] < 10000)
-                        {
-                                iv = 7;
-                                ev = 4;
-                        }
-                        if (planet->resource[i] > 10000
-                            && planet->resource[i] < 50000)
-                        {
-                                iv = 6;
-                                ev = 5;
-                        }
-                        if (planet->resource[i] > 50000
-                            && planet->resource[i] < 100000)
-                        {
-                                iv = 5;
-                                ev = 6;
-                        }
-                        if (planet->resource[i] > 100000
-                            && planet->resource[i] < 500000)
-                        {
-                                iv = 4;
-                                ev = 7;
-                        }
-                        if (planet->resource[i] > 500000
-                            && planet->resource[i] < 1000000)
-                        {
-                                iv = 3;
-                                ev = 8;
-                        }
-                        if (planet->resource[i] > 1000000)
-                        {
-                                iv = 2;
-                                ev = 9;
-                        }
-                        if (iv > ev)
-                        {
-                                /*
-                                 * Adjust import and export costs
-                                 */
-                                planet->cargoimport[i] =
-                                        ((10 * i) * (iv)) +
-                                        (int) (number_percent() * (0.1));
-                                planet->cargoexport[i] = 0;
-                                /*
-                                 * Adjust production and consumtion
-                                 */
-                                planet->produces[i] =
-                                        (int) (1.6 * number_percent() *
-                                               (iv - ev)) +
-                                        (number_percent());
-                                planet->consumes[i] =
-                                        (number_percent() * (iv - ev)) +
-                                        (number_percent());
-                        }
-                        else    /* if ( iv < ev ) */
-                        {
-                                /*
-                                 * Adjust import and export costs
-                                 */
-                                planet->cargoexport[i] =
-                                        ((10 * i) * (iv)) +
-                                        (int) (number_percent() * (0.1));
-                                planet->cargoimport[i] = 0;
-                                /*
-                                 * Adjust production and consumtion
-                                 */
-                                planet->produces[i] =
-                                        (number_percent() * (ev - iv)) +
-                                        (number_percent());
-                                planet->consumes[i] =
-                                        (int) (1.6 * number_percent() *
-                                               (ev - iv)) +
-                                        (number_percent());
-                        }
-                        /*
-                         * Implement production and consumtion values 
-                         */
-
-                        planet->resource[i] += planet->produces[i];
-
-                        planet->resource[i] -= planet->consumes[i];
-                        /*
-                         * Broadcast urgent import messages 
-                         */
-                        if (planet->resource[i] < 10000
-                            && planet->resource[i] > 0)
-                        {
-                                snprintf(buf, MSL,
-                                         "Trade Alert: %s is in need of imports!",
-                                         planet->name);
-                                echo_to_all(AT_GOLD, buf, 0);
-                        }
-                        /*
-                         * Reset negative values to 1 
-                         */
-                        /*
-                         * and do emergency import stuff 
-                         */
-                        if (planet->resource[i] < 0)
-                        {
-                                planet->resource[i] = 1;
-                                planet->cargoimport[i] =
-                                        ((100 * i) +
-                                         (int) (number_percent() * (0.1)));
-                                planet->cargoexport[i] = 0;
-                                snprintf(buf, MSL,
-                                         "Trade Alert: %s is in need of emergency imports!",
-                                         planet->name);
-                                echo_to_all(AT_GOLD, buf, 0);
-                        }
-                        /*
-                         * Save the planet file 
-                         */
-                        save_planet(planet, FALSE);
-                }
-                clan = planet->governed_by;
-                if (clan)
-                {
-                        clan->funds += get_taxes(planet) / 360;
-                        save_clan(clan);
-                        save_planet(planet, FALSE);
-                }
-        }
-}
-
 /*
  * Update the weather.
  */
@@ -2895,14 +2743,13 @@ void aggr_update(void)
                     || wch->top_level >= LEVEL_IMMORTAL || !wch->in_room)
                         continue;
 
-                for (ch = wch->in_room->first_person; ch; ch = ch_next)
+                for (ch = wch->in_room->first_npc; ch; ch = ch_next)
                 {
                         int       count = 0;
 
-                        ch_next = ch->next_in_room;
+                        ch_next = ch->next_in_kind;
 
-                        if (!IS_NPC(ch)
-                            || ch->fighting
+                        if (ch->fighting
                             || IS_AFFECTED(ch, AFF_CHARM)
                             || !IS_AWAKE(ch)
                             || (IS_SET(ch->act, ACT_WIMPY))
@@ -3155,11 +3002,12 @@ void update_handler(void)
         if (--sysdata.pulse_taxes <= 0)
         {
                 sysdata.pulse_taxes = PULSE_TAXES;
-                update_orbit();
-                update_taxes();
+                economy_settle();
                 update_salaries();
                 update_baccounts();
         }
+        else
+                economy_update(sysdata.pulse_taxes);
 
         if (--sysdata.pulse_mobile <= 0)
         {
@@ -3170,6 +3018,7 @@ void update_handler(void)
         if (--sysdata.pulse_space <= 0)
         {
                 sysdata.pulse_space = PULSE_SPACE;
+                update_orbit();
                 update_shuttle();
                 update_space();
                 do_who(NULL, "");
@@ -3252,6 +3101,9 @@ void update_handler(void)
                 auction_update();
         }
 
+        area_reset_update();        /* Queued area resets */
+        persist_update();   /* Save dirty homes, accounts, clans, ... */
+        search_update();    /* Page out asearch results */
         mpsleep_update();   /* Check for sleeping mud progs -rkb */
         aggr_update();
         obj_act_update();
@@ -3751,50 +3603,3 @@ void battalion_update(void)
 
         }
 }
-
-/* Can I remove this? */
-void logsize_update(void)
-{
-        char      buf[MAX_STRING_LENGTH];
-
-        snprintf(buf, MSL, "%s%s", SYSTEM_DIR, BUG_FILE);
-        if (file_size(buf) > sysdata.log_size)
-        {
-                FILE     *fp = fopen(buf, "w");
-
-                if (fp)
-                        FCLOSE(fp);
-        }
-        snprintf(buf, MSL, "%s%s", SYSTEM_DIR, LOG_FILE);
-        if (file_size(buf) > sysdata.log_size)
-        {
-                FILE     *fp = fopen(buf, "w");
-
-                if (fp)
-                        FCLOSE(fp);
-        }
-        snprintf(buf, MSL, "%s%s", SYSTEM_DIR, IDEA_FILE);
-        if (file_size(buf) > sysdata.log_size)
-        {
-                FILE     *fp = fopen(buf, "w");
-
-                if (fp)
-                        FCLOSE(fp);
-        }
-        snprintf(buf, MSL, "%s%s", SYSTEM_DIR, HELP_FILE);
-        if (file_size(buf) > sysdata.log_size)
-        {
-                FILE     *fp = fopen(buf, "w");
-
-                if (fp)
-                        FCLOSE(fp);
-        }
-        snprintf(buf, MSL, "%s%s", LOG_DIR, "swr.log");
-        if (file_size(buf) > sysdata.log_size)
-        {
-                FILE     *fp = fopen(buf, "w");
-
-                if (fp)
-                        FCLOSE(fp);
-        }
-}
@@ -0,0 +1,220 @@
+/* vim: ts=8 et ft=cpp sw=8
+ *****************************************************************************************
+ *                       DDDDD        A        RRRRRRR     K    K                        *
+ *                       D    D      A A       R      R    K   K                         *
+ *                       D     D    A   A      R      R    KK K                          *
+ *                       D     D   A     A     RRRRRRR     K K                           *
+ *                       D     D  AAAAAAAAA    R    R      K  K                          *
+ *                       D    D  A         A   R     R     K   K                         *
+ *                       DDDDD  A           A  R      R    K    K                        *
+ *                                                                                       *
+ *                                                                                       *
+ *W      WW      W    A        RRRRRRR   RRRRRRR   IIIIIIII    OOOO   RRRRRRR     SSSSS  *
+ * W    W  W    W    A A       R      R  R      R     II      O    O  R      R   S       *
+ * W    W  W    W   A   A      R      R  R      R     II     O      O R      R   S       *
+ * W    W  W    W  A     A     RRRRRRR   RRRRRRR      II     O      O RRRRRRR     SSSSS  *
+ *  W  W    W  W  AAAAAAAAA    R    R    R    R       II     O      O R    R           S *
+ *  W W     W W  A         A   R     R   R     R      II      O    O  R     R          S *
+ *   W       W  A           A  R      R  R      R  IIIIIIII    OOOO   R      R    SSSSS  *
+ *                                                                                       *
+ *****************************************************************************************
+ *                                                                                       *
+ * Dark Warrior Code additions and changes from the Star Wars Reality code copyright (c) *
+ * 2005 by Michael Ervin, Mark Gottselig, Gavin Mogan                                    *
+ *                                                                                       *
+ * Star Wars Reality Code Additions and changes from the Smaug Code copyright (c) 1997   *
+ * by Sean Cooper                                                                        *
+ *                                                                                       *
+ * Starwars and Starwars Names copyright(c) Lucas Film Ltd.                              *
+ *****************************************************************************************
+ * Original SMAUG 1.4a written by Thoric (Derek Snider) with Altrag, Blodkai, Haus, Narn,*
+ * Scryn, Swordbearer, Tricops, Gorog, Rennard, Grishnakh, Fireblade, and Nivek.         *
+ *                                                                                       *
+ * Original MERC 2.1 code by Hatchet, Furey, and Kahn.                                   *
+ *                                                                                       *
+ * Original DikuMUD code by: Hans Staerfeldt, Katja Nyboe, Tom Madsen, Michael Seifert,  *
+ * and Sebastian Hammer.                                                                 *
+ *****************************************************************************************
+ *                               SWTFE Vnum Index Tables                                 *
+ ****************************************************************************************/
+#ifndef _VNUMTABLE_H_
+#define _VNUMTABLE_H_
+
+#include <stddef.h>
+#include <vector>
+
+/*
+ * Direct vnum -> index data lookup.
+ *
+ * The vnum is split into three parts: the low 8 bits pick a slot in a
+ * 256 entry leaf page, the next 12 bits pick a leaf in a 4096 entry middle
+ * page, and the rest picks the middle page from a small top directory.
+ * Pages are only allocated for vnum blocks that are actually in use, so a
+ * few scattered ship and home vnums up near MAX_VNUMS cost a couple of
+ * pages rather than a flat array.  Lookup is three array hops, and walking
+ * first()/next() visits entries in ascending vnum order.
+ *
+ * The table only mirrors the *_index_hash chains, it does not own the
+ * entries.  Whoever links or unlinks an index in the hash keeps the table
+ * in step with set()/remove().
+ */
+template < class T > class VNUM_TABLE
+{
+      private:
+        static const int LEAF_BITS = 8;
+        static const int MID_BITS = 12;
+        static const int LEAF_SIZE = 1 << LEAF_BITS;
+        static const int MID_SIZE = 1 << MID_BITS;
+
+        struct leaf_page
+        {
+                T        *slot[LEAF_SIZE];
+        };
+        struct mid_page
+        {
+                leaf_page *leaf[MID_SIZE];
+        };
+
+        std::vector < mid_page * >_top;
+        int       _count;
+
+        static size_t top_index(int vnum)
+        {
+                return static_cast < size_t > (vnum) >> (LEAF_BITS + MID_BITS);
+        }
+        static size_t mid_index(int vnum)
+        {
+                return (static_cast < size_t > (vnum) >> LEAF_BITS) & (MID_SIZE - 1);
+        }
+        static size_t leaf_index(int vnum)
+        {
+                return static_cast < size_t > (vnum) & (LEAF_SIZE - 1);
+        }
+
+      public:
+        VNUM_TABLE():_count(0)
+        {
+        }
+        ~VNUM_TABLE()
+        {
+                clear();
+        }
+        VNUM_TABLE(const VNUM_TABLE &) = delete;
+        VNUM_TABLE & operator=(const VNUM_TABLE &) = delete;
+
+        inline T *get(int vnum) const
+        {
+                size_t    top;
+                leaf_page *leaf;
+
+                if (vnum < 0 || (top = top_index(vnum)) >= _top.size()
+                    || !_top[top])
+                        return NULL;
+                leaf = _top[top]->leaf[mid_index(vnum)];
+                return leaf ? leaf->slot[leaf_index(vnum)] : NULL;
+        }
+
+        void set(int vnum, T * item)
+        {
+                if (vnum < 0)
+                        return;
+
+                leaf_page *&leaf = *leaf_for(vnum);
+
+                if (!leaf)
+                        leaf = new leaf_page();
+                if (!leaf->slot[leaf_index(vnum)])
+                        _count++;
+                leaf->slot[leaf_index(vnum)] = item;
+        }
+
+        /*
+         * Only clears the slot if it still holds this item, so unlinking a
+         * stale duplicate never hides the live entry.
+         */
+        void remove(int vnum, T * item)
+        {
+                size_t    top;
+                leaf_page *leaf;
+
+                if (vnum < 0 || (top = top_index(vnum)) >= _top.size()
+                    || !_top[top])
+                        return;
+                leaf = _top[top]->leaf[mid_index(vnum)];
+                if (!leaf || leaf->slot[leaf_index(vnum)] != item)
+                        return;
+                leaf->slot[leaf_index(vnum)] = NULL;
+                _count--;
+        }
+
+        inline int count() const
+        {
+                return _count;
+        }
+
+        /*
+         * First entry with a vnum strictly greater than the one given.
+         * Whole empty pages are skipped in one step.
+         */
+        T        *next(int vnum) const
+        {
+                size_t    v = vnum < 0 ? 0 : static_cast < size_t > (vnum) + 1;
+                size_t    top, mid, slot;
+
+                for (top = v >> (LEAF_BITS + MID_BITS); top < _top.size();
+                     top++, v = top << (LEAF_BITS + MID_BITS))
+                {
+                        if (!_top[top])
+                                continue;
+                        for (mid = (v >> LEAF_BITS) & (MID_SIZE - 1);
+                             mid < MID_SIZE; mid++, v = (top << (LEAF_BITS + MID_BITS)) | (mid << LEAF_BITS))
+                        {
+                                leaf_page *leaf = _top[top]->leaf[mid];
+
+                                if (!leaf)
+                                        continue;
+                                for (slot = v & (LEAF_SIZE - 1); slot < LEAF_SIZE; slot++)
+                                        if (leaf->slot[slot])
+                                                return leaf->slot[slot];
+                        }
+                }
+                return NULL;
+        }
+
+        inline T *first() const
+        {
+                return next(-1);
+        }
+
+        void clear()
+        {
+                for (mid_page * mid:_top)
+                {
+                        if (!mid)
+                                continue;
+                        for (leaf_page * leaf:mid->leaf)
+                                delete    leaf;
+                        delete    mid;
+                }
+                _top.clear();
+                _count = 0;
+        }
+
+      private:
+        leaf_page **leaf_for(int vnum)
+        {
+                size_t    top = top_index(vnum);
+
+                if (top >= _top.size())
+                        _top.resize(top + 1, NULL);
+                if (!_top[top])
+                        _top[top] = new mid_page();
+                return &_top[top]->leaf[mid_index(vnum)];
+        }
+};
+
+extern VNUM_TABLE < ROOM_INDEX_DATA > room_index_table;
+extern VNUM_TABLE < MOB_INDEX_DATA > mob_index_table;
+extern VNUM_TABLE < OBJ_INDEX_DATA > obj_index_table;
+
+#endif
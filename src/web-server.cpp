@@ -116,7 +116,7 @@ void      web_header(WEB_DESCRIPTOR * wdesc, char *title);
 void      web_footer(WEB_DESCRIPTOR * wdesc);
 
 /* FUNCTION DEFS */
-int       send_buf(int fd, char *buf, bool filter);
+int       send_buf(int fd, const char *buf, int filter);
 void      handle_web_request(WEB_DESCRIPTOR * wdesc);
 void      handle_web_who_request(WEB_DESCRIPTOR * wdesc);
 void      handle_web_wwwwho_request(WEB_DESCRIPTOR * wdesc);
@@ -591,7 +591,7 @@ void handle_web(void)
 
 /* Generic Utility Function */
 
-int send_buf(int fd, char *buf, int filter)
+int send_buf(int fd, const char *buf, int filter)
 {
         char string[MSL * 10];
 
@@ -663,7 +663,8 @@ void handle_web_request(WEB_DESCRIPTOR * wdesc)
                 handle_web_clan_request(wdesc);
                 return;
         }
-        else if (strstr(wdesc->request, "/printooc.htm "))
+        else if (strstr(wdesc->request, "/printooc.htm ")
+                 || strstr(wdesc->request, "/printooc.htm?"))
         {
 //                log_string("Web Hit: CLAN-LIST");
                 print_ooc_history(wdesc);
@@ -2270,13 +2271,17 @@ void web_footer(WEB_DESCRIPTOR * wdesc)
 }
 
 
+/*
+ * /printooc.htm shows the recent lines kept in memory;
+ * /printooc.htm?days=N&page=P reads back from the history file.
+ */
 void print_ooc_history(WEB_DESCRIPTOR * wdesc)
 {
         CHANNEL_DATA *channel;
         char buf[MAX_STRING_LENGTH];
         char buf1[MAX_STRING_LENGTH];
+        const char *query;
         int count = 0;
-        int pos = 0;
 
         web_header(wdesc, "Index");
 
@@ -2287,26 +2292,55 @@ void print_ooc_history(WEB_DESCRIPTOR * wdesc)
                 return;
         }
 
-        snprintf(buf, MSL * 2, "&B%c&z%s History\n\rB-----------\n\r", channel->name[0],
+        if ((query = strstr(wdesc->request, "/printooc.htm?")) != NULL)
+        {
+                std::vector<channel_log_line> lines;
+                const char *opt;
+                int days = 0, page = 1;
+                int per_page = sysdata.channellog > 0 ? sysdata.channellog : 20;
+                time_t from;
+
+                if ((opt = strstr(query, "days=")) != NULL)
+                        days = URANGE(0, atoi(opt + 5), 3650);
+                if ((opt = strstr(query, "page=")) != NULL)
+                        page = UMAX(1, atoi(opt + 5));
+                from = current_time - current_time % 86400 -
+                        static_cast<time_t>(days) * 86400;
+
+                snprintf(buf, sizeof(buf), "&B%c&z%s History from %.10s, page %d\n\rB-----------\n\r",
+                         channel->name[0], channel->name + 1, ctime(&from), page);
+                send_buf(wdesc->fd, buf, 2);
+                count = (page - 1) * per_page;
+                read_channel_logfile(channel, from, count, per_page, lines);
+                for (channel_log_line &line : lines)
+                {
+                        snprintf(buf1, sizeof(buf1), "%s", line.message.c_str());
+                        snprintf(buf, sizeof(buf),
+                                 "&B[&W%2d&B][&W%.24s&B]&D %s %s&W: &W%s&w\n\r",
+                                 ++count, ctime(&line.time), channel->name,
+                                 line.name.c_str(), buf1);
+                        send_buf(wdesc->fd, buf, 2);
+                        send_buf(wdesc->fd, "<br>", 2);
+                }
+                web_footer(wdesc);
+                return;
+        }
+
+        snprintf(buf, sizeof(buf), "&B%c&z%s History\n\rB-----------\n\r", channel->name[0],
                 channel->name + 1);
         send_buf(wdesc->fd, buf, 2);
-        while (1)
+        for (count = 0; count < channel->logcount; count++)
         {
-                if (count++ >= sysdata.channellog)
-                        break;
-                if (pos > channel->logpos)
-                        break;
-                buf[0] = '\0';
+                LOG_DATA *entry = channel_log_entry(channel, count);
 
-                snprintf(buf1, MSL, "%s", channel->log[pos].message);
-                snprintf(buf, MSL * 2,
+                snprintf(buf1, sizeof(buf1), "%s", entry->message);
+                snprintf(buf, sizeof(buf),
                          "&B[&W%2d&B][&W%.24s&B]&D %s %s&W: &W%s&w\n\r",
-                         count,
-                         ctime(&channel->log[pos].time),
-                         channel->name, channel->log[pos].name, buf1);
+                         count + 1,
+                         ctime(&entry->time),
+                         channel->name, entry->name, buf1);
                 send_buf(wdesc->fd, buf, 2);
                 send_buf(wdesc->fd, "<br>", 2);
-                pos++;
         }
 
         web_footer(wdesc);